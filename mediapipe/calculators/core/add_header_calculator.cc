@@ -31,6 +31,7 @@ class AddHeaderCalculator : public CalculatorBase {
     cc->Inputs().Tag("HEADER").SetNone();
     cc->Inputs().Tag("DATA").SetAny();
     cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Tag("DATA"));
+    cc->SetTimestampOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
@@ -39,7 +40,6 @@ class AddHeaderCalculator : public CalculatorBase {
     if (!header.IsEmpty()) {
       cc->Outputs().Index(0).SetHeader(header);
     }
-    cc->SetOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
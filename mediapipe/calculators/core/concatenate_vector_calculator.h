@@ -41,12 +41,12 @@ class ConcatenateVectorCalculator : public CalculatorBase {
     }
 
     cc->Outputs().Index(0).Set<std::vector<T>>();
+    cc->SetTimestampOffset(TimestampDiff(0));
 
     return ::mediapipe::OkStatus();
   }
 
   ::mediapipe::Status Open(CalculatorContext* cc) override {
-    cc->SetOffset(TimestampDiff(0));
     only_emit_if_all_present_ =
         cc->Options<::mediapipe::ConcatenateVectorCalculatorOptions>()
             .only_emit_if_all_present();
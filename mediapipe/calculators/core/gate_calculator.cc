@@ -97,12 +97,12 @@ class GateCalculator : public CalculatorBase {
     if (cc->Outputs().HasTag("STATE_CHANGE")) {
       cc->Outputs().Tag("STATE_CHANGE").Set<bool>();
     }
+    cc->SetTimestampOffset(TimestampDiff(0));
 
     return ::mediapipe::OkStatus();
   }
 
   ::mediapipe::Status Open(CalculatorContext* cc) final {
-    cc->SetOffset(TimestampDiff(0));
     num_data_streams_ = cc->Inputs().NumEntries("");
     last_gate_state_ = GATE_UNINITIALIZED;
     RET_CHECK_OK(CopyInputHeadersToOutputs(cc->Inputs(), &cc->Outputs()));
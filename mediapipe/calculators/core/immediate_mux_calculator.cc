@@ -46,7 +46,6 @@ class ImmediateMuxCalculator : public CalculatorBase {
   // Passes any input packet to the output stream immediately, unless the
   // packet timestamp is lower than a previously passed packet.
   ::mediapipe::Status Process(CalculatorContext* cc) override;
-  ::mediapipe::Status Open(CalculatorContext* cc) override;
 };
 REGISTER_CALCULATOR(ImmediateMuxCalculator);
 
@@ -61,11 +60,7 @@ REGISTER_CALCULATOR(ImmediateMuxCalculator);
   for (int i = 0; i < cc->Inputs().NumEntries(); ++i) {
     cc->Inputs().Index(i).SetSameAs(&cc->Outputs().Index(0));
   }
-  return ::mediapipe::OkStatus();
-}
-
-::mediapipe::Status ImmediateMuxCalculator::Open(CalculatorContext* cc) {
-  cc->SetOffset(TimestampDiff(0));
+  cc->SetTimestampOffset(TimestampDiff(0));
   return ::mediapipe::OkStatus();
 }
 
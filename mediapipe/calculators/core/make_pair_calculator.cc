@@ -39,11 +39,7 @@ class MakePairCalculator : public CalculatorBase {
     cc->Inputs().Index(0).SetAny();
     cc->Inputs().Index(1).SetAny();
     cc->Outputs().Index(0).Set<std::pair<Packet, Packet>>();
-    return ::mediapipe::OkStatus();
-  }
-
-  ::mediapipe::Status Open(CalculatorContext* cc) override {
-    cc->SetOffset(TimestampDiff(0));
+    cc->SetTimestampOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
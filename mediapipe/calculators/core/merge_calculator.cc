@@ -59,12 +59,7 @@ class MergeCalculator : public CalculatorBase {
       cc->Inputs().Index(i).SetAny();
     }
     cc->Outputs().Index(0).SetAny();
-
-    return ::mediapipe::OkStatus();
-  }
-
-  ::mediapipe::Status Open(CalculatorContext* cc) final {
-    cc->SetOffset(TimestampDiff(0));
+    cc->SetTimestampOffset(TimestampDiff(0));
 
     return ::mediapipe::OkStatus();
   }
@@ -42,6 +42,7 @@ class MuxCalculator : public CalculatorBase {
     cc->SetInputStreamHandler("MuxInputStreamHandler");
     MediaPipeOptions options;
     cc->SetInputStreamHandlerOptions(options);
+    cc->SetTimestampOffset(TimestampDiff(0));
 
     return ::mediapipe::OkStatus();
   }
@@ -51,7 +52,6 @@ class MuxCalculator : public CalculatorBase {
     data_input_base_ = cc->Inputs().GetId("INPUT", 0);
     num_data_inputs_ = cc->Inputs().NumEntries("INPUT");
     output_ = cc->Outputs().GetId("OUTPUT", 0);
-    cc->SetOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
@@ -54,12 +54,12 @@ REGISTER_CALCULATOR(PacketInnerJoinCalculator);
     cc->Inputs().Index(i).SetAny();
     cc->Outputs().Index(i).SetSameAs(&cc->Inputs().Index(i));
   }
+  cc->SetTimestampOffset(TimestampDiff(0));
   return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status PacketInnerJoinCalculator::Open(CalculatorContext* cc) {
   num_streams_ = cc->Inputs().NumEntries();
-  cc->SetOffset(TimestampDiff(0));
   return mediapipe::OkStatus();
 }
 
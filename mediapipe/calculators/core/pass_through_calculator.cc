@@ -56,6 +56,7 @@ class PassThroughCalculator : public CalculatorBase {
             &cc->InputSidePackets().Get(id));
       }
     }
+    cc->SetTimestampOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
@@ -72,7 +73,6 @@ class PassThroughCalculator : public CalculatorBase {
         cc->OutputSidePackets().Get(id).Set(cc->InputSidePackets().Get(id));
       }
     }
-    cc->SetOffset(TimestampDiff(0));
     return ::mediapipe::OkStatus();
   }
 
@@ -0,0 +1,314 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/util/shared_memory_ring.h"
+#include "mediapipe/util/shared_memory_serializer.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns a segment name which is unique to the test process.
+std::string SegmentName(const std::string& test_name) {
+  return absl::StrCat("/mediapipe_", test_name, "_", getpid());
+}
+
+// Returns a graph config with one shared memory calculator node, whose
+// stream is "stream_line", e.g. 'input_stream: "input"', and which has the
+// additional "options" fields.
+CalculatorGraphConfig SharedMemoryGraph(const std::string& calculator,
+                                        const std::string& stream_line,
+                                        const std::string& segment_name,
+                                        int num_slots,
+                                        const std::string& options = "") {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"(
+        node {
+          calculator: "$0"
+          $1
+          options {
+            [mediapipe.SharedMemoryCalculatorOptions.ext] {
+              segment_name: "$2"
+              num_slots: $3
+              slot_size: 65536
+              $4
+            }
+          }
+        }
+      )",
+      calculator, stream_line, segment_name, num_slots, options));
+}
+
+// Runs a graph which writes "packets" into the segment "segment_name".
+void WritePackets(const std::string& segment_name, int num_slots,
+                  const std::vector<Packet>& packets) {
+  CalculatorGraphConfig config =
+      SharedMemoryGraph("SharedMemorySinkCalculator", "input_stream: \"input\"",
+                        segment_name, num_slots);
+  config.add_input_stream("input");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (const Packet& packet : packets) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream("input", packet));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Runs a graph which reads the packets from the segment "segment_name".
+std::vector<Packet> ReadPackets(const std::string& segment_name,
+                                int num_slots) {
+  CalculatorGraphConfig config = SharedMemoryGraph(
+      "SharedMemorySourceCalculator", "output_stream: \"output\"",
+      segment_name, num_slots);
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.Run());
+  return output_packets;
+}
+
+// Attaches a writer to "segment_name" in a child process, which then exits
+// without detaching, after writing a packet if "write" is true.
+void RunCrashingWriter(const std::string& segment_name, int num_slots,
+                       bool write) {
+  const pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    auto ring = SharedMemoryRing::Open(segment_name, SharedMemoryRing::kWriter,
+                                       num_slots, 65536);
+    if (!ring.ok()) {
+      _exit(1);
+    }
+    if (write) {
+      auto slot = ring.ValueOrDie()->AcquireWriteSlot();
+      if (!slot.ok() || !ring.ValueOrDie()
+                             ->CommitWriteSlot(slot.ValueOrDie(), "stale",
+                                               /*timestamp=*/0, /*size=*/0)
+                             .ok()) {
+        _exit(1);
+      }
+    }
+    // Exits without running the destructor of the ring.
+    _exit(0);
+  }
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+}
+
+Packet MakeImageFrame(int value, Timestamp timestamp) {
+  auto frame = absl::make_unique<ImageFrame>(ImageFormat::SRGB, 16, 8);
+  for (int y = 0; y < frame->Height(); ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < frame->Width() * frame->NumberOfChannels(); ++x) {
+      row[x] = value + y + x;
+    }
+  }
+  return Adopt(frame.release()).At(timestamp);
+}
+
+TEST(SharedMemoryCalculatorsTest, PassesImageFramesInPlace) {
+  const std::string segment_name = SegmentName("image_frames");
+  std::vector<Packet> input_packets;
+  for (int i = 0; i < 3; ++i) {
+    input_packets.push_back(MakeImageFrame(i * 10, Timestamp(i * 100)));
+  }
+  WritePackets(segment_name, /*num_slots=*/4, input_packets);
+  std::vector<Packet> output_packets = ReadPackets(segment_name, 4);
+
+  ASSERT_EQ(input_packets.size(), output_packets.size());
+  for (int i = 0; i < input_packets.size(); ++i) {
+    EXPECT_EQ(input_packets[i].Timestamp(), output_packets[i].Timestamp());
+    const ImageFrame& input = input_packets[i].Get<ImageFrame>();
+    const ImageFrame& output = output_packets[i].Get<ImageFrame>();
+    EXPECT_EQ(input.Format(), output.Format());
+    EXPECT_EQ(input.Width(), output.Width());
+    EXPECT_EQ(input.Height(), output.Height());
+    ASSERT_EQ(input.WidthStep(), output.WidthStep());
+    EXPECT_EQ(0, memcmp(input.PixelData(), output.PixelData(),
+                        input.WidthStep() * input.Height()));
+  }
+}
+
+TEST(SharedMemoryCalculatorsTest, PassesMatrices) {
+  const std::string segment_name = SegmentName("matrices");
+  Matrix matrix(2, 3);
+  matrix << 1, 2, 3, 4, 5, 6;
+  WritePackets(segment_name, /*num_slots=*/2,
+               {MakePacket<Matrix>(matrix).At(Timestamp(7))});
+  std::vector<Packet> output_packets = ReadPackets(segment_name, 2);
+
+  ASSERT_EQ(1, output_packets.size());
+  EXPECT_EQ(Timestamp(7), output_packets[0].Timestamp());
+  EXPECT_EQ(matrix, output_packets[0].Get<Matrix>());
+}
+
+TEST(SharedMemoryCalculatorsTest, PassesSerializableTypes) {
+  const std::string segment_name = SegmentName("serializable");
+  WritePackets(segment_name, /*num_slots=*/2,
+               {MakePacket<std::string>("hello").At(Timestamp(1)),
+                MakePacket<int>(42).At(Timestamp(2))});
+  std::vector<Packet> output_packets = ReadPackets(segment_name, 2);
+
+  ASSERT_EQ(2, output_packets.size());
+  EXPECT_EQ("hello", output_packets[0].Get<std::string>());
+  EXPECT_EQ(42, output_packets[1].Get<int>());
+}
+
+TEST(SharedMemoryCalculatorsTest, ReusesReleasedSlots) {
+  const std::string segment_name = SegmentName("reuse");
+  std::vector<Packet> input_packets;
+  for (int i = 0; i < 6; ++i) {
+    input_packets.push_back(MakeImageFrame(i, Timestamp(i)));
+  }
+  // The sink waits for the source to release slots, so both graphs run
+  // concurrently.  Each slot is released once the observer has seen its
+  // packet, since the test only keeps the timestamps.
+  CalculatorGraphConfig config = SharedMemoryGraph(
+      "SharedMemorySourceCalculator", "output_stream: \"output\"",
+      segment_name, /*num_slots=*/2);
+  std::vector<Timestamp> timestamps;
+  CalculatorGraph reader;
+  MP_ASSERT_OK(reader.Initialize(config));
+  MP_ASSERT_OK(reader.ObserveOutputStream(
+      "output", [&timestamps](const Packet& packet) {
+        timestamps.push_back(packet.Timestamp());
+        return ::mediapipe::OkStatus();
+      }));
+  MP_ASSERT_OK(reader.StartRun({}));
+  WritePackets(segment_name, /*num_slots=*/2, input_packets);
+  MP_ASSERT_OK(reader.WaitUntilDone());
+
+  ASSERT_EQ(input_packets.size(), timestamps.size());
+  for (int i = 0; i < input_packets.size(); ++i) {
+    EXPECT_EQ(input_packets[i].Timestamp(), timestamps[i]);
+  }
+}
+
+TEST(SharedMemoryCalculatorsTest, ReplacesSegmentOfCrashedWriter) {
+  const std::string segment_name = SegmentName("crashed_writer");
+  RunCrashingWriter(segment_name, /*num_slots=*/1, /*write=*/true);
+  // The segment left behind holds an unread slot, which would block the next
+  // writer if the segment were reused.
+  WritePackets(segment_name, /*num_slots=*/1,
+               {MakePacket<std::string>("fresh").At(Timestamp(5))});
+  std::vector<Packet> output_packets = ReadPackets(segment_name, 1);
+
+  ASSERT_EQ(1, output_packets.size());
+  EXPECT_EQ(Timestamp(5), output_packets[0].Timestamp());
+  EXPECT_EQ("fresh", output_packets[0].Get<std::string>());
+}
+
+TEST(SharedMemoryCalculatorsTest, ReaderFailsWhenWriterExits) {
+  const std::string segment_name = SegmentName("exited_writer");
+  auto reader = SharedMemoryRing::Open(segment_name, SharedMemoryRing::kReader,
+                                       /*num_slots=*/2, 65536);
+  MP_ASSERT_OK(reader.status());
+  RunCrashingWriter(segment_name, /*num_slots=*/2, /*write=*/false);
+  SharedMemoryRing::SlotInfo info;
+  ::mediapipe::Status status =
+      reader.ValueOrDie()->AcquireReadSlot(absl::Seconds(10), &info);
+  EXPECT_EQ(::mediapipe::StatusCode::kUnavailable, status.code());
+}
+
+TEST(SharedMemoryCalculatorsTest, ReleasesSlotOfTruncatedPayload) {
+  const std::string segment_name = SegmentName("truncated");
+  auto reader = SharedMemoryRing::Open(segment_name, SharedMemoryRing::kReader,
+                                       /*num_slots=*/1, 65536);
+  MP_ASSERT_OK(reader.status());
+  auto writer = SharedMemoryRing::Open(segment_name, SharedMemoryRing::kWriter,
+                                       /*num_slots=*/1, 65536);
+  MP_ASSERT_OK(writer.status());
+  std::shared_ptr<SharedMemoryRing> read_ring = reader.ValueOrDie();
+  std::shared_ptr<SharedMemoryRing> write_ring = writer.ValueOrDie();
+
+  for (const Packet& packet :
+       {MakeImageFrame(0, Timestamp(0)),
+        MakePacket<Matrix>(Matrix::Ones(2, 3)).At(Timestamp(1))}) {
+    auto slot = write_ring->AcquireWriteSlot(absl::Seconds(1));
+    MP_ASSERT_OK(slot.status());
+    std::string type_name;
+    int64 size;
+    MP_ASSERT_OK(WriteSharedMemoryPacket(
+        packet, write_ring->slot_data(slot.ValueOrDie()),
+        write_ring->slot_size(), &type_name, &size));
+    // Only the header of the payload is published.
+    MP_ASSERT_OK(write_ring->CommitWriteSlot(slot.ValueOrDie(), type_name,
+                                             packet.Timestamp().Value(),
+                                             /*size=*/16));
+
+    SharedMemoryRing::SlotInfo info;
+    MP_ASSERT_OK(read_ring->AcquireReadSlot(absl::Seconds(1), &info));
+    const int read_slot = info.slot;
+    EXPECT_FALSE(ReadSharedMemoryPacket(
+                     info.type_name, read_ring->slot_data(read_slot),
+                     info.size,
+                     [&read_ring, read_slot]() {
+                       read_ring->ReleaseReadSlot(read_slot);
+                     })
+                     .ok());
+  }
+  // The rejected payloads released their slot, so the only slot is free.
+  MP_EXPECT_OK(write_ring->AcquireWriteSlot(absl::Seconds(1)).status());
+}
+
+TEST(SharedMemoryCalculatorsTest, SourceTimesOutWithoutSink) {
+  CalculatorGraphConfig config = SharedMemoryGraph(
+      "SharedMemorySourceCalculator", "output_stream: \"output\"",
+      SegmentName("timeout"), /*num_slots=*/2, "timeout_usec: 200000");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  const absl::Time start = absl::Now();
+  EXPECT_FALSE(graph.Run().ok());
+  EXPECT_LT(absl::Now() - start, absl::Seconds(5));
+}
+
+TEST(SharedMemoryCalculatorsTest, SourceWaitingForSinkCanBeCancelled) {
+  CalculatorGraphConfig config =
+      SharedMemoryGraph("SharedMemorySourceCalculator",
+                        "output_stream: \"output\"", SegmentName("cancel"),
+                        /*num_slots=*/2);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  absl::SleepFor(absl::Milliseconds(50));
+  graph.Cancel();
+  EXPECT_EQ(::mediapipe::StatusCode::kCancelled,
+            graph.WaitUntilDone().code());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,93 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/shared_memory_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/shared_memory_ring.h"
+#include "mediapipe/util/shared_memory_serializer.h"
+
+namespace mediapipe {
+
+// Writes the packets of its input stream into a shared memory segment, from
+// which a SharedMemorySourceCalculator in another process reads them.
+//
+// Packets are written with the SharedMemorySerializer registered for their
+// type, which places the payload directly into the shared memory.  Packets of
+// other types are written with the serialize function registered for their
+// type with MEDIAPIPE_REGISTER_TYPE.  When all slots of the segment are in
+// use, Process() waits for the source to release one, for at most
+// timeout_usec, and fails if the source process exits.
+//
+// Example config:
+// node {
+//   calculator: "SharedMemorySinkCalculator"
+//   input_stream: "input_video"
+//   options {
+//     [mediapipe.SharedMemoryCalculatorOptions.ext] {
+//       segment_name: "/camera_frames"
+//     }
+//   }
+// }
+class SharedMemorySinkCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<SharedMemoryCalculatorOptions>();
+    ASSIGN_OR_RETURN(ring_,
+                     SharedMemoryRing::Open(options.segment_name(),
+                                            SharedMemoryRing::kWriter,
+                                            options.num_slots(),
+                                            options.slot_size()));
+    timeout_ = options.timeout_usec() > 0
+                   ? absl::Microseconds(options.timeout_usec())
+                   : absl::InfiniteDuration();
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    const Packet& packet = cc->Inputs().Index(0).Value();
+    ASSIGN_OR_RETURN(int slot, ring_->AcquireWriteSlot(timeout_));
+    std::string type_name;
+    int64 size;
+    MP_RETURN_IF_ERROR(WriteSharedMemoryPacket(packet, ring_->slot_data(slot),
+                                               ring_->slot_size(), &type_name,
+                                               &size));
+    return ring_->CommitWriteSlot(slot, type_name, packet.Timestamp().Value(),
+                                  size);
+  }
+
+  ::mediapipe::Status Close(CalculatorContext* cc) override {
+    if (ring_) {
+      ring_->CloseWriting();
+    }
+    return ::mediapipe::OkStatus();
+  }
+
+ private:
+  std::shared_ptr<SharedMemoryRing> ring_;
+  absl::Duration timeout_;
+};
+REGISTER_CALCULATOR(SharedMemorySinkCalculator);
+
+}  // namespace mediapipe
@@ -0,0 +1,121 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/shared_memory_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/shared_memory_ring.h"
+#include "mediapipe/util/shared_memory_serializer.h"
+
+namespace mediapipe {
+
+namespace {
+
+// How long Process() waits at a time, so that the graph can be cancelled
+// while the sink is idle.
+constexpr absl::Duration kWaitSlice = absl::Milliseconds(100);
+
+}  // namespace
+
+// Outputs the packets written into a shared memory segment by a
+// SharedMemorySinkCalculator in another process, with their original
+// timestamps.  The graph stops reading once the sink is closed.
+//
+// Packets of the types with a registered SharedMemorySerializer may refer to
+// their payload in the shared memory, whose slot is returned to the sink
+// once the last copy of the packet is destroyed.  The sink can therefore
+// only run ahead of this graph by as many packets as the segment has slots.
+//
+// Process() blocks until the sink writes the next packet, so the calculator
+// should be run on its own executor if the graph has other work to do.  It
+// fails if the sink process exits, or writes no packet within timeout_usec.
+// While it waits, it returns every 100 ms without output, so that the graph
+// can be cancelled.
+//
+// Example config:
+// node {
+//   calculator: "SharedMemorySourceCalculator"
+//   output_stream: "input_video"
+//   options {
+//     [mediapipe.SharedMemoryCalculatorOptions.ext] {
+//       segment_name: "/camera_frames"
+//     }
+//   }
+// }
+class SharedMemorySourceCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Index(0).SetAny();
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<SharedMemoryCalculatorOptions>();
+    ASSIGN_OR_RETURN(ring_,
+                     SharedMemoryRing::Open(options.segment_name(),
+                                            SharedMemoryRing::kReader,
+                                            options.num_slots(),
+                                            options.slot_size()));
+    timeout_ = options.timeout_usec() > 0
+                   ? absl::Microseconds(options.timeout_usec())
+                   : absl::InfiniteDuration();
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    if (wait_start_ == absl::InfinitePast()) {
+      wait_start_ = absl::Now();
+    }
+    SharedMemoryRing::SlotInfo info;
+    ::mediapipe::Status status = ring_->AcquireReadSlot(
+        std::min(kWaitSlice, timeout_ - (absl::Now() - wait_start_)), &info);
+    if (status.code() == ::mediapipe::StatusCode::kOutOfRange) {
+      return tool::StatusStop();
+    }
+    if (status.code() == ::mediapipe::StatusCode::kDeadlineExceeded &&
+        absl::Now() - wait_start_ < timeout_) {
+      return ::mediapipe::OkStatus();
+    }
+    MP_RETURN_IF_ERROR(status);
+    wait_start_ = absl::InfinitePast();
+    // The release function shares ownership of the ring, so that the slot
+    // can be released after this calculator is closed.
+    std::shared_ptr<SharedMemoryRing> ring = ring_;
+    const int slot = info.slot;
+    auto release = [ring, slot]() { ring->ReleaseReadSlot(slot); };
+    ASSIGN_OR_RETURN(Packet packet,
+                     ReadSharedMemoryPacket(info.type_name,
+                                            ring_->slot_data(slot), info.size,
+                                            std::move(release)));
+    cc->Outputs().Index(0).AddPacket(packet.At(Timestamp(info.timestamp)));
+    return ::mediapipe::OkStatus();
+  }
+
+ private:
+  std::shared_ptr<SharedMemoryRing> ring_;
+  absl::Duration timeout_;
+  // When the current wait for a packet started, or InfinitePast().
+  absl::Time wait_start_ = absl::InfinitePast();
+};
+REGISTER_CALCULATOR(SharedMemorySourceCalculator);
+
+}  // namespace mediapipe
@@ -73,13 +73,12 @@ class SplitVectorCalculator : public CalculatorBase {
         cc->Outputs().Index(i).Set<std::vector<T>>();
       }
     }
+    cc->SetTimestampOffset(TimestampDiff(0));
 
     return ::mediapipe::OkStatus();
   }
 
   ::mediapipe::Status Open(CalculatorContext* cc) override {
-    cc->SetOffset(TimestampDiff(0));
-
     const auto& options =
         cc->Options<::mediapipe::SplitVectorCalculatorOptions>();
 
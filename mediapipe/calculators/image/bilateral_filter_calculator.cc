@@ -15,16 +15,17 @@
 #include <memory>
 #include <string>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/calculators/image/bilateral_filter_calculator.pb.h"
+#include "mediapipe/calculators/image/bilateral_filter_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
-#include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/port/logging.h"
-#include "mediapipe/framework/port/opencv_core_inc.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/port/vector.h"
 
 #if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
@@ -45,6 +46,16 @@ constexpr char kInputGuideTagGpu[] = "GUIDE_GPU";
 constexpr char kOutputFrameTagGpu[] = "IMAGE_GPU";
 
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+bool IsSupportedCpuFormat(ImageFormat::Format format) {
+  return format == ImageFormat::GRAY8 || format == ImageFormat::SRGB ||
+         format == ImageFormat::SRGBA;
+}
+
+bilateral_filter::ImageView View(const ImageFrame& frame) {
+  return {frame.PixelData(), frame.WidthStep(), frame.NumberOfChannels(),
+          frame.Width(), frame.Height()};
+}
 }  // namespace
 
 // A calculator for applying a bilateral filter to an image,
@@ -52,21 +63,22 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //
 // Inputs:
 //   One of the following two IMAGE tags:
-//   IMAGE: ImageFrame containing input image - Grayscale or RGB only.
+//   IMAGE: ImageFrame containing input image - Grayscale, RGB or RGBA.
 //   IMAGE_GPU: GpuBuffer containing input image - Grayscale, RGB or RGBA.
 //
-//   GUIDE (optional): ImageFrame guide image used to filter IMAGE. (N/A).
+//   GUIDE (optional): ImageFrame guide image used to filter IMAGE.
 //   GUIDE_GPU (optional): GpuBuffer guide image used to filter IMAGE_GPU.
 //
 // Output:
 //   One of the following two tags:
-//   IMAGE:     A filtered ImageFrame - Same as input.
+//   IMAGE:     A filtered ImageFrame - Same format as input.
 //   IMAGE_GPU:  A filtered GpuBuffer - RGBA
 //
 // Options:
 //   sigma_space: Pixel radius: use (sigma_space*2+1)x(sigma_space*2+1) window.
 //                This should be set based on output image pixel space.
 //   sigma_color: Color variance: normalized [0-1] color difference allowed.
+//   num_threads: Number of threads filtering on CPU.
 //
 // Notes:
 //   * When GUIDE is present, the output image is same size as GUIDE image;
@@ -74,7 +86,10 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   * On GPU the kernel window is subsampled by approximately sqrt(sigma_space)
 //     i.e. the step size is ~sqrt(sigma_space),
 //     prioritizing performance > quality.
-//   * TODO: Add CPU path for joint filter.
+//   * On CPU the filter is computed with a bilateral grid, in time
+//     independent of sigma_space, with Gaussian kernels of standard
+//     deviations sigma_space and sigma_color, on the luminance of the guide
+//     image.  The alpha channel of an RGBA output is opaque, as on GPU.
 //
 class BilateralFilterCalculator : public CalculatorBase {
  public:
@@ -101,6 +116,9 @@ class BilateralFilterCalculator : public CalculatorBase {
 
   bool use_gpu_ = false;
   bool gpu_initialized_ = false;
+  std::unique_ptr<bilateral_filter::BilateralGrid> grid_;
+  int num_threads_ = 1;
+  std::unique_ptr<ThreadPool> thread_pool_;
 #if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint program_ = 0;
@@ -183,6 +201,17 @@ REGISTER_CALCULATOR(BilateralFilterCalculator);
 #if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
 #endif
+  } else {
+    RET_CHECK_GE(options_.num_threads(), 1);
+    grid_ = absl::make_unique<bilateral_filter::BilateralGrid>(sigma_space_,
+                                                               sigma_color_);
+    num_threads_ = options_.num_threads();
+    if (num_threads_ > 1) {
+      // The calling thread filters one of the bands.
+      thread_pool_ =
+          absl::make_unique<ThreadPool>("bilateral_filter", num_threads_ - 1);
+      thread_pool_->StartWorkers();
+    }
   }
 
   return ::mediapipe::OkStatus();
@@ -209,6 +238,7 @@ REGISTER_CALCULATOR(BilateralFilterCalculator);
 }
 
 ::mediapipe::Status BilateralFilterCalculator::Close(CalculatorContext* cc) {
+  thread_pool_.reset();
 #if defined(__ANDROID__) || defined(__EMSCRIPTEN__)
   gpu_helper_.RunInGlContext([this] {
     if (program_) glDeleteProgram(program_);
@@ -228,29 +258,22 @@ REGISTER_CALCULATOR(BilateralFilterCalculator);
   }
 
   const auto& input_frame = cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>();
-  auto input_mat = mediapipe::formats::MatView(&input_frame);
+  RET_CHECK(IsSupportedCpuFormat(input_frame.Format()))
+      << "Unsupported image format: " << input_frame.Format();
 
-  // Only 1 or 3 channel images supported by OpenCV.
-  if ((input_mat.channels() == 1 || input_mat.channels() == 3)) {
-    return ::mediapipe::InternalError(
-        "CPU filtering supports only 1 or 3 channel input images.");
-  }
-
-  auto output_frame = absl::make_unique<ImageFrame>(
-      input_frame.Format(), input_mat.cols, input_mat.rows);
   const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTag) &&
                                !cc->Inputs().Tag(kInputGuideTag).IsEmpty();
+  const ImageFrame& guide_frame =
+      has_guide_image ? cc->Inputs().Tag(kInputGuideTag).Get<ImageFrame>()
+                      : input_frame;
+  RET_CHECK(IsSupportedCpuFormat(guide_frame.Format()))
+      << "Unsupported guide image format: " << guide_frame.Format();
 
-  if (has_guide_image) {
-    // cv::jointBilateralFilter() is in contrib module 'ximgproc'.
-    return ::mediapipe::UnimplementedError(
-        "CPU joint filtering support is not implemented yet.");
-  } else {
-    auto output_mat = mediapipe::formats::MatView(output_frame.get());
-    // Prefer setting 'd = sigma_space * 2' to match GPU definition of radius.
-    cv::bilateralFilter(input_mat, output_mat, /*d=*/sigma_space_ * 2.0,
-                        sigma_color_, sigma_space_);
-  }
+  auto output_frame = absl::make_unique<ImageFrame>(
+      input_frame.Format(), guide_frame.Width(), guide_frame.Height());
+  grid_->Filter(View(input_frame), View(guide_frame), num_threads_,
+                thread_pool_.get(), output_frame->MutablePixelData(),
+                output_frame->WidthStep());
 
   cc->Outputs()
       .Tag(kOutputFrameTag)
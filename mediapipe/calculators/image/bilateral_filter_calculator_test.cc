@@ -0,0 +1,121 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/image/bilateral_filter_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns an image whose left half is "left" and right half is "right", in
+// all channels, with a checkerboard of "noise" added.
+Packet StepImage(ImageFormat::Format format, int width, int height, int left,
+                 int right, int noise) {
+  auto image = absl::make_unique<ImageFrame>(format, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      const int value =
+          (x < width / 2 ? left : right) + ((x + y) % 2 ? noise : -noise);
+      for (int c = 0; c < image->NumberOfChannels(); ++c) {
+        row[x * image->NumberOfChannels() + c] = value;
+      }
+    }
+  }
+  return Adopt(image.release()).At(Timestamp(0));
+}
+
+CalculatorGraphConfig::Node FilterNode(bool guide) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::StrCat(
+      R"(
+        calculator: "BilateralFilterCalculator"
+        input_stream: "IMAGE:input"
+      )",
+      guide ? R"(input_stream: "GUIDE:guide")" : "", R"(
+        output_stream: "IMAGE:output"
+        options {
+          [mediapipe.BilateralFilterCalculatorOptions.ext] {
+            sigma_space: 8
+            sigma_color: 0.1
+            num_threads: 2
+          }
+        }
+      )"));
+}
+
+TEST(BilateralFilterCalculatorTest, SmoothsRgbaImageOnCpu) {
+  CalculatorRunner runner(FilterNode(/*guide=*/false));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      StepImage(ImageFormat::SRGBA, 64, 48, 60, 180, 10));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("IMAGE").packets;
+  ASSERT_EQ(1, packets.size());
+  const ImageFrame& output = packets[0].Get<ImageFrame>();
+  ASSERT_EQ(ImageFormat::SRGBA, output.Format());
+  ASSERT_EQ(64, output.Width());
+  ASSERT_EQ(48, output.Height());
+  for (int y = 0; y < output.Height(); ++y) {
+    const uint8* row = output.PixelData() + y * output.WidthStep();
+    for (int x = 0; x < output.Width(); ++x) {
+      const int expected = x < 32 ? 60 : 180;
+      for (int c = 0; c < 3; ++c) {
+        ASSERT_NEAR(expected, row[x * 4 + c], 3) << x << "," << y;
+      }
+      ASSERT_EQ(255, row[x * 4 + 3]);
+    }
+  }
+}
+
+TEST(BilateralFilterCalculatorTest, FiltersWithGuideOnCpu) {
+  CalculatorRunner runner(FilterNode(/*guide=*/true));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      StepImage(ImageFormat::GRAY8, 16, 12, 0, 200, 0));
+  runner.MutableInputs()->Tag("GUIDE").packets.push_back(
+      StepImage(ImageFormat::SRGB, 64, 48, 0, 255, 0));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("IMAGE").packets;
+  ASSERT_EQ(1, packets.size());
+  const ImageFrame& output = packets[0].Get<ImageFrame>();
+  ASSERT_EQ(ImageFormat::GRAY8, output.Format());
+  // The output has the size of the guide, and its edge.
+  ASSERT_EQ(64, output.Width());
+  ASSERT_EQ(48, output.Height());
+  for (int y = 0; y < output.Height(); ++y) {
+    const uint8* row = output.PixelData() + y * output.WidthStep();
+    EXPECT_NEAR(0, row[31], 2);
+    EXPECT_NEAR(200, row[32], 2);
+  }
+}
+
+TEST(BilateralFilterCalculatorTest, RejectsUnsupportedFormats) {
+  CalculatorRunner runner(FilterNode(/*guide=*/false));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      Adopt(new ImageFrame(ImageFormat::VEC32F1, 8, 8)).At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,493 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/bilateral_filter_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "mediapipe/util/parallel_rows.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+namespace mediapipe {
+namespace bilateral_filter {
+
+namespace {
+
+// The number of floats in a grid cell: the sums of the red, green and blue
+// values, and of the weights.
+constexpr int kCellSize = 4;
+
+// The 5-tap binomial kernel, a Gaussian with a standard deviation of one
+// cell.
+constexpr float kBlurWeights[5] = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16,
+                                   1.0f / 16};
+
+// The luminance weights of LuminanceCalculator in 8-bit fixed point.
+inline int RangeValue(const uint8* pixel, int channels) {
+  if (channels < 3) return pixel[0];
+  return (54 * pixel[0] + 183 * pixel[1] + 19 * pixel[2] + 128) >> 8;
+}
+
+// Writes the color channels of a pixel from the sums of a cell, and sets its
+// alpha channel to opaque.
+inline void StorePixel(const float* sums, int channels, uint8* pixel) {
+  const float inverse_weight = sums[3] > 0.0f ? 1.0f / sums[3] : 0.0f;
+  for (int c = 0; c < std::min(channels, 3); ++c) {
+    pixel[c] = std::min(255L, std::max(0L, std::lrint(sums[c] *
+                                                      inverse_weight)));
+  }
+  if (channels == 4) pixel[3] = 255;
+}
+
+// A grid cell, with the operations needed to splat, blur and slice.  The
+// SIMD cell implements the same operations with SSE2.
+struct ScalarCell {
+  float sums[kCellSize];
+
+  static ScalarCell Zero() { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+
+  // Returns the cell of a pixel, with a weight of one.
+  static ScalarCell FromPixel(const uint8* pixel, int channels) {
+    if (channels < 3) return {{pixel[0] * 1.0f, 0.0f, 0.0f, 1.0f}};
+    return {{pixel[0] * 1.0f, pixel[1] * 1.0f, pixel[2] * 1.0f, 1.0f}};
+  }
+
+  static ScalarCell Load(const float* grid) {
+    return {{grid[0], grid[1], grid[2], grid[3]}};
+  }
+
+  void Store(float* grid) const { std::copy(sums, sums + kCellSize, grid); }
+
+  // Adds "weight" times "cell" to this cell.
+  void AddScaled(const ScalarCell& cell, float weight) {
+    for (int c = 0; c < kCellSize; ++c) sums[c] += cell.sums[c] * weight;
+  }
+
+  void ToPixel(int channels, uint8* pixel) const {
+    StorePixel(sums, channels, pixel);
+  }
+};
+
+#if defined(__SSE2__)
+
+struct SimdCell {
+  __m128 sums;
+
+  static SimdCell Zero() { return {_mm_setzero_ps()}; }
+
+  static SimdCell FromPixel(const uint8* pixel, int channels) {
+    if (channels < 3) return {_mm_set_ps(1.0f, 0.0f, 0.0f, pixel[0])};
+    return {_mm_set_ps(1.0f, pixel[2], pixel[1], pixel[0])};
+  }
+
+  static SimdCell Load(const float* grid) { return {_mm_loadu_ps(grid)}; }
+
+  void Store(float* grid) const { _mm_storeu_ps(grid, sums); }
+
+  void AddScaled(const SimdCell& cell, float weight) {
+    sums = _mm_add_ps(sums, _mm_mul_ps(cell.sums, _mm_set1_ps(weight)));
+  }
+
+  void ToPixel(int channels, uint8* pixel) const {
+    const __m128 weight = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(3, 3, 3, 3));
+    if (_mm_cvtss_f32(weight) <= 0.0f) {
+      const float zero[kCellSize] = {0.0f, 0.0f, 0.0f, 0.0f};
+      StorePixel(zero, channels, pixel);
+      return;
+    }
+    // Rounds to nearest even like std::lrint, and saturates to [0, 255].
+    const __m128i values = _mm_cvtps_epi32(_mm_div_ps(sums, weight));
+    const __m128i words = _mm_packs_epi32(values, values);
+    const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    pixel[0] = packed & 0xff;
+    if (channels >= 3) {
+      pixel[1] = (packed >> 8) & 0xff;
+      pixel[2] = (packed >> 16) & 0xff;
+    }
+    if (channels == 4) pixel[3] = 255;
+  }
+};
+
+#else
+
+using SimdCell = ScalarCell;
+
+#endif  // __SSE2__
+
+template <bool kSimd>
+struct CellType {
+  using Type = ScalarCell;
+};
+
+template <>
+struct CellType<true> {
+  using Type = SimdCell;
+};
+
+// Adds "weight" times "value" to the cell at "grid".
+template <typename Cell>
+inline void Splat(const Cell& value, float weight, float* grid) {
+  Cell cell = Cell::Load(grid);
+  cell.AddScaled(value, weight);
+  cell.Store(grid);
+}
+
+// Sets "lines" to the neighbors at offsets -2 to 2 of the line "index" of
+// "count" lines which are "stride" floats apart, or to null past the ends.
+inline void Neighbors(const float* line, int index, int count, int stride,
+                      const float* lines[5]) {
+  for (int t = 0; t < 5; ++t) {
+    const int neighbor = index + t - 2;
+    lines[t] = (neighbor >= 0 && neighbor < count)
+                   ? line + (t - 2) * stride
+                   : nullptr;
+  }
+}
+
+// Writes the blur of "num_cells" cells of the neighboring "lines" into
+// "output".  The null lines are outside of the grid, whose cells are empty.
+template <typename Cell>
+inline void BlurLines(const float* const lines[5], int num_cells,
+                      float* output) {
+  if (lines[0] && lines[4]) {
+    for (int i = 0; i < num_cells * kCellSize; i += kCellSize) {
+      Cell sum = Cell::Zero();
+      for (int t = 0; t < 5; ++t) {
+        sum.AddScaled(Cell::Load(lines[t] + i), kBlurWeights[t]);
+      }
+      sum.Store(output + i);
+    }
+    return;
+  }
+  for (int i = 0; i < num_cells * kCellSize; i += kCellSize) {
+    Cell sum = Cell::Zero();
+    for (int t = 0; t < 5; ++t) {
+      if (lines[t]) sum.AddScaled(Cell::Load(lines[t] + i), kBlurWeights[t]);
+    }
+    sum.Store(output + i);
+  }
+}
+
+// Writes the blur of a column of "depth" cells along the range axis into
+// "output".
+template <typename Cell>
+inline void BlurColumn(const float* column, int depth, float* output) {
+  const float* lines[5];
+  for (int k = 0; k < depth; ++k) {
+    const float* cell = column + k * kCellSize;
+    if (k >= 2 && k + 2 < depth) {
+      Cell sum = Cell::Zero();
+      for (int t = 0; t < 5; ++t) {
+        sum.AddScaled(Cell::Load(cell + (t - 2) * kCellSize),
+                      kBlurWeights[t]);
+      }
+      sum.Store(output + k * kCellSize);
+    } else {
+      Neighbors(cell, k, depth, kCellSize, lines);
+      BlurLines<Cell>(lines, 1, output + k * kCellSize);
+    }
+  }
+}
+
+// Returns the index of the cell below "coordinate", and sets "fraction" to
+// the weight of the next cell.
+inline int CellOf(float coordinate, float* fraction) {
+  const int cell = static_cast<int>(coordinate);
+  *fraction = coordinate - cell;
+  return cell;
+}
+
+}  // namespace
+
+BilateralGrid::BilateralGrid(float sigma_space, float sigma_color)
+    : cell_space_(std::max(sigma_space, 1.0f)),
+      cell_range_(std::max(sigma_color, 1.0f)),
+      inverse_cell_space_(1.0f / cell_space_),
+      inverse_cell_range_(1.0f / cell_range_) {
+  // The direct filter truncates its spatial kernel at two standard
+  // deviations.
+  direct_radius_ = static_cast<int>(std::ceil(2.0f * std::max(sigma_space,
+                                                              0.0f)));
+  const int window = 2 * direct_radius_ + 1;
+  const float space_coefficient =
+      -0.5f / std::pow(std::max(sigma_space, 0.5f), 2.0f);
+  space_weights_.resize(window * window);
+  for (int dy = -direct_radius_; dy <= direct_radius_; ++dy) {
+    for (int dx = -direct_radius_; dx <= direct_radius_; ++dx) {
+      space_weights_[(dy + direct_radius_) * window + dx + direct_radius_] =
+          std::exp((dx * dx + dy * dy) * space_coefficient);
+    }
+  }
+  const float range_coefficient =
+      -0.5f / std::pow(std::max(sigma_color, 0.5f), 2.0f);
+  range_weights_.resize(256);
+  for (int d = 0; d < 256; ++d) {
+    range_weights_[d] = std::exp(d * d * range_coefficient);
+  }
+}
+
+bool BilateralGrid::UsesDirectFilter(int width, int height) const {
+  const int64 grid_width =
+      static_cast<int>((width - 1) * inverse_cell_space_) + 2;
+  const int64 grid_height =
+      static_cast<int>((height - 1) * inverse_cell_space_) + 2;
+  const int64 grid_depth = static_cast<int>(255 * inverse_cell_range_) + 2;
+  return grid_width * grid_height * grid_depth >
+         static_cast<int64>(width) * height;
+}
+
+void BilateralGrid::Filter(const ImageView& image, const ImageView& guide,
+                           int num_threads, ThreadPool* pool, uint8* output,
+                           int output_step) {
+  FilterImpl<true>(image, guide, num_threads, pool, output, output_step);
+}
+
+void BilateralGrid::FilterScalar(const ImageView& image,
+                                 const ImageView& guide, int num_threads,
+                                 ThreadPool* pool, uint8* output,
+                                 int output_step) {
+  FilterImpl<false>(image, guide, num_threads, pool, output, output_step);
+}
+
+template <bool kSimd>
+void BilateralGrid::FilterImpl(const ImageView& image, const ImageView& guide,
+                               int num_threads, ThreadPool* pool,
+                               uint8* output, int output_step) {
+  Prepare(image, guide.width, guide.height);
+  if (UsesDirectFilter(guide.width, guide.height)) {
+    ParallelForRowBands(guide.height, num_threads, pool,
+                        [&](int first_row, int end_row) {
+                          DirectRows(image, guide, first_row, end_row, output,
+                                     output_step);
+                        });
+    return;
+  }
+  ParallelForRowBands(grid_height_, num_threads, pool,
+                      [&](int first_row, int end_row) {
+                        SplatRows<kSimd>(image, guide, first_row, end_row);
+                      });
+  ParallelForRowBands(grid_height_, num_threads, pool,
+                      [this](int first_row, int end_row) {
+                        BlurWithinRows<kSimd>(first_row, end_row);
+                      });
+  ParallelForRowBands(grid_height_, num_threads, pool,
+                      [this](int first_row, int end_row) {
+                        BlurAcrossRows<kSimd>(first_row, end_row);
+                      });
+  ParallelForRowBands(guide.height, num_threads, pool,
+                      [&](int first_row, int end_row) {
+                        SliceRows<kSimd>(guide, image.channels, first_row,
+                                         end_row, output, output_step);
+                      });
+}
+
+void BilateralGrid::Prepare(const ImageView& image, int width, int height) {
+  image_columns_.resize(width);
+  for (int x = 0; x < width; ++x) {
+    image_columns_[x] = std::min(
+        static_cast<int>((2 * x + 1) * static_cast<int64>(image.width) /
+                         (2 * width)),
+        image.width - 1);
+  }
+  image_rows_.resize(height);
+  for (int y = 0; y < height; ++y) {
+    image_rows_[y] = std::min(
+        static_cast<int>((2 * y + 1) * static_cast<int64>(image.height) /
+                         (2 * height)),
+        image.height - 1);
+  }
+  if (UsesDirectFilter(width, height)) return;
+
+  grid_width_ = static_cast<int>((width - 1) * inverse_cell_space_) + 2;
+  grid_height_ = static_cast<int>((height - 1) * inverse_cell_space_) + 2;
+  grid_depth_ = static_cast<int>(255 * inverse_cell_range_) + 2;
+  const size_t grid_size =
+      static_cast<size_t>(grid_width_) * grid_height_ * grid_depth_ *
+      kCellSize;
+  grid_.resize(grid_size);
+  scratch_.resize(grid_size);
+
+  x_cells_.resize(width);
+  x_fractions_.resize(width);
+  for (int x = 0; x < width; ++x) {
+    x_cells_[x] = CellOf(x * inverse_cell_space_, &x_fractions_[x]);
+  }
+  y_cells_.resize(height);
+  y_fractions_.resize(height);
+  for (int y = 0; y < height; ++y) {
+    y_cells_[y] = CellOf(y * inverse_cell_space_, &y_fractions_[y]);
+  }
+  range_cells_.resize(256);
+  range_fractions_.resize(256);
+  for (int value = 0; value < 256; ++value) {
+    range_cells_[value] =
+        CellOf(value * inverse_cell_range_, &range_fractions_[value]);
+  }
+}
+
+template <bool kSimd>
+void BilateralGrid::SplatRows(const ImageView& image, const ImageView& guide,
+                              int first_grid_row, int end_grid_row) {
+  using Cell = typename CellType<kSimd>::Type;
+  const int row_size = grid_width_ * grid_depth_ * kCellSize;
+  const int column_size = grid_depth_ * kCellSize;
+  std::fill(grid_.begin() + first_grid_row * row_size,
+            grid_.begin() + end_grid_row * row_size, 0.0f);
+  // As in the paper, the pixels are splatted into the nearest cells in
+  // space, and interpolated along the range axis only, which halves the
+  // number of cells updated per pixel at little cost in accuracy since the
+  // grid is blurred afterwards.
+  for (int y = 0; y < guide.height; ++y) {
+    const int grid_row = y_cells_[y] + (y_fractions_[y] >= 0.5f);
+    if (grid_row < first_grid_row || grid_row >= end_grid_row) continue;
+    float* cells_row = &grid_[grid_row * row_size];
+    const uint8* image_row = image.data + image_rows_[y] * image.step;
+    const uint8* guide_row = guide.data + y * guide.step;
+    for (int x = 0; x < guide.width; ++x) {
+      const Cell value = Cell::FromPixel(
+          image_row + image_columns_[x] * image.channels, image.channels);
+      const int range = RangeValue(guide_row + x * guide.channels,
+                                   guide.channels);
+      float* cells = cells_row +
+                     (x_cells_[x] + (x_fractions_[x] >= 0.5f)) * column_size +
+                     range_cells_[range] * kCellSize;
+      const float range_fraction = range_fractions_[range];
+      Splat(value, 1.0f - range_fraction, cells);
+      Splat(value, range_fraction, cells + kCellSize);
+    }
+  }
+}
+
+template <bool kSimd>
+void BilateralGrid::BlurWithinRows(int first_grid_row, int end_grid_row) {
+  using Cell = typename CellType<kSimd>::Type;
+  const int row_size = grid_width_ * grid_depth_ * kCellSize;
+  const int column_size = grid_depth_ * kCellSize;
+  const float* lines[5];
+  for (int j = first_grid_row; j < end_grid_row; ++j) {
+    // Blurs along the range axis into scratch_, and then along the x axis
+    // back into grid_.
+    const float* row = &grid_[j * row_size];
+    float* scratch_row = &scratch_[j * row_size];
+    for (int i = 0; i < grid_width_; ++i) {
+      BlurColumn<Cell>(row + i * column_size, grid_depth_,
+                       scratch_row + i * column_size);
+    }
+    for (int i = 0; i < grid_width_; ++i) {
+      const int offset = i * column_size;
+      Neighbors(scratch_row + offset, i, grid_width_, column_size, lines);
+      BlurLines<Cell>(lines, grid_depth_, &grid_[j * row_size + offset]);
+    }
+  }
+}
+
+template <bool kSimd>
+void BilateralGrid::BlurAcrossRows(int first_grid_row, int end_grid_row) {
+  using Cell = typename CellType<kSimd>::Type;
+  const int row_size = grid_width_ * grid_depth_ * kCellSize;
+  const float* lines[5];
+  for (int j = first_grid_row; j < end_grid_row; ++j) {
+    Neighbors(&grid_[j * row_size], j, grid_height_, row_size, lines);
+    BlurLines<Cell>(lines, grid_width_ * grid_depth_, &scratch_[j * row_size]);
+  }
+}
+
+template <bool kSimd>
+void BilateralGrid::SliceRows(const ImageView& guide, int channels,
+                              int first_row, int end_row, uint8* output,
+                              int output_step) const {
+  using Cell = typename CellType<kSimd>::Type;
+  const int row_size = grid_width_ * grid_depth_ * kCellSize;
+  const int column_size = grid_depth_ * kCellSize;
+  for (int y = first_row; y < end_row; ++y) {
+    const float* grid_row0 = &scratch_[y_cells_[y] * row_size];
+    const float* grid_row1 = grid_row0 + row_size;
+    const float y_fraction = y_fractions_[y];
+    const uint8* guide_row = guide.data + y * guide.step;
+    uint8* output_row = output + y * output_step;
+    for (int x = 0; x < guide.width; ++x) {
+      const int range = RangeValue(guide_row + x * guide.channels,
+                                   guide.channels);
+      const int offset = x_cells_[x] * column_size +
+                         range_cells_[range] * kCellSize;
+      const float x_fraction = x_fractions_[x];
+      const float range_fraction = range_fractions_[range];
+      Cell sums = Cell::Zero();
+      const float* grid_rows[2] = {grid_row0 + offset, grid_row1 + offset};
+      const float y_weights[2] = {1.0f - y_fraction, y_fraction};
+      for (int r = 0; r < 2; ++r) {
+        const float* cells = grid_rows[r];
+        const float weight0 = y_weights[r] * (1.0f - x_fraction);
+        const float weight1 = y_weights[r] * x_fraction;
+        sums.AddScaled(Cell::Load(cells), weight0 * (1.0f - range_fraction));
+        sums.AddScaled(Cell::Load(cells + kCellSize),
+                       weight0 * range_fraction);
+        sums.AddScaled(Cell::Load(cells + column_size),
+                       weight1 * (1.0f - range_fraction));
+        sums.AddScaled(Cell::Load(cells + column_size + kCellSize),
+                       weight1 * range_fraction);
+      }
+      sums.ToPixel(channels, output_row + x * channels);
+    }
+  }
+}
+
+void BilateralGrid::DirectRows(const ImageView& image, const ImageView& guide,
+                               int first_row, int end_row, uint8* output,
+                               int output_step) const {
+  const int window = 2 * direct_radius_ + 1;
+  for (int y = first_row; y < end_row; ++y) {
+    const int first_y = std::max(y - direct_radius_, 0);
+    const int end_y = std::min(y + direct_radius_ + 1, guide.height);
+    uint8* output_row = output + y * output_step;
+    for (int x = 0; x < guide.width; ++x) {
+      const int first_x = std::max(x - direct_radius_, 0);
+      const int end_x = std::min(x + direct_radius_ + 1, guide.width);
+      const int center_range = RangeValue(
+          guide.data + y * guide.step + x * guide.channels, guide.channels);
+      float sums[kCellSize] = {0.0f, 0.0f, 0.0f, 0.0f};
+      for (int window_y = first_y; window_y < end_y; ++window_y) {
+        const uint8* guide_row = guide.data + window_y * guide.step;
+        const uint8* image_row =
+            image.data + image_rows_[window_y] * image.step;
+        const float* space_weights =
+            &space_weights_[(window_y - y + direct_radius_) * window];
+        for (int window_x = first_x; window_x < end_x; ++window_x) {
+          const int range = RangeValue(guide_row + window_x * guide.channels,
+                                       guide.channels);
+          const float weight =
+              space_weights[window_x - x + direct_radius_] *
+              range_weights_[std::abs(range - center_range)];
+          const uint8* pixel =
+              image_row + image_columns_[window_x] * image.channels;
+          sums[0] += pixel[0] * weight;
+          if (image.channels >= 3) {
+            sums[1] += pixel[1] * weight;
+            sums[2] += pixel[2] * weight;
+          }
+          sums[3] += weight;
+        }
+      }
+      StorePixel(sums, image.channels, output_row + x * image.channels);
+    }
+  }
+}
+
+}  // namespace bilateral_filter
+}  // namespace mediapipe
@@ -0,0 +1,153 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// CPU kernels for BilateralFilterCalculator.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_BILATERAL_FILTER_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_BILATERAL_FILTER_UTILS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace bilateral_filter {
+
+// An 8-bit image with "channels" (1, 3 or 4) interleaved channels per pixel,
+// whose rows are "step" bytes apart, as stored in an ImageFrame.
+struct ImageView {
+  const uint8* data;
+  int step;
+  int channels;
+  int width;
+  int height;
+};
+
+// Applies a bilateral filter to an image, optionally guided by another
+// image (joint bilateral filter), in time linear in the number of pixels
+// regardless of the size of the kernel.
+//
+// The filter is computed with a bilateral grid [Chen, Paris and Durand,
+// "Real-time edge-aware image processing with the bilateral grid", 2007]:
+// the pixels are splatted into a 3D grid of (x, y, range) cells, which are
+// "sigma_space" pixels wide and "sigma_color" intensity levels deep, the grid
+// is blurred with a separable binomial kernel, and the output is sliced out
+// of the grid with trilinear interpolation.  The range of a pixel is the
+// luminance of the guide image, or its first channel if it is gray.  The
+// spatial and range kernels are therefore approximately Gaussian with
+// standard deviations "sigma_space" and "sigma_color".
+//
+// When the grid would have more cells than the image has pixels, i.e. for
+// small kernels, the filter is computed directly with truncated Gaussian
+// kernels instead, which is faster and uses less memory.
+//
+// The grid is kept between calls, so that filtering images of a constant
+// size does not allocate memory.  The grid operations are vectorized
+// with SSE2 when available.  The methods are not thread-safe.
+class BilateralGrid {
+ public:
+  // "sigma_space" is in pixels of the output image, "sigma_color" in
+  // intensity levels (0-255).
+  BilateralGrid(float sigma_space, float sigma_color);
+
+  // Filters "image" into "output", which is "output_step" bytes per row and
+  // has the size of "guide" and the channels of "image".  "image" is
+  // resampled to the size of "guide" with nearest neighbor sampling if
+  // needed.  Only the color channels are filtered; the alpha channel of an
+  // RGBA output is opaque.  Without a guide, "guide" is "image" itself.
+  //
+  // The work is split into "num_threads" bands of rows, which run on "pool"
+  // except for the first one, or on the calling thread if "pool" is null.
+  void Filter(const ImageView& image, const ImageView& guide, int num_threads,
+              ThreadPool* pool, uint8* output, int output_step);
+
+  // Same as Filter(), without SIMD instructions.  The results differ by at
+  // most one intensity level.  Exposed for testing and benchmarking.
+  void FilterScalar(const ImageView& image, const ImageView& guide,
+                    int num_threads, ThreadPool* pool, uint8* output,
+                    int output_step);
+
+  // Returns true if images of the given size are filtered directly rather
+  // than with the grid.
+  bool UsesDirectFilter(int width, int height) const;
+
+ private:
+  template <bool kSimd>
+  void FilterImpl(const ImageView& image, const ImageView& guide,
+                  int num_threads, ThreadPool* pool, uint8* output,
+                  int output_step);
+
+  // Sets up the coordinate tables, and the grid unless the image is
+  // filtered directly, for an output image of the given size.
+  void Prepare(const ImageView& image, int width, int height);
+
+  template <bool kSimd>
+  void SplatRows(const ImageView& image, const ImageView& guide,
+                 int first_grid_row, int end_grid_row);
+  // Blurs the grid rows along the x and range axes, and across rows along
+  // the y axis, into scratch_.
+  template <bool kSimd>
+  void BlurWithinRows(int first_grid_row, int end_grid_row);
+  template <bool kSimd>
+  void BlurAcrossRows(int first_grid_row, int end_grid_row);
+  template <bool kSimd>
+  void SliceRows(const ImageView& guide, int channels, int first_row,
+                 int end_row, uint8* output, int output_step) const;
+
+  void DirectRows(const ImageView& image, const ImageView& guide,
+                  int first_row, int end_row, uint8* output,
+                  int output_step) const;
+
+  // The size of a cell, and its inverse.
+  const float cell_space_;
+  const float cell_range_;
+  const float inverse_cell_space_;
+  const float inverse_cell_range_;
+
+  // The number of cells along each axis.
+  int grid_width_ = 0;
+  int grid_height_ = 0;
+  int grid_depth_ = 0;
+
+  // The grid cells, stored as (red, green, blue, weight) sums with the range
+  // axis varying fastest and the y axis slowest, and a grid of the same size
+  // holding the intermediate results of the blur.
+  std::vector<float> grid_;
+  std::vector<float> scratch_;
+
+  // For each output column, row and intensity level: the index of the cell
+  // below its grid coordinate, and the fractional part of the coordinate.
+  std::vector<int> x_cells_;
+  std::vector<float> x_fractions_;
+  std::vector<int> y_cells_;
+  std::vector<float> y_fractions_;
+  std::vector<int> range_cells_;
+  std::vector<float> range_fractions_;
+
+  // For each output column and row, the nearest column and row of the image.
+  std::vector<int> image_columns_;
+  std::vector<int> image_rows_;
+
+  // The kernels of the direct filter: the spatial weights of the
+  // (2 * radius + 1)^2 window, and the range weights of each intensity
+  // difference.
+  int direct_radius_ = 0;
+  std::vector<float> space_weights_;
+  std::vector<float> range_weights_;
+};
+
+}  // namespace bilateral_filter
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_BILATERAL_FILTER_UTILS_H_
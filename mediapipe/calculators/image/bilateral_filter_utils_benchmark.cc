@@ -0,0 +1,81 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the CPU bilateral filter of BilateralFilterCalculator on 1080p
+// RGB frames, e.g.:
+//   bazel run -c opt \
+//       //mediapipe/calculators/image:bilateral_filter_utils_benchmark -- \
+//       --benchmark_format=console
+
+#include <vector>
+
+#include "mediapipe/calculators/image/bilateral_filter_utils.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace bilateral_filter {
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr int kChannels = 3;
+constexpr float kSigmaColor = 0.1f * 255;
+
+std::vector<uint8> MakeImage() {
+  std::vector<uint8> image(kWidth * kHeight * kChannels);
+  for (int i = 0; i < image.size(); ++i) {
+    image[i] = (i / kChannels % kWidth) * 255 / kWidth + i % 17;
+  }
+  return image;
+}
+
+// Filters a frame with sigma_space state.range(0) on state.range(1) threads.
+template <bool kSimd>
+void BM_BilateralGrid(benchmark::State& state) {
+  const std::vector<uint8> image = MakeImage();
+  const ImageView view = {image.data(), kWidth * kChannels, kChannels, kWidth,
+                          kHeight};
+  std::vector<uint8> output(image.size());
+  const int num_threads = state.range(1);
+  ThreadPool pool("benchmark", num_threads - 1);
+  pool.StartWorkers();
+  BilateralGrid grid(state.range(0), kSigmaColor);
+  for (auto _ : state) {
+    if (kSimd) {
+      grid.Filter(view, view, num_threads, &pool, output.data(),
+                  kWidth * kChannels);
+    } else {
+      grid.FilterScalar(view, view, num_threads, &pool, output.data(),
+                        kWidth * kChannels);
+    }
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK_TEMPLATE(BM_BilateralGrid, false)
+    ->Args({4, 1})
+    ->Args({16, 1})
+    ->Args({64, 1});
+BENCHMARK_TEMPLATE(BM_BilateralGrid, true)
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Args({16, 1})
+    ->Args({64, 1})
+    ->Args({16, 4});
+
+}  // namespace
+}  // namespace bilateral_filter
+}  // namespace mediapipe
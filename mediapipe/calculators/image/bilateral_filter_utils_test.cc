@@ -0,0 +1,234 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/bilateral_filter_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace bilateral_filter {
+namespace {
+
+struct TestImage {
+  TestImage(int width, int height, int channels)
+      : width(width),
+        height(height),
+        channels(channels),
+        pixels(width * height * channels) {}
+
+  ImageView View() const {
+    return {pixels.data(), width * channels, channels, width, height};
+  }
+  uint8& At(int x, int y, int c) {
+    return pixels[(y * width + x) * channels + c];
+  }
+  uint8 At(int x, int y, int c) const {
+    return pixels[(y * width + x) * channels + c];
+  }
+
+  int width;
+  int height;
+  int channels;
+  std::vector<uint8> pixels;
+};
+
+// Returns a gray image whose left half is "left" and right half is "right",
+// plus uniform noise in [-noise, noise].
+TestImage StepImage(int width, int height, int left, int right, int noise,
+                    std::mt19937* rng) {
+  std::uniform_int_distribution<int> distribution(-noise, noise);
+  TestImage image(width, height, 1);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const int value = (x < width / 2 ? left : right) + distribution(*rng);
+      image.At(x, y, 0) = std::min(std::max(value, 0), 255);
+    }
+  }
+  return image;
+}
+
+TestImage Filter(float sigma_space, float sigma_color, const TestImage& image,
+                 const TestImage& guide) {
+  TestImage output(guide.width, guide.height, image.channels);
+  BilateralGrid grid(sigma_space, sigma_color);
+  grid.Filter(image.View(), guide.View(), /*num_threads=*/1, nullptr,
+              output.pixels.data(), output.width * output.channels);
+  return output;
+}
+
+// An exact bilateral filter of a gray image with Gaussian kernels truncated
+// at three standard deviations.
+TestImage ReferenceFilter(float sigma_space, float sigma_color,
+                          const TestImage& image) {
+  TestImage output(image.width, image.height, 1);
+  const int radius = std::ceil(3 * sigma_space);
+  for (int y = 0; y < image.height; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      const int center = image.At(x, y, 0);
+      double sum = 0.0;
+      double weights = 0.0;
+      for (int wy = std::max(y - radius, 0);
+           wy <= std::min(y + radius, image.height - 1); ++wy) {
+        for (int wx = std::max(x - radius, 0);
+             wx <= std::min(x + radius, image.width - 1); ++wx) {
+          const int value = image.At(wx, wy, 0);
+          const double distance2 = (wx - x) * (wx - x) + (wy - y) * (wy - y);
+          const double difference = value - center;
+          const double weight =
+              std::exp(-distance2 / (2 * sigma_space * sigma_space) -
+                       difference * difference /
+                           (2 * sigma_color * sigma_color));
+          sum += weight * value;
+          weights += weight;
+        }
+      }
+      output.At(x, y, 0) = std::round(sum / weights);
+    }
+  }
+  return output;
+}
+
+TEST(BilateralGridTest, ApproximatesExactFilter) {
+  std::mt19937 rng(1);
+  const TestImage image = StepImage(96, 64, 60, 180, 30, &rng);
+  BilateralGrid grid(4.0f, 25.0f);
+  ASSERT_FALSE(grid.UsesDirectFilter(image.width, image.height));
+  const TestImage output = Filter(4.0f, 25.0f, image, image);
+  const TestImage expected = ReferenceFilter(4.0f, 25.0f, image);
+  double total_error = 0.0;
+  for (int i = 0; i < image.pixels.size(); ++i) {
+    total_error += std::abs(output.pixels[i] - expected.pixels[i]);
+  }
+  EXPECT_LT(total_error / image.pixels.size(), 2.0);
+}
+
+TEST(BilateralGridTest, SmoothsNoiseAndPreservesEdges) {
+  std::mt19937 rng(2);
+  const TestImage image = StepImage(128, 64, 50, 200, 20, &rng);
+  for (float sigma_space : {2.0f, 8.0f, 32.0f}) {
+    const TestImage output = Filter(sigma_space, 40.0f, image, image);
+    double input_noise = 0.0;
+    double output_noise = 0.0;
+    for (int y = 0; y < image.height; ++y) {
+      for (int x = 0; x < image.width; ++x) {
+        const int expected = x < image.width / 2 ? 50 : 200;
+        ASSERT_NEAR(expected, output.At(x, y, 0), 8)
+            << "x: " << x << " y: " << y << " sigma_space: " << sigma_space;
+        input_noise += std::abs(image.At(x, y, 0) - expected);
+        output_noise += std::abs(output.At(x, y, 0) - expected);
+      }
+    }
+    EXPECT_LT(output_noise, input_noise / 3) << sigma_space;
+  }
+}
+
+TEST(BilateralGridTest, FollowsEdgesOfGuide) {
+  std::mt19937 rng(3);
+  const TestImage image = StepImage(64, 32, 0, 250, 0, &rng);
+  const TestImage edge_guide = StepImage(64, 32, 100, 150, 0, &rng);
+  const TestImage flat_guide = StepImage(64, 32, 100, 100, 0, &rng);
+  const TestImage guided = Filter(6.0f, 10.0f, image, edge_guide);
+  const TestImage unguided = Filter(6.0f, 10.0f, image, flat_guide);
+  for (int y = 0; y < image.height; ++y) {
+    EXPECT_NEAR(0, guided.At(31, y, 0), 2);
+    EXPECT_NEAR(250, guided.At(32, y, 0), 2);
+    // Without an edge in the guide, the image edge is blurred.
+    EXPECT_GT(unguided.At(31, y, 0), 50);
+    EXPECT_LT(unguided.At(32, y, 0), 200);
+  }
+}
+
+TEST(BilateralGridTest, ResamplesImageToGuideSize) {
+  std::mt19937 rng(4);
+  TestImage image(8, 6, 3);
+  for (int y = 0; y < image.height; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      image.At(x, y, 0) = 10;
+      image.At(x, y, 1) = 120;
+      image.At(x, y, 2) = 230;
+    }
+  }
+  TestImage guide(64, 48, 4);
+  const TestImage output = Filter(4.0f, 20.0f, image, guide);
+  ASSERT_EQ(3, output.channels);
+  for (int y = 0; y < output.height; ++y) {
+    for (int x = 0; x < output.width; ++x) {
+      EXPECT_EQ(10, output.At(x, y, 0));
+      EXPECT_EQ(120, output.At(x, y, 1));
+      EXPECT_EQ(230, output.At(x, y, 2));
+    }
+  }
+}
+
+TEST(BilateralGridTest, FiltersSmallKernelsDirectly) {
+  std::mt19937 rng(5);
+  const TestImage image = StepImage(40, 30, 50, 200, 20, &rng);
+  BilateralGrid grid(1.0f, 2.0f);
+  EXPECT_TRUE(grid.UsesDirectFilter(image.width, image.height));
+  // A zero spatial kernel leaves the image unchanged.
+  const TestImage output = Filter(0.0f, 30.0f, image, image);
+  EXPECT_EQ(image.pixels, output.pixels);
+}
+
+TEST(BilateralGridTest, SimdMatchesScalar) {
+  std::mt19937 rng(6);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  for (int channels : {1, 3, 4}) {
+    TestImage image(101, 67, channels);
+    for (uint8& value : image.pixels) {
+      value = distribution(rng);
+    }
+    for (float sigma_space : {1.0f, 5.0f}) {
+      BilateralGrid grid(sigma_space, 30.0f);
+      TestImage output(image.width, image.height, channels);
+      TestImage expected(image.width, image.height, channels);
+      const int step = image.width * channels;
+      grid.Filter(image.View(), image.View(), 1, nullptr,
+                  output.pixels.data(), step);
+      grid.FilterScalar(image.View(), image.View(), 1, nullptr,
+                        expected.pixels.data(), step);
+      for (int i = 0; i < image.pixels.size(); ++i) {
+        ASSERT_NEAR(expected.pixels[i], output.pixels[i], 1)
+            << "i: " << i << " channels: " << channels;
+      }
+    }
+  }
+}
+
+TEST(BilateralGridTest, ThreadsMatchSingleThread) {
+  std::mt19937 rng(7);
+  const TestImage image = StepImage(120, 97, 30, 220, 25, &rng);
+  ThreadPool pool("bilateral_test", 3);
+  pool.StartWorkers();
+  for (float sigma_space : {1.5f, 3.0f, 16.0f}) {
+    BilateralGrid grid(sigma_space, 20.0f);
+    TestImage output(image.width, image.height, 1);
+    grid.Filter(image.View(), image.View(), /*num_threads=*/4, &pool,
+                output.pixels.data(), image.width);
+    EXPECT_EQ(Filter(sigma_space, 20.0f, image, image).pixels, output.pixels)
+        << sigma_space;
+  }
+}
+
+}  // namespace
+}  // namespace bilateral_filter
+}  // namespace mediapipe
@@ -0,0 +1,333 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/edge_detection_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "mediapipe/calculators/image/image_simd_utils.h"
+
+namespace mediapipe {
+namespace edge_detection {
+
+namespace {
+
+// The luminance weights of the GPU shader in 8-bit fixed point, which add up
+// to 256 so that white stays white.
+constexpr int kRedWeight = 54;
+constexpr int kGreenWeight = 183;
+constexpr int kBlueWeight = 19;
+
+inline int Luminance(const uint8* pixel) {
+  return (kRedWeight * pixel[0] + kGreenWeight * pixel[1] +
+          kBlueWeight * pixel[2] + 128) >>
+         8;
+}
+
+// Returns the gradient magnitude, rounded to nearest even as the SSE4.1
+// conversion does.
+inline uint8 Magnitude(int horizontal, int vertical) {
+  const float squared =
+      static_cast<float>(horizontal * horizontal + vertical * vertical);
+  return std::min(255L, std::lrint(std::sqrt(squared)));
+}
+
+// Writes the Sobel magnitude of the pixels [first_x, end_x) of a row.
+void SobelRange(const uint8* above, const uint8* center, const uint8* below,
+                int width, int first_x, int end_x, uint8* magnitude) {
+  for (int x = first_x; x < end_x; ++x) {
+    const int left = std::max(x - 1, 0);
+    const int right = std::min(x + 1, width - 1);
+    const int horizontal = above[right] + 2 * center[right] + below[right] -
+                           above[left] - 2 * center[left] - below[left];
+    const int vertical = below[left] + 2 * below[x] + below[right] -
+                         above[left] - 2 * above[x] - above[right];
+    magnitude[x] = Magnitude(horizontal, vertical);
+  }
+}
+
+void GrayToRgbRowScalar(const uint8* gray, const uint8* alpha_source,
+                        int channels, int width, uint8* output) {
+  for (int x = 0; x < width; ++x) {
+    uint8* pixel = output + x * channels;
+    for (int c = 0; c < std::min(channels, 3); ++c) {
+      pixel[c] = gray[x];
+    }
+    if (channels == 4) {
+      pixel[3] = alpha_source ? alpha_source[x * 4 + 3] : 255;
+    }
+  }
+}
+
+#if defined(__SSE4_1__)
+
+using image_simd::ChannelLoader;
+
+// Converts the pixels of a row to luminance in groups of 8, and returns the
+// number of pixels converted.
+int LuminanceRowSse41(const uint8* image, int channels, int width,
+                      uint8* gray) {
+  const ChannelLoader red_loader(channels, 0);
+  const ChannelLoader green_loader(channels, 1);
+  const ChannelLoader blue_loader(channels, 2);
+  const __m128i red_weight = _mm_set1_epi16(kRedWeight);
+  const __m128i green_weight = _mm_set1_epi16(kGreenWeight);
+  const __m128i blue_weight = _mm_set1_epi16(kBlueWeight);
+  const __m128i half = _mm_set1_epi16(128);
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const uint8* pixels = image + x * channels;
+    // The weighted sum is below 2^16, so it is computed in unsigned 16 bits.
+    __m128i luminance =
+        _mm_add_epi16(_mm_mullo_epi16(red_loader.Load(pixels), red_weight),
+                      _mm_mullo_epi16(green_loader.Load(pixels), green_weight));
+    luminance = _mm_add_epi16(
+        luminance, _mm_mullo_epi16(blue_loader.Load(pixels), blue_weight));
+    luminance = _mm_srli_epi16(_mm_add_epi16(luminance, half), 8);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(gray + x),
+                     _mm_packus_epi16(luminance, luminance));
+  }
+  return x;
+}
+
+// Extracts one channel of the pixels of a row in groups of 8, and returns the
+// number of pixels extracted.
+int ChannelRowSse41(const uint8* image, int channels, int channel, int width,
+                    uint8* gray) {
+  const ChannelLoader loader(channels, channel);
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const __m128i value = loader.Load(image + x * channels);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(gray + x),
+                     _mm_packus_epi16(value, value));
+  }
+  return x;
+}
+
+// Loads 8 gray values into the 16-bit lanes of a vector.
+inline __m128i LoadGray(const uint8* gray) {
+  return _mm_cvtepu8_epi16(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(gray)));
+}
+
+// Computes the Sobel magnitude of the pixels of a row in groups of 8, from
+// the second pixel up to the last group which does not read past the end of
+// the row.  Returns the end of the computed pixels.
+int SobelRowSse41(const uint8* above, const uint8* center, const uint8* below,
+                  int width, uint8* magnitude) {
+  int x = 1;
+  for (; x + 9 <= width; x += 8) {
+    const __m128i above_left = LoadGray(above + x - 1);
+    const __m128i above_right = LoadGray(above + x + 1);
+    const __m128i below_left = LoadGray(below + x - 1);
+    const __m128i below_right = LoadGray(below + x + 1);
+    const __m128i left = _mm_add_epi16(
+        _mm_add_epi16(above_left, below_left),
+        _mm_slli_epi16(LoadGray(center + x - 1), 1));
+    const __m128i right = _mm_add_epi16(
+        _mm_add_epi16(above_right, below_right),
+        _mm_slli_epi16(LoadGray(center + x + 1), 1));
+    const __m128i top =
+        _mm_add_epi16(_mm_add_epi16(above_left, above_right),
+                      _mm_slli_epi16(LoadGray(above + x), 1));
+    const __m128i bottom =
+        _mm_add_epi16(_mm_add_epi16(below_left, below_right),
+                      _mm_slli_epi16(LoadGray(below + x), 1));
+    const __m128i horizontal = _mm_sub_epi16(right, left);
+    const __m128i vertical = _mm_sub_epi16(bottom, top);
+    // Interleaving the gradients lets one multiply-add compute the squared
+    // magnitude of 4 pixels in 32 bits.
+    const __m128i low = _mm_unpacklo_epi16(horizontal, vertical);
+    const __m128i high = _mm_unpackhi_epi16(horizontal, vertical);
+    auto length = [](__m128i gradients) {
+      return _mm_cvtps_epi32(_mm_sqrt_ps(
+          _mm_cvtepi32_ps(_mm_madd_epi16(gradients, gradients))));
+    };
+    const __m128i result = _mm_packs_epi32(length(low), length(high));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(magnitude + x),
+                     _mm_packus_epi16(result, result));
+  }
+  return x;
+}
+
+// Replicates 16 gray values into 16 RGB or RGBA pixels.
+class GrayStorer {
+ public:
+  explicit GrayStorer(int channels) : channels_(channels) {
+    alignas(16) int8 masks[4][16];
+    for (int j = 0; j < 16 * channels; ++j) {
+      masks[j / 16][j % 16] = j % channels == 3 ? -1 : j / channels;
+    }
+    for (int k = 0; k < channels; ++k) {
+      masks_[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(masks[k]));
+    }
+  }
+
+  // Stores the pixels, with the alpha channel of RGBA pixels from
+  // "alpha_source", or 255 if it is null.
+  void Store(const uint8* gray, const uint8* alpha_source,
+             uint8* pixels) const {
+    const __m128i value =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(gray));
+    const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    for (int k = 0; k < channels_; ++k) {
+      __m128i result = _mm_shuffle_epi8(value, masks_[k]);
+      if (channels_ == 4) {
+        const __m128i alpha =
+            alpha_source ? _mm_and_si128(
+                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                                   alpha_source + 16 * k)),
+                               alpha_mask)
+                         : alpha_mask;
+        result = _mm_or_si128(result, alpha);
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 16 * k), result);
+    }
+  }
+
+ private:
+  int channels_;
+  __m128i masks_[4];
+};
+
+// Replicates the gray values of a row in groups of 16 pixels, and returns
+// the number of pixels written.
+int GrayToRgbRowSse41(const uint8* gray, const uint8* alpha_source,
+                      int channels, int width, uint8* output) {
+  const GrayStorer storer(channels);
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    storer.Store(gray + x, alpha_source ? alpha_source + x * channels : nullptr,
+                 output + x * channels);
+  }
+  return x;
+}
+
+#endif  // __SSE4_1__
+
+}  // namespace
+
+void LuminanceRowScalar(const uint8* image, int channels, int width,
+                        uint8* gray) {
+  for (int x = 0; x < width; ++x) {
+    gray[x] = Luminance(image + x * channels);
+  }
+}
+
+void LuminanceRow(const uint8* image, int channels, int width, uint8* gray) {
+  int x = 0;
+#if defined(__SSE4_1__)
+  x = LuminanceRowSse41(image, channels, width, gray);
+#endif  // __SSE4_1__
+  LuminanceRowScalar(image + x * channels, channels, width - x, gray + x);
+}
+
+void ChannelRow(const uint8* image, int channels, int channel, int width,
+                uint8* gray) {
+  if (channels == 1) {
+    std::memcpy(gray, image, width);
+    return;
+  }
+  int x = 0;
+#if defined(__SSE4_1__)
+  x = ChannelRowSse41(image, channels, channel, width, gray);
+#endif  // __SSE4_1__
+  for (; x < width; ++x) {
+    gray[x] = image[x * channels + channel];
+  }
+}
+
+void SobelRowScalar(const uint8* above, const uint8* center,
+                    const uint8* below, int width, uint8* magnitude) {
+  SobelRange(above, center, below, width, 0, width, magnitude);
+}
+
+void SobelRow(const uint8* above, const uint8* center, const uint8* below,
+              int width, uint8* magnitude) {
+#if defined(__SSE4_1__)
+  if (width > 1) {
+    const int end_x = SobelRowSse41(above, center, below, width, magnitude);
+    SobelRange(above, center, below, width, 0, 1, magnitude);
+    SobelRange(above, center, below, width, end_x, width, magnitude);
+    return;
+  }
+#endif  // __SSE4_1__
+  SobelRowScalar(above, center, below, width, magnitude);
+}
+
+void GrayToRgbRow(const uint8* gray, const uint8* alpha_source, int channels,
+                  int width, uint8* output) {
+  if (channels == 1) {
+    std::memcpy(output, gray, width);
+    return;
+  }
+  int x = 0;
+#if defined(__SSE4_1__)
+  x = GrayToRgbRowSse41(gray, alpha_source, channels, width, output);
+#endif  // __SSE4_1__
+  GrayToRgbRowScalar(gray + x,
+                     alpha_source ? alpha_source + x * channels : nullptr,
+                     channels, width - x, output + x * channels);
+}
+
+void LuminanceRows(const uint8* image, int image_step, int channels,
+                   int width, int first_row, int end_row, uint8* output,
+                   int output_step) {
+  std::vector<uint8> gray(width);
+  for (int y = first_row; y < end_row; ++y) {
+    const uint8* row = image + y * image_step;
+    LuminanceRow(row, channels, width, gray.data());
+    GrayToRgbRow(gray.data(), row, channels, width, output + y * output_step);
+  }
+}
+
+void SobelEdgesRows(const uint8* image, int image_step, int channels,
+                    int width, int height, bool luminance, int first_row,
+                    int end_row, uint8* output, int output_step) {
+  if (first_row >= end_row) {
+    return;
+  }
+  // The gray values of the rows above, at and below the current row, and the
+  // magnitude of the current row.
+  std::vector<uint8> buffer(4 * width);
+  uint8* above = buffer.data();
+  uint8* center = above + width;
+  uint8* below = center + width;
+  uint8* magnitude = below + width;
+  auto to_gray = [&](int y, uint8* gray) {
+    const uint8* row =
+        image + std::min(std::max(y, 0), height - 1) * image_step;
+    if (luminance) {
+      LuminanceRow(row, channels, width, gray);
+    } else {
+      ChannelRow(row, channels, 0, width, gray);
+    }
+  };
+  to_gray(first_row - 1, above);
+  to_gray(first_row, center);
+  for (int y = first_row; y < end_row; ++y) {
+    to_gray(y + 1, below);
+    SobelRow(above, center, below, width, magnitude);
+    GrayToRgbRow(magnitude, nullptr, channels, width,
+                 output + y * output_step);
+    std::swap(above, center);
+    std::swap(center, below);
+  }
+}
+
+}  // namespace edge_detection
+}  // namespace mediapipe
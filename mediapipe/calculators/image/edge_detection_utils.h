@@ -0,0 +1,85 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// CPU kernels for LuminanceCpuCalculator and SobelEdgesCpuCalculator.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_EDGE_DETECTION_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_EDGE_DETECTION_UTILS_H_
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace edge_detection {
+
+// Writes the luminance of "width" pixels of "image", which has "channels"
+// (3 or 4) interleaved channels per pixel, into "gray".  The weights are those
+// of the GPU shader of LuminanceCalculator in 8-bit fixed point:
+//
+//   gray = dot(rgb, (0.2125, 0.7154, 0.0721))
+void LuminanceRow(const uint8* image, int channels, int width, uint8* gray);
+
+// Writes the channel "channel" of "width" pixels of "image", which has
+// "channels" (1, 3 or 4) interleaved channels per pixel, into "gray".
+void ChannelRow(const uint8* image, int channels, int channel, int width,
+                uint8* gray);
+
+// Writes the magnitude of the Sobel gradient of the row "center" of a gray
+// image into "magnitude", as in the GPU shader of SobelEdgesCalculator:
+//
+//   magnitude = min(255, round(length(vec2(horizontal, vertical))))
+//
+// "above" and "below" are the neighboring rows, and the pixels past the left
+// and right edges are clamped to the edge pixels.
+void SobelRow(const uint8* above, const uint8* center, const uint8* below,
+              int width, uint8* magnitude);
+
+// Writes "width" pixels of "output", which has "channels" (1, 3 or 4)
+// interleaved channels per pixel, with the gray value replicated into the
+// color channels.  The alpha channel is copied from "alpha_source", which has
+// the same layout as "output", or is set to 255 if "alpha_source" is null.
+void GrayToRgbRow(const uint8* gray, const uint8* alpha_source, int channels,
+                  int width, uint8* output);
+
+// The scalar implementations of the functions above, which produce identical
+// results.  Exposed for testing and benchmarking.
+void LuminanceRowScalar(const uint8* image, int channels, int width,
+                        uint8* gray);
+void SobelRowScalar(const uint8* above, const uint8* center,
+                    const uint8* below, int width, uint8* magnitude);
+
+// Writes the luminance of the rows [first_row, end_row) of an image of
+// "width" pixels with "channels" (3 or 4) interleaved channels into the same
+// rows of "output", which has the same format as "image", with the luminance
+// replicated into the color channels and the alpha channel preserved.
+void LuminanceRows(const uint8* image, int image_step, int channels,
+                   int width, int first_row, int end_row, uint8* output,
+                   int output_step);
+
+// Writes the Sobel edges of the rows [first_row, end_row) of an image of
+// "width" x "height" pixels with "channels" (1, 3 or 4) interleaved channels,
+// into the same rows of "output", which has the same format as "image".  The
+// gray value of a pixel is its luminance if "luminance" is true, and its first
+// channel otherwise, as for the images produced by LuminanceCalculator.
+// The rows past the top and bottom edges are clamped to the edge rows.
+//
+// The image is processed one row at a time, keeping the gray values of the
+// three rows under the Sobel kernel in a small ring buffer, so that each
+// input row is converted once and the working set stays in cache.
+void SobelEdgesRows(const uint8* image, int image_step, int channels,
+                    int width, int height, bool luminance, int first_row,
+                    int end_row, uint8* output, int output_step);
+
+}  // namespace edge_detection
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_EDGE_DETECTION_UTILS_H_
@@ -0,0 +1,127 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks the CPU kernels of the edge detection calculators on 1080p
+// frames, e.g.:
+//   bazel run -c opt --copt=-msse4.1 \
+//       //mediapipe/calculators/image:edge_detection_utils_benchmark -- \
+//       --benchmark_format=console
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/calculators/image/edge_detection_utils.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace edge_detection {
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+
+std::vector<uint8> MakeImage(int channels) {
+  std::vector<uint8> image(kWidth * kHeight * channels);
+  for (int i = 0; i < image.size(); ++i) {
+    image[i] = i * 7;
+  }
+  return image;
+}
+
+// A naive per-pixel implementation of the floating point shader.
+void LuminanceRowNaive(const uint8* image, int channels, int width,
+                       uint8* gray) {
+  for (int x = 0; x < width; ++x) {
+    const uint8* pixel = image + x * channels;
+    gray[x] = static_cast<uint8>(0.2125f * pixel[0] + 0.7154f * pixel[1] +
+                                 0.0721f * pixel[2] + 0.5f);
+  }
+}
+
+// A naive per-pixel implementation of the floating point shader.
+void SobelRowNaive(const uint8* above, const uint8* center,
+                   const uint8* below, int width, uint8* magnitude) {
+  for (int x = 0; x < width; ++x) {
+    const int left = std::max(x - 1, 0);
+    const int right = std::min(x + 1, width - 1);
+    const float horizontal = -above[left] - 2.0f * center[left] -
+                             below[left] + above[right] +
+                             2.0f * center[right] + below[right];
+    const float vertical = -above[left] - 2.0f * above[x] - above[right] +
+                           below[left] + 2.0f * below[x] + below[right];
+    magnitude[x] = static_cast<uint8>(std::min(
+        255.0f,
+        std::sqrt(horizontal * horizontal + vertical * vertical) + 0.5f));
+  }
+}
+
+// Converts a frame with state.range(0) channels to luminance.
+template <void (*kLuminanceRow)(const uint8*, int, int, uint8*)>
+void BM_Luminance(benchmark::State& state) {
+  const int channels = state.range(0);
+  const std::vector<uint8> image = MakeImage(channels);
+  std::vector<uint8> gray(kWidth * kHeight);
+  for (auto _ : state) {
+    for (int y = 0; y < kHeight; ++y) {
+      kLuminanceRow(&image[y * kWidth * channels], channels, kWidth,
+                    &gray[y * kWidth]);
+    }
+    benchmark::DoNotOptimize(gray.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK_TEMPLATE(BM_Luminance, LuminanceRowNaive)->Arg(3)->Arg(4);
+BENCHMARK_TEMPLATE(BM_Luminance, LuminanceRowScalar)->Arg(3)->Arg(4);
+BENCHMARK_TEMPLATE(BM_Luminance, LuminanceRow)->Arg(3)->Arg(4);
+
+// Filters a gray frame.
+template <void (*kSobelRow)(const uint8*, const uint8*, const uint8*, int,
+                            uint8*)>
+void BM_Sobel(benchmark::State& state) {
+  const std::vector<uint8> gray = MakeImage(1);
+  std::vector<uint8> magnitude(gray.size());
+  for (auto _ : state) {
+    for (int y = 1; y + 1 < kHeight; ++y) {
+      kSobelRow(&gray[(y - 1) * kWidth], &gray[y * kWidth],
+                &gray[(y + 1) * kWidth], kWidth, &magnitude[y * kWidth]);
+    }
+    benchmark::DoNotOptimize(magnitude.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK_TEMPLATE(BM_Sobel, SobelRowNaive);
+BENCHMARK_TEMPLATE(BM_Sobel, SobelRowScalar);
+BENCHMARK_TEMPLATE(BM_Sobel, SobelRow);
+
+// Computes the edges of a frame with state.range(0) channels, as
+// SobelEdgesCpuCalculator does with compute_luminance.
+void BM_SobelEdgesFused(benchmark::State& state) {
+  const int channels = state.range(0);
+  const int step = kWidth * channels;
+  const std::vector<uint8> image = MakeImage(channels);
+  std::vector<uint8> output(image.size());
+  for (auto _ : state) {
+    SobelEdgesRows(image.data(), step, channels, kWidth, kHeight,
+                   /*luminance=*/true, 0, kHeight, output.data(), step);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK(BM_SobelEdgesFused)->Arg(3)->Arg(4);
+
+}  // namespace
+}  // namespace edge_detection
+}  // namespace mediapipe
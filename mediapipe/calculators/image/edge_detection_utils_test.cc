@@ -0,0 +1,170 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/edge_detection_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace edge_detection {
+namespace {
+
+std::vector<uint8> RandomBytes(int size, std::mt19937* rng) {
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8> bytes(size);
+  for (uint8& byte : bytes) {
+    byte = distribution(*rng);
+  }
+  return bytes;
+}
+
+// The floating point luminance of the GPU shader, stored in 8 bits.
+uint8 ReferenceLuminance(const uint8* pixel) {
+  return std::round(0.2125f * pixel[0] + 0.7154f * pixel[1] +
+                    0.0721f * pixel[2]);
+}
+
+// The floating point Sobel magnitude of the GPU shader, stored in 8 bits,
+// with the texture coordinates clamped to the edges.
+uint8 ReferenceSobel(const std::vector<uint8>& gray, int width, int height,
+                     int x, int y) {
+  auto at = [&](int dx, int dy) -> float {
+    const int clamped_x = std::min(std::max(x + dx, 0), width - 1);
+    const int clamped_y = std::min(std::max(y + dy, 0), height - 1);
+    return gray[clamped_y * width + clamped_x] / 255.0f;
+  };
+  const float horizontal = -at(-1, -1) - 2.0f * at(-1, 0) - at(-1, 1) +
+                           at(1, -1) + 2.0f * at(1, 0) + at(1, 1);
+  const float vertical = -at(-1, -1) - 2.0f * at(0, -1) - at(1, -1) +
+                         at(-1, 1) + 2.0f * at(0, 1) + at(1, 1);
+  const float magnitude = std::sqrt(horizontal * horizontal +
+                                    vertical * vertical);
+  return std::round(std::min(magnitude, 1.0f) * 255.0f);
+}
+
+TEST(EdgeDetectionUtilsTest, LuminanceMatchesScalarImplementation) {
+  std::mt19937 rng(0);
+  // The widths cover rows shorter than, equal to and longer than a vector.
+  for (int width : {1, 7, 8, 9, 16, 17, 37, 64}) {
+    for (int channels : {3, 4}) {
+      const std::vector<uint8> image = RandomBytes(width * channels, &rng);
+      std::vector<uint8> gray(width);
+      std::vector<uint8> expected(width);
+      LuminanceRow(image.data(), channels, width, gray.data());
+      LuminanceRowScalar(image.data(), channels, width, expected.data());
+      EXPECT_EQ(expected, gray) << "width: " << width
+                                << " channels: " << channels;
+    }
+  }
+}
+
+TEST(EdgeDetectionUtilsTest, SobelMatchesScalarImplementation) {
+  std::mt19937 rng(1);
+  for (int width : {1, 2, 8, 9, 10, 17, 37, 64}) {
+    const std::vector<uint8> above = RandomBytes(width, &rng);
+    const std::vector<uint8> center = RandomBytes(width, &rng);
+    const std::vector<uint8> below = RandomBytes(width, &rng);
+    std::vector<uint8> magnitude(width);
+    std::vector<uint8> expected(width);
+    SobelRow(above.data(), center.data(), below.data(), width,
+             magnitude.data());
+    SobelRowScalar(above.data(), center.data(), below.data(), width,
+                   expected.data());
+    EXPECT_EQ(expected, magnitude) << "width: " << width;
+  }
+}
+
+TEST(EdgeDetectionUtilsTest, LuminanceApproximatesShader) {
+  std::mt19937 rng(2);
+  const int kWidth = 256;
+  const std::vector<uint8> image = RandomBytes(kWidth * 4, &rng);
+  std::vector<uint8> output(image.size());
+  LuminanceRows(image.data(), kWidth * 4, 4, kWidth, 0, 1, output.data(),
+                kWidth * 4);
+  for (int x = 0; x < kWidth; ++x) {
+    const uint8* pixel = &output[x * 4];
+    EXPECT_NEAR(ReferenceLuminance(&image[x * 4]), pixel[0], 1) << "x: " << x;
+    EXPECT_EQ(pixel[0], pixel[1]);
+    EXPECT_EQ(pixel[0], pixel[2]);
+    EXPECT_EQ(image[x * 4 + 3], pixel[3]);
+  }
+}
+
+TEST(EdgeDetectionUtilsTest, SobelEdgesApproximateShader) {
+  std::mt19937 rng(3);
+  const int kWidth = 41;
+  const int kHeight = 13;
+  const std::vector<uint8> gray = RandomBytes(kWidth * kHeight, &rng);
+  std::vector<uint8> image(kWidth * kHeight * 3);
+  for (int i = 0; i < gray.size(); ++i) {
+    std::fill_n(&image[i * 3], 3, gray[i]);
+  }
+  std::vector<uint8> output(image.size());
+  SobelEdgesRows(image.data(), kWidth * 3, 3, kWidth, kHeight,
+                 /*luminance=*/false, 0, kHeight, output.data(), kWidth * 3);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      const uint8* pixel = &output[(y * kWidth + x) * 3];
+      EXPECT_NEAR(ReferenceSobel(gray, kWidth, kHeight, x, y), pixel[0], 1)
+          << "x: " << x << " y: " << y;
+      EXPECT_EQ(pixel[0], pixel[1]);
+      EXPECT_EQ(pixel[0], pixel[2]);
+    }
+  }
+}
+
+TEST(EdgeDetectionUtilsTest, FusedLuminanceMatchesSeparatePasses) {
+  std::mt19937 rng(4);
+  const int kWidth = 37;
+  const int kHeight = 9;
+  const int kStep = kWidth * 4;
+  const std::vector<uint8> image = RandomBytes(kStep * kHeight, &rng);
+  std::vector<uint8> luminance(image.size());
+  std::vector<uint8> separate(image.size());
+  std::vector<uint8> fused(image.size());
+  LuminanceRows(image.data(), kStep, 4, kWidth, 0, kHeight, luminance.data(),
+                kStep);
+  SobelEdgesRows(luminance.data(), kStep, 4, kWidth, kHeight,
+                 /*luminance=*/false, 0, kHeight, separate.data(), kStep);
+  // The fused filter is run in bands, which must not change the result.
+  for (int first_row = 0; first_row < kHeight; first_row += 4) {
+    SobelEdgesRows(image.data(), kStep, 4, kWidth, kHeight,
+                   /*luminance=*/true, first_row,
+                   std::min(first_row + 4, kHeight), fused.data(), kStep);
+  }
+  EXPECT_EQ(separate, fused);
+  for (int i = 3; i < fused.size(); i += 4) {
+    EXPECT_EQ(255, fused[i]);
+  }
+}
+
+TEST(EdgeDetectionUtilsTest, FlatImageHasNoEdges) {
+  const int kWidth = 19;
+  const int kHeight = 5;
+  const std::vector<uint8> image(kWidth * kHeight, 200);
+  std::vector<uint8> output(image.size(), 1);
+  SobelEdgesRows(image.data(), kWidth, 1, kWidth, kHeight,
+                 /*luminance=*/false, 0, kHeight, output.data(), kWidth);
+  EXPECT_EQ(std::vector<uint8>(image.size(), 0), output);
+}
+
+}  // namespace
+}  // namespace edge_detection
+}  // namespace mediapipe
@@ -0,0 +1,135 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SSE4.1 helpers shared by the CPU kernels of the image calculators, which
+// process 8 pixels at a time with one 16-bit lane per pixel and channel.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_IMAGE_SIMD_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_IMAGE_SIMD_UTILS_H_
+
+#include "mediapipe/framework/port/integral_types.h"
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+
+namespace mediapipe {
+namespace image_simd {
+
+// Returns round(value / 255) in each 16-bit lane, for values in
+// [0, 255 * 255].
+inline __m128i Div255(__m128i value) {
+  value = _mm_add_epi16(value, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+
+// Loads one channel of 8 interleaved pixels into the 16-bit lanes of a
+// vector.
+class ChannelLoader {
+ public:
+  ChannelLoader(int num_channels, int channel) : num_channels_(num_channels) {
+    // The 8 pixels span 24 or 32 bytes, which are loaded as two overlapping
+    // or adjacent 16-byte vectors.
+    high_offset_ = num_channels == 3 ? 8 : 16;
+    alignas(16) int8 low_mask[16];
+    alignas(16) int8 high_mask[16];
+    for (int i = 0; i < 8; ++i) {
+      const int offset = i * num_channels + channel;
+      low_mask[2 * i] = offset < 16 ? offset : -1;
+      high_mask[2 * i] = offset < 16 ? -1 : offset - high_offset_;
+      low_mask[2 * i + 1] = -1;
+      high_mask[2 * i + 1] = -1;
+    }
+    low_mask_ = _mm_load_si128(reinterpret_cast<const __m128i*>(low_mask));
+    high_mask_ = _mm_load_si128(reinterpret_cast<const __m128i*>(high_mask));
+  }
+
+  __m128i Load(const uint8* pixels) const {
+    if (num_channels_ == 1) {
+      return _mm_cvtepu8_epi16(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels)));
+    }
+    const __m128i low =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+    const __m128i high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(pixels + high_offset_));
+    return _mm_or_si128(_mm_shuffle_epi8(low, low_mask_),
+                        _mm_shuffle_epi8(high, high_mask_));
+  }
+
+ private:
+  int num_channels_;
+  int high_offset_;
+  __m128i low_mask_;
+  __m128i high_mask_;
+};
+
+// Stores 8 RGB pixels from the 16-bit lanes of three vectors.
+class RgbStorer {
+ public:
+  RgbStorer() {
+    // The red and green channels are packed into one vector and the blue
+    // channel into another, and each output byte is picked from either.
+    alignas(16) int8 masks[4][16];
+    for (int j = 0; j < 24; ++j) {
+      const int i = j / 3;
+      const int channel = j % 3;
+      int8* red_green = masks[j < 16 ? 0 : 2];
+      int8* blue = masks[j < 16 ? 1 : 3];
+      red_green[j % 16] = channel < 2 ? channel * 8 + i : -1;
+      blue[j % 16] = channel == 2 ? i : -1;
+    }
+    for (int j = 8; j < 16; ++j) {
+      masks[2][j] = -1;
+      masks[3][j] = -1;
+    }
+    for (int k = 0; k < 4; ++k) {
+      masks_[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(masks[k]));
+    }
+  }
+
+  void Store(__m128i r, __m128i g, __m128i b, uint8* pixels) const {
+    const __m128i red_green = _mm_packus_epi16(r, g);
+    const __m128i blue = _mm_packus_epi16(b, b);
+    const __m128i low = _mm_or_si128(_mm_shuffle_epi8(red_green, masks_[0]),
+                                     _mm_shuffle_epi8(blue, masks_[1]));
+    const __m128i high = _mm_or_si128(_mm_shuffle_epi8(red_green, masks_[2]),
+                                      _mm_shuffle_epi8(blue, masks_[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), low);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(pixels + 16), high);
+  }
+
+ private:
+  __m128i masks_[4];
+};
+
+// Stores 8 RGBA pixels from the 16-bit lanes of four vectors.
+inline void StoreRgba(__m128i r, __m128i g, __m128i b, __m128i a,
+                      uint8* pixels) {
+  const __m128i red_green = _mm_packus_epi16(r, g);
+  const __m128i blue_alpha = _mm_packus_epi16(b, a);
+  const __m128i rg =
+      _mm_unpacklo_epi8(red_green, _mm_srli_si128(red_green, 8));
+  const __m128i ba =
+      _mm_unpacklo_epi8(blue_alpha, _mm_srli_si128(blue_alpha, 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels),
+                   _mm_unpacklo_epi16(rg, ba));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 16),
+                   _mm_unpackhi_epi16(rg, ba));
+}
+
+}  // namespace image_simd
+}  // namespace mediapipe
+
+#endif  // __SSE4_1__
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_IMAGE_SIMD_UTILS_H_
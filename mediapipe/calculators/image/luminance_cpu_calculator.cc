@@ -0,0 +1,72 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/image/edge_detection_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+// Converts RGB images into luminance images, still stored in RGB format, on
+// the CPU.  This is the CPU counterpart of LuminanceCalculator, whose results
+// it matches within one intensity level.  The alpha channel of RGBA images is
+// preserved.
+//
+// Inputs:
+//   An ImageFrame, RGB or RGBA.
+// Outputs:
+//   An ImageFrame in the same format as the input.
+//
+// Example config:
+// node {
+//   calculator: "LuminanceCpuCalculator"
+//   input_stream: "input_video"
+//   output_stream: "luma_video"
+// }
+class LuminanceCpuCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<ImageFrame>();
+    cc->Outputs().Index(0).Set<ImageFrame>();
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    const auto& input = cc->Inputs().Index(0).Get<ImageFrame>();
+    RET_CHECK(input.Format() == ImageFormat::SRGB ||
+              input.Format() == ImageFormat::SRGBA)
+        << "Unsupported image format: " << input.Format();
+    auto output = absl::make_unique<ImageFrame>(input.Format(), input.Width(),
+                                                input.Height());
+    edge_detection::LuminanceRows(
+        input.PixelData(), input.WidthStep(), input.NumberOfChannels(),
+        input.Width(), 0, input.Height(), output->MutablePixelData(),
+        output->WidthStep());
+    cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+    return ::mediapipe::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(LuminanceCpuCalculator);
+
+}  // namespace mediapipe
@@ -12,16 +12,31 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
 #include "mediapipe/calculators/image/mask_overlay_calculator.pb.h"
+#include "mediapipe/calculators/image/mask_overlay_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "mediapipe/gpu/gl_simple_shaders.h"
 #include "mediapipe/gpu/shader_util.h"
+#endif  // __ANDROID__ or iOS
 
+namespace {
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 
+// The number of unused output frames kept for reuse on the CPU.
+constexpr int kNumPooledFrames = 2;
+}  // namespace
+
 namespace mediapipe {
 
 using ::mediapipe::MaskOverlayCalculatorOptions_MaskChannel_ALPHA;
@@ -30,21 +45,31 @@ using ::mediapipe::MaskOverlayCalculatorOptions_MaskChannel_UNKNOWN;
 
 // Mixes two frames using a third mask frame or constant value.
 //
+// The frames are GpuBuffers with the VIDEO tag, and ImageFrames with the
+// IMAGE tag.  On the CPU, the mix is computed in a single pass with 8-bit
+// fixed point arithmetic, which is vectorized with SSE4.1 when the build
+// enables it, e.g. with -msse4.1.  The output is written in place into one of
+// the input images if this calculator holds its only reference, and into a
+// frame from a pool otherwise.
+//
 // Inputs:
-//   VIDEO:[0,1] (GpuBuffer):
-//     Two inputs should be provided.
-//   MASK (GpuBuffer):
+//   VIDEO:[0,1] (GpuBuffer) or IMAGE:[0,1] (ImageFrame):
+//     Two inputs should be provided.  The images should have the same size
+//     and format, Gray, RGB or RGBA.
+//   MASK (GpuBuffer or ImageFrame, same as the images):
 //     Optional.
 //     Where the mask is 0, VIDEO:0 will be used. Where it is 1, VIDEO:1.
 //     Intermediate values will blend.
 //     If not specified, CONST_MASK float must be present.
+//     An ImageFrame mask should have the size of the images, and be Gray,
+//     RGB or RGBA.  The ALPHA mask_channel requires an RGBA mask.
 //   CONST_MASK (float):
 //     Optional.
 //     If not specified, MASK GpuBuffer must be present.
 //     Similar to MASK GpuBuffer, but applied globally to every pixel.
 //
 // Outputs:
-//   OUTPUT (GpuBuffer):
+//   OUTPUT (GpuBuffer or ImageFrame, same as the images):
 //     The mix.
 
 class MaskOverlayCalculator : public CalculatorBase {
@@ -57,23 +82,51 @@ class MaskOverlayCalculator : public CalculatorBase {
   ::mediapipe::Status Open(CalculatorContext* cc) override;
   ::mediapipe::Status Process(CalculatorContext* cc) override;
 
+ private:
+  ::mediapipe::Status ProcessCpu(CalculatorContext* cc);
+  ::mediapipe::Status ProcessGpu(CalculatorContext* cc);
+
+  // Returns an output frame for the ImageFrame "image", which is one of the
+  // input images if it can be consumed, and a pooled frame otherwise.
+  std::unique_ptr<ImageFrame> AcquireOutputFrame(CalculatorContext* cc,
+                                                 const ImageFrame& image);
+
+  bool use_gpu_ = false;
+  bool use_mask_tex_ = false;  // Otherwise, use constant float value.
+  std::shared_ptr<ImageFramePool> frame_pool_;
+
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   ::mediapipe::Status GlSetup(
       const MaskOverlayCalculatorOptions::MaskChannel mask_channel);
   ::mediapipe::Status GlRender(const float mask_const);
 
- private:
   GlCalculatorHelper helper_;
   bool initialized_ = false;
-  bool use_mask_tex_ = false;  // Otherwise, use constant float value.
   GLuint program_ = 0;
   GLint unif_frame1_;
   GLint unif_frame2_;
   GLint unif_mask_;
+#endif  // __ANDROID__ or iOS
 };
 REGISTER_CALCULATOR(MaskOverlayCalculator);
 
 // static
 ::mediapipe::Status MaskOverlayCalculator::GetContract(CalculatorContract* cc) {
+  if (cc->Inputs().HasTag("IMAGE")) {
+    cc->Inputs().Get("IMAGE", 0).Set<ImageFrame>();
+    cc->Inputs().Get("IMAGE", 1).Set<ImageFrame>();
+    if (cc->Inputs().HasTag("MASK"))
+      cc->Inputs().Tag("MASK").Set<ImageFrame>();
+    else if (cc->Inputs().HasTag("CONST_MASK"))
+      cc->Inputs().Tag("CONST_MASK").Set<float>();
+    else
+      return ::mediapipe::Status(
+          ::mediapipe::StatusCode::kNotFound,
+          "At least one mask input stream must be present.");
+    cc->Outputs().Tag("OUTPUT").Set<ImageFrame>();
+    return ::mediapipe::OkStatus();
+  }
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   MP_RETURN_IF_ERROR(GlCalculatorHelper::UpdateContract(cc));
   cc->Inputs().Get("VIDEO", 0).Set<GpuBuffer>();
   cc->Inputs().Get("VIDEO", 1).Set<GpuBuffer>();
@@ -87,6 +140,9 @@ REGISTER_CALCULATOR(MaskOverlayCalculator);
         "At least one mask input stream must be present.");
   cc->Outputs().Tag("OUTPUT").Set<GpuBuffer>();
   return ::mediapipe::OkStatus();
+#else
+  RET_CHECK_FAIL() << "GPU processing is not enabled, use IMAGE inputs.";
+#endif  // __ANDROID__ or iOS
 }
 
 ::mediapipe::Status MaskOverlayCalculator::Open(CalculatorContext* cc) {
@@ -94,10 +150,110 @@ REGISTER_CALCULATOR(MaskOverlayCalculator);
   if (cc->Inputs().HasTag("MASK")) {
     use_mask_tex_ = true;
   }
-  return helper_.Open(cc);
+  if (cc->Inputs().HasTag("VIDEO")) {
+    use_gpu_ = true;
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
+    MP_RETURN_IF_ERROR(helper_.Open(cc));
+#endif  // __ANDROID__ or iOS
+  }
+  return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status MaskOverlayCalculator::Process(CalculatorContext* cc) {
+  if (use_gpu_) {
+    return ProcessGpu(cc);
+  }
+  return ProcessCpu(cc);
+}
+
+std::unique_ptr<ImageFrame> MaskOverlayCalculator::AcquireOutputFrame(
+    CalculatorContext* cc, const ImageFrame& image) {
+  for (int i = 0; i < 2; ++i) {
+    // Consuming succeeds only if no other calculator or output holds the
+    // input packet, so its frame can be overwritten.
+    auto consumed = cc->Inputs().Get("IMAGE", i).Value().Consume<ImageFrame>();
+    if (consumed.ok()) {
+      return std::move(consumed).ValueOrDie();
+    }
+  }
+  if (!frame_pool_ || frame_pool_->width() != image.Width() ||
+      frame_pool_->height() != image.Height() ||
+      frame_pool_->format() != image.Format()) {
+    frame_pool_ = ImageFramePool::Create(image.Width(), image.Height(),
+                                         image.Format(), kNumPooledFrames);
+  }
+  return frame_pool_->GetBuffer();
+}
+
+::mediapipe::Status MaskOverlayCalculator::ProcessCpu(CalculatorContext* cc) {
+  const Packet& input1_packet = cc->Inputs().Get("IMAGE", 1).Value();
+  const Packet& mask_packet = use_mask_tex_
+                                  ? cc->Inputs().Tag("MASK").Value()
+                                  : cc->Inputs().Tag("CONST_MASK").Value();
+
+  if (mask_packet.IsEmpty()) {
+    cc->Outputs().Tag("OUTPUT").AddPacket(input1_packet);
+    return ::mediapipe::OkStatus();
+  }
+
+  const auto& image0 = cc->Inputs().Get("IMAGE", 0).Get<ImageFrame>();
+  const auto& image1 = input1_packet.Get<ImageFrame>();
+  RET_CHECK(image0.Format() == ImageFormat::GRAY8 ||
+            image0.Format() == ImageFormat::SRGB ||
+            image0.Format() == ImageFormat::SRGBA)
+      << "Unsupported image format: " << image0.Format();
+  RET_CHECK_EQ(image0.Format(), image1.Format());
+  RET_CHECK_EQ(image0.Width(), image1.Width());
+  RET_CHECK_EQ(image0.Height(), image1.Height());
+
+  const ImageFrame* mask = nullptr;
+  int mask_channel = 0;
+  uint8 weight = 0;
+  if (use_mask_tex_) {
+    mask = &mask_packet.Get<ImageFrame>();
+    RET_CHECK(mask->Format() == ImageFormat::GRAY8 ||
+              mask->Format() == ImageFormat::SRGB ||
+              mask->Format() == ImageFormat::SRGBA)
+        << "Unsupported mask format: " << mask->Format();
+    RET_CHECK_EQ(image0.Width(), mask->Width());
+    RET_CHECK_EQ(image0.Height(), mask->Height());
+    const auto mask_channel_option =
+        cc->Options<MaskOverlayCalculatorOptions>().mask_channel();
+    if (mask->Format() != ImageFormat::GRAY8 &&
+        mask_channel_option == MaskOverlayCalculatorOptions_MaskChannel_ALPHA) {
+      RET_CHECK(mask->Format() == ImageFormat::SRGBA)
+          << "The ALPHA mask channel requires an RGBA mask.";
+      mask_channel = 3;
+    }
+  } else {
+    const float mask_const = mask_packet.Get<float>();
+    weight = std::round(std::min(std::max(mask_const, 0.0f), 1.0f) * 255.0f);
+  }
+
+  // The input frames stay alive when one of them is consumed as the output.
+  std::unique_ptr<ImageFrame> output = AcquireOutputFrame(cc, image0);
+  const int channels = image0.NumberOfChannels();
+  for (int y = 0; y < image0.Height(); ++y) {
+    const uint8* row0 = image0.PixelData() + y * image0.WidthStep();
+    const uint8* row1 = image1.PixelData() + y * image1.WidthStep();
+    uint8* output_row = output->MutablePixelData() + y * output->WidthStep();
+    if (mask) {
+      mask_overlay::BlendRow(row0, row1, channels,
+                             mask->PixelData() + y * mask->WidthStep(),
+                             mask->NumberOfChannels(), mask_channel,
+                             image0.Width(), output_row);
+    } else {
+      mask_overlay::BlendRowConstant(row0, row1, channels, weight,
+                                     image0.Width(), output_row);
+    }
+  }
+
+  cc->Outputs().Tag("OUTPUT").Add(output.release(), cc->InputTimestamp());
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status MaskOverlayCalculator::ProcessGpu(CalculatorContext* cc) {
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   return helper_.RunInGlContext([this, &cc]() -> ::mediapipe::Status {
     if (!initialized_) {
       const auto& options = cc->Options<MaskOverlayCalculatorOptions>();
@@ -175,8 +331,13 @@ REGISTER_CALCULATOR(MaskOverlayCalculator);
     cc->Outputs().Tag("OUTPUT").Add(output.release(), cc->InputTimestamp());
     return ::mediapipe::OkStatus();
   });
+#else
+  return ::mediapipe::OkStatus();
+#endif  // __ANDROID__ or iOS
 }
 
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
+
 ::mediapipe::Status MaskOverlayCalculator::GlSetup(
     const MaskOverlayCalculatorOptions::MaskChannel mask_channel) {
   // Load vertex and fragment shaders
@@ -270,13 +431,20 @@ REGISTER_CALCULATOR(MaskOverlayCalculator);
   return ::mediapipe::OkStatus();
 }
 
+#endif  // __ANDROID__ or iOS
+
 MaskOverlayCalculator::~MaskOverlayCalculator() {
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
+  if (!use_gpu_) {
+    return;
+  }
   helper_.RunInGlContext([this] {
     if (program_) {
       glDeleteProgram(program_);
       program_ = 0;
     }
   });
+#endif  // __ANDROID__ or iOS
 }
 
 }  // namespace mediapipe
@@ -0,0 +1,194 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/image/mask_overlay_calculator.pb.h"
+#include "mediapipe/calculators/image/mask_overlay_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+std::unique_ptr<ImageFrame> MakeImage(ImageFormat::Format format, int width,
+                                      int height, int seed) {
+  auto image = absl::make_unique<ImageFrame>(format, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < width * image->NumberOfChannels(); ++x) {
+      row[x] = (x * 31 + y * 17 + seed) % 256;
+    }
+  }
+  return image;
+}
+
+// Returns the expected mix of "image0" and "image1" with "mask".
+std::vector<uint8> ExpectedRow(const ImageFrame& image0,
+                               const ImageFrame& image1,
+                               const ImageFrame& mask, int y) {
+  std::vector<uint8> row(image0.Width() * image0.NumberOfChannels());
+  mask_overlay::BlendRowScalar(
+      image0.PixelData() + y * image0.WidthStep(),
+      image1.PixelData() + y * image1.WidthStep(), image0.NumberOfChannels(),
+      mask.PixelData() + y * mask.WidthStep(), mask.NumberOfChannels(), 0,
+      image0.Width(), row.data());
+  return row;
+}
+
+std::vector<uint8> Row(const ImageFrame& image, int y) {
+  const uint8* row = image.PixelData() + y * image.WidthStep();
+  return std::vector<uint8>(row,
+                            row + image.Width() * image.NumberOfChannels());
+}
+
+TEST(MaskOverlayCalculatorTest, BlendsWithMaskOnCpu) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "MaskOverlayCalculator"
+    input_stream: "IMAGE:0:image0"
+    input_stream: "IMAGE:1:image1"
+    input_stream: "MASK:mask"
+    output_stream: "OUTPUT:output"
+  )"));
+  const Packet image0 =
+      Adopt(MakeImage(ImageFormat::SRGBA, 29, 7, 0).release()).At(Timestamp(0));
+  const Packet image1 =
+      Adopt(MakeImage(ImageFormat::SRGBA, 29, 7, 9).release()).At(Timestamp(0));
+  const Packet mask =
+      Adopt(MakeImage(ImageFormat::GRAY8, 29, 7, 3).release()).At(Timestamp(0));
+  runner.MutableInputs()->Get("IMAGE", 0).packets.push_back(image0);
+  runner.MutableInputs()->Get("IMAGE", 1).packets.push_back(image1);
+  runner.MutableInputs()->Tag("MASK").packets.push_back(mask);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("OUTPUT").packets;
+  ASSERT_EQ(1, packets.size());
+  const ImageFrame& output = packets[0].Get<ImageFrame>();
+  ASSERT_EQ(ImageFormat::SRGBA, output.Format());
+  // The runner keeps the input packets, so they cannot be overwritten.
+  EXPECT_NE(image0.Get<ImageFrame>().PixelData(), output.PixelData());
+  EXPECT_NE(image1.Get<ImageFrame>().PixelData(), output.PixelData());
+  for (int y = 0; y < output.Height(); ++y) {
+    EXPECT_EQ(ExpectedRow(image0.Get<ImageFrame>(), image1.Get<ImageFrame>(),
+                          mask.Get<ImageFrame>(), y),
+              Row(output, y))
+        << "y: " << y;
+  }
+}
+
+TEST(MaskOverlayCalculatorTest, BlendsWithConstantMaskOnCpu) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "MaskOverlayCalculator"
+    input_stream: "IMAGE:0:image0"
+    input_stream: "IMAGE:1:image1"
+    input_stream: "CONST_MASK:weight"
+    output_stream: "OUTPUT:output"
+  )"));
+  for (int t = 0; t < 2; ++t) {
+    runner.MutableInputs()->Get("IMAGE", 0).packets.push_back(
+        Adopt(MakeImage(ImageFormat::SRGB, 10, 3, 0).release())
+            .At(Timestamp(t)));
+    runner.MutableInputs()->Get("IMAGE", 1).packets.push_back(
+        Adopt(MakeImage(ImageFormat::SRGB, 10, 3, 50).release())
+            .At(Timestamp(t)));
+  }
+  // The second image has no mask, and is replaced by IMAGE:1.
+  runner.MutableInputs()->Tag("CONST_MASK").packets.push_back(
+      MakePacket<float>(1.0f).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("OUTPUT").packets;
+  ASSERT_EQ(2, packets.size());
+  const ImageFrame& expected = runner.MutableInputs()
+                                   ->Get("IMAGE", 1)
+                                   .packets[0]
+                                   .Get<ImageFrame>();
+  for (int y = 0; y < expected.Height(); ++y) {
+    EXPECT_EQ(Row(expected, y), Row(packets[0].Get<ImageFrame>(), y));
+  }
+  EXPECT_EQ(runner.MutableInputs()->Get("IMAGE", 1).packets[1].Get<ImageFrame>()
+                .PixelData(),
+            packets[1].Get<ImageFrame>().PixelData());
+}
+
+TEST(MaskOverlayCalculatorTest, BlendsInPlaceWhenInputIsConsumable) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "image0"
+        input_stream: "image1"
+        input_stream: "mask"
+        node {
+          calculator: "MaskOverlayCalculator"
+          input_stream: "IMAGE:0:image0"
+          input_stream: "IMAGE:1:image1"
+          input_stream: "MASK:mask"
+          output_stream: "OUTPUT:output"
+        }
+      )");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  std::vector<Packet> outputs;
+  MP_ASSERT_OK(graph.ObserveOutputStream("output", [&](const Packet& packet) {
+    outputs.push_back(packet);
+    return ::mediapipe::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  auto image0 = MakeImage(ImageFormat::SRGB, 33, 5, 0);
+  const uint8* image0_pixels = image0->PixelData();
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "image0", Adopt(image0.release()).At(Timestamp(0))));
+  auto image1 = MakeImage(ImageFormat::SRGB, 33, 5, 1);
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "image1", Adopt(image1.release()).At(Timestamp(0))));
+  auto mask = MakeImage(ImageFormat::SRGB, 33, 5, 2);
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "mask", Adopt(mask.release()).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_EQ(image0_pixels, outputs[0].Get<ImageFrame>().PixelData());
+}
+
+TEST(MaskOverlayCalculatorTest, RejectsAlphaChannelOfRgbMask) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "MaskOverlayCalculator"
+    input_stream: "IMAGE:0:image0"
+    input_stream: "IMAGE:1:image1"
+    input_stream: "MASK:mask"
+    output_stream: "OUTPUT:output"
+    options {
+      [mediapipe.MaskOverlayCalculatorOptions.ext] { mask_channel: ALPHA }
+    }
+  )"));
+  runner.MutableInputs()->Get("IMAGE", 0).packets.push_back(
+      Adopt(MakeImage(ImageFormat::SRGB, 4, 4, 0).release()).At(Timestamp(0)));
+  runner.MutableInputs()->Get("IMAGE", 1).packets.push_back(
+      Adopt(MakeImage(ImageFormat::SRGB, 4, 4, 1).release()).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("MASK").packets.push_back(
+      Adopt(MakeImage(ImageFormat::SRGB, 4, 4, 2).release()).At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,166 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/mask_overlay_utils.h"
+
+#include "mediapipe/calculators/image/image_simd_utils.h"
+
+namespace mediapipe {
+namespace mask_overlay {
+
+namespace {
+
+// Returns round(value / 255) for a value in [0, 255 * 255].
+inline int Div255(int value) {
+  value += 128;
+  return (value + (value >> 8)) >> 8;
+}
+
+inline uint8 Blend(int value0, int value1, int weight) {
+  return Div255(value0 * (255 - weight) + value1 * weight);
+}
+
+void BlendBytesScalar(const uint8* image0, const uint8* image1, int weight,
+                      int size, uint8* output) {
+  for (int i = 0; i < size; ++i) {
+    output[i] = Blend(image0[i], image1[i], weight);
+  }
+}
+
+#if defined(__SSE4_1__)
+
+// The SSE4.1 kernels process 16 bytes at a time, which are widened to 16-bit
+// lanes so that all intermediate values fit in 16 bits.
+
+using image_simd::ChannelLoader;
+using image_simd::Div255;
+
+// Blends 16 bytes of two rows with 16 weights.
+inline __m128i BlendBytes(__m128i value0, __m128i value1, __m128i weight) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i opaque = _mm_set1_epi16(255);
+  auto blend = [&opaque](__m128i a, __m128i b, __m128i w) {
+    return Div255(_mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(opaque, w)),
+                                _mm_mullo_epi16(b, w)));
+  };
+  const __m128i low =
+      blend(_mm_unpacklo_epi8(value0, zero), _mm_unpacklo_epi8(value1, zero),
+            _mm_unpacklo_epi8(weight, zero));
+  const __m128i high =
+      blend(_mm_unpackhi_epi8(value0, zero), _mm_unpackhi_epi8(value1, zero),
+            _mm_unpackhi_epi8(weight, zero));
+  return _mm_packus_epi16(low, high);
+}
+
+inline __m128i LoadBytes(const uint8* bytes) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+// Blends the bytes of two rows with one weight in groups of 16, and returns
+// the number of bytes blended.
+int BlendBytesSse41(const uint8* image0, const uint8* image1, uint8 weight,
+                    int size, uint8* output) {
+  const __m128i weights = _mm_set1_epi8(weight);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(output + i),
+        BlendBytes(LoadBytes(image0 + i), LoadBytes(image1 + i), weights));
+  }
+  return i;
+}
+
+// Blends the pixels of two rows with a mask in groups of 16, and returns the
+// number of pixels blended.
+int BlendRowSse41(const uint8* image0, const uint8* image1, int channels,
+                  const uint8* mask, int mask_channels, int mask_channel,
+                  int width, uint8* output) {
+  const ChannelLoader mask_loader(mask_channels, mask_channel);
+  // The masks which replicate the weight of each of 16 pixels into the bytes
+  // of its channels.
+  alignas(16) int8 replicate[4][16];
+  for (int j = 0; j < 16 * channels; ++j) {
+    replicate[j / 16][j % 16] = j / channels;
+  }
+  __m128i replicate_masks[4];
+  for (int k = 0; k < channels; ++k) {
+    replicate_masks[k] =
+        _mm_load_si128(reinterpret_cast<const __m128i*>(replicate[k]));
+  }
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i weights;
+    if (mask_channels == 1) {
+      weights = LoadBytes(mask + x);
+    } else {
+      const uint8* pixels = mask + x * mask_channels;
+      weights = _mm_packus_epi16(mask_loader.Load(pixels),
+                                 mask_loader.Load(pixels + 8 * mask_channels));
+    }
+    const int offset = x * channels;
+    for (int k = 0; k < channels; ++k) {
+      const int i = offset + 16 * k;
+      const __m128i channel_weights =
+          channels == 1 ? weights
+                        : _mm_shuffle_epi8(weights, replicate_masks[k]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+                       BlendBytes(LoadBytes(image0 + i), LoadBytes(image1 + i),
+                                  channel_weights));
+    }
+  }
+  return x;
+}
+
+#endif  // __SSE4_1__
+
+}  // namespace
+
+void BlendRowScalar(const uint8* image0, const uint8* image1, int channels,
+                    const uint8* mask, int mask_channels, int mask_channel,
+                    int width, uint8* output) {
+  for (int x = 0; x < width; ++x) {
+    const int offset = x * channels;
+    BlendBytesScalar(image0 + offset, image1 + offset,
+                     mask[x * mask_channels + mask_channel], channels,
+                     output + offset);
+  }
+}
+
+void BlendRow(const uint8* image0, const uint8* image1, int channels,
+              const uint8* mask, int mask_channels, int mask_channel,
+              int width, uint8* output) {
+  int x = 0;
+#if defined(__SSE4_1__)
+  x = BlendRowSse41(image0, image1, channels, mask, mask_channels,
+                    mask_channel, width, output);
+#endif  // __SSE4_1__
+  const int offset = x * channels;
+  BlendRowScalar(image0 + offset, image1 + offset, channels,
+                 mask + x * mask_channels, mask_channels, mask_channel,
+                 width - x, output + offset);
+}
+
+void BlendRowConstant(const uint8* image0, const uint8* image1, int channels,
+                      uint8 weight, int width, uint8* output) {
+  const int size = width * channels;
+  int i = 0;
+#if defined(__SSE4_1__)
+  i = BlendBytesSse41(image0, image1, weight, size, output);
+#endif  // __SSE4_1__
+  BlendBytesScalar(image0 + i, image1 + i, weight, size - i, output + i);
+}
+
+}  // namespace mask_overlay
+}  // namespace mediapipe
@@ -0,0 +1,52 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// CPU kernels for MaskOverlayCalculator.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_MASK_OVERLAY_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_MASK_OVERLAY_UTILS_H_
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace mask_overlay {
+
+// Blends one row of "width" pixels of "image0" and "image1", which have
+// "channels" (1, 3 or 4) interleaved channels per pixel, as in the GPU shader
+// of MaskOverlayCalculator:
+//
+//   output = mix(image0, image1, mask / 255)
+//
+// where "mask" is the channel "mask_channel" of a row with "mask_channels"
+// (1, 3 or 4) channels per pixel.  All channels, including alpha, are
+// blended.  "output" may be the same row as "image0" or "image1".  The
+// computation uses 8-bit fixed point arithmetic, and is vectorized with
+// SSE4.1 when available.
+void BlendRow(const uint8* image0, const uint8* image1, int channels,
+              const uint8* mask, int mask_channels, int mask_channel,
+              int width, uint8* output);
+
+// Same as BlendRow(), with the same mask value "weight" for every pixel.
+void BlendRowConstant(const uint8* image0, const uint8* image1, int channels,
+                      uint8 weight, int width, uint8* output);
+
+// The scalar implementation of BlendRow(), which produces identical
+// results.  Exposed for testing and benchmarking.
+void BlendRowScalar(const uint8* image0, const uint8* image1, int channels,
+                    const uint8* mask, int mask_channels, int mask_channel,
+                    int width, uint8* output);
+
+}  // namespace mask_overlay
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_MASK_OVERLAY_UTILS_H_
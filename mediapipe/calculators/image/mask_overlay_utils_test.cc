@@ -0,0 +1,111 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/mask_overlay_utils.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace mask_overlay {
+namespace {
+
+std::vector<uint8> RandomBytes(int size, std::mt19937* rng) {
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8> bytes(size);
+  for (uint8& byte : bytes) {
+    byte = distribution(*rng);
+  }
+  return bytes;
+}
+
+TEST(MaskOverlayUtilsTest, MatchesScalarImplementation) {
+  std::mt19937 rng(0);
+  // The widths cover rows shorter than, equal to and longer than a vector.
+  for (int width : {1, 15, 16, 17, 33, 64}) {
+    for (int channels : {1, 3, 4}) {
+      for (int mask_channels : {1, 3, 4}) {
+        const int mask_channel = mask_channels - 1;
+        const std::vector<uint8> image0 = RandomBytes(width * channels, &rng);
+        const std::vector<uint8> image1 = RandomBytes(width * channels, &rng);
+        const std::vector<uint8> mask =
+            RandomBytes(width * mask_channels, &rng);
+        std::vector<uint8> output(image0.size());
+        std::vector<uint8> expected(image0.size());
+        BlendRow(image0.data(), image1.data(), channels, mask.data(),
+                 mask_channels, mask_channel, width, output.data());
+        BlendRowScalar(image0.data(), image1.data(), channels, mask.data(),
+                       mask_channels, mask_channel, width, expected.data());
+        EXPECT_EQ(expected, output)
+            << "width: " << width << " channels: " << channels
+            << " mask_channels: " << mask_channels;
+      }
+    }
+  }
+}
+
+TEST(MaskOverlayUtilsTest, ApproximatesShaderMix) {
+  std::mt19937 rng(1);
+  const int kWidth = 100;
+  const std::vector<uint8> image0 = RandomBytes(kWidth * 4, &rng);
+  const std::vector<uint8> image1 = RandomBytes(kWidth * 4, &rng);
+  const std::vector<uint8> mask = RandomBytes(kWidth, &rng);
+  std::vector<uint8> output(image0.size());
+  BlendRow(image0.data(), image1.data(), 4, mask.data(), 1, 0, kWidth,
+           output.data());
+  for (int i = 0; i < output.size(); ++i) {
+    const float weight = mask[i / 4] / 255.0f;
+    const float expected = image0[i] * (1.0f - weight) + image1[i] * weight;
+    EXPECT_NEAR(expected, output[i], 0.5f + 1e-3f) << "i: " << i;
+  }
+}
+
+TEST(MaskOverlayUtilsTest, ConstantWeightMatchesUniformMask) {
+  std::mt19937 rng(2);
+  const int kWidth = 45;
+  const std::vector<uint8> image0 = RandomBytes(kWidth * 3, &rng);
+  const std::vector<uint8> image1 = RandomBytes(kWidth * 3, &rng);
+  for (int weight : {0, 77, 255}) {
+    const std::vector<uint8> mask(kWidth, weight);
+    std::vector<uint8> output(image0.size());
+    std::vector<uint8> expected(image0.size());
+    BlendRowConstant(image0.data(), image1.data(), 3, weight, kWidth,
+                     output.data());
+    BlendRowScalar(image0.data(), image1.data(), 3, mask.data(), 1, 0, kWidth,
+                   expected.data());
+    EXPECT_EQ(expected, output) << "weight: " << weight;
+  }
+}
+
+TEST(MaskOverlayUtilsTest, BlendsInPlace) {
+  std::mt19937 rng(3);
+  const int kWidth = 40;
+  std::vector<uint8> image0 = RandomBytes(kWidth * 4, &rng);
+  const std::vector<uint8> image1 = RandomBytes(kWidth * 4, &rng);
+  const std::vector<uint8> mask = RandomBytes(kWidth, &rng);
+  std::vector<uint8> expected(image0.size());
+  BlendRowScalar(image0.data(), image1.data(), 4, mask.data(), 1, 0, kWidth,
+                 expected.data());
+  BlendRow(image0.data(), image1.data(), 4, mask.data(), 1, 0, kWidth,
+           image0.data());
+  EXPECT_EQ(expected, image0);
+}
+
+}  // namespace
+}  // namespace mask_overlay
+}  // namespace mediapipe
@@ -12,14 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/calculators/image/recolor_calculator.pb.h"
+#include "mediapipe/calculators/image/recolor_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/parallel_rows.h"
 
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -40,14 +45,17 @@ namespace mediapipe {
 // The luminance of the input image is used to adjust the blending weight,
 // to help preserve image textures.
 //
-// TODO implement cpu support.
+// On the CPU, the image is recolored with fixed point arithmetic, which is
+// vectorized with SSE4.1 when the build enables it, e.g. with -msse4.1.  Bands
+// of rows can be recolored in parallel with the num_threads option.
 //
 // Inputs:
 //   One of the following IMAGE tags:
 //   IMAGE: An ImageFrame input image, RGB or RGBA.
 //   IMAGE_GPU: A GpuBuffer input image, RGBA.
 //   One of the following MASK tags:
-//   MASK: An ImageFrame input mask, Gray, RGB or RGBA.
+//   MASK: An ImageFrame input mask, Gray, RGB or RGBA.  The ALPHA
+//         mask_channel requires an RGBA mask.
 //   MASK_GPU: A GpuBuffer input mask, RGBA.
 // Output:
 //   One of the following IMAGE tags:
@@ -92,7 +100,10 @@ class RecolorCalculator : public CalculatorBase {
 
   bool initialized_ = false;
   std::vector<float> color_;
+  uint8 color_rgb_[3];
   mediapipe::RecolorCalculatorOptions::MaskChannel mask_channel_;
+  int num_threads_ = 1;
+  std::unique_ptr<ThreadPool> thread_pool_;
 
   bool use_gpu_ = false;
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
@@ -153,6 +164,12 @@ REGISTER_CALCULATOR(RecolorCalculator);
 
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
+  if (!use_gpu_ && num_threads_ > 1) {
+    // The calling thread recolors one of the bands.
+    thread_pool_ = absl::make_unique<ThreadPool>("recolor", num_threads_ - 1);
+    thread_pool_->StartWorkers();
+  }
+
   return ::mediapipe::OkStatus();
 }
 
@@ -182,12 +199,56 @@ REGISTER_CALCULATOR(RecolorCalculator);
     program_ = 0;
   });
 #endif  // __ANDROID__ or iOS
+  thread_pool_.reset();
 
   return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status RecolorCalculator::RenderCpu(CalculatorContext* cc) {
-  return ::mediapipe::UnimplementedError("CPU support is not implemented yet.");
+  if (cc->Inputs().Tag("MASK").IsEmpty()) {
+    return ::mediapipe::OkStatus();
+  }
+  // Get inputs and setup output.
+  const auto& input_img = cc->Inputs().Tag("IMAGE").Get<ImageFrame>();
+  const auto& mask_img = cc->Inputs().Tag("MASK").Get<ImageFrame>();
+  RET_CHECK(input_img.Format() == ImageFormat::SRGB ||
+            input_img.Format() == ImageFormat::SRGBA)
+      << "Unsupported image format: " << input_img.Format();
+  RET_CHECK(mask_img.Format() == ImageFormat::GRAY8 ||
+            mask_img.Format() == ImageFormat::SRGB ||
+            mask_img.Format() == ImageFormat::SRGBA)
+      << "Unsupported mask format: " << mask_img.Format();
+  RET_CHECK_EQ(input_img.Width(), mask_img.Width());
+  RET_CHECK_EQ(input_img.Height(), mask_img.Height());
+
+  int mask_channel = 0;
+  if (mask_img.Format() != ImageFormat::GRAY8 &&
+      mask_channel_ == mediapipe::RecolorCalculatorOptions_MaskChannel_ALPHA) {
+    RET_CHECK(mask_img.Format() == ImageFormat::SRGBA)
+        << "The ALPHA mask channel requires an RGBA mask.";
+    mask_channel = 3;
+  }
+
+  auto output_img = absl::make_unique<ImageFrame>(
+      input_img.Format(), input_img.Width(), input_img.Height());
+  const int image_channels = input_img.NumberOfChannels();
+  const int mask_channels = mask_img.NumberOfChannels();
+  ImageFrame* output = output_img.get();
+  ParallelForRowBands(
+      input_img.Height(), num_threads_, thread_pool_.get(),
+      [&](int first_row, int end_row) {
+        for (int y = first_row; y < end_row; ++y) {
+          recolor::RecolorRow(
+              input_img.PixelData() + y * input_img.WidthStep(),
+              image_channels, mask_img.PixelData() + y * mask_img.WidthStep(),
+              mask_channels, mask_channel, color_rgb_, input_img.Width(),
+              output->MutablePixelData() + y * output->WidthStep());
+        }
+      });
+
+  cc->Outputs().Tag("IMAGE").Add(output_img.release(), cc->InputTimestamp());
+
+  return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status RecolorCalculator::RenderGpu(CalculatorContext* cc) {
@@ -300,6 +361,12 @@ void RecolorCalculator::GlRender() {
   color_.push_back(options.color().r() / 255.0);
   color_.push_back(options.color().g() / 255.0);
   color_.push_back(options.color().b() / 255.0);
+  color_rgb_[0] = options.color().r();
+  color_rgb_[1] = options.color().g();
+  color_rgb_[2] = options.color().b();
+
+  RET_CHECK_GE(options.num_threads(), 1);
+  num_threads_ = options.num_threads();
 
   return ::mediapipe::OkStatus();
 }
@@ -0,0 +1,105 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/image/recolor_calculator.pb.h"
+#include "mediapipe/calculators/image/recolor_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+CalculatorGraphConfig::Node RecolorNode(const std::string& mask_channel,
+                                        int num_threads) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+      R"(
+        calculator: "RecolorCalculator"
+        input_stream: "IMAGE:image"
+        input_stream: "MASK:mask"
+        output_stream: "IMAGE:output_image"
+        options {
+          [mediapipe.RecolorCalculatorOptions.ext] {
+            color { r: 0 g: 0 b: 255 }
+            mask_channel: $0
+            num_threads: $1
+          }
+        })",
+      mask_channel, num_threads));
+}
+
+Packet MakeImage(ImageFormat::Format format, int width, int height,
+                 int seed) {
+  auto image = absl::make_unique<ImageFrame>(format, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < width * image->NumberOfChannels(); ++x) {
+      row[x] = (x * 31 + y * 17 + seed) % 256;
+    }
+  }
+  return Adopt(image.release());
+}
+
+TEST(RecolorCalculatorTest, RecolorsOnCpu) {
+  for (int num_threads : {1, 3}) {
+    CalculatorRunner runner(RecolorNode("RED", num_threads));
+    const Packet image = MakeImage(ImageFormat::SRGB, 37, 11, 0);
+    const Packet mask = MakeImage(ImageFormat::GRAY8, 37, 11, 5);
+    runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+        image.At(Timestamp(0)));
+    runner.MutableInputs()->Tag("MASK").packets.push_back(
+        mask.At(Timestamp(0)));
+    MP_ASSERT_OK(runner.Run());
+
+    const auto& packets = runner.Outputs().Tag("IMAGE").packets;
+    ASSERT_EQ(1, packets.size());
+    const ImageFrame& output = packets[0].Get<ImageFrame>();
+    const ImageFrame& input = image.Get<ImageFrame>();
+    const ImageFrame& mask_frame = mask.Get<ImageFrame>();
+    ASSERT_EQ(ImageFormat::SRGB, output.Format());
+    ASSERT_EQ(input.Width(), output.Width());
+    ASSERT_EQ(input.Height(), output.Height());
+    const uint8 color[3] = {0, 0, 255};
+    std::vector<uint8> expected(input.Width() * 3);
+    for (int y = 0; y < input.Height(); ++y) {
+      recolor::RecolorRowScalar(
+          input.PixelData() + y * input.WidthStep(), 3,
+          mask_frame.PixelData() + y * mask_frame.WidthStep(), 1, 0, color,
+          input.Width(), expected.data());
+      const uint8* row = output.PixelData() + y * output.WidthStep();
+      EXPECT_EQ(expected, std::vector<uint8>(row, row + expected.size()))
+          << "row: " << y << " num_threads: " << num_threads;
+    }
+  }
+}
+
+TEST(RecolorCalculatorTest, RejectsAlphaChannelOfRgbMask) {
+  CalculatorRunner runner(RecolorNode("ALPHA", 1));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      MakeImage(ImageFormat::SRGB, 8, 8, 0).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("MASK").packets.push_back(
+      MakeImage(ImageFormat::SRGB, 8, 8, 0).At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,134 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/calculators/image/recolor_utils.h"
+
+#include "mediapipe/calculators/image/image_simd_utils.h"
+
+namespace mediapipe {
+namespace recolor {
+
+namespace {
+
+// Returns round(value / 255) for a value in [0, 255 * 255].
+inline int Div255(int value) {
+  value += 128;
+  return (value + (value >> 8)) >> 8;
+}
+
+// Returns the luminance of an RGB pixel, with the weights of the GPU shader
+// in 8-bit fixed point.
+inline int Luminance(const uint8* pixel) {
+  return (77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8;
+}
+
+#if defined(__SSE4_1__)
+
+// The SSE4.1 kernel processes 8 pixels at a time, with one 16-bit lane per
+// pixel and channel, so that all intermediate values fit in 16 bits.
+
+using image_simd::ChannelLoader;
+using image_simd::Div255;
+using image_simd::RgbStorer;
+using image_simd::StoreRgba;
+
+// Recolors the pixels of a row in groups of 8, and returns the number of
+// pixels recolored.
+int RecolorRowSse41(const uint8* image, int image_channels, const uint8* mask,
+                    int mask_channels, int mask_channel, const uint8 color[3],
+                    int width, uint8* output) {
+  const ChannelLoader red_loader(image_channels, 0);
+  const ChannelLoader green_loader(image_channels, 1);
+  const ChannelLoader blue_loader(image_channels, 2);
+  // Only used for RGBA images.
+  const ChannelLoader alpha_loader(image_channels, image_channels - 1);
+  const ChannelLoader mask_loader(mask_channels, mask_channel);
+  const RgbStorer rgb_storer;
+  const __m128i red_weight = _mm_set1_epi16(77);
+  const __m128i green_weight = _mm_set1_epi16(150);
+  const __m128i blue_weight = _mm_set1_epi16(29);
+  const __m128i half = _mm_set1_epi16(128);
+  const __m128i opaque = _mm_set1_epi16(255);
+  const __m128i red_color = _mm_set1_epi16(color[0]);
+  const __m128i green_color = _mm_set1_epi16(color[1]);
+  const __m128i blue_color = _mm_set1_epi16(color[2]);
+
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const uint8* pixels = image + x * image_channels;
+    const __m128i r = red_loader.Load(pixels);
+    const __m128i g = green_loader.Load(pixels);
+    const __m128i b = blue_loader.Load(pixels);
+    const __m128i m = mask_loader.Load(mask + x * mask_channels);
+
+    __m128i luminance = _mm_add_epi16(_mm_mullo_epi16(r, red_weight),
+                                      _mm_mullo_epi16(g, green_weight));
+    luminance = _mm_add_epi16(luminance, _mm_mullo_epi16(b, blue_weight));
+    luminance = _mm_srli_epi16(_mm_add_epi16(luminance, half), 8);
+    const __m128i mix = Div255(_mm_mullo_epi16(m, luminance));
+    const __m128i keep = _mm_sub_epi16(opaque, mix);
+    auto blend = [&keep, &mix](__m128i value, __m128i color) {
+      return Div255(_mm_add_epi16(_mm_mullo_epi16(value, keep),
+                                  _mm_mullo_epi16(color, mix)));
+    };
+
+    uint8* out = output + x * image_channels;
+    if (image_channels == 4) {
+      const __m128i a = alpha_loader.Load(pixels);
+      StoreRgba(blend(r, red_color), blend(g, green_color),
+                blend(b, blue_color), blend(a, opaque), out);
+    } else {
+      rgb_storer.Store(blend(r, red_color), blend(g, green_color),
+                       blend(b, blue_color), out);
+    }
+  }
+  return x;
+}
+
+#endif  // __SSE4_1__
+
+}  // namespace
+
+void RecolorRowScalar(const uint8* image, int image_channels,
+                      const uint8* mask, int mask_channels, int mask_channel,
+                      const uint8 color[3], int width, uint8* output) {
+  for (int x = 0; x < width; ++x) {
+    const uint8* pixel = image + x * image_channels;
+    uint8* out = output + x * image_channels;
+    const int mix =
+        Div255(mask[x * mask_channels + mask_channel] * Luminance(pixel));
+    const int keep = 255 - mix;
+    if (image_channels == 4) {
+      out[3] = Div255(pixel[3] * keep + 255 * mix);
+    }
+    for (int c = 0; c < 3; ++c) {
+      out[c] = Div255(pixel[c] * keep + color[c] * mix);
+    }
+  }
+}
+
+void RecolorRow(const uint8* image, int image_channels, const uint8* mask,
+                int mask_channels, int mask_channel, const uint8 color[3],
+                int width, uint8* output) {
+  int x = 0;
+#if defined(__SSE4_1__)
+  x = RecolorRowSse41(image, image_channels, mask, mask_channels,
+                      mask_channel, color, width, output);
+#endif  // __SSE4_1__
+  RecolorRowScalar(image + x * image_channels, image_channels,
+                   mask + x * mask_channels, mask_channels, mask_channel,
+                   color, width - x, output + x * image_channels);
+}
+
+}  // namespace recolor
+}  // namespace mediapipe
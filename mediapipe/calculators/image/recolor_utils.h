@@ -0,0 +1,49 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// CPU kernels for RecolorCalculator.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_RECOLOR_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_RECOLOR_UTILS_H_
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace recolor {
+
+// Recolors one row of "width" pixels, blending "color" (RGB) into the pixels
+// of "image" where the channel "mask_channel" of "mask" is non-zero.  The
+// blending weight is the mask value times the luminance of the pixel, as in
+// the GPU shader of RecolorCalculator:
+//
+//   mix = mask / 255 * dot(rgb, (0.299, 0.587, 0.114)) / 255
+//   output = image * (1 - mix) + color * mix
+//
+// "image" and "output" have "image_channels" (3 or 4) interleaved channels
+// per pixel, and the alpha channel is blended towards 255.  "mask" has
+// "mask_channels" (1, 3 or 4) channels per pixel.  The computation uses 8-bit
+// fixed point arithmetic, and is vectorized with SSE4.1 when available.
+void RecolorRow(const uint8* image, int image_channels, const uint8* mask,
+                int mask_channels, int mask_channel, const uint8 color[3],
+                int width, uint8* output);
+
+// The scalar implementation of RecolorRow(), which produces identical
+// results.  Exposed for testing and benchmarking.
+void RecolorRowScalar(const uint8* image, int image_channels,
+                      const uint8* mask, int mask_channels, int mask_channel,
+                      const uint8 color[3], int width, uint8* output);
+
+}  // namespace recolor
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_RECOLOR_UTILS_H_
@@ -0,0 +1,121 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/calculators/image/recolor_utils.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace recolor {
+namespace {
+
+const uint8 kColor[3] = {20, 140, 250};
+
+std::vector<uint8> RandomBytes(int size, std::mt19937* rng) {
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8> bytes(size);
+  for (uint8& byte : bytes) {
+    byte = distribution(*rng);
+  }
+  return bytes;
+}
+
+// The floating point blend of the GPU shader.
+uint8 ReferenceBlend(const uint8* pixel, int mask_value, int channel) {
+  const float luminance =
+      (0.299f * pixel[0] + 0.587f * pixel[1] + 0.114f * pixel[2]) / 255.0f;
+  const float mix = mask_value / 255.0f * luminance;
+  const float color = channel < 3 ? kColor[channel] : 255.0f;
+  return std::round(pixel[channel] * (1.0f - mix) + color * mix);
+}
+
+TEST(RecolorUtilsTest, MatchesScalarImplementation) {
+  std::mt19937 rng(0);
+  // The widths cover rows shorter than, equal to and longer than a vector.
+  for (int width : {1, 7, 8, 9, 16, 37, 64}) {
+    for (int image_channels : {3, 4}) {
+      for (int mask_channels : {1, 3, 4}) {
+        for (int mask_channel = 0; mask_channel < mask_channels;
+             ++mask_channel) {
+          const std::vector<uint8> image =
+              RandomBytes(width * image_channels, &rng);
+          const std::vector<uint8> mask =
+              RandomBytes(width * mask_channels, &rng);
+          std::vector<uint8> output(image.size());
+          std::vector<uint8> expected(image.size());
+          RecolorRow(image.data(), image_channels, mask.data(), mask_channels,
+                     mask_channel, kColor, width, output.data());
+          RecolorRowScalar(image.data(), image_channels, mask.data(),
+                           mask_channels, mask_channel, kColor, width,
+                           expected.data());
+          EXPECT_EQ(expected, output)
+              << "width: " << width << " image_channels: " << image_channels
+              << " mask_channels: " << mask_channels
+              << " mask_channel: " << mask_channel;
+        }
+      }
+    }
+  }
+}
+
+TEST(RecolorUtilsTest, ApproximatesShaderBlend) {
+  std::mt19937 rng(1);
+  const int kWidth = 256;
+  const std::vector<uint8> image = RandomBytes(kWidth * 4, &rng);
+  const std::vector<uint8> mask = RandomBytes(kWidth, &rng);
+  std::vector<uint8> output(image.size());
+  RecolorRowScalar(image.data(), 4, mask.data(), 1, 0, kColor, kWidth,
+                   output.data());
+  for (int x = 0; x < kWidth; ++x) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_NEAR(ReferenceBlend(&image[x * 4], mask[x], c),
+                  output[x * 4 + c], 2)
+          << "x: " << x << " channel: " << c;
+    }
+  }
+}
+
+TEST(RecolorUtilsTest, KeepsUnmaskedPixels) {
+  std::mt19937 rng(2);
+  const int kWidth = 20;
+  const std::vector<uint8> image = RandomBytes(kWidth * 3, &rng);
+  const std::vector<uint8> mask(kWidth, 0);
+  std::vector<uint8> output(image.size());
+  RecolorRow(image.data(), 3, mask.data(), 1, 0, kColor, kWidth,
+             output.data());
+  EXPECT_EQ(image, output);
+}
+
+TEST(RecolorUtilsTest, RecolorsWhitePixelsFully) {
+  const int kWidth = 10;
+  const std::vector<uint8> image(kWidth * 4, 255);
+  const std::vector<uint8> mask(kWidth * 4, 255);
+  std::vector<uint8> output(image.size());
+  RecolorRow(image.data(), 4, mask.data(), 4, 3, kColor, kWidth,
+             output.data());
+  for (int x = 0; x < kWidth; ++x) {
+    EXPECT_EQ(kColor[0], output[x * 4]);
+    EXPECT_EQ(kColor[1], output[x * 4 + 1]);
+    EXPECT_EQ(kColor[2], output[x * 4 + 2]);
+    EXPECT_EQ(255, output[x * 4 + 3]);
+  }
+}
+
+}  // namespace
+}  // namespace recolor
+}  // namespace mediapipe
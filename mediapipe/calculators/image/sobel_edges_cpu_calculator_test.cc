@@ -0,0 +1,123 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/image/sobel_edges_cpu_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+namespace {
+
+Packet MakeImage(ImageFormat::Format format, int width, int height) {
+  auto image = absl::make_unique<ImageFrame>(format, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < width * image->NumberOfChannels(); ++x) {
+      row[x] = (x * x * 7 + y * 29) % 256;
+    }
+  }
+  return Adopt(image.release()).At(Timestamp(0));
+}
+
+// Runs "node" on "input" and returns the output image.
+::mediapipe::StatusOr<Packet> RunNode(const CalculatorGraphConfig::Node& node,
+                                      const Packet& input) {
+  CalculatorRunner runner(node);
+  runner.MutableInputs()->Index(0).packets.push_back(input);
+  MP_RETURN_IF_ERROR(runner.Run());
+  RET_CHECK_EQ(1, runner.Outputs().Index(0).packets.size());
+  return runner.Outputs().Index(0).packets[0];
+}
+
+CalculatorGraphConfig::Node SobelNode(bool compute_luminance,
+                                      int num_threads) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+      R"(
+        calculator: "SobelEdgesCpuCalculator"
+        input_stream: "input_video"
+        output_stream: "output_video"
+        options {
+          [mediapipe.SobelEdgesCpuCalculatorOptions.ext] {
+            compute_luminance: $0
+            num_threads: $1
+          }
+        })",
+      compute_luminance ? "true" : "false", num_threads));
+}
+
+bool SameImage(const ImageFrame& a, const ImageFrame& b) {
+  if (a.Format() != b.Format() || a.Width() != b.Width() ||
+      a.Height() != b.Height()) {
+    return false;
+  }
+  const int row_size = a.Width() * a.ByteDepth() * a.NumberOfChannels();
+  for (int y = 0; y < a.Height(); ++y) {
+    if (std::memcmp(a.PixelData() + y * a.WidthStep(),
+                    b.PixelData() + y * b.WidthStep(), row_size) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(SobelEdgesCpuCalculatorTest, FusedLuminanceMatchesLuminanceCalculator) {
+  const Packet input = MakeImage(ImageFormat::SRGBA, 45, 17);
+  auto luminance = RunNode(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+                             calculator: "LuminanceCpuCalculator"
+                             input_stream: "input_video"
+                             output_stream: "luma_video"
+                           )"),
+                           input);
+  MP_ASSERT_OK(luminance);
+  auto separate = RunNode(SobelNode(false, 1), luminance.ValueOrDie());
+  MP_ASSERT_OK(separate);
+  const ImageFrame& expected = separate.ValueOrDie().Get<ImageFrame>();
+  EXPECT_EQ(ImageFormat::SRGBA, expected.Format());
+
+  for (int num_threads : {1, 3}) {
+    auto fused = RunNode(SobelNode(true, num_threads), input);
+    MP_ASSERT_OK(fused);
+    EXPECT_TRUE(SameImage(expected, fused.ValueOrDie().Get<ImageFrame>()))
+        << "num_threads: " << num_threads;
+  }
+}
+
+TEST(SobelEdgesCpuCalculatorTest, FiltersGrayImages) {
+  const Packet input = MakeImage(ImageFormat::GRAY8, 20, 6);
+  auto output = RunNode(SobelNode(false, 2), input);
+  MP_ASSERT_OK(output);
+  EXPECT_EQ(ImageFormat::GRAY8,
+            output.ValueOrDie().Get<ImageFrame>().Format());
+}
+
+TEST(SobelEdgesCpuCalculatorTest, RejectsLuminanceOfGrayImages) {
+  const Packet input = MakeImage(ImageFormat::GRAY8, 20, 6);
+  EXPECT_FALSE(RunNode(SobelNode(true, 1), input).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
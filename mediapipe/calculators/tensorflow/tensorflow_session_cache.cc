@@ -0,0 +1,52 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensorflow/tensorflow_session_cache.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+const GraphService<TensorFlowSessionCache> kTensorFlowSessionCacheService(
+    "kTensorFlowSessionCacheService");
+
+::mediapipe::StatusOr<Packet> TensorFlowSessionCache::GetSession(
+    const std::string& key, const SessionFactory& create) {
+  absl::MutexLock lock(&mutex_);
+  std::weak_ptr<TensorFlowSession>& cached = sessions_[key];
+  std::shared_ptr<TensorFlowSession> session = cached.lock();
+  if (!session) {
+    ASSIGN_OR_RETURN(std::unique_ptr<TensorFlowSession> created, create());
+    RET_CHECK(created && created->session);
+    session = std::move(created);
+    cached = session;
+  }
+  // The packet and its copies keep the session alive.
+  return PointToForeign(session.get(),
+                        [session]() mutable { session.reset(); });
+}
+
+int TensorFlowSessionCache::NumSessions() {
+  absl::MutexLock lock(&mutex_);
+  int count = 0;
+  for (const auto& entry : sessions_) {
+    count += !entry.second.expired();
+  }
+  return count;
+}
+
+}  // namespace mediapipe
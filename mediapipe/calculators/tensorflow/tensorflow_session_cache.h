@@ -0,0 +1,69 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_TENSORFLOW_CALCULATORS_TENSORFLOW_SESSION_CACHE_H_
+#define MEDIAPIPE_TENSORFLOW_CALCULATORS_TENSORFLOW_SESSION_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensorflow/tensorflow_session.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// Shares TensorFlow sessions between the graphs of a process.
+//
+// A session is created once for all the graphs asking for the same key, and
+// is destroyed when the last packet holding it is.  Since
+// tensorflow::Session::Run() is thread-safe, the graphs can run the shared
+// session concurrently.
+//
+// The cache is thread-safe.  It is available to
+// TensorFlowSessionFromFrozenGraphCalculator as a graph service, e.g.:
+//   auto cache = std::make_shared<TensorFlowSessionCache>();
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(kTensorFlowSessionCacheService,
+//                                             cache));
+class TensorFlowSessionCache {
+ public:
+  using SessionFactory = std::function<
+      ::mediapipe::StatusOr<std::unique_ptr<TensorFlowSession>>()>;
+
+  // Returns a packet holding the session for "key", and creates the session
+  // with "create" if no packet holds it.  Sessions are created one at a time,
+  // so that concurrent callers with the same key share one session.
+  ::mediapipe::StatusOr<Packet> GetSession(const std::string& key,
+                                           const SessionFactory& create);
+
+  // Returns the number of sessions held by packets.
+  int NumSessions();
+
+ private:
+  absl::Mutex mutex_;
+  std::map<std::string, std::weak_ptr<TensorFlowSession>> sessions_
+      GUARDED_BY(mutex_);
+};
+
+extern const GraphService<TensorFlowSessionCache>
+    kTensorFlowSessionCacheService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TENSORFLOW_CALCULATORS_TENSORFLOW_SESSION_CACHE_H_
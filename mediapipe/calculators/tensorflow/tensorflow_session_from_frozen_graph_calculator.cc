@@ -20,24 +20,25 @@
 // typically provided by EmbeddingFilePacketFactory.
 //
 // Produces a SessionBundle that TensorFlowInferenceCalculator can use.
+//
+// If the graph provides kTensorFlowSessionCacheService, a model loaded from a
+// path is shared with the other graphs using the same cache, path and options,
+// rather than loaded again by each graph.
 
+#include <memory>
 #include <string>
 
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
+#include "mediapipe/calculators/tensorflow/tensorflow_session_cache.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session_from_frozen_graph_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/advanced_proto_lite_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/resource_mapping.h"
 #include "tensorflow/core/public/session_options.h"
 
-#if defined(MEDIAPIPE_LITE) || defined(__ANDROID__) || \
-    defined(__APPLE__) && !TARGET_OS_OSX
-#include "mediapipe/util/android/file/base/helpers.h"
-#else
-#include "mediapipe/framework/port/file_helpers.h"
-#endif
-
 namespace mediapipe {
 
 namespace tf = ::tensorflow;
@@ -74,13 +75,62 @@ class TensorFlowSessionFromFrozenGraphCalculator : public CalculatorBase {
         // a map from tags to tensor names.
     );
     RET_CHECK_GT(options.tag_to_tensor_names().size(), 0);
+    cc->UseService(kTensorFlowSessionCacheService).Optional();
     return ::mediapipe::OkStatus();
   }
 
   ::mediapipe::Status Open(CalculatorContext* cc) override {
+    if (cc->Service(kTensorFlowSessionCacheService).IsAvailable() &&
+        !cc->InputSidePackets().HasTag("STRING_MODEL")) {
+      TensorFlowSessionCache& cache =
+          cc->Service(kTensorFlowSessionCacheService).GetObject();
+      ASSIGN_OR_RETURN(Packet session,
+                       cache.GetSession(CacheKey(cc),
+                                        [cc]() { return CreateSession(cc); }));
+      cc->OutputSidePackets().Tag("SESSION").Set(session);
+      return ::mediapipe::OkStatus();
+    }
+    ASSIGN_OR_RETURN(std::unique_ptr<TensorFlowSession> session,
+                     CreateSession(cc));
+    cc->OutputSidePackets().Tag("SESSION").Set(Adopt(session.release()));
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    return ::mediapipe::OkStatus();
+  }
+
+ private:
+  // Returns the path of the model to load.
+  static const std::string& ModelPath(CalculatorContext* cc) {
+    const auto& options =
+        cc->Options<TensorFlowSessionFromFrozenGraphCalculatorOptions>();
+    return cc->InputSidePackets().HasTag("STRING_MODEL_FILE_PATH")
+               ? cc->InputSidePackets()
+                     .Tag("STRING_MODEL_FILE_PATH")
+                     .Get<std::string>()
+               : options.graph_proto_path();
+  }
+
+  // Returns the key of the session in the cache: the model path and the
+  // options, which determine the session config and initialization.
+  static std::string CacheKey(CalculatorContext* cc) {
+    std::string key = ModelPath(cc);
+    key.push_back('\0');
+    {
+      proto_ns::io::StringOutputStream stream(&key);
+      proto_ns::io::CodedOutputStream coded(&stream);
+      coded.SetSerializationDeterministic(true);
+      cc->Options<TensorFlowSessionFromFrozenGraphCalculatorOptions>()
+          .SerializeToCodedStream(&coded);
+    }
+    return key;
+  }
+
+  static ::mediapipe::StatusOr<std::unique_ptr<TensorFlowSession>>
+  CreateSession(CalculatorContext* cc) {
     const auto& options =
         cc->Options<TensorFlowSessionFromFrozenGraphCalculatorOptions>();
-    // Output bundle packet.
     auto session = ::absl::make_unique<TensorFlowSession>();
 
     tf::SessionOptions session_options;
@@ -92,23 +142,18 @@ class TensorFlowSessionFromFrozenGraphCalculator : public CalculatorBase {
     }
     session->session.reset(tf::NewSession(session_options));
 
-    std::string graph_def_serialized;
+    tensorflow::GraphDef graph_def;
     if (cc->InputSidePackets().HasTag("STRING_MODEL")) {
-      graph_def_serialized =
-          cc->InputSidePackets().Tag("STRING_MODEL").Get<std::string>();
-    } else if (cc->InputSidePackets().HasTag("STRING_MODEL_FILE_PATH")) {
-      const std::string& frozen_graph = cc->InputSidePackets()
-                                            .Tag("STRING_MODEL_FILE_PATH")
-                                            .Get<std::string>();
-      RET_CHECK_OK(
-          mediapipe::file::GetContents(frozen_graph, &graph_def_serialized));
+      RET_CHECK(graph_def.ParseFromString(
+          cc->InputSidePackets().Tag("STRING_MODEL").Get<std::string>()));
     } else {
-      RET_CHECK_OK(mediapipe::file::GetContents(options.graph_proto_path(),
-                                                &graph_def_serialized));
+      // The graph is parsed from the mapped file, rather than from a copy of
+      // the file on the heap.
+      ASSIGN_OR_RETURN(std::shared_ptr<const MappedResource> graph_file,
+                       MapResource(ModelPath(cc)));
+      RET_CHECK(graph_def.ParseFromArray(graph_file->data(),
+                                         graph_file->size()));
     }
-    tensorflow::GraphDef graph_def;
-
-    RET_CHECK(graph_def.ParseFromString(graph_def_serialized));
     const tf::Status tf_status = session->session->Create(graph_def);
     RET_CHECK(tf_status.ok()) << "Create failed: " << tf_status.error_message();
 
@@ -122,13 +167,7 @@ class TensorFlowSessionFromFrozenGraphCalculator : public CalculatorBase {
       // informative error message.
       RET_CHECK(tf_status.ok()) << "Run failed: " << tf_status.error_message();
     }
-
-    cc->OutputSidePackets().Tag("SESSION").Set(Adopt(session.release()));
-    return ::mediapipe::OkStatus();
-  }
-
-  ::mediapipe::Status Process(CalculatorContext* cc) override {
-    return ::mediapipe::OkStatus();
+    return std::move(session);
   }
 };
 REGISTER_CALCULATOR(TensorFlowSessionFromFrozenGraphCalculator);
@@ -14,6 +14,7 @@
 
 #include "absl/strings/substitute.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
+#include "mediapipe/calculators/tensorflow/tensorflow_session_cache.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session_from_frozen_graph_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
@@ -312,5 +313,42 @@ TEST_F(TensorFlowSessionFromFrozenGraphCalculatorTest,
   VerifySignatureMap(session);
 }
 
+TEST_F(TensorFlowSessionFromFrozenGraphCalculatorTest,
+       SharesSessionThroughCacheService) {
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+          absl::Substitute(R"(
+      node {
+        calculator: "TensorFlowSessionFromFrozenGraphCalculator"
+        output_side_packet: "SESSION:session"
+        options {
+          [mediapipe.TensorFlowSessionFromFrozenGraphCalculatorOptions.ext]: {
+            $0
+          }
+        }
+      }
+  )",
+                           calculator_options_->DebugString()));
+  auto cache = std::make_shared<TensorFlowSessionCache>();
+  std::vector<Packet> sessions;
+  for (int i = 0; i < 2; ++i) {
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.Initialize(config));
+    MP_ASSERT_OK(graph.SetServiceObject(kTensorFlowSessionCacheService, cache));
+    MP_ASSERT_OK(graph.Run());
+    auto status_or_session = graph.GetOutputSidePacket("session");
+    MP_ASSERT_OK(status_or_session.status());
+    sessions.push_back(status_or_session.ValueOrDie());
+    VerifySignatureMap(sessions.back().Get<TensorFlowSession>());
+  }
+  EXPECT_EQ(&sessions[0].Get<TensorFlowSession>(),
+            &sessions[1].Get<TensorFlowSession>());
+  EXPECT_EQ(cache->NumSessions(), 1);
+
+  // The session is released with the last packet holding it.
+  sessions.clear();
+  EXPECT_EQ(cache->NumSessions(), 0);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -22,15 +22,16 @@
 // See tensorflow_session_bundle_from_graph_generator.proto for options.
 // Produces a SessionBundle that TensorFlowInferenceCalculator can use.
 
+#include <memory>
 #include <string>
 
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session_from_frozen_graph_generator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
-#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/resource_mapping.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace mediapipe {
@@ -92,22 +93,23 @@ class TensorFlowSessionFromFrozenGraphGenerator : public PacketGenerator {
     }
     session->session.reset(tf::NewSession(session_options));
 
-    std::string graph_def_serialized;
+    tensorflow::GraphDef graph_def;
     if (input_side_packets.HasTag("STRING_MODEL")) {
-      graph_def_serialized =
-          input_side_packets.Tag("STRING_MODEL").Get<std::string>();
-    } else if (input_side_packets.HasTag("STRING_MODEL_FILE_PATH")) {
-      const std::string& frozen_graph =
-          input_side_packets.Tag("STRING_MODEL_FILE_PATH").Get<std::string>();
-      RET_CHECK_OK(
-          mediapipe::file::GetContents(frozen_graph, &graph_def_serialized));
+      RET_CHECK(graph_def.ParseFromString(
+          input_side_packets.Tag("STRING_MODEL").Get<std::string>()));
     } else {
-      RET_CHECK_OK(mediapipe::file::GetContents(options.graph_proto_path(),
-                                                &graph_def_serialized));
+      const std::string& frozen_graph =
+          input_side_packets.HasTag("STRING_MODEL_FILE_PATH")
+              ? input_side_packets.Tag("STRING_MODEL_FILE_PATH")
+                    .Get<std::string>()
+              : options.graph_proto_path();
+      // The graph is parsed from the mapped file, rather than from a copy of
+      // the file on the heap.
+      ASSIGN_OR_RETURN(std::shared_ptr<const MappedResource> graph_file,
+                       MapResource(frozen_graph));
+      RET_CHECK(graph_def.ParseFromArray(graph_file->data(),
+                                         graph_file->size()));
     }
-    tensorflow::GraphDef graph_def;
-
-    RET_CHECK(graph_def.ParseFromString(graph_def_serialized));
     const tf::Status tf_status = session->session->Create(graph_def);
     RET_CHECK(tf_status.ok()) << "Create failed: " << tf_status.error_message();
 
@@ -0,0 +1,402 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tflite/image_to_tensor_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mediapipe/framework/port/logging.h"
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif  // __SSE4_1__
+
+namespace mediapipe {
+namespace image_to_tensor {
+
+namespace {
+
+// The rectangle covered by the rotated and scaled image in the tensor, in
+// tensor pixels.
+struct ContentRect {
+  double left;
+  double top;
+  double width;
+  double height;
+};
+
+int NormalizedRotation(int rotation_degrees) {
+  return (rotation_degrees % 360 + 360) % 360;
+}
+
+ContentRect ComputeContentRect(const Transform& transform, int image_width,
+                               int image_height) {
+  const int rotation = NormalizedRotation(transform.rotation_degrees);
+  if (rotation == 90 || rotation == 270) {
+    std::swap(image_width, image_height);
+  }
+  double scale_x =
+      static_cast<double>(transform.output_width) / image_width;
+  double scale_y =
+      static_cast<double>(transform.output_height) / image_height;
+  if (transform.scale_mode == ScaleMode::FIT) {
+    scale_x = scale_y = std::min(scale_x, scale_y);
+  } else if (transform.scale_mode == ScaleMode::FILL_AND_CROP) {
+    scale_x = scale_y = std::max(scale_x, scale_y);
+  }
+  ContentRect rect;
+  rect.width = image_width * scale_x;
+  rect.height = image_height * scale_y;
+  rect.left = (transform.output_width - rect.width) / 2;
+  rect.top = (transform.output_height - rect.height) / 2;
+  return rect;
+}
+
+// Returns the tap of a linear interpolation at "coordinate" along "size"
+// pixels which are "stride" bytes apart, where pixel i is centered at
+// i + 0.5.  Pixels beyond the edges are replicated.
+template <typename Tap>
+Tap MakeTap(double coordinate, int size, int stride) {
+  const double position = coordinate - 0.5;
+  const double index = std::floor(position);
+  const int index0 = std::min(std::max(static_cast<int>(index), 0), size - 1);
+  const int index1 =
+      std::min(std::max(static_cast<int>(index) + 1, 0), size - 1);
+  return {index0 * stride, index1 * stride,
+          static_cast<float>(position - index)};
+}
+
+// Fills "taps" with the taps of "num_taps" tensor pixels along one axis of
+// the tensor, covered by the image within [start, start + length), which
+// maps to "size" pixels, "stride" bytes apart, along one axis of the image.
+// Returns the range of the tensor pixels covered by the image in "begin" and
+// "end".
+template <typename Tap>
+void MakeTaps(int num_taps, bool flip, double start, double length,
+              int size, int stride, bool reverse, std::vector<Tap>* taps,
+              int* begin, int* end) {
+  taps->resize(num_taps);
+  *begin = num_taps;
+  *end = 0;
+  for (int i = 0; i < num_taps; ++i) {
+    const int position = flip ? num_taps - 1 - i : i;
+    double coordinate = (position + 0.5 - start) / length * size;
+    if (coordinate < 0 || coordinate >= size) {
+      continue;
+    }
+    if (reverse) {
+      coordinate = size - coordinate;
+    }
+    (*taps)[i] = MakeTap<Tap>(coordinate, size, stride);
+    *begin = std::min(*begin, i);
+    *end = i + 1;
+  }
+  if (*begin >= *end) {
+    *begin = *end = 0;
+  }
+}
+
+// Writes the channels of interpolated pixels as float values.
+struct FloatOutput {
+  typedef float Type;
+
+  float Pad() const { return offset; }
+
+  template <int kChannels>
+  void Store(const float* value, float* output) const {
+    for (int c = 0; c < kChannels; ++c) {
+      output[c] = value[c] * scale + offset;
+    }
+  }
+
+#if defined(__SSE4_1__)
+  template <int kChannels>
+  void Store(__m128 value, float* output) const {
+    value = _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(scale)),
+                       _mm_set1_ps(offset));
+    if (kChannels == 4) {
+      _mm_storeu_ps(output, value);
+    } else if (kChannels == 3) {
+      _mm_storel_pi(reinterpret_cast<__m64*>(output), value);
+      _mm_store_ss(output + 2, _mm_movehl_ps(value, value));
+    } else {
+      _mm_store_ss(output, value);
+    }
+  }
+#endif  // __SSE4_1__
+
+  float scale;
+  float offset;
+};
+
+// Writes the channels of interpolated pixels rounded to bytes.
+struct ByteOutput {
+  typedef uint8 Type;
+
+  uint8 Pad() const { return 0; }
+
+  template <int kChannels>
+  void Store(const float* value, uint8* output) const {
+    for (int c = 0; c < kChannels; ++c) {
+      output[c] = static_cast<uint8>(value[c] + 0.5f);
+    }
+  }
+
+#if defined(__SSE4_1__)
+  template <int kChannels>
+  void Store(__m128 value, uint8* output) const {
+    __m128i bytes = _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+    bytes = _mm_packus_epi32(bytes, bytes);
+    bytes = _mm_packus_epi16(bytes, bytes);
+    const int32 pixel = _mm_cvtsi128_si32(bytes);
+    std::memcpy(output, &pixel, kChannels);
+  }
+#endif  // __SSE4_1__
+};
+
+#if defined(__SSE4_1__)
+
+// Loads the channels of a pixel into the 32-bit float lanes of a vector.
+// The bytes of 3-channel pixels are combined in a register rather than
+// copied, which would stall the load of the vector.
+template <int kChannels>
+inline __m128 LoadPixel(const uint8* pixel) {
+  int32 bytes;
+  if (kChannels == 4) {
+    std::memcpy(&bytes, pixel, 4);
+  } else if (kChannels == 3) {
+    bytes = pixel[0] | pixel[1] << 8 | pixel[2] << 16;
+  } else {
+    bytes = pixel[0];
+  }
+  return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes)));
+}
+
+inline __m128 Lerp(__m128 a, __m128 b, __m128 weight) {
+  return _mm_add_ps(a, _mm_mul_ps(weight, _mm_sub_ps(b, a)));
+}
+
+#endif  // __SSE4_1__
+
+inline float Lerp(float a, float b, float weight) {
+  return a + weight * (b - a);
+}
+
+#if defined(__SSE4_1__)
+
+// Normalizes the lowest 4 bytes of "bytes" into 4 floats.
+inline void StoreNormalized(__m128i bytes, __m128 scale, __m128 offset,
+                            float* output) {
+  const __m128 values = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes));
+  _mm_storeu_ps(output, _mm_add_ps(_mm_mul_ps(values, scale), offset));
+}
+
+// Normalizes 16 bytes into 16 floats.
+inline void StoreNormalized16(__m128i bytes, __m128 scale, __m128 offset,
+                              float* output) {
+  StoreNormalized(bytes, scale, offset, output);
+  StoreNormalized(_mm_srli_si128(bytes, 4), scale, offset, output + 4);
+  StoreNormalized(_mm_srli_si128(bytes, 8), scale, offset, output + 8);
+  StoreNormalized(_mm_srli_si128(bytes, 12), scale, offset, output + 12);
+}
+
+#endif  // __SSE4_1__
+
+}  // namespace
+
+std::array<float, 4> LetterboxPadding(const Transform& transform,
+                                      int image_width, int image_height) {
+  std::array<float, 4> padding = {0.f, 0.f, 0.f, 0.f};
+  if (transform.scale_mode != ScaleMode::FIT) {
+    return padding;
+  }
+  const ContentRect rect =
+      ComputeContentRect(transform, image_width, image_height);
+  padding[0] = padding[2] = std::max(rect.left / transform.output_width, 0.0);
+  padding[1] = padding[3] = std::max(rect.top / transform.output_height, 0.0);
+  return padding;
+}
+
+void Sampler::Prepare(const ImageView& image) {
+  if (image.width == width_ && image.height == height_ &&
+      image.channels == channels_ && image.step == step_) {
+    return;
+  }
+  width_ = image.width;
+  height_ = image.height;
+  channels_ = image.channels;
+  step_ = image.step;
+
+  const int rotation = NormalizedRotation(transform_.rotation_degrees);
+  CHECK_EQ(rotation % 90, 0);
+  const ContentRect rect =
+      ComputeContentRect(transform_, image.width, image.height);
+  // The tensor columns run along the lines, which are the image rows unless
+  // the image is rotated by 90 or 270 degrees.  The rotation is a reversal
+  // of the tensor columns, rows, or both, relative to the image.
+  const bool transpose = rotation == 90 || rotation == 270;
+  const int line_size = transpose ? image.height : image.width;
+  const int line_stride = transpose ? image.step : image.channels;
+  const int num_lines = transpose ? image.width : image.height;
+  const int lines_stride = transpose ? image.channels : image.step;
+  MakeTaps(transform_.output_width, transform_.flip_horizontally, rect.left,
+           rect.width, line_size, line_stride,
+           /*reverse=*/rotation == 180 || rotation == 270, &column_taps_,
+           &column_begin_, &column_end_);
+  MakeTaps(transform_.output_height, transform_.flip_vertically, rect.top,
+           rect.height, num_lines, lines_stride,
+           /*reverse=*/rotation == 90 || rotation == 180, &row_taps_,
+           &row_begin_, &row_end_);
+}
+
+template <bool kSimd, int kInChannels, int kOutChannels, typename Output>
+void Sampler::SampleRows(const ImageView& image, const Output& output,
+                         typename Output::Type* tensor) const {
+  const int width = transform_.output_width;
+  const int row_size = width * kOutChannels;
+  const typename Output::Type pad = output.Pad();
+  for (int y = 0; y < transform_.output_height; ++y) {
+    typename Output::Type* row = tensor + y * row_size;
+    if (y < row_begin_ || y >= row_end_) {
+      std::fill(row, row + row_size, pad);
+      continue;
+    }
+    const Tap& row_tap = row_taps_[y];
+    const uint8* line0 = image.data + row_tap.offset0;
+    const uint8* line1 = image.data + row_tap.offset1;
+    std::fill(row, row + column_begin_ * kOutChannels, pad);
+    int x = column_begin_;
+#if defined(__SSE4_1__)
+    if (kSimd) {
+      const __m128 row_weight = _mm_set1_ps(row_tap.weight);
+      for (; x < column_end_; ++x) {
+        const Tap& tap = column_taps_[x];
+        const __m128 weight = _mm_set1_ps(tap.weight);
+        const __m128 top =
+            Lerp(LoadPixel<kInChannels>(line0 + tap.offset0),
+                 LoadPixel<kInChannels>(line0 + tap.offset1), weight);
+        const __m128 bottom =
+            Lerp(LoadPixel<kInChannels>(line1 + tap.offset0),
+                 LoadPixel<kInChannels>(line1 + tap.offset1), weight);
+        output.template Store<kOutChannels>(Lerp(top, bottom, row_weight),
+                                            row + x * kOutChannels);
+      }
+    }
+#endif  // __SSE4_1__
+    for (; x < column_end_; ++x) {
+      const Tap& tap = column_taps_[x];
+      float value[kOutChannels];
+      for (int c = 0; c < kOutChannels; ++c) {
+        const float top = Lerp(line0[tap.offset0 + c],
+                               line0[tap.offset1 + c], tap.weight);
+        const float bottom = Lerp(line1[tap.offset0 + c],
+                                  line1[tap.offset1 + c], tap.weight);
+        value[c] = Lerp(top, bottom, row_tap.weight);
+      }
+      output.template Store<kOutChannels>(value, row + x * kOutChannels);
+    }
+    std::fill(row + column_end_ * kOutChannels, row + row_size, pad);
+  }
+}
+
+template <typename Output>
+void Sampler::Sample(const ImageView& image, int channels, bool simd,
+                     const Output& output, typename Output::Type* tensor) {
+  CHECK(image.channels == 1 ? channels == 1
+                            : channels == 3 || channels == 4);
+  CHECK_LE(channels, image.channels);
+  Prepare(image);
+  if (image.channels == 1) {
+    simd ? SampleRows<true, 1, 1>(image, output, tensor)
+         : SampleRows<false, 1, 1>(image, output, tensor);
+  } else if (image.channels == 3) {
+    simd ? SampleRows<true, 3, 3>(image, output, tensor)
+         : SampleRows<false, 3, 3>(image, output, tensor);
+  } else if (channels == 3) {
+    simd ? SampleRows<true, 4, 3>(image, output, tensor)
+         : SampleRows<false, 4, 3>(image, output, tensor);
+  } else {
+    simd ? SampleRows<true, 4, 4>(image, output, tensor)
+         : SampleRows<false, 4, 4>(image, output, tensor);
+  }
+}
+
+void Sampler::ToFloat(const ImageView& image, int channels, float scale,
+                      float offset, float* tensor) {
+  Sample(image, channels, /*simd=*/true, FloatOutput{scale, offset}, tensor);
+}
+
+void Sampler::ToUint8(const ImageView& image, int channels, uint8* tensor) {
+  Sample(image, channels, /*simd=*/true, ByteOutput(), tensor);
+}
+
+void Sampler::ToFloatScalar(const ImageView& image, int channels, float scale,
+                            float offset, float* tensor) {
+  Sample(image, channels, /*simd=*/false, FloatOutput{scale, offset}, tensor);
+}
+
+void Sampler::ToUint8Scalar(const ImageView& image, int channels,
+                            uint8* tensor) {
+  Sample(image, channels, /*simd=*/false, ByteOutput(), tensor);
+}
+
+void NormalizeRow(const uint8* row, int channels, int out_channels, int width,
+                  float scale, float offset, float* output) {
+  int x = 0;
+#if defined(__SSE4_1__)
+  const __m128 scales = _mm_set1_ps(scale);
+  const __m128 offsets = _mm_set1_ps(offset);
+  if (channels == out_channels) {
+    // All channels are kept, so the row is normalized as a row of bytes.
+    const int size = width * channels;
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+      StoreNormalized16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)), scales,
+          offsets, output + i);
+    }
+    NormalizeRowScalar(row + i, 1, 1, size - i, scale, offset, output + i);
+    return;
+  }
+  // The alpha channel of 4 pixels is dropped, leaving 12 bytes.
+  const __m128i drop_alpha =
+      _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  for (; x + 4 <= width; x += 4) {
+    const __m128i bytes = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4)),
+        drop_alpha);
+    float* out = output + x * 3;
+    StoreNormalized(bytes, scales, offsets, out);
+    StoreNormalized(_mm_srli_si128(bytes, 4), scales, offsets, out + 4);
+    StoreNormalized(_mm_srli_si128(bytes, 8), scales, offsets, out + 8);
+  }
+#endif  // __SSE4_1__
+  NormalizeRowScalar(row + x * channels, channels, out_channels, width - x,
+                     scale, offset, output + x * out_channels);
+}
+
+void NormalizeRowScalar(const uint8* row, int channels, int out_channels,
+                        int width, float scale, float offset, float* output) {
+  for (int x = 0; x < width; ++x) {
+    for (int c = 0; c < out_channels; ++c) {
+      *output++ = row[c] * scale + offset;
+    }
+    row += channels;
+  }
+}
+
+}  // namespace image_to_tensor
+}  // namespace mediapipe
@@ -0,0 +1,144 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// CPU kernels for TfLiteImageToTensorCalculator and
+// TfLiteConverterCalculator.
+#ifndef MEDIAPIPE_CALCULATORS_TFLITE_IMAGE_TO_TENSOR_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TFLITE_IMAGE_TO_TENSOR_UTILS_H_
+
+#include <array>
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/gpu/scale_mode.pb.h"
+
+namespace mediapipe {
+namespace image_to_tensor {
+
+// An image with "channels" (1, 3 or 4) interleaved 8-bit channels per pixel,
+// whose rows are "step" bytes apart.
+struct ImageView {
+  const uint8* data;
+  int step;
+  int channels;
+  int width;
+  int height;
+};
+
+// Describes how an image is mapped into a tensor, as in
+// ImageTransformationCalculator: the image is rotated counterclockwise by
+// "rotation_degrees", a multiple of 90, scaled to "output_width" x
+// "output_height" according to "scale_mode", and flipped.
+struct Transform {
+  int output_width = 0;
+  int output_height = 0;
+  int rotation_degrees = 0;
+  ScaleMode::Mode scale_mode = ScaleMode::STRETCH;
+  bool flip_horizontally = false;
+  bool flip_vertically = false;
+};
+
+// Returns the letterbox padding of the tensor of an image of the given size,
+// as [left, top, right, bottom] normalized by the output dimensions.  The
+// padding is non-zero only for the FIT scale mode.
+std::array<float, 4> LetterboxPadding(const Transform& transform,
+                                      int image_width, int image_height);
+
+// Samples images directly into tensors of output_height x output_width x
+// channels values, bilinearly interpolating each tensor value from the four
+// nearest pixels of the image.  The letterbox of the FIT scale mode is filled
+// with black.  The interpolation tables are computed for the first image and
+// reused for the following images of the same size.
+//
+// The kernels are vectorized with SSE4.1 when available, with one 32-bit
+// lane per channel.
+class Sampler {
+ public:
+  explicit Sampler(const Transform& transform) : transform_(transform) {}
+
+  // Writes "channels" (1 for 1-channel images, otherwise 3 or 4) channels of
+  // each pixel as pixel * scale + offset.
+  void ToFloat(const ImageView& image, int channels, float scale, float offset,
+               float* tensor);
+
+  // Writes "channels" channels of each pixel, rounded to the nearest integer.
+  void ToUint8(const ImageView& image, int channels, uint8* tensor);
+
+  // The scalar implementations of ToFloat() and ToUint8(), which produce
+  // the same results.  Exposed for testing and benchmarking.
+  void ToFloatScalar(const ImageView& image, int channels, float scale,
+                     float offset, float* tensor);
+  void ToUint8Scalar(const ImageView& image, int channels, uint8* tensor);
+
+ private:
+  // The two pixels, as byte offsets, and the weight of the second one, of a
+  // linear interpolation.
+  struct Tap {
+    int offset0;
+    int offset1;
+    float weight;
+  };
+
+  // Computes the interpolation tables for images of the size of "image".
+  void Prepare(const ImageView& image);
+
+  template <typename Output>
+  void Sample(const ImageView& image, int channels, bool simd,
+              const Output& output, typename Output::Type* tensor);
+  template <bool kSimd, int kInChannels, int kOutChannels, typename Output>
+  void SampleRows(const ImageView& image, const Output& output,
+                  typename Output::Type* tensor) const;
+
+  const Transform transform_;
+
+  // The geometry of the images for which the tables were computed.
+  int width_ = -1;
+  int height_ = -1;
+  int channels_ = -1;
+  int step_ = -1;
+
+  // The image is interpolated between two lines for each tensor row, and
+  // between two pixels of these lines for each tensor column.  The lines are
+  // the rows of the image, or its columns when it is rotated by 90 or 270
+  // degrees.
+  std::vector<Tap> row_taps_;
+  std::vector<Tap> column_taps_;
+  // The tensor rows and columns covered by the image, outside of which the
+  // tensor is letterboxed.
+  int row_begin_ = 0;
+  int row_end_ = 0;
+  int column_begin_ = 0;
+  int column_end_ = 0;
+};
+
+// Writes "width" pixels of a row with "channels" (1, 3 or 4) interleaved
+// channels per pixel as "out_channels" float values per pixel:
+//
+//   output = pixel * scale + offset
+//
+// "out_channels" is either "channels", or 3 for 4-channel rows, whose alpha
+// channel is then dropped.  The conversion is vectorized with SSE4.1 when
+// available.
+void NormalizeRow(const uint8* row, int channels, int out_channels, int width,
+                  float scale, float offset, float* output);
+
+// The scalar implementation of NormalizeRow(), which produces identical
+// results.  Exposed for testing and benchmarking.
+void NormalizeRowScalar(const uint8* row, int channels, int out_channels,
+                        int width, float scale, float offset, float* output);
+
+}  // namespace image_to_tensor
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TFLITE_IMAGE_TO_TENSOR_UTILS_H_
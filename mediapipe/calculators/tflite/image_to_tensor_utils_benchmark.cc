@@ -0,0 +1,109 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks the CPU kernels of TfLiteImageToTensorCalculator, on a 640x480
+// RGB frame letterboxed into a 128x128 tensor, and of
+// TfLiteConverterCalculator, on a 640x480 frame, e.g.:
+//   bazel run -c opt --copt=-msse4.1 \
+//       //mediapipe/calculators/tflite:image_to_tensor_utils_benchmark -- \
+//       --benchmark_format=console
+
+#include <algorithm>
+#include <vector>
+
+#include "mediapipe/calculators/tflite/image_to_tensor_utils.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace image_to_tensor {
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+constexpr int kTensorSize = 128;
+
+// Samples the frame into a float tensor normalized to [-1, 1], rotated by
+// state.range(0) degrees.  The unfused variant first samples the frame into
+// an RGB image, as ImageTransformationCalculator, and then normalizes it, as
+// TfLiteConverterCalculator.
+template <bool kFused, bool kSimd>
+void BM_ImageToTensor(benchmark::State& state) {
+  std::vector<uint8> image(kWidth * kHeight * 3);
+  for (int i = 0; i < image.size(); ++i) {
+    image[i] = i * 7;
+  }
+  const ImageView view = {image.data(), kWidth * 3, 3, kWidth, kHeight};
+  Transform transform;
+  transform.output_width = kTensorSize;
+  transform.output_height = kTensorSize;
+  transform.rotation_degrees = state.range(0);
+  transform.scale_mode = ScaleMode::FIT;
+  Sampler sampler(transform);
+  std::vector<uint8> transformed(kTensorSize * kTensorSize * 3);
+  std::vector<float> tensor(transformed.size());
+  for (auto _ : state) {
+    if (kFused) {
+      if (kSimd) {
+        sampler.ToFloat(view, 3, 1.f / 127.5f, -1.f, tensor.data());
+      } else {
+        sampler.ToFloatScalar(view, 3, 1.f / 127.5f, -1.f, tensor.data());
+      }
+    } else {
+      sampler.ToUint8Scalar(view, 3, transformed.data());
+      for (int i = 0; i < transformed.size(); ++i) {
+        tensor[i] = transformed[i] / 127.5f - 1.f;
+      }
+    }
+    benchmark::DoNotOptimize(tensor.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kTensorSize * kTensorSize);
+}
+BENCHMARK_TEMPLATE(BM_ImageToTensor, false, false)->Arg(0)->Arg(90);
+BENCHMARK_TEMPLATE(BM_ImageToTensor, true, false)->Arg(0)->Arg(90);
+BENCHMARK_TEMPLATE(BM_ImageToTensor, true, true)->Arg(0)->Arg(90);
+
+// Normalizes the rows of an image with state.range(0) channels into an RGB
+// float tensor, as TfLiteConverterCalculator.
+template <bool kSimd>
+void BM_NormalizeRow(benchmark::State& state) {
+  const int channels = state.range(0);
+  std::vector<uint8> image(kWidth * kHeight * channels);
+  for (int i = 0; i < image.size(); ++i) {
+    image[i] = i * 7;
+  }
+  const int out_channels = std::min(channels, 3);
+  std::vector<float> tensor(kWidth * kHeight * out_channels);
+  for (auto _ : state) {
+    for (int y = 0; y < kHeight; ++y) {
+      const uint8* row = image.data() + y * kWidth * channels;
+      float* output = tensor.data() + y * kWidth * out_channels;
+      if (kSimd) {
+        NormalizeRow(row, channels, out_channels, kWidth, 1.f / 127.5f, -1.f,
+                     output);
+      } else {
+        NormalizeRowScalar(row, channels, out_channels, kWidth, 1.f / 127.5f,
+                           -1.f, output);
+      }
+    }
+    benchmark::DoNotOptimize(tensor.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kWidth * kHeight);
+}
+BENCHMARK_TEMPLATE(BM_NormalizeRow, false)->Arg(3)->Arg(4);
+BENCHMARK_TEMPLATE(BM_NormalizeRow, true)->Arg(3)->Arg(4);
+
+}  // namespace
+}  // namespace image_to_tensor
+}  // namespace mediapipe
@@ -0,0 +1,242 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tflite/image_to_tensor_utils.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace image_to_tensor {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::FloatEq;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// Returns a width x height image with "channels" channels, whose rows are
+// padded to "step" bytes, filled with distinct values.
+std::vector<uint8> MakeImage(int width, int height, int channels, int step) {
+  std::vector<uint8> image(step * height);
+  for (int y = 0; y < height; ++y) {
+    for (int i = 0; i < width * channels; ++i) {
+      image[y * step + i] = (y * 31 + i * 7) % 256;
+    }
+  }
+  return image;
+}
+
+ImageView View(const std::vector<uint8>& image, int width, int height,
+               int channels, int step) {
+  return {image.data(), step, channels, width, height};
+}
+
+Transform MakeTransform(int width, int height, int rotation_degrees,
+                        ScaleMode::Mode scale_mode) {
+  Transform transform;
+  transform.output_width = width;
+  transform.output_height = height;
+  transform.rotation_degrees = rotation_degrees;
+  transform.scale_mode = scale_mode;
+  return transform;
+}
+
+TEST(ImageToTensorUtilsTest, NormalizesImageOfTensorSize) {
+  const std::vector<uint8> image = MakeImage(5, 3, 3, 16);
+  Sampler sampler(MakeTransform(5, 3, 0, ScaleMode::STRETCH));
+  std::vector<float> tensor(5 * 3 * 3);
+  sampler.ToFloat(View(image, 5, 3, 3, 16), 3, 1.f / 127.5f, -1.f,
+                  tensor.data());
+  std::vector<uint8> bytes(tensor.size());
+  sampler.ToUint8(View(image, 5, 3, 3, 16), 3, bytes.data());
+  for (int y = 0; y < 3; ++y) {
+    for (int i = 0; i < 5 * 3; ++i) {
+      const uint8 value = image[y * 16 + i];
+      EXPECT_NEAR(value / 127.5f - 1.f, tensor[y * 15 + i], 1e-6);
+      EXPECT_EQ(value, bytes[y * 15 + i]);
+    }
+  }
+}
+
+TEST(ImageToTensorUtilsTest, DropsAlphaChannel) {
+  const std::vector<uint8> image = {1, 2, 3, 4, 5, 6, 7, 8};
+  Sampler sampler(MakeTransform(2, 1, 0, ScaleMode::STRETCH));
+  std::vector<uint8> tensor(2 * 3);
+  sampler.ToUint8(View(image, 2, 1, 4, 8), 3, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(1, 2, 3, 5, 6, 7));
+}
+
+TEST(ImageToTensorUtilsTest, RotatesImageCounterclockwise) {
+  // A 3x2 gray image.
+  const std::vector<uint8> image = {1, 2, 3,  //
+                                    4, 5, 6};
+  std::vector<uint8> tensor(6);
+  Sampler rotation_90(MakeTransform(2, 3, 90, ScaleMode::STRETCH));
+  rotation_90.ToUint8(View(image, 3, 2, 1, 3), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(3, 6,  //
+                                  2, 5,  //
+                                  1, 4));
+  Sampler rotation_180(MakeTransform(3, 2, 180, ScaleMode::STRETCH));
+  rotation_180.ToUint8(View(image, 3, 2, 1, 3), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(6, 5, 4,  //
+                                  3, 2, 1));
+  Sampler rotation_270(MakeTransform(2, 3, -90, ScaleMode::STRETCH));
+  rotation_270.ToUint8(View(image, 3, 2, 1, 3), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(4, 1,  //
+                                  5, 2,  //
+                                  6, 3));
+}
+
+TEST(ImageToTensorUtilsTest, FlipsImageAfterRotation) {
+  const std::vector<uint8> image = {1, 2, 3,  //
+                                    4, 5, 6};
+  std::vector<uint8> tensor(6);
+  Transform transform = MakeTransform(3, 2, 0, ScaleMode::STRETCH);
+  transform.flip_horizontally = true;
+  Sampler horizontal(transform);
+  horizontal.ToUint8(View(image, 3, 2, 1, 3), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(3, 2, 1,  //
+                                  6, 5, 4));
+  transform = MakeTransform(2, 3, 90, ScaleMode::STRETCH);
+  transform.flip_vertically = true;
+  Sampler vertical(transform);
+  vertical.ToUint8(View(image, 3, 2, 1, 3), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(1, 4,  //
+                                  2, 5,  //
+                                  3, 6));
+}
+
+TEST(ImageToTensorUtilsTest, InterpolatesBilinearly) {
+  const std::vector<uint8> image = {0, 100,  //
+                                    200, 200};
+  Sampler sampler(MakeTransform(4, 2, 0, ScaleMode::STRETCH));
+  std::vector<float> tensor(4 * 2);
+  sampler.ToFloat(View(image, 2, 2, 1, 2), 1, 1.f, 0.f, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(FloatEq(0), FloatEq(25), FloatEq(75),
+                                  FloatEq(100), FloatEq(200), FloatEq(200),
+                                  FloatEq(200), FloatEq(200)));
+}
+
+TEST(ImageToTensorUtilsTest, LetterboxesImage) {
+  // A 4x2 image fits the middle two rows of a 4x4 tensor.
+  const std::vector<uint8> image = MakeImage(4, 2, 1, 4);
+  const Transform transform = MakeTransform(4, 4, 0, ScaleMode::FIT);
+  Sampler sampler(transform);
+  std::vector<float> tensor(4 * 4);
+  sampler.ToFloat(View(image, 4, 2, 1, 4), 1, 1.f / 127.5f, -1.f,
+                  tensor.data());
+  for (int x = 0; x < 4; ++x) {
+    EXPECT_EQ(-1.f, tensor[x]);
+    EXPECT_NEAR(image[x] / 127.5f - 1.f, tensor[4 + x], 1e-6);
+    EXPECT_NEAR(image[4 + x] / 127.5f - 1.f, tensor[8 + x], 1e-6);
+    EXPECT_EQ(-1.f, tensor[12 + x]);
+  }
+  EXPECT_THAT(LetterboxPadding(transform, 4, 2),
+              ElementsAre(0.f, 0.25f, 0.f, 0.25f));
+}
+
+TEST(ImageToTensorUtilsTest, LetterboxesRotatedImage) {
+  // A 20x10 image rotated by 90 degrees fits the middle of a 20x10 tensor.
+  const Transform transform = MakeTransform(20, 10, 90, ScaleMode::FIT);
+  EXPECT_THAT(LetterboxPadding(transform, 20, 10),
+              ElementsAre(FloatEq(0.375f), 0.f, FloatEq(0.375f), 0.f));
+  const std::vector<uint8> image(20 * 10, 255);
+  Sampler sampler(transform);
+  std::vector<uint8> tensor(20 * 10);
+  sampler.ToUint8(View(image, 20, 10, 1, 20), 1, tensor.data());
+  for (int y = 0; y < 10; ++y) {
+    for (int x = 0; x < 20; ++x) {
+      EXPECT_EQ(x >= 7 && x < 12 ? 255 : 0, tensor[y * 20 + x]);
+    }
+  }
+  EXPECT_THAT(LetterboxPadding(MakeTransform(20, 10, 90, ScaleMode::STRETCH),
+                               20, 10),
+              ElementsAre(0.f, 0.f, 0.f, 0.f));
+}
+
+TEST(ImageToTensorUtilsTest, CropsImageToFill) {
+  // The middle 2x2 pixels of a 4x2 image fill a 2x2 tensor.
+  const std::vector<uint8> image = MakeImage(4, 2, 1, 4);
+  const Transform transform = MakeTransform(2, 2, 0, ScaleMode::FILL_AND_CROP);
+  Sampler sampler(transform);
+  std::vector<uint8> tensor(2 * 2);
+  sampler.ToUint8(View(image, 4, 2, 1, 4), 1, tensor.data());
+  EXPECT_THAT(tensor, ElementsAre(image[1], image[2], image[5], image[6]));
+  EXPECT_THAT(LetterboxPadding(transform, 4, 2),
+              ElementsAre(0.f, 0.f, 0.f, 0.f));
+}
+
+TEST(ImageToTensorUtilsTest, SimdMatchesScalar) {
+  Transform transform = MakeTransform(24, 20, 270, ScaleMode::FIT);
+  transform.flip_horizontally = true;
+  const int channels[][2] = {{1, 1}, {3, 3}, {4, 3}, {4, 4}};
+  for (const auto& pair : channels) {
+    const int step = 37 * pair[0] + 5;
+    const std::vector<uint8> image = MakeImage(37, 23, pair[0], step);
+    const ImageView view = View(image, 37, 23, pair[0], step);
+    const int size = 24 * 20 * pair[1];
+    Sampler sampler(transform);
+    std::vector<float> floats(size);
+    std::vector<float> scalar_floats(size);
+    sampler.ToFloat(view, pair[1], 1.f / 255.f, 0.f, floats.data());
+    sampler.ToFloatScalar(view, pair[1], 1.f / 255.f, 0.f,
+                          scalar_floats.data());
+    for (int i = 0; i < size; ++i) {
+      EXPECT_NEAR(scalar_floats[i], floats[i], 1e-6) << i;
+    }
+    std::vector<uint8> bytes(size);
+    std::vector<uint8> scalar_bytes(size);
+    sampler.ToUint8(view, pair[1], bytes.data());
+    sampler.ToUint8Scalar(view, pair[1], scalar_bytes.data());
+    EXPECT_THAT(bytes, ElementsAreArray(scalar_bytes));
+  }
+}
+
+TEST(ImageToTensorUtilsTest, NormalizesRow) {
+  const uint8 row[] = {0, 51, 255, 102, 204, 0, 255, 10};
+  std::vector<float> output(6);
+  NormalizeRow(row, 4, 3, 2, 1.f / 255.f, 0.f, output.data());
+  EXPECT_THAT(output, Pointwise(FloatNear(1e-6),
+                                {0.f, 0.2f, 1.f, 0.8f, 0.f, 1.f}));
+  output.resize(8);
+  NormalizeRow(row, 4, 4, 2, 1.f / 127.5f, -1.f, output.data());
+  EXPECT_THAT(output,
+              Pointwise(FloatNear(1e-6), {-1.f, -0.6f, 1.f, -0.2f, 0.6f, -1.f,
+                                          1.f, 10 / 127.5f - 1.f}));
+}
+
+TEST(ImageToTensorUtilsTest, NormalizeRowSimdMatchesScalar) {
+  const int channels[][2] = {{1, 1}, {3, 3}, {4, 3}, {4, 4}};
+  for (const auto& pair : channels) {
+    for (int width : {1, 5, 16, 37}) {
+      const std::vector<uint8> row = MakeImage(width, 1, pair[0], width * 4);
+      std::vector<float> output(width * pair[1]);
+      std::vector<float> scalar_output(width * pair[1]);
+      NormalizeRow(row.data(), pair[0], pair[1], width, 1.f / 127.5f, -1.f,
+                   output.data());
+      NormalizeRowScalar(row.data(), pair[0], pair[1], width, 1.f / 127.5f,
+                         -1.f, scalar_output.data());
+      EXPECT_THAT(output, ElementsAreArray(scalar_output));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace image_to_tensor
+}  // namespace mediapipe
@@ -19,6 +19,8 @@
 #include "mediapipe/calculators/tflite/tflite_converter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -196,4 +198,75 @@ TEST_F(TfLiteConverterCalculatorTest, RandomMatrixRowMajor) {
   }
 }
 
+TEST_F(TfLiteConverterCalculatorTest, CustomNormalization) {
+  CalculatorGraphConfig graph_config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "input_image"
+        node {
+          calculator: "TfLiteConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TfLiteConverterCalculatorOptions.ext] {
+              use_custom_normalization: true
+              custom_div: 2.0
+              custom_sub: 33.0
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  // Run the graph.
+  graph_ = absl::make_unique<CalculatorGraph>();
+  MP_ASSERT_OK(graph_->Initialize(graph_config));
+  MP_ASSERT_OK(graph_->StartRun({}));
+
+  // An RGBA image, whose alpha channel is dropped from the tensor.
+  const int width = 21;
+  const int height = 3;
+  auto input_image =
+      absl::make_unique<ImageFrame>(ImageFormat::SRGBA, width, height);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = input_image->MutablePixelData() + y * input_image->WidthStep();
+    for (int x = 0; x < width * 4; ++x) {
+      row[x] = (y * 31 + x * 7) % 256;
+    }
+  }
+  MP_ASSERT_OK(graph_->AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+
+  // Wait until the calculator done processing.
+  MP_ASSERT_OK(graph_->WaitUntilIdle());
+  ASSERT_EQ(1, output_packets.size());
+
+  // Get and process results.
+  const std::vector<TfLiteTensor>& tensor_vec =
+      output_packets[0].Get<std::vector<TfLiteTensor>>();
+  ASSERT_EQ(1, tensor_vec.size());
+
+  const TfLiteTensor* tensor = &tensor_vec[0];
+  EXPECT_EQ(kTfLiteFloat32, tensor->type);
+
+  // Verify that the data is correct.
+  const float* tensor_buffer = tensor->data.f;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        const int pixel = (y * 31 + (x * 4 + c) * 7) % 256;
+        EXPECT_FLOAT_EQ(pixel / 2.0f - 33.0f, *tensor_buffer++)
+            << "at y = " << y << ", x = " << x << ", c = " << c;
+      }
+    }
+  }
+
+  // Fully close graph at end, otherwise calculator+tensors are destroyed
+  // after calling WaitUntilDone().
+  MP_ASSERT_OK(graph_->CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph_->WaitUntilDone());
+
+  graph_.reset();
+}
+
 }  // namespace mediapipe
@@ -0,0 +1,257 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
+#include "mediapipe/calculators/tflite/image_to_tensor_utils.h"
+#include "mediapipe/calculators/tflite/tflite_image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+
+namespace {
+
+int RotationModeToDegrees(RotationMode::Mode rotation) {
+  switch (rotation) {
+    case RotationMode::ROTATION_90:
+      return 90;
+    case RotationMode::ROTATION_180:
+      return 180;
+    case RotationMode::ROTATION_270:
+      return 270;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+// Converts an ImageFrame into a TfLiteTensor (float 32 or uint8) of fixed
+// dimensions, rotating, scaling and flipping the image as
+// ImageTransformationCalculator and normalizing it as
+// TfLiteConverterCalculator.
+//
+// This calculator replaces an ImageTransformationCalculator followed by a
+// TfLiteConverterCalculator on CPU.  Each tensor value is interpolated
+// directly from the input image, in one pass and without intermediate
+// images.  The letterbox of the FIT scale mode is black, i.e. -1 or 0 after
+// normalization.
+//
+// Input:
+//  IMAGE - ImageFrame (SRGBA, SRGB or GRAY8).
+//  ROTATION_DEGREES (optional) - The counterclockwise rotation angle in
+//    degrees, a multiple of 90.  It overrides the ROTATION_DEGREES input side
+//    packet and the rotation mode of the options.
+//
+// Input side packet:
+//  ROTATION_DEGREES (optional) - The counterclockwise rotation angle in
+//    degrees, a multiple of 90.  It overrides the rotation mode of the
+//    options.
+//
+// Output:
+//  TENSORS - Vector of TfLiteTensor of type kTfLiteFloat32, or kTfLiteUint8,
+//    with dimensions [output_height, output_width, channels].
+//  LETTERBOX_PADDING (optional) - An std::array<float, 4> representing the
+//    letterbox padding from the 4 sides ([left, top, right, bottom]) of the
+//    tensor, normalized to [0.f, 1.f] by the tensor dimensions, as in
+//    ImageTransformationCalculator.
+//
+// Example use:
+// node {
+//   calculator: "TfLiteImageToTensorCalculator"
+//   input_stream: "IMAGE:input_video"
+//   output_stream: "TENSORS:image_tensor"
+//   output_stream: "LETTERBOX_PADDING:letterbox_padding"
+//   options: {
+//     [mediapipe.TfLiteImageToTensorCalculatorOptions.ext] {
+//       output_width: 128
+//       output_height: 128
+//       scale_mode: FIT
+//     }
+//   }
+// }
+//
+// This calculator uses FixedSizeInputStreamHandler by default.
+//
+class TfLiteImageToTensorCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc);
+
+  ::mediapipe::Status Open(CalculatorContext* cc) override;
+  ::mediapipe::Status Process(CalculatorContext* cc) override;
+
+ private:
+  ::mediapipe::Status InitTensor(const ImageFrame& image_frame);
+
+  TfLiteImageToTensorCalculatorOptions options_;
+  std::unique_ptr<tflite::Interpreter> interpreter_ = nullptr;
+  // The sampler for the current rotation.
+  std::unique_ptr<image_to_tensor::Sampler> sampler_;
+  image_to_tensor::Transform transform_;
+  int channels_ = 0;
+};
+REGISTER_CALCULATOR(TfLiteImageToTensorCalculator);
+
+::mediapipe::Status TfLiteImageToTensorCalculator::GetContract(
+    CalculatorContract* cc) {
+  RET_CHECK(cc->Inputs().HasTag("IMAGE"));
+  RET_CHECK(cc->Outputs().HasTag("TENSORS"));
+
+  cc->Inputs().Tag("IMAGE").Set<ImageFrame>();
+  if (cc->Inputs().HasTag("ROTATION_DEGREES")) {
+    cc->Inputs().Tag("ROTATION_DEGREES").Set<int>();
+  }
+  if (cc->InputSidePackets().HasTag("ROTATION_DEGREES")) {
+    cc->InputSidePackets().Tag("ROTATION_DEGREES").Set<int>();
+  }
+
+  cc->Outputs().Tag("TENSORS").Set<std::vector<TfLiteTensor>>();
+  if (cc->Outputs().HasTag("LETTERBOX_PADDING")) {
+    cc->Outputs().Tag("LETTERBOX_PADDING").Set<std::array<float, 4>>();
+  }
+
+  // Assign this calculator's default InputStreamHandler.
+  cc->SetInputStreamHandler("FixedSizeInputStreamHandler");
+
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status TfLiteImageToTensorCalculator::Open(
+    CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  options_ = cc->Options<TfLiteImageToTensorCalculatorOptions>();
+  RET_CHECK_GT(options_.output_width(), 0);
+  RET_CHECK_GT(options_.output_height(), 0);
+  RET_CHECK(options_.max_num_channels() == 3 ||
+            options_.max_num_channels() == 4)
+      << "max_num_channels must be 3 or 4.";
+
+  transform_.output_width = options_.output_width();
+  transform_.output_height = options_.output_height();
+  transform_.flip_horizontally = options_.flip_horizontally();
+  transform_.flip_vertically = options_.flip_vertically();
+  transform_.scale_mode = options_.scale_mode() == ScaleMode::DEFAULT
+                              ? ScaleMode::STRETCH
+                              : options_.scale_mode();
+  if (cc->InputSidePackets().HasTag("ROTATION_DEGREES")) {
+    transform_.rotation_degrees =
+        cc->InputSidePackets().Tag("ROTATION_DEGREES").Get<int>();
+  } else {
+    transform_.rotation_degrees =
+        RotationModeToDegrees(options_.rotation_mode());
+  }
+  RET_CHECK_EQ(transform_.rotation_degrees % 90, 0)
+      << "The rotation must be a multiple of 90 degrees.";
+
+  interpreter_ = absl::make_unique<tflite::Interpreter>();
+  interpreter_->AddTensors(1);
+  interpreter_->SetInputs({0});
+
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status TfLiteImageToTensorCalculator::Process(
+    CalculatorContext* cc) {
+  const auto& image_frame = cc->Inputs().Tag("IMAGE").Get<ImageFrame>();
+  if (channels_ == 0) {
+    MP_RETURN_IF_ERROR(InitTensor(image_frame));
+  }
+  RET_CHECK_EQ(std::min(image_frame.NumberOfChannels(),
+                        options_.max_num_channels()),
+               channels_)
+      << "The format of the input images must not change.";
+
+  if (cc->Inputs().HasTag("ROTATION_DEGREES") &&
+      !cc->Inputs().Tag("ROTATION_DEGREES").IsEmpty()) {
+    const int rotation_degrees =
+        cc->Inputs().Tag("ROTATION_DEGREES").Get<int>();
+    RET_CHECK_EQ(rotation_degrees % 90, 0)
+        << "The rotation must be a multiple of 90 degrees.";
+    if (rotation_degrees != transform_.rotation_degrees) {
+      transform_.rotation_degrees = rotation_degrees;
+      sampler_.reset();
+    }
+  }
+  if (!sampler_) {
+    sampler_ = absl::make_unique<image_to_tensor::Sampler>(transform_);
+  }
+
+  const image_to_tensor::ImageView image = {
+      image_frame.PixelData(), image_frame.WidthStep(),
+      image_frame.NumberOfChannels(), image_frame.Width(),
+      image_frame.Height()};
+  TfLiteTensor* tensor = interpreter_->tensor(interpreter_->inputs()[0]);
+  if (options_.use_quantized_tensors()) {
+    RET_CHECK(tensor->data.uint8);
+    sampler_->ToUint8(image, channels_, tensor->data.uint8);
+  } else {
+    RET_CHECK(tensor->data.f);
+    // [-1,1] or [0,1]
+    const bool zero_center = options_.zero_center();
+    sampler_->ToFloat(image, channels_,
+                      zero_center ? 1.0f / 127.5f : 1.0f / 255.0f,
+                      zero_center ? -1.0f : 0.0f, tensor->data.f);
+  }
+
+  auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
+  output_tensors->emplace_back(*tensor);
+  cc->Outputs().Tag("TENSORS").Add(output_tensors.release(),
+                                   cc->InputTimestamp());
+
+  if (cc->Outputs().HasTag("LETTERBOX_PADDING")) {
+    auto padding = absl::make_unique<std::array<float, 4>>(
+        image_to_tensor::LetterboxPadding(transform_, image_frame.Width(),
+                                          image_frame.Height()));
+    cc->Outputs().Tag("LETTERBOX_PADDING").Add(padding.release(),
+                                               cc->InputTimestamp());
+  }
+
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status TfLiteImageToTensorCalculator::InitTensor(
+    const ImageFrame& image_frame) {
+  RET_CHECK(image_frame.Format() == ImageFormat::SRGBA ||
+            image_frame.Format() == ImageFormat::SRGB ||
+            image_frame.Format() == ImageFormat::GRAY8)
+      << "Unsupported CPU input format.";
+  channels_ =
+      std::min(image_frame.NumberOfChannels(), options_.max_num_channels());
+
+  // The tensor has the same dimensions for every image, so it is allocated
+  // once.
+  TfLiteQuantization quant;
+  interpreter_->SetTensorParametersReadWrite(
+      0, options_.use_quantized_tensors() ? kTfLiteUInt8 : kTfLiteFloat32, "",
+      {channels_}, quant);
+  const int tensor_idx = interpreter_->inputs()[0];
+  interpreter_->ResizeInputTensor(
+      tensor_idx,
+      {options_.output_height(), options_.output_width(), channels_});
+  interpreter_->AllocateTensors();
+
+  return ::mediapipe::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,158 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/calculators/tflite/tflite_image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"  // NOLINT
+#include "mediapipe/framework/tool/sink.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Returns a packet with a width x height image, whose channel c of pixel
+// (x, y) is 10 * (y * width + x) + c.
+Packet MakeImagePacket(ImageFormat::Format format, int width, int height) {
+  auto image = absl::make_unique<ImageFrame>(format, width, height);
+  const int channels = image->NumberOfChannels();
+  for (int y = 0; y < height; ++y) {
+    uint8* row = image->MutablePixelData() + y * image->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < channels; ++c) {
+        row[x * channels + c] = 10 * (y * width + x) + c;
+      }
+    }
+  }
+  return Adopt(image.release()).At(Timestamp(0));
+}
+
+std::vector<int> TensorDims(const TfLiteTensor& tensor) {
+  return std::vector<int>(tensor.dims->data,
+                          tensor.dims->data + tensor.dims->size);
+}
+
+// The output tensors refer to the memory of the calculator, so the graph is
+// kept open until they are verified.
+class TfLiteImageToTensorCalculatorTest : public ::testing::Test {
+ protected:
+  void StartGraph(const std::string& node) {
+    CalculatorGraphConfig config =
+        ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+          input_stream: "image"
+          input_stream: "rotation"
+          node {
+            calculator: "TfLiteImageToTensorCalculator"
+            input_stream: "IMAGE:image"
+            output_stream: "TENSORS:tensors"
+            output_stream: "LETTERBOX_PADDING:letterbox_padding"
+          }
+        )");
+    config.mutable_node(0)->MergeFrom(
+        ParseTextProtoOrDie<CalculatorGraphConfig::Node>(node));
+    tool::AddVectorSink("tensors", &config, &tensors_packets_);
+    tool::AddVectorSink("letterbox_padding", &config, &padding_packets_);
+    MP_ASSERT_OK(graph_.Initialize(config));
+    MP_ASSERT_OK(graph_.StartRun({}));
+  }
+
+  void TearDown() override {
+    MP_ASSERT_OK(graph_.CloseAllInputStreams());
+    MP_ASSERT_OK(graph_.WaitUntilDone());
+  }
+
+  CalculatorGraph graph_;
+  std::vector<Packet> tensors_packets_;
+  std::vector<Packet> padding_packets_;
+};
+
+TEST_F(TfLiteImageToTensorCalculatorTest, LetterboxesImageIntoFloatTensor) {
+  StartGraph(R"(
+    options {
+      [mediapipe.TfLiteImageToTensorCalculatorOptions.ext] {
+        output_width: 4
+        output_height: 4
+        scale_mode: FIT
+      }
+    }
+  )");
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "image", MakeImagePacket(ImageFormat::SRGB, 4, 2)));
+  MP_ASSERT_OK(graph_.WaitUntilIdle());
+
+  ASSERT_EQ(1, tensors_packets_.size());
+  const auto& tensors = tensors_packets_[0].Get<std::vector<TfLiteTensor>>();
+  ASSERT_EQ(1, tensors.size());
+  const TfLiteTensor& tensor = tensors[0];
+  EXPECT_EQ(kTfLiteFloat32, tensor.type);
+  EXPECT_THAT(TensorDims(tensor), ElementsAre(4, 4, 3));
+  for (int y = 0; y < 4; ++y) {
+    for (int i = 0; i < 4 * 3; ++i) {
+      const int value = 10 * ((y - 1) * 4 + i / 3) + i % 3;
+      const float expected = y == 0 || y == 3 ? -1.f : value / 127.5f - 1.f;
+      EXPECT_NEAR(expected, tensor.data.f[y * 12 + i], 1e-6);
+    }
+  }
+  ASSERT_EQ(1, padding_packets_.size());
+  const auto& padding = padding_packets_[0].Get<std::array<float, 4>>();
+  EXPECT_THAT(padding, ElementsAre(0.f, 0.25f, 0.f, 0.25f));
+}
+
+TEST_F(TfLiteImageToTensorCalculatorTest, RotatesImageIntoQuantizedTensor) {
+  StartGraph(R"(
+    input_stream: "ROTATION_DEGREES:rotation"
+    options {
+      [mediapipe.TfLiteImageToTensorCalculatorOptions.ext] {
+        output_width: 2
+        output_height: 3
+        use_quantized_tensors: true
+        max_num_channels: 4
+      }
+    }
+  )");
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "image", MakeImagePacket(ImageFormat::SRGBA, 3, 2)));
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "rotation", MakePacket<int>(90).At(Timestamp(0))));
+  MP_ASSERT_OK(graph_.WaitUntilIdle());
+
+  ASSERT_EQ(1, tensors_packets_.size());
+  const TfLiteTensor& tensor =
+      tensors_packets_[0].Get<std::vector<TfLiteTensor>>()[0];
+  EXPECT_EQ(kTfLiteUInt8, tensor.type);
+  EXPECT_THAT(TensorDims(tensor), ElementsAre(3, 2, 4));
+  // Pixel (x, y) of the tensor is pixel (2 - y, x) of the image.
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 2; ++x) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_EQ(10 * (x * 3 + 2 - y) + c,
+                  tensor.data.uint8[y * 8 + x * 4 + c]);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
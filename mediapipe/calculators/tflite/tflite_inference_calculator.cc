@@ -12,13 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/tflite/tflite_inference_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/tflite/tflite_model_cache.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/register.h"
@@ -31,6 +37,7 @@
 #include "tensorflow/lite/delegates/gpu/gl/gl_program.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_shader.h"
 #include "tensorflow/lite/delegates/gpu/gl_delegate.h"
+#include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #endif  // __ANDROID__
 
 #if defined(__APPLE__) && !TARGET_OS_OSX  // iOS
@@ -69,6 +76,28 @@ struct GPUData {
 };
 #endif
 
+namespace {
+
+// Returns a copy of the per-tensor quantization of "tensor", to be owned by
+// the interpreter.
+TfLiteQuantization CopyQuantization(const TfLiteTensor& tensor) {
+  TfLiteQuantization quantization = TfLiteQuantization();
+  if (tensor.quantization.type == kTfLiteAffineQuantization) {
+    auto* params = static_cast<TfLiteAffineQuantization*>(
+        malloc(sizeof(TfLiteAffineQuantization)));
+    params->scale = TfLiteFloatArrayCreate(1);
+    params->scale->data[0] = tensor.params.scale;
+    params->zero_point = TfLiteIntArrayCreate(1);
+    params->zero_point->data[0] = tensor.params.zero_point;
+    params->quantized_dimension = 0;
+    quantization.type = kTfLiteAffineQuantization;
+    quantization.params = params;
+  }
+  return quantization;
+}
+
+}  // namespace
+
 // Calculator Header Section
 
 // Runs inference on the provided input TFLite tensors and TFLite model.
@@ -96,6 +125,12 @@ struct GPUData {
 //  CUSTOM_OP_RESOLVER (optional) - Use a custom op resolver,
 //                                  instead of the builtin one.
 //
+// Graph service:
+//  kTfLiteModelCacheService (optional) - Shares the model and the
+//                                        interpreters of CPU inference with
+//                                        other graphs of the process, see
+//                                        TfLiteModelCache.
+//
 // Example use:
 // node {
 //   calculator: "TfLiteInferenceCalculator"
@@ -109,11 +144,53 @@ struct GPUData {
 //   }
 // }
 //
+// Example use of parallel CPU inference:
+// node {
+//   calculator: "TfLiteInferenceCalculator"
+//   input_stream: "TENSORS:tensor_image"
+//   output_stream: "TENSORS:tensors"
+//   input_stream_handler {
+//     input_stream_handler: "DefaultInputStreamHandler"
+//   }
+//   max_in_flight: 4
+//   options: {
+//     [mediapipe.TfLiteInferenceCalculatorOptions.ext] {
+//       model_path: "modelname.tflite"
+//       cpu_num_thread: 2
+//       num_interpreters: 4
+//     }
+//   }
+// }
+//
+// CPU input tensors are copied, since upstream calculators such as
+// TfLiteConverterCalculator reuse one buffer for every frame.  With
+// "bind_cpu_input", the buffer of each input tensor is instead bound to the
+// corresponding interpreter input for the call to invoke(), so the upstream
+// calculator effectively writes the model input in place.  The CPU output
+// tensors refer to the interpreter's output buffers, and are emitted without
+// copying.
+//
+// CPU inference can use several threads per interpreter, and several
+// interpreters, each of which runs one input at a time.  In order to run the
+// interpreters in parallel, set "max_in_flight" of the node to the number of
+// interpreters, and the default input stream handler, so that no input is
+// dropped.  Process() waits for an idle interpreter if all of them are busy.
+// With several interpreters, the CPU input and output tensors are always
+// copied, since an interpreter runs its next input while the outputs of the
+// previous one are still in use downstream.
+//
 // IMPORTANT Notes:
 //  Tensors are assumed to be ordered correctly (sequentially added to model).
 //  Input tensors are assumed to be of the correct size and already normalized.
+//  With "bind_cpu_input", input tensors must stay unchanged until this
+//  calculator has processed them, so calculators reusing their output
+//  tensors, e.g. TfLiteConverterCalculator, must not run ahead of it (see
+//  FlowLimiterCalculator).
 //  All output TfLiteTensors will be destroyed when the graph closes,
 //  (i.e. after calling graph.WaitUntilDone()).
+//  With kTfLiteModelCacheService, the interpreter is returned to the cache
+//  when the graph closes, and its next user overwrites the output tensors of
+//  a single interpreter, so they must not be held past graph.WaitUntilDone().
 //  GPU tensors are currently only supported on Android and iOS.
 //  This calculator uses FixedSizeInputStreamHandler by default.
 //
@@ -130,7 +207,41 @@ class TfLiteInferenceCalculator : public CalculatorBase {
   ::mediapipe::Status LoadModel(CalculatorContext* cc);
   ::mediapipe::Status LoadDelegate(CalculatorContext* cc);
 
-  std::unique_ptr<tflite::Interpreter> interpreter_;
+  // An interpreter with its CPU tensors.
+  struct Replica {
+    TfLiteModelCache::InterpreterPtr interpreter;
+    // Whether input buffers are bound to the interpreter, which is not
+    // possible once a delegate is applied.
+    bool bind_inputs = true;
+    // Whether input tensors are copied before they are bound, see the notes
+    // above.
+    bool copy_inputs = false;
+    // The storage of copied input tensors, and of input tensors whose buffers
+    // are not aligned for TFLite.
+    std::vector<std::vector<float>> input_copies;
+  };
+
+  // Runs inference on the inputs of "cc" with "replica".
+  ::mediapipe::Status ProcessWithReplica(CalculatorContext* cc,
+                                         Replica* replica);
+  // Returns an idle replica, and waits for one if all are busy.
+  Replica* AcquireReplica();
+  void ReleaseReplica(Replica* replica);
+  bool HasIdleReplica() const EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !idle_replicas_.empty();
+  }
+  // Sets the input tensor "index" of "replica" to "input_tensor".
+  ::mediapipe::Status SetInputTensor(Replica* replica, int index,
+                                     const TfLiteTensor& input_tensor);
+  // Returns the output tensors of the interpreter as a packet.
+  Packet MakeOutputTensorsPacket(Replica* replica);
+
+  std::vector<std::unique_ptr<Replica>> replicas_;
+  absl::Mutex mutex_;
+  std::vector<Replica*> idle_replicas_ GUARDED_BY(mutex_);
+  // The interpreter of the first replica, which is the only one for GPU
+  // inference.
+  tflite::Interpreter* interpreter_ = nullptr;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   TfLiteDelegate* delegate_ = nullptr;
 
@@ -149,6 +260,10 @@ class TfLiteInferenceCalculator : public CalculatorBase {
   bool gpu_input_ = false;
   bool gpu_output_ = false;
   bool use_quantized_tensors_ = false;
+  int cpu_num_thread_ = -1;
+  int num_interpreters_ = 1;
+  bool bind_cpu_input_ = false;
+  bool use_nnapi_ = false;
 };
 REGISTER_CALCULATOR(TfLiteInferenceCalculator);
 
@@ -181,6 +296,8 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
         .Set<tflite::ops::builtin::BuiltinOpResolver>();
   }
 
+  cc->UseService(kTfLiteModelCacheService).Optional();
+
 #if defined(__ANDROID__)
   MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #elif defined(__APPLE__) && !TARGET_OS_OSX  // iOS
@@ -227,13 +344,30 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
     RET_CHECK(gpu_helper_);
 #endif
 
+    RET_CHECK_EQ(replicas_.size(), 1)
+        << "GPU inference uses a single interpreter.";
     MP_RETURN_IF_ERROR(LoadDelegate(cc));
+    replicas_[0]->bind_inputs = false;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  for (auto& replica : replicas_) {
+    idle_replicas_.push_back(replica.get());
   }
 
   return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status TfLiteInferenceCalculator::Process(CalculatorContext* cc) {
+  Replica* replica = AcquireReplica();
+  ::mediapipe::Status status = ProcessWithReplica(cc, replica);
+  ReleaseReplica(replica);
+  return status;
+}
+
+::mediapipe::Status TfLiteInferenceCalculator::ProcessWithReplica(
+    CalculatorContext* cc, Replica* replica) {
+  tflite::Interpreter* interpreter = replica->interpreter.get();
   // 1. Receive pre-processed tensor inputs.
   if (gpu_input_) {
     // Read GPU input into SSBO.
@@ -272,18 +406,11 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
     const auto& input_tensors =
         cc->Inputs().Tag("TENSORS").Get<std::vector<TfLiteTensor>>();
     RET_CHECK_GT(input_tensors.size(), 0);
+    RET_CHECK_LE(input_tensors.size(), interpreter->inputs().size());
     for (int i = 0; i < input_tensors.size(); ++i) {
       const TfLiteTensor* input_tensor = &input_tensors[i];
       RET_CHECK(input_tensor->data.raw);
-      if (use_quantized_tensors_) {
-        const uint8* input_tensor_buffer = input_tensor->data.uint8;
-        uint8* local_tensor_buffer = interpreter_->typed_input_tensor<uint8>(i);
-        memcpy(local_tensor_buffer, input_tensor_buffer, input_tensor->bytes);
-      } else {
-        const float* input_tensor_buffer = input_tensor->data.f;
-        float* local_tensor_buffer = interpreter_->typed_input_tensor<float>(i);
-        memcpy(local_tensor_buffer, input_tensor_buffer, input_tensor->bytes);
-      }
+      MP_RETURN_IF_ERROR(SetInputTensor(replica, i, *input_tensor));
     }
   }
 
@@ -299,7 +426,7 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
     RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
 #endif
   } else {
-    RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+    RET_CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
   }
 
   // 3. Output processed tensors.
@@ -352,14 +479,8 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
 #endif
   } else {
     // Output result tensors (CPU).
-    const auto& tensor_indexes = interpreter_->outputs();
-    auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
-    for (int i = 0; i < tensor_indexes.size(); ++i) {
-      TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-      output_tensors->emplace_back(*tensor);
-    }
-    cc->Outputs().Tag("TENSORS").Add(output_tensors.release(),
-                                     cc->InputTimestamp());
+    cc->Outputs().Tag("TENSORS").AddPacket(
+        MakeOutputTensorsPacket(replica).At(cc->InputTimestamp()));
   }
 
   return ::mediapipe::OkStatus();
@@ -409,41 +530,169 @@ REGISTER_CALCULATOR(TfLiteInferenceCalculator);
 
   // Get execution modes.
   gpu_inference_ = options.use_gpu();
+  cpu_num_thread_ = options.cpu_num_thread();
+  num_interpreters_ = options.num_interpreters();
+  RET_CHECK_GE(num_interpreters_, 1);
+  bind_cpu_input_ = options.bind_cpu_input();
+  use_nnapi_ = options.use_nnapi();
+#if !defined(__ANDROID__)
+  RET_CHECK(!use_nnapi_) << "NNAPI is for Android only.";
+#endif
 
   return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status TfLiteInferenceCalculator::LoadModel(
     CalculatorContext* cc) {
-  model_ = tflite::FlatBufferModel::BuildFromFile(model_path_.c_str());
-  RET_CHECK(model_);
-
-  if (cc->InputSidePackets().HasTag("CUSTOM_OP_RESOLVER")) {
-    const auto& op_resolver =
-        cc->InputSidePackets()
-            .Tag("CUSTOM_OP_RESOLVER")
-            .Get<tflite::ops::builtin::BuiltinOpResolver>();
-    tflite::InterpreterBuilder(*model_, op_resolver)(&interpreter_);
+  // CPU inference with the builtin ops shares the interpreters of the model
+  // cache, if the graph has one.
+  TfLiteModelCache* cache = nullptr;
+  if (cc->Service(kTfLiteModelCacheService).IsAvailable() && !gpu_inference_ &&
+      !use_nnapi_ && !cc->InputSidePackets().HasTag("CUSTOM_OP_RESOLVER")) {
+    cache = &cc->Service(kTfLiteModelCacheService).GetObject();
   } else {
-    const tflite::ops::builtin::BuiltinOpResolver op_resolver;
-    tflite::InterpreterBuilder(*model_, op_resolver)(&interpreter_);
+    model_ = tflite::FlatBufferModel::BuildFromFile(model_path_.c_str());
+    RET_CHECK(model_);
   }
 
-  RET_CHECK(interpreter_);
+  for (int i = 0; i < num_interpreters_; ++i) {
+    auto replica = absl::make_unique<Replica>();
+    if (cache) {
+      // The tensors of the cached interpreters are already allocated.
+      ASSIGN_OR_RETURN(replica->interpreter,
+                       cache->GetInterpreter(model_path_, cpu_num_thread_));
+    } else {
+      std::unique_ptr<tflite::Interpreter> interpreter;
+      if (cc->InputSidePackets().HasTag("CUSTOM_OP_RESOLVER")) {
+        const auto& op_resolver =
+            cc->InputSidePackets()
+                .Tag("CUSTOM_OP_RESOLVER")
+                .Get<tflite::ops::builtin::BuiltinOpResolver>();
+        tflite::InterpreterBuilder(*model_, op_resolver)(&interpreter);
+      } else {
+        const tflite::ops::builtin::BuiltinOpResolver op_resolver;
+        tflite::InterpreterBuilder(*model_, op_resolver)(&interpreter);
+      }
+      RET_CHECK(interpreter);
+      if (cpu_num_thread_ > 0) {
+        interpreter->SetNumThreads(cpu_num_thread_);
+      }
+      if (!gpu_output_) {
+        RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+      }
+      replica->interpreter = TfLiteModelCache::InterpreterPtr(
+          interpreter.release(), std::default_delete<tflite::Interpreter>());
+    }
+    replica->copy_inputs = !bind_cpu_input_ || num_interpreters_ > 1;
+    replica->input_copies.resize(replica->interpreter->inputs().size());
+    replicas_.push_back(std::move(replica));
+  }
+  interpreter_ = replicas_[0]->interpreter.get();
 
   if (gpu_output_) {
     use_quantized_tensors_ = false;
   } else {
-    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
     use_quantized_tensors_ =
         (interpreter_->tensor(interpreter_->inputs()[0])->quantization.type ==
          kTfLiteAffineQuantization);
     if (use_quantized_tensors_) gpu_inference_ = false;
   }
 
+#if defined(__ANDROID__)
+  if (use_nnapi_ && !gpu_inference_) {
+    for (auto& replica : replicas_) {
+      RET_CHECK_EQ(replica->interpreter->ModifyGraphWithDelegate(
+                       tflite::NnApiDelegate()),
+                   kTfLiteOk);
+      replica->bind_inputs = false;
+    }
+  }
+#endif  // __ANDROID__
+
   return ::mediapipe::OkStatus();
 }
 
+TfLiteInferenceCalculator::Replica*
+TfLiteInferenceCalculator::AcquireReplica() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(
+      absl::Condition(this, &TfLiteInferenceCalculator::HasIdleReplica));
+  Replica* replica = idle_replicas_.back();
+  idle_replicas_.pop_back();
+  return replica;
+}
+
+void TfLiteInferenceCalculator::ReleaseReplica(Replica* replica) {
+  absl::MutexLock lock(&mutex_);
+  idle_replicas_.push_back(replica);
+}
+
+::mediapipe::Status TfLiteInferenceCalculator::SetInputTensor(
+    Replica* replica, int index, const TfLiteTensor& input_tensor) {
+  tflite::Interpreter* interpreter = replica->interpreter.get();
+  const int tensor_index = interpreter->inputs()[index];
+  const TfLiteTensor* tensor = interpreter->tensor(tensor_index);
+  if (!replica->bind_inputs) {
+    // The delegate owns the input buffers of the interpreter.
+    memcpy(tensor->data.raw, input_tensor.data.raw, input_tensor.bytes);
+    return ::mediapipe::OkStatus();
+  }
+  RET_CHECK_EQ(input_tensor.type, tensor->type);
+  RET_CHECK_EQ(input_tensor.bytes, tensor->bytes);
+  const char* buffer = input_tensor.data.raw;
+  // TFLite kernels assume buffers to be aligned at least for floats, so
+  // unaligned buffers are copied as well.
+  if (replica->copy_inputs ||
+      reinterpret_cast<uintptr_t>(buffer) % sizeof(float) != 0) {
+    std::vector<float>& copy = replica->input_copies[index];
+    copy.resize((tensor->bytes + sizeof(float) - 1) / sizeof(float));
+    memcpy(copy.data(), buffer, tensor->bytes);
+    buffer = reinterpret_cast<const char*>(copy.data());
+  }
+  if (buffer == tensor->data.raw) {
+    return ::mediapipe::OkStatus();
+  }
+  // With unchanged type and dimensions, the interpreter only replaces the
+  // buffer of the tensor, and stays invokable.
+  const std::vector<int> dims(tensor->dims->data,
+                              tensor->dims->data + tensor->dims->size);
+  RET_CHECK_EQ(interpreter->SetTensorParametersReadOnly(
+                   tensor_index, tensor->type, tensor->name, dims,
+                   CopyQuantization(*tensor), buffer, tensor->bytes),
+               kTfLiteOk);
+  return ::mediapipe::OkStatus();
+}
+
+Packet TfLiteInferenceCalculator::MakeOutputTensorsPacket(Replica* replica) {
+  tflite::Interpreter* interpreter = replica->interpreter.get();
+  const auto& tensor_indexes = interpreter->outputs();
+  auto output_tensors = absl::make_unique<std::vector<TfLiteTensor>>();
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    TfLiteTensor* tensor = interpreter->tensor(tensor_indexes[i]);
+    output_tensors->emplace_back(*tensor);
+  }
+  if (replicas_.size() == 1) {
+    return Adopt(output_tensors.release());
+  }
+  // The interpreter runs the next input as soon as it is released, so the
+  // packet owns copies of the output buffers.
+  std::vector<TfLiteTensor>* tensors = output_tensors.release();
+  for (TfLiteTensor& tensor : *tensors) {
+    char* data = new char[tensor.bytes];
+    memcpy(data, tensor.data.raw, tensor.bytes);
+    tensor.data.raw = data;
+    tensor.dims = TfLiteIntArrayCopy(tensor.dims);
+    tensor.allocation_type = kTfLiteDynamic;
+  }
+  return PointToForeign(tensors, [tensors]() {
+    for (TfLiteTensor& tensor : *tensors) {
+      delete[] tensor.data.raw;
+      TfLiteIntArrayFree(tensor.dims);
+    }
+    delete tensors;
+  });
+}
+
 ::mediapipe::Status TfLiteInferenceCalculator::LoadDelegate(
     CalculatorContext* cc) {
 #if defined(__ANDROID__)
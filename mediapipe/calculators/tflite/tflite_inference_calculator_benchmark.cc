@@ -0,0 +1,166 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the latency and throughput of CPU inference with
+// TfLiteInferenceCalculator on the detection models, for several numbers of
+// interpreter threads and interpreters, e.g.:
+//   bazel run -c opt \
+//       //mediapipe/calculators/tflite:tflite_inference_calculator_benchmark \
+//       -- --benchmark_format=console
+// The object detection model is not checked in, see
+// mediapipe/docs/object_detection_desktop.md for how to obtain it; its
+// benchmarks are skipped if it is missing.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/tflite/tflite_inference_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace {
+
+struct Model {
+  const char* path;
+  int width;
+  int height;
+};
+
+// Indexed by the first argument of the benchmarks.
+constexpr Model kModels[] = {
+    {"mediapipe/models/face_detection_front.tflite", 128, 128},
+    {"mediapipe/models/ssdlite_object_detection.tflite", 320, 320},
+};
+
+// Runs a graph with a TfLiteInferenceCalculator on constant RGB tensors.
+class InferenceGraph {
+ public:
+  InferenceGraph(const Model& model, int cpu_num_thread, int num_interpreters)
+      : buffer_(model.width * model.height * 3, 0.5f) {
+    auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+        R"(
+          input_stream: "tensor_in"
+          num_threads: $3
+          node {
+            calculator: "TfLiteInferenceCalculator"
+            input_stream: "TENSORS:tensor_in"
+            output_stream: "TENSORS:tensor_out"
+            input_stream_handler {
+              input_stream_handler: "DefaultInputStreamHandler"
+            }
+            max_in_flight: $2
+            options {
+              [mediapipe.TfLiteInferenceCalculatorOptions.ext] {
+                model_path: "$0"
+                cpu_num_thread: $1
+                num_interpreters: $2
+              }
+            }
+          }
+        )",
+        model.path, cpu_num_thread, num_interpreters, num_interpreters + 1));
+    MEDIAPIPE_CHECK_OK(graph_.Initialize(config));
+    MEDIAPIPE_CHECK_OK(graph_.ObserveOutputStream(
+        "tensor_out", [this](const Packet& packet) {
+          ++num_outputs_;
+          return ::mediapipe::OkStatus();
+        }));
+    MEDIAPIPE_CHECK_OK(graph_.StartRun({}));
+    tensor_ = TfLiteTensor();
+    tensor_.type = kTfLiteFloat32;
+    tensor_.data.f = buffer_.data();
+    tensor_.bytes = buffer_.size() * sizeof(float);
+  }
+
+  ~InferenceGraph() {
+    MEDIAPIPE_CHECK_OK(graph_.CloseAllInputStreams());
+    MEDIAPIPE_CHECK_OK(graph_.WaitUntilDone());
+  }
+
+  // Sends "num_packets" inputs and waits for their outputs.
+  void Run(int num_packets) {
+    for (int i = 0; i < num_packets; ++i) {
+      MEDIAPIPE_CHECK_OK(graph_.AddPacketToInputStream(
+          "tensor_in",
+          MakePacket<std::vector<TfLiteTensor>>(1, tensor_)
+              .At(Timestamp(timestamp_++))));
+    }
+    MEDIAPIPE_CHECK_OK(graph_.WaitUntilIdle());
+  }
+
+  int num_outputs() const { return num_outputs_; }
+
+ private:
+  std::vector<float> buffer_;
+  TfLiteTensor tensor_;
+  CalculatorGraph graph_;
+  int64 timestamp_ = 0;
+  int num_outputs_ = 0;
+};
+
+// Returns the model of the benchmark, or nullptr if it is missing.
+const Model* GetModel(benchmark::State* state) {
+  const Model& model = kModels[state->range(0)];
+  if (!file::Exists(model.path).ok()) {
+    state->SkipWithError(absl::StrCat("Missing ", model.path).c_str());
+    return nullptr;
+  }
+  return &model;
+}
+
+// Runs one input at a time with state.range(1) interpreter threads.
+void BM_InferenceLatency(benchmark::State& state) {
+  const Model* model = GetModel(&state);
+  if (!model) return;
+  InferenceGraph graph(*model, state.range(1), /*num_interpreters=*/1);
+  for (auto _ : state) {
+    graph.Run(1);
+  }
+  CHECK_EQ(state.iterations(), graph.num_outputs());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InferenceLatency)
+    ->ArgNames({"model", "threads"})
+    ->ArgsProduct({{0, 1}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// Runs batches of inputs with state.range(2) interpreters, each using
+// state.range(1) threads.
+void BM_InferenceThroughput(benchmark::State& state) {
+  constexpr int kBatchSize = 32;
+  const Model* model = GetModel(&state);
+  if (!model) return;
+  InferenceGraph graph(*model, state.range(1), state.range(2));
+  for (auto _ : state) {
+    graph.Run(kBatchSize);
+  }
+  CHECK_EQ(state.iterations() * kBatchSize, graph.num_outputs());
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_InferenceThroughput)
+    ->ArgNames({"model", "threads", "interpreters"})
+    ->ArgsProduct({{0, 1}, {1, 4}, {1, 4, 16}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
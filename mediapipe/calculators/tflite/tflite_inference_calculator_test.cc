@@ -26,6 +26,7 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT
 #include "mediapipe/framework/tool/validate_type.h"
+#include "mediapipe/util/tflite/tflite_model_cache.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/register.h"
@@ -120,4 +121,189 @@ TEST_F(TfLiteInferenceCalculatorTest, SmokeTest) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+// Tests that the input tensors of consecutive packets, which are bound to the
+// interpreter with "bind_cpu_input" instead of being copied, are all used.
+TEST_F(TfLiteInferenceCalculatorTest, UsesBuffersOfEachInput) {
+  const int num_elements = 8 * 8 * 3;
+
+  CalculatorGraphConfig graph_config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+          R"(
+            input_stream: "tensor_in"
+            node {
+              calculator: "TfLiteInferenceCalculator"
+              input_stream: "TENSORS:tensor_in"
+              output_stream: "TENSORS:tensor_out"
+              options {
+                [mediapipe.TfLiteInferenceCalculatorOptions.ext] {
+                  use_gpu: false
+                  model_path: "mediapipe/calculators/tflite/testdata/add.bin"
+                  bind_cpu_input: true
+                }
+              }
+            }
+          )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // The input buffers of both packets are alive until the graph is done.
+  std::vector<std::vector<float>> buffers(2);
+  for (int i = 0; i < buffers.size(); ++i) {
+    buffers[i].assign(num_elements, i + 1);
+    TfLiteTensor tensor = {};
+    tensor.type = kTfLiteFloat32;
+    tensor.data.f = buffers[i].data();
+    tensor.bytes = num_elements * sizeof(float);
+    auto input_vec = absl::make_unique<std::vector<TfLiteTensor>>();
+    input_vec->push_back(tensor);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    ASSERT_EQ(i + 1, output_packets.size());
+
+    const std::vector<TfLiteTensor>& result_vec =
+        output_packets[i].Get<std::vector<TfLiteTensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    const float* result_buffer = result_vec[0].data.f;
+    ASSERT_NE(result_buffer, nullptr);
+    for (int j = 0; j < num_elements; ++j) {
+      ASSERT_EQ(3 * (i + 1), result_buffer[j]);
+    }
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Tests that inputs are processed by several interpreters in parallel, and
+// that the outputs keep the order of the inputs.
+TEST_F(TfLiteInferenceCalculatorTest, RunsInterpretersInParallel) {
+  const int num_elements = 8 * 8 * 3;
+  const int num_packets = 16;
+
+  CalculatorGraphConfig graph_config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+          R"(
+            input_stream: "tensor_in"
+            num_threads: 4
+            node {
+              calculator: "TfLiteInferenceCalculator"
+              input_stream: "TENSORS:tensor_in"
+              output_stream: "TENSORS:tensor_out"
+              input_stream_handler {
+                input_stream_handler: "DefaultInputStreamHandler"
+              }
+              max_in_flight: 3
+              options {
+                [mediapipe.TfLiteInferenceCalculatorOptions.ext] {
+                  model_path: "mediapipe/calculators/tflite/testdata/add.bin"
+                  cpu_num_thread: 2
+                  num_interpreters: 3
+                }
+              }
+            }
+          )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // Each packet has a distinct input.  All outputs are held until the end, so
+  // they must not share the buffers of the interpreters.
+  std::vector<std::vector<float>> buffers(num_packets);
+  for (int i = 0; i < num_packets; ++i) {
+    buffers[i].assign(num_elements, i + 1);
+    TfLiteTensor tensor = {};
+    tensor.type = kTfLiteFloat32;
+    tensor.data.f = buffers[i].data();
+    tensor.bytes = num_elements * sizeof(float);
+    auto input_vec = absl::make_unique<std::vector<TfLiteTensor>>();
+    input_vec->push_back(tensor);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  ASSERT_EQ(num_packets, output_packets.size());
+  for (int i = 0; i < num_packets; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets[i].Timestamp());
+    const std::vector<TfLiteTensor>& result_vec =
+        output_packets[i].Get<std::vector<TfLiteTensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(3 * (i + 1), result_vec[0].data.f[0]);
+    EXPECT_EQ(3 * (i + 1), result_vec[0].data.f[num_elements - 1]);
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Tests that graphs given a model cache share its model and interpreters.
+TEST_F(TfLiteInferenceCalculatorTest, SharesInterpretersOfModelCache) {
+  const std::string model_path =
+      "mediapipe/calculators/tflite/testdata/add.bin";
+  const int num_elements = 8 * 8 * 3;
+  auto cache = std::make_shared<TfLiteModelCache>();
+
+  CalculatorGraphConfig graph_config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+          R"(
+            input_stream: "tensor_in"
+            node {
+              calculator: "TfLiteInferenceCalculator"
+              input_stream: "TENSORS:tensor_in"
+              output_stream: "TENSORS:tensor_out"
+              options {
+                [mediapipe.TfLiteInferenceCalculatorOptions.ext] {
+                  model_path: "mediapipe/calculators/tflite/testdata/add.bin"
+                  num_interpreters: 2
+                }
+              }
+            }
+          )");
+  std::vector<float> buffer(num_elements, 1);
+  TfLiteTensor tensor = {};
+  tensor.type = kTfLiteFloat32;
+  tensor.data.f = buffer.data();
+  tensor.bytes = num_elements * sizeof(float);
+  for (int run = 0; run < 2; ++run) {
+    CalculatorGraphConfig config = graph_config;
+    std::vector<Packet> output_packets;
+    tool::AddVectorSink("tensor_out", &config, &output_packets);
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.SetServiceObject(kTfLiteModelCacheService, cache));
+    MP_ASSERT_OK(graph.Initialize(config));
+    MP_ASSERT_OK(graph.StartRun({}));
+
+    auto input_vec = absl::make_unique<std::vector<TfLiteTensor>>();
+    input_vec->push_back(tensor);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(0))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    // The second run reuses the interpreters of the first one.
+    EXPECT_EQ(0, cache->NumIdleInterpreters());
+    ASSERT_EQ(1, output_packets.size());
+    const std::vector<TfLiteTensor>& result_vec =
+        output_packets[0].Get<std::vector<TfLiteTensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(3, result_vec[0].data.f[0]);
+
+    MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+    MP_ASSERT_OK(graph.WaitUntilDone());
+  }
+  EXPECT_EQ(2, cache->NumIdleInterpreters());
+
+  // The idle interpreters keep the model loaded.
+  auto status_or_model = cache->GetModel(model_path);
+  MP_ASSERT_OK(status_or_model.status());
+  std::shared_ptr<tflite::FlatBufferModel> model =
+      std::move(status_or_model).ValueOrDie();
+  EXPECT_EQ(3, model.use_count());
+  cache->ReleaseIdleInterpreters();
+  EXPECT_EQ(0, cache->NumIdleInterpreters());
+  EXPECT_EQ(1, model.use_count());
+}
+
 }  // namespace mediapipe
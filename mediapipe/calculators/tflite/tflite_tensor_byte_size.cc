@@ -0,0 +1,41 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Registers the byte size of std::vector<TfLiteTensor> packets, so that the
+// tensors buffered in input streams count towards
+// CalculatorGraphConfig.max_buffered_bytes.
+
+#include <vector>
+
+#include "mediapipe/framework/packet_byte_size.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+
+namespace {
+
+int64 TensorsByteSize(const std::vector<TfLiteTensor>& tensors) {
+  int64 bytes = 0;
+  for (const TfLiteTensor& tensor : tensors) {
+    bytes += tensor.bytes;
+  }
+  return bytes;
+}
+
+}  // namespace
+
+REGISTER_PACKET_BYTE_SIZE(std::vector<TfLiteTensor>, TensorsByteSize);
+
+}  // namespace mediapipe
@@ -0,0 +1,144 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Registers a SharedMemorySerializer for std::vector<TfLiteTensor> packets,
+// so that the output tensors of a TfLiteInferenceCalculator can be passed to
+// another process with SharedMemorySinkCalculator.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "mediapipe/framework/deps/cleanup.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/shared_memory_serializer.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The maximum number of dimensions of a serialized tensor.
+constexpr int kMaxDims = 8;
+
+// The alignment of the tensor data, as in the TfLite arena.
+constexpr int64 kTensorAlignment = 64;
+
+// Describes one tensor.  The records of all tensors follow the number of
+// tensors, and are followed by the data of the tensors.
+struct TensorRecord {
+  int32 type;
+  int32 num_dims;
+  int32 dims[kMaxDims];
+  float scale;
+  int32 zero_point;
+  int64 bytes;
+  int64 data_offset;
+};
+
+int64 AlignTensorOffset(int64 offset) {
+  return (offset + kTensorAlignment - 1) / kTensorAlignment * kTensorAlignment;
+}
+
+// Copies the tensors into the buffer.  The tensors of packets read from the
+// buffer point to their data in place, as read-only memory-mapped tensors.
+class TfLiteTensorVectorSerializer : public SharedMemorySerializer {
+ public:
+  ::mediapipe::Status Write(const Packet& packet, uint8* buffer,
+                            int64 capacity, int64* size) const override {
+    const auto& tensors = packet.Get<std::vector<TfLiteTensor>>();
+    const int64 num_tensors = tensors.size();
+    int64 offset =
+        AlignTensorOffset(sizeof(num_tensors) +
+                          num_tensors * sizeof(TensorRecord));
+    RET_CHECK_LE(offset, capacity);
+    memcpy(buffer, &num_tensors, sizeof(num_tensors));
+    TensorRecord* records =
+        reinterpret_cast<TensorRecord*>(buffer + sizeof(num_tensors));
+    for (int i = 0; i < num_tensors; ++i) {
+      const TfLiteTensor& tensor = tensors[i];
+      RET_CHECK(tensor.dims && tensor.dims->size <= kMaxDims)
+          << "Tensors with more than " << kMaxDims
+          << " dimensions are not supported.";
+      RET_CHECK(tensor.data.raw || tensor.bytes == 0)
+          << "Tensor " << i << " has no data on the CPU.";
+      RET_CHECK_LE(offset + static_cast<int64>(tensor.bytes), capacity)
+          << "The tensors do not fit into a shared memory slot.";
+      TensorRecord& record = records[i];
+      record = {};
+      record.type = tensor.type;
+      record.num_dims = tensor.dims->size;
+      std::copy_n(tensor.dims->data, tensor.dims->size, record.dims);
+      record.scale = tensor.params.scale;
+      record.zero_point = tensor.params.zero_point;
+      record.bytes = tensor.bytes;
+      record.data_offset = offset;
+      memcpy(buffer + offset, tensor.data.raw, tensor.bytes);
+      offset = AlignTensorOffset(offset + tensor.bytes);
+    }
+    *size = offset;
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::StatusOr<Packet> Read(
+      const uint8* buffer, int64 size,
+      std::function<void()> release) const override {
+    // The slot is released if the payload is rejected.
+    auto release_on_error = MakeCleanup(release);
+    int64 num_tensors;
+    RET_CHECK_GE(size, sizeof(num_tensors));
+    memcpy(&num_tensors, buffer, sizeof(num_tensors));
+    RET_CHECK_LE(sizeof(num_tensors) + num_tensors * sizeof(TensorRecord),
+                 size);
+    const TensorRecord* records =
+        reinterpret_cast<const TensorRecord*>(buffer + sizeof(num_tensors));
+    for (int i = 0; i < num_tensors; ++i) {
+      RET_CHECK(records[i].num_dims >= 0 && records[i].num_dims <= kMaxDims);
+      RET_CHECK_LE(records[i].data_offset + records[i].bytes, size);
+    }
+
+    release_on_error.release();
+    auto* tensors = new std::vector<TfLiteTensor>(num_tensors);
+    for (int i = 0; i < num_tensors; ++i) {
+      const TensorRecord& record = records[i];
+      TfLiteTensor& tensor = (*tensors)[i];
+      tensor.type = static_cast<TfLiteType>(record.type);
+      tensor.dims = TfLiteIntArrayCreate(record.num_dims);
+      std::copy_n(record.dims, record.num_dims, tensor.dims->data);
+      tensor.params.scale = record.scale;
+      tensor.params.zero_point = record.zero_point;
+      tensor.bytes = record.bytes;
+      tensor.data.raw =
+          const_cast<char*>(reinterpret_cast<const char*>(buffer)) +
+          record.data_offset;
+      tensor.allocation_type = kTfLiteMmapRo;
+    }
+    return PointToForeign(tensors, [tensors, release]() {
+      for (TfLiteTensor& tensor : *tensors) {
+        TfLiteIntArrayFree(tensor.dims);
+      }
+      delete tensors;
+      release();
+    });
+  }
+};
+REGISTER_SHARED_MEMORY_SERIALIZER(std::vector<TfLiteTensor>,
+                                  TfLiteTensorVectorSerializer);
+
+}  // namespace
+
+}  // namespace mediapipe
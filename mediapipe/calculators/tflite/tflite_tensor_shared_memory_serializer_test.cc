@@ -0,0 +1,135 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/shared_memory_serializer.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns a tensor of "type" with "dims" whose data is at "data".
+TfLiteTensor MakeTensor(TfLiteType type, const std::vector<int>& dims,
+                        void* data, size_t bytes) {
+  TfLiteTensor tensor;
+  memset(&tensor, 0, sizeof(tensor));
+  tensor.type = type;
+  tensor.dims = TfLiteIntArrayCreate(dims.size());
+  for (int i = 0; i < dims.size(); ++i) {
+    tensor.dims->data[i] = dims[i];
+  }
+  tensor.data.raw = static_cast<char*>(data);
+  tensor.bytes = bytes;
+  return tensor;
+}
+
+class TfLiteTensorSharedMemorySerializerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    float_data_ = {1.0f, -2.0f, 3.5f, 4.0f, 0.0f, 6.25f};
+    byte_data_ = {0, 7, 128, 255};
+    tensors_.push_back(MakeTensor(kTfLiteFloat32, {1, 2, 3}, float_data_.data(),
+                                  float_data_.size() * sizeof(float)));
+    tensors_.push_back(
+        MakeTensor(kTfLiteUInt8, {4}, byte_data_.data(), byte_data_.size()));
+    tensors_[1].params.scale = 0.5f;
+    tensors_[1].params.zero_point = 3;
+  }
+
+  void TearDown() override {
+    for (TfLiteTensor& tensor : tensors_) {
+      TfLiteIntArrayFree(tensor.dims);
+    }
+  }
+
+  std::vector<float> float_data_;
+  std::vector<uint8> byte_data_;
+  std::vector<TfLiteTensor> tensors_;
+  alignas(64) uint8 buffer_[4096];
+};
+
+TEST_F(TfLiteTensorSharedMemorySerializerTest, ReadsTensorsInPlace) {
+  std::string type_name;
+  int64 size;
+  MP_ASSERT_OK(WriteSharedMemoryPacket(
+      MakePacket<std::vector<TfLiteTensor>>(tensors_), buffer_,
+      sizeof(buffer_), &type_name, &size));
+  EXPECT_LE(size, sizeof(buffer_));
+
+  bool released = false;
+  {
+    auto status_or_packet = ReadSharedMemoryPacket(
+        type_name, buffer_, size, [&released]() { released = true; });
+    MP_ASSERT_OK(status_or_packet.status());
+    Packet packet = status_or_packet.ValueOrDie();
+    const auto& tensors = packet.Get<std::vector<TfLiteTensor>>();
+    ASSERT_EQ(tensors_.size(), tensors.size());
+    for (int i = 0; i < tensors.size(); ++i) {
+      const TfLiteTensor& expected = tensors_[i];
+      const TfLiteTensor& tensor = tensors[i];
+      EXPECT_EQ(expected.type, tensor.type);
+      ASSERT_EQ(expected.dims->size, tensor.dims->size);
+      for (int d = 0; d < tensor.dims->size; ++d) {
+        EXPECT_EQ(expected.dims->data[d], tensor.dims->data[d]);
+      }
+      EXPECT_EQ(expected.params.scale, tensor.params.scale);
+      EXPECT_EQ(expected.params.zero_point, tensor.params.zero_point);
+      ASSERT_EQ(expected.bytes, tensor.bytes);
+      EXPECT_EQ(0, memcmp(expected.data.raw, tensor.data.raw, tensor.bytes));
+      // The data is read in place, aligned as in the TfLite arena.
+      EXPECT_GE(tensor.data.raw, reinterpret_cast<char*>(buffer_));
+      EXPECT_LT(tensor.data.raw, reinterpret_cast<char*>(buffer_) + size);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(tensor.data.raw) % 64);
+      EXPECT_EQ(kTfLiteMmapRo, tensor.allocation_type);
+    }
+    EXPECT_FALSE(released);
+  }
+  // The buffer is released with the last copy of the packet.
+  EXPECT_TRUE(released);
+}
+
+TEST_F(TfLiteTensorSharedMemorySerializerTest, FailsIfTensorsDoNotFit) {
+  std::string type_name;
+  int64 size;
+  EXPECT_FALSE(WriteSharedMemoryPacket(
+                   MakePacket<std::vector<TfLiteTensor>>(tensors_), buffer_,
+                   /*capacity=*/256, &type_name, &size)
+                   .ok());
+}
+
+TEST_F(TfLiteTensorSharedMemorySerializerTest, ReleasesTruncatedPayload) {
+  std::string type_name;
+  int64 size;
+  MP_ASSERT_OK(WriteSharedMemoryPacket(
+      MakePacket<std::vector<TfLiteTensor>>(tensors_), buffer_,
+      sizeof(buffer_), &type_name, &size));
+
+  // The payload is cut before the data of the last tensor, which takes the
+  // last aligned block.
+  bool released = false;
+  EXPECT_FALSE(ReadSharedMemoryPacket(type_name, buffer_, size - 64,
+                                      [&released]() { released = true; })
+                   .ok());
+  EXPECT_TRUE(released);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -21,9 +23,11 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/typed_stream.h"
 #include "tensorflow/lite/interpreter.h"
 
 #if defined(__ANDROID__)
@@ -48,6 +52,11 @@ namespace {
 constexpr int kNumInputTensorsWithAnchors = 3;
 constexpr int kNumCoordsPerBox = 4;
 
+constexpr StreamTag<std::vector<TfLiteTensor>> kTensorsTag("TENSORS");
+constexpr char kTensorsGpuTag[] = "TENSORS_GPU";
+constexpr StreamTag<std::vector<Detection>> kDetectionsTag("DETECTIONS");
+constexpr StreamTag<DetectionBatch> kDetectionBatchTag("DETECTION_BATCH");
+
 void ConvertRawValuesToAnchors(const float* raw_anchors, int num_boxes,
                                std::vector<Anchor>* anchors) {
   anchors->clear();
@@ -91,6 +100,7 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
 //  TENSORS_GPU - vector of GlBuffer.
 // Output:
 //  DETECTIONS - Result MediaPipe detections.
+//  DETECTION_BATCH - Result MediaPipe detections as a DetectionBatch.
 //
 // Usage example:
 // node {
@@ -120,10 +130,14 @@ class TfLiteTensorsToDetectionsCalculator : public CalculatorBase {
   ::mediapipe::Status Close(CalculatorContext* cc) override;
 
  private:
+  // The detections are appended to "output_detections" and "output_batch",
+  // either of which may be null.
   ::mediapipe::Status ProcessCPU(CalculatorContext* cc,
-                                 std::vector<Detection>* output_detections);
+                                 std::vector<Detection>* output_detections,
+                                 DetectionBatch* output_batch);
   ::mediapipe::Status ProcessGPU(CalculatorContext* cc,
-                                 std::vector<Detection>* output_detections);
+                                 std::vector<Detection>* output_detections,
+                                 DetectionBatch* output_batch);
 
   ::mediapipe::Status LoadOptions(CalculatorContext* cc);
   ::mediapipe::Status GlSetup(CalculatorContext* cc);
@@ -132,10 +146,14 @@ class TfLiteTensorsToDetectionsCalculator : public CalculatorBase {
                                   std::vector<float>* boxes);
   ::mediapipe::Status ConvertToDetections(
       const float* detection_boxes, const float* detection_scores,
-      const int* detection_classes, std::vector<Detection>* output_detections);
+      const int* detection_classes, std::vector<Detection>* output_detections,
+      DetectionBatch* output_batch);
   Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
                                float box_xmax, float score, int class_id,
                                bool flip_vertically);
+  // Appends the detection whose box and keypoints start at "box".
+  void AddToDetectionBatch(const float* box, float score, int class_id,
+                           DetectionBatch* output_batch);
 
   int num_classes_ = 0;
   int num_boxes_ = 0;
@@ -146,8 +164,13 @@ class TfLiteTensorsToDetectionsCalculator : public CalculatorBase {
   std::vector<Anchor> anchors_;
   bool side_packet_anchors_{};
 
+  TypedInput<std::vector<TfLiteTensor>> tensors_input_;
+  TypedOutput<std::vector<Detection>> detections_output_;
+  TypedOutput<DetectionBatch> detection_batch_output_;
+
 #if defined(__ANDROID__)
   mediapipe::GlCalculatorHelper gpu_helper_;
+  TypedInput<std::vector<GlBuffer>> gpu_tensors_input_;
   std::unique_ptr<GlProgram> decode_program_;
   std::unique_ptr<GlProgram> score_program_;
   std::unique_ptr<GlBuffer> decoded_boxes_buffer_;
@@ -167,19 +190,16 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
   RET_CHECK(!cc->Inputs().GetTags().empty());
   RET_CHECK(!cc->Outputs().GetTags().empty());
 
-  if (cc->Inputs().HasTag("TENSORS")) {
-    cc->Inputs().Tag("TENSORS").Set<std::vector<TfLiteTensor>>();
-  }
+  kTensorsTag.SetTypeIfPresent(&cc->Inputs());
 
 #if defined(__ANDROID__)
-  if (cc->Inputs().HasTag("TENSORS_GPU")) {
-    cc->Inputs().Tag("TENSORS_GPU").Set<std::vector<GlBuffer>>();
+  if (cc->Inputs().HasTag(kTensorsGpuTag)) {
+    cc->Inputs().Tag(kTensorsGpuTag).Set<std::vector<GlBuffer>>();
   }
 #endif
 
-  if (cc->Outputs().HasTag("DETECTIONS")) {
-    cc->Outputs().Tag("DETECTIONS").Set<std::vector<Detection>>();
-  }
+  kDetectionsTag.SetTypeIfPresent(&cc->Outputs());
+  kDetectionBatchTag.SetTypeIfPresent(&cc->Outputs());
 
   if (cc->InputSidePackets().UsesTags()) {
     if (cc->InputSidePackets().HasTag("ANCHORS")) {
@@ -198,13 +218,24 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
     CalculatorContext* cc) {
   cc->SetOffset(TimestampDiff(0));
 
-  if (cc->Inputs().HasTag("TENSORS_GPU")) {
+  if (cc->Inputs().HasTag(kTensorsGpuTag)) {
     gpu_input_ = true;
 #if defined(__ANDROID__)
     MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
 #endif
   }
 
+  tensors_input_ =
+      TypedInput<std::vector<TfLiteTensor>>(kTensorsTag, cc->Inputs());
+  detections_output_ =
+      TypedOutput<std::vector<Detection>>(kDetectionsTag, cc->Outputs());
+  detection_batch_output_ =
+      TypedOutput<DetectionBatch>(kDetectionBatchTag, cc->Outputs());
+#if defined(__ANDROID__)
+  gpu_tensors_input_ = TypedInput<std::vector<GlBuffer>>(
+      StreamTag<std::vector<GlBuffer>>(kTensorsGpuTag), cc->Inputs());
+#endif
+
   MP_RETURN_IF_ERROR(LoadOptions(cc));
   side_packet_anchors_ = cc->InputSidePackets().HasTag("ANCHORS");
 
@@ -217,33 +248,51 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
 
 ::mediapipe::Status TfLiteTensorsToDetectionsCalculator::Process(
     CalculatorContext* cc) {
-  if ((!gpu_input_ && cc->Inputs().Tag("TENSORS").IsEmpty()) ||
-      (gpu_input_ && cc->Inputs().Tag("TENSORS_GPU").IsEmpty())) {
+#if defined(__ANDROID__)
+  const bool input_empty = gpu_input_ ? gpu_tensors_input_.IsEmpty(cc)
+                                      : tensors_input_.IsEmpty(cc);
+#else
+  const bool input_empty = tensors_input_.IsEmpty(cc);
+#endif
+  if (input_empty) {
     return ::mediapipe::OkStatus();
   }
 
-  auto output_detections = absl::make_unique<std::vector<Detection>>();
+  // Each output is only filled in if it is consumed.
+  std::unique_ptr<std::vector<Detection>> output_detections;
+  if (detections_output_.IsConnected()) {
+    output_detections = absl::make_unique<std::vector<Detection>>();
+  }
+  std::unique_ptr<DetectionBatch> output_batch;
+  if (detection_batch_output_.IsConnected()) {
+    output_batch = absl::make_unique<DetectionBatch>(options_.num_keypoints());
+  }
 
   if (gpu_input_) {
-    MP_RETURN_IF_ERROR(ProcessGPU(cc, output_detections.get()));
+    MP_RETURN_IF_ERROR(
+        ProcessGPU(cc, output_detections.get(), output_batch.get()));
   } else {
-    MP_RETURN_IF_ERROR(ProcessCPU(cc, output_detections.get()));
+    MP_RETURN_IF_ERROR(
+        ProcessCPU(cc, output_detections.get(), output_batch.get()));
   }  // if gpu_input_
 
   // Output
-  if (cc->Outputs().HasTag("DETECTIONS")) {
-    cc->Outputs()
-        .Tag("DETECTIONS")
-        .Add(output_detections.release(), cc->InputTimestamp());
+  if (output_detections) {
+    detections_output_.Add(cc, std::move(output_detections),
+                           cc->InputTimestamp());
+  }
+  if (output_batch) {
+    detection_batch_output_.Add(cc, std::move(output_batch),
+                                cc->InputTimestamp());
   }
 
   return ::mediapipe::OkStatus();
 }
 
 ::mediapipe::Status TfLiteTensorsToDetectionsCalculator::ProcessCPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
-  const auto& input_tensors =
-      cc->Inputs().Tag("TENSORS").Get<std::vector<TfLiteTensor>>();
+    CalculatorContext* cc, std::vector<Detection>* output_detections,
+    DetectionBatch* output_batch) {
+  const auto& input_tensors = tensors_input_.Get(cc);
 
   if (input_tensors.size() == 2) {
     // Postprocessing on CPU for model without postprocessing op. E.g. output
@@ -316,9 +365,9 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
       detection_classes[i] = class_id;
     }
 
-    MP_RETURN_IF_ERROR(
-        ConvertToDetections(boxes.data(), detection_scores.data(),
-                            detection_classes.data(), output_detections));
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        boxes.data(), detection_scores.data(), detection_classes.data(),
+        output_detections, output_batch));
   } else {
     // Postprocessing on CPU with postprocessing op (e.g. anchor decoding and
     // non-maximum suppression) within the model.
@@ -350,17 +399,17 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
       detection_classes[i] =
           static_cast<int>(detection_classes_tensor->data.f[i]);
     }
-    MP_RETURN_IF_ERROR(ConvertToDetections(detection_boxes, detection_scores,
-                                           detection_classes.data(),
-                                           output_detections));
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        detection_boxes, detection_scores, detection_classes.data(),
+        output_detections, output_batch));
   }
   return ::mediapipe::OkStatus();
 }
 ::mediapipe::Status TfLiteTensorsToDetectionsCalculator::ProcessGPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
+    CalculatorContext* cc, std::vector<Detection>* output_detections,
+    DetectionBatch* output_batch) {
 #if defined(__ANDROID__)
-  const auto& input_tensors =
-      cc->Inputs().Tag("TENSORS_GPU").Get<std::vector<GlBuffer>>();
+  const auto& input_tensors = gpu_tensors_input_.Get(cc);
 
   // Copy inputs.
   tflite::gpu::gl::CopyBuffer(input_tensors[0], *raw_boxes_buffer_.get());
@@ -419,9 +468,9 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
     detection_scores[i] = score_class_id_pairs[i * 2];
     detection_classes[i] = static_cast<int>(score_class_id_pairs[i * 2 + 1]);
   }
-  MP_RETURN_IF_ERROR(ConvertToDetections(boxes.data(), detection_scores.data(),
-                                         detection_classes.data(),
-                                         output_detections));
+  MP_RETURN_IF_ERROR(ConvertToDetections(
+      boxes.data(), detection_scores.data(), detection_classes.data(),
+      output_detections, output_batch));
 #else
   LOG(ERROR) << "GPU input on non-Android not supported yet.";
 #endif  // defined(__ANDROID__)
@@ -535,13 +584,21 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
 
 ::mediapipe::Status TfLiteTensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
-    const int* detection_classes, std::vector<Detection>* output_detections) {
+    const int* detection_classes, std::vector<Detection>* output_detections,
+    DetectionBatch* output_batch) {
   for (int i = 0; i < num_boxes_; ++i) {
     if (options_.has_min_score_thresh() &&
         detection_scores[i] < options_.min_score_thresh()) {
       continue;
     }
     const int box_offset = i * num_coords_;
+    if (output_batch != nullptr) {
+      AddToDetectionBatch(detection_boxes + box_offset, detection_scores[i],
+                          detection_classes[i], output_batch);
+    }
+    if (output_detections == nullptr) {
+      continue;
+    }
     Detection detection = ConvertToDetection(
         detection_boxes[box_offset + 0], detection_boxes[box_offset + 1],
         detection_boxes[box_offset + 2], detection_boxes[box_offset + 3],
@@ -549,6 +606,8 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
     // Add keypoints.
     if (options_.num_keypoints() > 0) {
       auto* location_data = detection.mutable_location_data();
+      location_data->mutable_relative_keypoints()->Reserve(
+          options_.num_keypoints());
       for (int kp_id = 0; kp_id < options_.num_keypoints() *
                                       options_.num_values_per_keypoint();
            kp_id += options_.num_values_per_keypoint()) {
@@ -561,11 +620,31 @@ REGISTER_CALCULATOR(TfLiteTensorsToDetectionsCalculator);
                             : detection_boxes[keypoint_index + 1]);
       }
     }
-    output_detections->emplace_back(detection);
+    output_detections->emplace_back(std::move(detection));
   }
   return ::mediapipe::OkStatus();
 }
 
+void TfLiteTensorsToDetectionsCalculator::AddToDetectionBatch(
+    const float* box, float score, int class_id,
+    DetectionBatch* output_batch) {
+  const float box_ymin = box[0];
+  const float box_xmin = box[1];
+  const float box_ymax = box[2];
+  const float box_xmax = box[3];
+  const bool flip_vertically = options_.flip_vertically();
+  const int index = output_batch->Add(
+      box_xmin, flip_vertically ? 1.f - box_ymax : box_ymin,
+      box_xmax - box_xmin, box_ymax - box_ymin, score, class_id);
+  float* keypoints = output_batch->mutable_keypoints(index);
+  for (int k = 0; k < options_.num_keypoints(); ++k) {
+    const float* keypoint = box + options_.keypoint_coord_offset() +
+                            k * options_.num_values_per_keypoint();
+    keypoints[2 * k] = keypoint[0];
+    keypoints[2 * k + 1] = flip_vertically ? 1.f - keypoint[1] : keypoint[1];
+  }
+}
+
 Detection TfLiteTensorsToDetectionsCalculator::ConvertToDetection(
     float box_ymin, float box_xmin, float box_ymax, float box_xmax, float score,
     int class_id, bool flip_vertically) {
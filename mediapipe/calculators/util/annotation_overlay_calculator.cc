@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "mediapipe/calculators/util/annotation_overlay_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -24,6 +25,7 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/vector.h"
+#include "mediapipe/framework/typed_stream.h"
 #include "mediapipe/util/annotation_renderer.h"
 #include "mediapipe/util/color.pb.h"
 
@@ -38,8 +40,8 @@ namespace mediapipe {
 
 namespace {
 
-constexpr char kInputFrameTag[] = "INPUT_FRAME";
-constexpr char kOutputFrameTag[] = "OUTPUT_FRAME";
+constexpr StreamTag<ImageFrame> kInputFrameTag("INPUT_FRAME");
+constexpr StreamTag<ImageFrame> kOutputFrameTag("OUTPUT_FRAME");
 
 constexpr char kInputFrameTagGpu[] = "INPUT_FRAME_GPU";
 constexpr char kOutputFrameTagGpu[] = "OUTPUT_FRAME_GPU";
@@ -141,6 +143,11 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   // Number of input streams with render data.
   int num_render_streams_;
 
+  // Input streams with render data, and the image streams.
+  std::vector<TypedInput<RenderData>> render_data_inputs_;
+  TypedInput<ImageFrame> image_frame_input_;
+  TypedOutput<ImageFrame> image_frame_output_;
+
   // Indicates if image frame is available as input.
   bool image_frame_available_ = false;
 
@@ -148,6 +155,8 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   bool gpu_initialized_ = false;
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   mediapipe::GlCalculatorHelper gpu_helper_;
+  TypedInput<mediapipe::GpuBuffer> gpu_buffer_input_;
+  TypedOutput<mediapipe::GpuBuffer> gpu_buffer_output_;
   GLuint program_ = 0;
   GLuint image_mat_tex_ = 0;  // Overlay drawing image for GPU.
   int width_ = 0;
@@ -160,7 +169,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     CalculatorContract* cc) {
   CHECK_GE(cc->Inputs().NumEntries(), 1);
 
-  if (cc->Inputs().HasTag(kInputFrameTag) &&
+  if (kInputFrameTag.IsPresent(cc->Inputs()) &&
       cc->Inputs().HasTag(kInputFrameTagGpu)) {
     return ::mediapipe::InternalError("Cannot have multiple input images.");
   }
@@ -179,8 +188,8 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     num_render_streams = cc->Inputs().NumEntries() - 1;
   }
 #endif  // __ANDROID__ or iOS
-  if (cc->Inputs().HasTag(kInputFrameTag)) {
-    cc->Inputs().Tag(kInputFrameTag).Set<ImageFrame>();
+  if (kInputFrameTag.IsPresent(cc->Inputs())) {
+    kInputFrameTag.SetType(&cc->Inputs());
     num_render_streams = cc->Inputs().NumEntries() - 1;
   }
 
@@ -195,9 +204,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     cc->Outputs().Tag(kOutputFrameTagGpu).Set<mediapipe::GpuBuffer>();
   }
 #endif  // __ANDROID__ or iOS
-  if (cc->Outputs().HasTag(kOutputFrameTag)) {
-    cc->Outputs().Tag(kOutputFrameTag).Set<ImageFrame>();
-  }
+  kOutputFrameTag.SetTypeIfPresent(&cc->Outputs());
 
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
@@ -220,7 +227,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
   }
 
   if (cc->Inputs().HasTag(kInputFrameTagGpu) ||
-      cc->Inputs().HasTag(kInputFrameTag)) {
+      kInputFrameTag.IsPresent(cc->Inputs())) {
     image_frame_available_ = true;
     num_render_streams_ = cc->Inputs().NumEntries() - 1;
   } else {
@@ -230,13 +237,30 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     num_render_streams_ = cc->Inputs().NumEntries();
   }
 
+  // Resolve the streams once, so that Process() does no tag lookups.
+  render_data_inputs_.clear();
+  for (int i = 0; i < num_render_streams_; ++i) {
+    render_data_inputs_.emplace_back(StreamTag<RenderData>("", i),
+                                     cc->Inputs());
+  }
+  image_frame_input_ = TypedInput<ImageFrame>(kInputFrameTag, cc->Inputs());
+  image_frame_output_ =
+      TypedOutput<ImageFrame>(kOutputFrameTag, cc->Outputs());
+#if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
+  gpu_buffer_input_ = TypedInput<mediapipe::GpuBuffer>(
+      StreamTag<mediapipe::GpuBuffer>(kInputFrameTagGpu), cc->Inputs());
+  gpu_buffer_output_ = TypedOutput<mediapipe::GpuBuffer>(
+      StreamTag<mediapipe::GpuBuffer>(kOutputFrameTagGpu), cc->Outputs());
+#endif  // __ANDROID__ or iOS
+
   // Initialize the helper renderer library.
   renderer_ = absl::make_unique<AnnotationRenderer>();
   renderer_->SetFlipTextVertically(options_.flip_text_vertically());
 
   // Set the output header based on the input header (if present).
-  const char* input_tag = use_gpu_ ? kInputFrameTagGpu : kInputFrameTag;
-  const char* output_tag = use_gpu_ ? kOutputFrameTagGpu : kOutputFrameTag;
+  const char* input_tag = use_gpu_ ? kInputFrameTagGpu : kInputFrameTag.tag();
+  const char* output_tag =
+      use_gpu_ ? kOutputFrameTagGpu : kOutputFrameTag.tag();
   if (image_frame_available_ &&
       !cc->Inputs().Tag(input_tag).Header().IsEmpty()) {
     const auto& input_header =
@@ -279,11 +303,11 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
   renderer_->AdoptImage(image_mat.get());
 
   // Render streams onto render target.
-  for (int i = 0; i < num_render_streams_; ++i) {
-    if (cc->Inputs().Index(i).IsEmpty()) {
+  for (const TypedInput<RenderData>& render_data_input : render_data_inputs_) {
+    if (render_data_input.IsEmpty(cc)) {
       continue;
     }
-    const RenderData& render_data = cc->Inputs().Index(i).Get<RenderData>();
+    const RenderData& render_data = render_data_input.Get(cc);
 //    renderer_->RenderDataOnImage(render_data);
   }
 
@@ -335,9 +359,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
                               ImageFrame::kDefaultAlignmentBoundary);
 #endif  // __ANDROID__ or iOS
 
-  cc->Outputs()
-      .Tag(kOutputFrameTag)
-      .Add(output_frame.release(), cc->InputTimestamp());
+  image_frame_output_.Add(cc, std::move(output_frame), cc->InputTimestamp());
 
   return ::mediapipe::OkStatus();
 }
@@ -346,8 +368,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     CalculatorContext* cc, uchar* overlay_image) {
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   // Source and destination textures.
-  const auto& input_frame =
-      cc->Inputs().Tag(kInputFrameTagGpu).Get<mediapipe::GpuBuffer>();
+  const auto& input_frame = gpu_buffer_input_.Get(cc);
   auto input_texture = gpu_helper_.CreateSourceTexture(input_frame);
 
   auto output_texture = gpu_helper_.CreateDestinationTexture(
@@ -383,9 +404,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
 
   // Send out blended image as GPU packet.
   auto output_frame = output_texture.GetFrame<mediapipe::GpuBuffer>();
-  cc->Outputs()
-      .Tag(kOutputFrameTagGpu)
-      .Add(output_frame.release(), cc->InputTimestamp());
+  gpu_buffer_output_.Add(cc, std::move(output_frame), cc->InputTimestamp());
 
   // Cleanup
   input_texture.Release();
@@ -399,8 +418,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
     ImageFormat::Format* target_format) {
   if (image_frame_available_) {
-    const auto& input_frame =
-        cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>();
+    const auto& input_frame = image_frame_input_.Get(cc);
 
     int target_mat_type;
     switch (input_frame.Format()) {
@@ -453,8 +471,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
     CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat) {
 #if defined(__ANDROID__) || (defined(__APPLE__) && !TARGET_OS_OSX)
   if (image_frame_available_) {
-    const auto& input_frame =
-        cc->Inputs().Tag(kInputFrameTagGpu).Get<mediapipe::GpuBuffer>();
+    const auto& input_frame = gpu_buffer_input_.Get(cc);
 
     const mediapipe::ImageFormat::Format format =
         mediapipe::ImageFormatForGpuBufferFormat(input_frame.format());
@@ -591,8 +608,7 @@ REGISTER_CALCULATOR(AnnotationOverlayCalculator);
               kAnnotationBackgroundColor[2] / 255.0);
 
   // Init texture for opencv rendered frame.
-  const auto& input_frame =
-      cc->Inputs().Tag(kInputFrameTagGpu).Get<mediapipe::GpuBuffer>();
+  const auto& input_frame = gpu_buffer_input_.Get(cc);
   // Ensure GPU texture is divisible by 4. See b/138751944 for more info.
   width_ =
       RoundUp(input_frame.width(), ImageFrame::kGlDefaultAlignmentBoundary);
@@ -31,6 +31,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -39,6 +40,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 
 }  // namespace
@@ -61,6 +63,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   DETECTIONS: An std::vector<Detection> representing detections with their
 //   locations adjusted to the letterbox-removed (non-padded) image.
 //
+// Alternatively, the detections can be input and output as a DetectionBatch
+// on DETECTION_BATCH streams instead of DETECTIONS streams.
+//
 // Usage example:
 // node {
 //   calculator: "DetectionLetterboxRemovalCalculator"
@@ -71,15 +76,21 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 class DetectionLetterboxRemovalCalculator : public CalculatorBase {
  public:
   static ::mediapipe::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kDetectionsTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kDetectionsTag) ^
+               cc->Inputs().HasTag(kDetectionBatchTag)) &&
               cc->Inputs().HasTag(kLetterboxPaddingTag))
-        << "Missing one or more input streams.";
-
-    cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+        << "Exactly one of DETECTIONS and DETECTION_BATCH, and "
+           "LETTERBOX_PADDING must be specified.";
+
+    if (cc->Inputs().HasTag(kDetectionsTag)) {
+      cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+      cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+    } else {
+      cc->Inputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+      cc->Outputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+    }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
-    cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
-
     return ::mediapipe::OkStatus();
   }
 
@@ -90,6 +101,9 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
   }
 
   ::mediapipe::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+      return ProcessBatch(cc);
+    }
     // Only process if there's input detections.
     if (cc->Inputs().Tag(kDetectionsTag).IsEmpty()) {
       return ::mediapipe::OkStatus();
@@ -148,6 +162,54 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
         .Add(output_detections.release(), cc->InputTimestamp());
     return ::mediapipe::OkStatus();
   }
+
+ private:
+  ::mediapipe::Status ProcessBatch(CalculatorContext* cc) {
+    // Only process if there's input detections.
+    if (cc->Inputs().Tag(kDetectionBatchTag).IsEmpty()) {
+      return ::mediapipe::OkStatus();
+    }
+
+    const auto& letterbox_padding =
+        cc->Inputs().Tag(kLetterboxPaddingTag).Get<std::array<float, 4>>();
+    const float left = letterbox_padding[0];
+    const float top = letterbox_padding[1];
+    const float left_and_right = letterbox_padding[0] + letterbox_padding[2];
+    const float top_and_bottom = letterbox_padding[1] + letterbox_padding[3];
+
+    auto output_detections = absl::make_unique<DetectionBatch>(
+        cc->Inputs().Tag(kDetectionBatchTag).Get<DetectionBatch>());
+    const int num_detections = output_detections->size();
+    float* xmin = output_detections->mutable_xmin();
+    float* ymin = output_detections->mutable_ymin();
+    float* width = output_detections->mutable_width();
+    float* height = output_detections->mutable_height();
+    for (int i = 0; i < num_detections; ++i) {
+      xmin[i] = (xmin[i] - left) / (1.0f - left_and_right);
+      ymin[i] = (ymin[i] - top) / (1.0f - top_and_bottom);
+      // The size of the bounding box will change as well.
+      width[i] = width[i] / (1.0f - left_and_right);
+      height[i] = height[i] / (1.0f - top_and_bottom);
+    }
+
+    // Adjust keypoints as well.  The keypoints of all detections are stored
+    // contiguously as (x, y) pairs.
+    if (output_detections->num_keypoints() > 0) {
+      float* keypoints = output_detections->mutable_keypoints(0);
+      const int num_keypoints =
+          num_detections * output_detections->num_keypoints();
+      for (int k = 0; k < num_keypoints; ++k) {
+        keypoints[2 * k] = (keypoints[2 * k] - left) / (1.0f - left_and_right);
+        keypoints[2 * k + 1] =
+            (keypoints[2 * k + 1] - top) / (1.0f - top_and_bottom);
+      }
+    }
+
+    cc->Outputs()
+        .Tag(kDetectionBatchTag)
+        .Add(output_detections.release(), cc->InputTimestamp());
+    return ::mediapipe::OkStatus();
+  }
 };
 REGISTER_CALCULATOR(DetectionLetterboxRemovalCalculator);
 
@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -155,4 +156,46 @@ TEST(DetectionLetterboxRemovalCalculatorTest, PaddingTopBottom) {
               testing::FloatNear(0.5f, 1e-5));
 }
 
+TEST(DetectionLetterboxRemovalCalculatorTest, DetectionBatch) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "DetectionLetterboxRemovalCalculator"
+    input_stream: "DETECTION_BATCH:detections"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "DETECTION_BATCH:adjusted_detections"
+  )"));
+
+  auto detections = absl::make_unique<DetectionBatch>(/*num_keypoints=*/1);
+  const int index = detections->Add(0.25f, 0.25f, 0.25f, 0.25f, 0.3f, 2);
+  detections->mutable_keypoints(index)[0] = 0.5f;
+  detections->mutable_keypoints(index)[1] = 0.5f;
+  runner.MutableInputs()
+      ->Tag("DETECTION_BATCH")
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+
+  auto padding = absl::make_unique<std::array<float, 4>>(
+      std::array<float, 4>{0.2f, 0.2f, 0.3f, 0.3f});
+  runner.MutableInputs()
+      ->Tag("LETTERBOX_PADDING")
+      .packets.push_back(Adopt(padding.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag("DETECTION_BATCH").packets;
+  ASSERT_EQ(1, output.size());
+  const auto& output_detections = output[0].Get<DetectionBatch>();
+
+  ASSERT_EQ(output_detections.size(), 1);
+  EXPECT_EQ(output_detections.score()[0], 0.3f);
+  EXPECT_EQ(output_detections.label_id()[0], 2);
+  EXPECT_THAT(output_detections.xmin()[0], testing::FloatNear(0.1f, 1e-5));
+  EXPECT_THAT(output_detections.ymin()[0], testing::FloatNear(0.1f, 1e-5));
+  EXPECT_THAT(output_detections.width()[0], testing::FloatNear(0.5f, 1e-5));
+  EXPECT_THAT(output_detections.height()[0], testing::FloatNear(0.5f, 1e-5));
+  EXPECT_THAT(output_detections.keypoints(0)[0],
+              testing::FloatNear(0.6f, 1e-5));
+  EXPECT_THAT(output_detections.keypoints(0)[1],
+              testing::FloatNear(0.6f, 1e-5));
+}
+
 }  // namespace mediapipe
@@ -21,6 +21,7 @@
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/typed_stream.h"
 
 namespace mediapipe {
 
@@ -28,13 +29,13 @@ using mediapipe::DetectionsToRectsCalculatorOptions;
 
 namespace {
 
-constexpr char kDetectionTag[] = "DETECTION";
-constexpr char kDetectionsTag[] = "DETECTIONS";
-constexpr char kImageSizeTag[] = "IMAGE_SIZE";
-constexpr char kRectTag[] = "RECT";
-constexpr char kNormRectTag[] = "NORM_RECT";
-constexpr char kRectsTag[] = "RECTS";
-constexpr char kNormRectsTag[] = "NORM_RECTS";
+constexpr StreamTag<Detection> kDetectionTag("DETECTION");
+constexpr StreamTag<std::vector<Detection>> kDetectionsTag("DETECTIONS");
+constexpr StreamTag<std::pair<int, int>> kImageSizeTag("IMAGE_SIZE");
+constexpr StreamTag<Rect> kRectTag("RECT");
+constexpr StreamTag<NormalizedRect> kNormRectTag("NORM_RECT");
+constexpr StreamTag<std::vector<Rect>> kRectsTag("RECTS");
+constexpr StreamTag<std::vector<NormalizedRect>> kNormRectsTag("NORM_RECTS");
 
 ::mediapipe::Status DetectionToRect(const Detection& detection, Rect* rect) {
   const LocationData location_data = detection.location_data();
@@ -133,46 +134,39 @@ class DetectionsToRectsCalculator : public CalculatorBase {
   float target_angle_;  // In radians.
   bool rotate_;
   bool output_zero_rect_for_empty_detections_;
+
+  TypedInput<Detection> detection_input_;
+  TypedInput<std::vector<Detection>> detections_input_;
+  TypedInput<std::pair<int, int>> image_size_input_;
+  TypedOutput<Rect> rect_output_;
+  TypedOutput<NormalizedRect> norm_rect_output_;
+  TypedOutput<std::vector<Rect>> rects_output_;
+  TypedOutput<std::vector<NormalizedRect>> norm_rects_output_;
 };
 REGISTER_CALCULATOR(DetectionsToRectsCalculator);
 
 ::mediapipe::Status DetectionsToRectsCalculator::GetContract(
     CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kDetectionTag) ^
-            cc->Inputs().HasTag(kDetectionsTag))
+  RET_CHECK(kDetectionTag.IsPresent(cc->Inputs()) ^
+            kDetectionsTag.IsPresent(cc->Inputs()))
       << "Exactly one of DETECTION or DETECTIONS input stream should be "
          "provided.";
-  RET_CHECK_EQ((cc->Outputs().HasTag(kNormRectTag) ? 1 : 0) +
-                   (cc->Outputs().HasTag(kRectTag) ? 1 : 0) +
-                   (cc->Outputs().HasTag(kNormRectsTag) ? 1 : 0) +
-                   (cc->Outputs().HasTag(kRectsTag) ? 1 : 0),
+  RET_CHECK_EQ((kNormRectTag.IsPresent(cc->Outputs()) ? 1 : 0) +
+                   (kRectTag.IsPresent(cc->Outputs()) ? 1 : 0) +
+                   (kNormRectsTag.IsPresent(cc->Outputs()) ? 1 : 0) +
+                   (kRectsTag.IsPresent(cc->Outputs()) ? 1 : 0),
                1)
       << "Exactly one of NORM_RECT, RECT, NORM_RECTS or RECTS output stream "
          "should be provided.";
 
-  if (cc->Inputs().HasTag(kDetectionTag)) {
-    cc->Inputs().Tag(kDetectionTag).Set<Detection>();
-  }
-  if (cc->Inputs().HasTag(kDetectionsTag)) {
-    cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
-  }
-  if (cc->Inputs().HasTag(kImageSizeTag)) {
-    cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
-  }
-
-  if (cc->Outputs().HasTag(kRectTag)) {
-    cc->Outputs().Tag(kRectTag).Set<Rect>();
-  }
-  if (cc->Outputs().HasTag(kNormRectTag)) {
-    cc->Outputs().Tag(kNormRectTag).Set<NormalizedRect>();
-  }
-  if (cc->Outputs().HasTag(kRectsTag)) {
-    cc->Outputs().Tag(kRectsTag).Set<std::vector<Rect>>();
-  }
-  if (cc->Outputs().HasTag(kNormRectsTag)) {
-    cc->Outputs().Tag(kNormRectsTag).Set<std::vector<NormalizedRect>>();
-  }
+  kDetectionTag.SetTypeIfPresent(&cc->Inputs());
+  kDetectionsTag.SetTypeIfPresent(&cc->Inputs());
+  kImageSizeTag.SetTypeIfPresent(&cc->Inputs());
 
+  kRectTag.SetTypeIfPresent(&cc->Outputs());
+  kNormRectTag.SetTypeIfPresent(&cc->Outputs());
+  kRectsTag.SetTypeIfPresent(&cc->Outputs());
+  kNormRectsTag.SetTypeIfPresent(&cc->Outputs());
   return ::mediapipe::OkStatus();
 }
 
@@ -181,11 +175,22 @@ REGISTER_CALCULATOR(DetectionsToRectsCalculator);
 
   options_ = cc->Options<DetectionsToRectsCalculatorOptions>();
 
+  detection_input_ = TypedInput<Detection>(kDetectionTag, cc->Inputs());
+  detections_input_ =
+      TypedInput<std::vector<Detection>>(kDetectionsTag, cc->Inputs());
+  image_size_input_ =
+      TypedInput<std::pair<int, int>>(kImageSizeTag, cc->Inputs());
+  rect_output_ = TypedOutput<Rect>(kRectTag, cc->Outputs());
+  norm_rect_output_ = TypedOutput<NormalizedRect>(kNormRectTag, cc->Outputs());
+  rects_output_ = TypedOutput<std::vector<Rect>>(kRectsTag, cc->Outputs());
+  norm_rects_output_ =
+      TypedOutput<std::vector<NormalizedRect>>(kNormRectsTag, cc->Outputs());
+
   if (options_.has_rotation_vector_start_keypoint_index()) {
     RET_CHECK(options_.has_rotation_vector_end_keypoint_index());
     RET_CHECK(options_.has_rotation_vector_target_angle() ^
               options_.has_rotation_vector_target_angle_degrees());
-    RET_CHECK(cc->Inputs().HasTag(kImageSizeTag));
+    RET_CHECK(image_size_input_.IsConnected());
 
     if (options_.has_rotation_vector_target_angle()) {
       target_angle_ = options_.rotation_vector_target_angle();
@@ -206,90 +211,80 @@ REGISTER_CALCULATOR(DetectionsToRectsCalculator);
 
 ::mediapipe::Status DetectionsToRectsCalculator::Process(
     CalculatorContext* cc) {
-  if (cc->Inputs().HasTag(kDetectionTag) &&
-      cc->Inputs().Tag(kDetectionTag).IsEmpty()) {
-    return ::mediapipe::OkStatus();
-  }
-  if (cc->Inputs().HasTag(kDetectionsTag) &&
-      cc->Inputs().Tag(kDetectionsTag).IsEmpty()) {
+  // Exactly one of the detection inputs is connected.
+  if (detection_input_.IsConnected() ? detection_input_.IsEmpty(cc)
+                                     : detections_input_.IsEmpty(cc)) {
     return ::mediapipe::OkStatus();
   }
 
-  std::vector<Detection> detections;
-  if (cc->Inputs().HasTag(kDetectionTag)) {
-    detections.push_back(cc->Inputs().Tag(kDetectionTag).Get<Detection>());
-  }
-  if (cc->Inputs().HasTag(kDetectionsTag)) {
-    detections = cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>();
-    if (detections.empty()) {
+  std::vector<Detection> single_detection;
+  const std::vector<Detection>* detections = &single_detection;
+  if (detection_input_.IsConnected()) {
+    single_detection.push_back(detection_input_.Get(cc));
+  } else {
+    detections = &detections_input_.Get(cc);
+    if (detections->empty()) {
       if (output_zero_rect_for_empty_detections_) {
-        if (cc->Outputs().HasTag(kRectTag)) {
-          cc->Outputs().Tag(kRectTag).AddPacket(
-              MakePacket<Rect>().At(cc->InputTimestamp()));
+        if (rect_output_.IsConnected()) {
+          rect_output_.Add(cc, Rect(), cc->InputTimestamp());
         }
-        if (cc->Outputs().HasTag(kNormRectTag)) {
-          cc->Outputs()
-              .Tag(kNormRectTag)
-              .AddPacket(MakePacket<NormalizedRect>().At(cc->InputTimestamp()));
+        if (norm_rect_output_.IsConnected()) {
+          norm_rect_output_.Add(cc, NormalizedRect(), cc->InputTimestamp());
         }
       }
       return ::mediapipe::OkStatus();
     }
   }
+  const Detection& first_detection = detections->front();
 
   std::pair<int, int> image_size;
   if (rotate_) {
-    RET_CHECK(!cc->Inputs().Tag(kImageSizeTag).IsEmpty());
-    image_size = cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+    RET_CHECK(!image_size_input_.IsEmpty(cc));
+    image_size = image_size_input_.Get(cc);
   }
 
-  if (cc->Outputs().HasTag(kRectTag)) {
+  if (rect_output_.IsConnected()) {
     auto output_rect = absl::make_unique<Rect>();
-    MP_RETURN_IF_ERROR(DetectionToRect(detections[0], output_rect.get()));
+    MP_RETURN_IF_ERROR(DetectionToRect(first_detection, output_rect.get()));
     if (rotate_) {
-      output_rect->set_rotation(ComputeRotation(detections[0], image_size));
+      output_rect->set_rotation(ComputeRotation(first_detection, image_size));
     }
-    cc->Outputs().Tag(kRectTag).Add(output_rect.release(),
-                                    cc->InputTimestamp());
+    rect_output_.Add(cc, std::move(output_rect), cc->InputTimestamp());
   }
-  if (cc->Outputs().HasTag(kNormRectTag)) {
+  if (norm_rect_output_.IsConnected()) {
     auto output_rect = absl::make_unique<NormalizedRect>();
     MP_RETURN_IF_ERROR(
-        DetectionToNormalizedRect(detections[0], output_rect.get()));
+        DetectionToNormalizedRect(first_detection, output_rect.get()));
     if (rotate_) {
-      output_rect->set_rotation(ComputeRotation(detections[0], image_size));
+      output_rect->set_rotation(ComputeRotation(first_detection, image_size));
     }
-    cc->Outputs()
-        .Tag(kNormRectTag)
-        .Add(output_rect.release(), cc->InputTimestamp());
+    norm_rect_output_.Add(cc, std::move(output_rect), cc->InputTimestamp());
   }
-  if (cc->Outputs().HasTag(kRectsTag)) {
-    auto output_rects = absl::make_unique<std::vector<Rect>>(detections.size());
-    for (int i = 0; i < detections.size(); ++i) {
+  if (rects_output_.IsConnected()) {
+    auto output_rects =
+        absl::make_unique<std::vector<Rect>>(detections->size());
+    for (int i = 0; i < detections->size(); ++i) {
       MP_RETURN_IF_ERROR(
-          DetectionToRect(detections[i], &(output_rects->at(i))));
+          DetectionToRect((*detections)[i], &(output_rects->at(i))));
       if (rotate_) {
         output_rects->at(i).set_rotation(
-            ComputeRotation(detections[i], image_size));
+            ComputeRotation((*detections)[i], image_size));
       }
     }
-    cc->Outputs().Tag(kRectsTag).Add(output_rects.release(),
-                                     cc->InputTimestamp());
+    rects_output_.Add(cc, std::move(output_rects), cc->InputTimestamp());
   }
-  if (cc->Outputs().HasTag(kNormRectsTag)) {
+  if (norm_rects_output_.IsConnected()) {
     auto output_rects =
-        absl::make_unique<std::vector<NormalizedRect>>(detections.size());
-    for (int i = 0; i < detections.size(); ++i) {
-      MP_RETURN_IF_ERROR(
-          DetectionToNormalizedRect(detections[i], &(output_rects->at(i))));
+        absl::make_unique<std::vector<NormalizedRect>>(detections->size());
+    for (int i = 0; i < detections->size(); ++i) {
+      MP_RETURN_IF_ERROR(DetectionToNormalizedRect((*detections)[i],
+                                                   &(output_rects->at(i))));
       if (rotate_) {
         output_rects->at(i).set_rotation(
-            ComputeRotation(detections[i], image_size));
+            ComputeRotation((*detections)[i], image_size));
       }
     }
-    cc->Outputs()
-        .Tag(kNormRectsTag)
-        .Add(output_rects.release(), cc->InputTimestamp());
+    norm_rects_output_.Add(cc, std::move(output_rects), cc->InputTimestamp());
   }
 
   return ::mediapipe::OkStatus();
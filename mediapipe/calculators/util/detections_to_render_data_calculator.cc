@@ -12,13 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "absl/memory/memory.h"
+#include <memory>
+#include <utility>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "mediapipe/calculators/util/detections_to_render_data_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
@@ -29,6 +32,7 @@ namespace {
 
 constexpr char kDetectionsTag[] = "DETECTIONS";
 constexpr char kDetectionListTag[] = "DETECTION_LIST";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
 
 constexpr char kSceneLabelLabel[] = "LABEL";
@@ -46,7 +50,7 @@ constexpr double kLabelToBoundingBoxRatio = 0.1;
 // visualization.
 //
 // Detection is the format for encoding one or more detections in an image.
-// The input can be std::vector<Detection> or DetectionList.
+// The input can be std::vector<Detection>, DetectionList or DetectionBatch.
 //
 // Please note that only Location Data formats of BOUNDING_BOX and
 // RELATIVE_BOUNDING_BOX are supported. Normalized coordinates for
@@ -121,7 +125,8 @@ REGISTER_CALCULATOR(DetectionsToRenderDataCalculator);
 ::mediapipe::Status DetectionsToRenderDataCalculator::GetContract(
     CalculatorContract* cc) {
   RET_CHECK(cc->Inputs().HasTag(kDetectionListTag) ||
-            cc->Inputs().HasTag(kDetectionsTag))
+            cc->Inputs().HasTag(kDetectionsTag) ||
+            cc->Inputs().HasTag(kDetectionBatchTag))
       << "None of the input streams are provided.";
 
   if (cc->Inputs().HasTag(kDetectionListTag)) {
@@ -130,6 +135,9 @@ REGISTER_CALCULATOR(DetectionsToRenderDataCalculator);
   if (cc->Inputs().HasTag(kDetectionsTag)) {
     cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
   }
+  if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+    cc->Inputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+  }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
   return ::mediapipe::OkStatus();
 }
@@ -153,30 +161,46 @@ REGISTER_CALCULATOR(DetectionsToRenderDataCalculator);
   const bool has_detection_from_vector =
       cc->Inputs().HasTag(kDetectionsTag) &&
       !cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>().empty();
+  const bool has_detection_from_batch =
+      cc->Inputs().HasTag(kDetectionBatchTag) &&
+      !cc->Inputs().Tag(kDetectionBatchTag).IsEmpty() &&
+      !cc->Inputs().Tag(kDetectionBatchTag).Get<DetectionBatch>().empty();
   if (!options.produce_empty_packet() && !has_detection_from_list &&
-      !has_detection_from_vector) {
+      !has_detection_from_vector && !has_detection_from_batch) {
     return ::mediapipe::OkStatus();
   }
 
   // TODO: Add score threshold to
   // DetectionsToRenderDataCalculatorOptions.
-  auto render_data = absl::make_unique<RenderData>();
+  // The render data and its annotations are allocated on one arena, owned by
+  // the output packet.
+  auto arena = std::make_shared<proto_ns::Arena>();
+  auto* render_data = proto_ns::Arena::CreateMessage<RenderData>(arena.get());
   render_data->set_scene_class(options.scene_class());
   if (has_detection_from_list) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionListTag).Get<DetectionList>().detection()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
     }
   }
   if (has_detection_from_vector) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
+    }
+  }
+  if (has_detection_from_batch) {
+    const auto& detections =
+        cc->Inputs().Tag(kDetectionBatchTag).Get<DetectionBatch>();
+    for (int i = 0; i < detections.size(); ++i) {
+      AddDetectionToRenderData(detections.GetDetection(i), options,
+                               render_data);
     }
   }
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(AdoptOnArena(render_data, std::move(arena))
+                     .At(cc->InputTimestamp()));
   return ::mediapipe::OkStatus();
 }
 
@@ -31,6 +31,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -38,6 +39,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kLandmarkArrayTag[] = "NORM_LANDMARK_ARRAY";
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 
 }  // namespace
@@ -60,6 +62,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   LANDMARKS: An std::vector<NormalizedLandmark> representing landmarks with
 //   their locations adjusted to the letterbox-removed (non-padded) image.
 //
+// Alternatively, the landmarks can be input and output as a LandmarkArray on
+// NORM_LANDMARK_ARRAY streams instead of LANDMARKS streams.
+//
 // Usage example:
 // node {
 //   calculator: "LandmarkLetterboxRemovalCalculator"
@@ -70,15 +75,21 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
  public:
   static ::mediapipe::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kLandmarksTag) ^
+               cc->Inputs().HasTag(kLandmarkArrayTag)) &&
               cc->Inputs().HasTag(kLetterboxPaddingTag))
-        << "Missing one or more input streams.";
-
-    cc->Inputs().Tag(kLandmarksTag).Set<std::vector<Landmark>>();
+        << "Exactly one of LANDMARKS and NORM_LANDMARK_ARRAY, and "
+           "LETTERBOX_PADDING must be specified.";
+
+    if (cc->Inputs().HasTag(kLandmarksTag)) {
+      cc->Inputs().Tag(kLandmarksTag).Set<std::vector<Landmark>>();
+      cc->Outputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
+    } else {
+      cc->Inputs().Tag(kLandmarkArrayTag).Set<LandmarkArray>();
+      cc->Outputs().Tag(kLandmarkArrayTag).Set<LandmarkArray>();
+    }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
-    cc->Outputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
-
     return ::mediapipe::OkStatus();
   }
 
@@ -89,6 +100,9 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
   }
 
   ::mediapipe::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kLandmarkArrayTag)) {
+      return ProcessLandmarkArray(cc);
+    }
     // Only process if there's input landmarks.
     if (cc->Inputs().Tag(kLandmarksTag).IsEmpty()) {
       return ::mediapipe::OkStatus();
@@ -127,6 +141,37 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
         .Add(output_landmarks.release(), cc->InputTimestamp());
     return ::mediapipe::OkStatus();
   }
+
+ private:
+  ::mediapipe::Status ProcessLandmarkArray(CalculatorContext* cc) {
+    // Only process if there's input landmarks.
+    if (cc->Inputs().Tag(kLandmarkArrayTag).IsEmpty()) {
+      return ::mediapipe::OkStatus();
+    }
+
+    const auto& letterbox_padding =
+        cc->Inputs().Tag(kLetterboxPaddingTag).Get<std::array<float, 4>>();
+    const float left = letterbox_padding[0];
+    const float top = letterbox_padding[1];
+    const float left_and_right = letterbox_padding[0] + letterbox_padding[2];
+    const float top_and_bottom = letterbox_padding[1] + letterbox_padding[3];
+
+    // Keep z-coords as they are.
+    auto output_landmarks = absl::make_unique<LandmarkArray>(
+        cc->Inputs().Tag(kLandmarkArrayTag).Get<LandmarkArray>());
+    const int num_landmarks = output_landmarks->size();
+    float* x = output_landmarks->mutable_x();
+    float* y = output_landmarks->mutable_y();
+    for (int i = 0; i < num_landmarks; ++i) {
+      x[i] = (x[i] - left) / (1.0f - left_and_right);
+      y[i] = (y[i] - top) / (1.0f - top_and_bottom);
+    }
+
+    cc->Outputs()
+        .Tag(kLandmarkArrayTag)
+        .Add(output_landmarks.release(), cc->InputTimestamp());
+    return ::mediapipe::OkStatus();
+  }
 };
 REGISTER_CALCULATOR(LandmarkLetterboxRemovalCalculator);
 
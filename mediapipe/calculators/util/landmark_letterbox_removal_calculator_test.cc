@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -108,4 +109,41 @@ TEST(LandmarkLetterboxRemovalCalculatorTest, PaddingTopBottom) {
   EXPECT_THAT(output_landmarks[2].y(), testing::FloatNear(1.0f, 1e-5));
 }
 
+TEST(LandmarkLetterboxRemovalCalculatorTest, LandmarkArray) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "LandmarkLetterboxRemovalCalculator"
+    input_stream: "NORM_LANDMARK_ARRAY:landmarks"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "NORM_LANDMARK_ARRAY:adjusted_landmarks"
+  )"));
+
+  auto landmarks = absl::make_unique<LandmarkArray>();
+  landmarks->Add(0.5f, 0.5f, 0.1f);
+  landmarks->Add(0.2f, 0.2f, 0.2f);
+  runner.MutableInputs()
+      ->Tag("NORM_LANDMARK_ARRAY")
+      .packets.push_back(
+          Adopt(landmarks.release()).At(Timestamp::PostStream()));
+
+  auto padding = absl::make_unique<std::array<float, 4>>(
+      std::array<float, 4>{0.2f, 0.2f, 0.3f, 0.3f});
+  runner.MutableInputs()
+      ->Tag("LETTERBOX_PADDING")
+      .packets.push_back(Adopt(padding.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag("NORM_LANDMARK_ARRAY").packets;
+  ASSERT_EQ(1, output.size());
+  const auto& output_landmarks = output[0].Get<LandmarkArray>();
+
+  ASSERT_EQ(output_landmarks.size(), 2);
+  EXPECT_THAT(output_landmarks.x()[0], testing::FloatNear(0.6f, 1e-5));
+  EXPECT_THAT(output_landmarks.y()[0], testing::FloatNear(0.6f, 1e-5));
+  EXPECT_THAT(output_landmarks.z()[0], testing::FloatNear(0.1f, 1e-5));
+  EXPECT_THAT(output_landmarks.x()[1], testing::FloatNear(0.0f, 1e-5));
+  EXPECT_THAT(output_landmarks.y()[1], testing::FloatNear(0.0f, 1e-5));
+  EXPECT_THAT(output_landmarks.z()[1], testing::FloatNear(0.2f, 1e-5));
+}
+
 }  // namespace mediapipe
@@ -32,6 +32,7 @@
 #include "mediapipe/calculators/util/landmark_projection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -40,6 +41,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kLandmarkArrayTag[] = "NORM_LANDMARK_ARRAY";
 constexpr char kRectTag[] = "NORM_RECT";
 
 }  // namespace
@@ -56,6 +58,9 @@ constexpr char kRectTag[] = "NORM_RECT";
 //   NORM_LANDMARKS: An std::vector<NormalizedLandmark> representing landmarks
 //                   with their locations adjusted to the image.
 //
+// Alternatively, the landmarks can be input and output as a LandmarkArray on
+// NORM_LANDMARK_ARRAY streams instead of NORM_LANDMARKS streams.
+//
 // Usage example:
 // node {
 //   calculator: "LandmarkProjectionCalculator"
@@ -66,15 +71,21 @@ constexpr char kRectTag[] = "NORM_RECT";
 class LandmarkProjectionCalculator : public CalculatorBase {
  public:
   static ::mediapipe::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kLandmarksTag) ^
+               cc->Inputs().HasTag(kLandmarkArrayTag)) &&
               cc->Inputs().HasTag(kRectTag))
-        << "Missing one or more input streams.";
-
-    cc->Inputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
+        << "Exactly one of NORM_LANDMARKS and NORM_LANDMARK_ARRAY, and "
+           "NORM_RECT must be specified.";
+
+    if (cc->Inputs().HasTag(kLandmarksTag)) {
+      cc->Inputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
+      cc->Outputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
+    } else {
+      cc->Inputs().Tag(kLandmarkArrayTag).Set<LandmarkArray>();
+      cc->Outputs().Tag(kLandmarkArrayTag).Set<LandmarkArray>();
+    }
     cc->Inputs().Tag(kRectTag).Set<NormalizedRect>();
 
-    cc->Outputs().Tag(kLandmarksTag).Set<std::vector<NormalizedLandmark>>();
-
     return ::mediapipe::OkStatus();
   }
 
@@ -85,6 +96,9 @@ class LandmarkProjectionCalculator : public CalculatorBase {
   }
 
   ::mediapipe::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kLandmarkArrayTag)) {
+      return ProcessLandmarkArray(cc);
+    }
     const auto& options =
         cc->Options<::mediapipe::LandmarkProjectionCalculatorOptions>();
     // Only process if there's input landmarks.
@@ -129,6 +143,41 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         .Add(output_landmarks.release(), cc->InputTimestamp());
     return ::mediapipe::OkStatus();
   }
+
+ private:
+  ::mediapipe::Status ProcessLandmarkArray(CalculatorContext* cc) {
+    const auto& options =
+        cc->Options<::mediapipe::LandmarkProjectionCalculatorOptions>();
+    // Only process if there's input landmarks.
+    if (cc->Inputs().Tag(kLandmarkArrayTag).IsEmpty()) {
+      return ::mediapipe::OkStatus();
+    }
+
+    const auto& input_rect = cc->Inputs().Tag(kRectTag).Get<NormalizedRect>();
+    const float angle = options.ignore_rotation() ? 0 : input_rect.rotation();
+    const float cos_angle = std::cos(angle);
+    const float sin_angle = std::sin(angle);
+
+    // Keep z-coords as they are.
+    auto output_landmarks = absl::make_unique<LandmarkArray>(
+        cc->Inputs().Tag(kLandmarkArrayTag).Get<LandmarkArray>());
+    const int num_landmarks = output_landmarks->size();
+    float* x = output_landmarks->mutable_x();
+    float* y = output_landmarks->mutable_y();
+    for (int i = 0; i < num_landmarks; ++i) {
+      const float centered_x = x[i] - 0.5f;
+      const float centered_y = y[i] - 0.5f;
+      const float rotated_x = cos_angle * centered_x - sin_angle * centered_y;
+      const float rotated_y = sin_angle * centered_x + cos_angle * centered_y;
+      x[i] = rotated_x * input_rect.width() + input_rect.x_center();
+      y[i] = rotated_y * input_rect.height() + input_rect.y_center();
+    }
+
+    cc->Outputs()
+        .Tag(kLandmarkArrayTag)
+        .Add(output_landmarks.release(), cc->InputTimestamp());
+    return ::mediapipe::OkStatus();
+  }
 };
 REGISTER_CALCULATOR(LandmarkProjectionCalculator);
 
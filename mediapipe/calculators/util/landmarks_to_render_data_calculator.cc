@@ -12,13 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "absl/memory/memory.h"
+#include <memory>
+#include <utility>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "mediapipe/calculators/util/landmarks_to_render_data_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
@@ -29,6 +32,7 @@ namespace {
 
 constexpr char kLandmarksTag[] = "LANDMARKS";
 constexpr char kNormLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kNormLandmarkArrayTag[] = "NORM_LANDMARK_ARRAY";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
 constexpr char kLandmarkLabel[] = "KEYPOINT";
 constexpr int kMaxLandmarkThickness = 18;
@@ -50,13 +54,24 @@ template <class LandmarkType>
 inline void GetMinMaxZ(const std::vector<LandmarkType>& landmarks, float* z_min,
                        float* z_max) {
   *z_min = std::numeric_limits<float>::max();
-  *z_max = std::numeric_limits<float>::min();
+  *z_max = std::numeric_limits<float>::lowest();
   for (const auto& landmark : landmarks) {
     *z_min = std::min(landmark.z(), *z_min);
     *z_max = std::max(landmark.z(), *z_max);
   }
 }
 
+inline void GetMinMaxZ(const LandmarkArray& landmarks, float* z_min,
+                       float* z_max) {
+  *z_min = std::numeric_limits<float>::max();
+  *z_max = std::numeric_limits<float>::lowest();
+  const float* z = landmarks.z();
+  for (int i = 0; i < landmarks.size(); ++i) {
+    *z_min = std::min(z[i], *z_min);
+    *z_max = std::max(z[i], *z_max);
+  }
+}
+
 void SetColorSizeValueFromZ(float z, float z_min, float z_max,
                             RenderAnnotation* render_annotation) {
   const int color_value = 255 - static_cast<int>(Remap(z, z_min, z_max, 255));
@@ -74,7 +89,8 @@ void SetColorSizeValueFromZ(float z, float z_min, float z_max,
 
 // A calculator that converts Landmark proto to RenderData proto for
 // visualization. The input should be std::vector<Landmark>. It is also possible
-// to specify the connections between landmarks.
+// to specify the connections between landmarks. Normalized landmarks can also
+// be input as a LandmarkArray on the NORM_LANDMARK_ARRAY stream.
 //
 // Example config:
 // node {
@@ -121,11 +137,11 @@ class LandmarksToRenderDataCalculator : public CalculatorBase {
       const LandmarksToRenderDataCalculatorOptions& options, bool normalized,
       int gray_val1, int gray_val2, RenderData* render_data);
 
-  template <class LandmarkType>
-  void AddConnections(const std::vector<LandmarkType>& landmarks,
-                      bool normalized, RenderData* render_data);
-  template <class LandmarkType>
-  void AddConnectionsWithDepth(const std::vector<LandmarkType>& landmarks,
+  template <class LandmarkListType>
+  void AddConnections(const LandmarkListType& landmarks, bool normalized,
+                      RenderData* render_data);
+  template <class LandmarkListType>
+  void AddConnectionsWithDepth(const LandmarkListType& landmarks,
                                bool normalized, float min_z, float max_z,
                                RenderData* render_data);
 
@@ -135,11 +151,12 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
 
 ::mediapipe::Status LandmarksToRenderDataCalculator::GetContract(
     CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) ||
-            cc->Inputs().HasTag(kNormLandmarksTag))
+  const int num_landmark_inputs = cc->Inputs().HasTag(kLandmarksTag) +
+                                  cc->Inputs().HasTag(kNormLandmarksTag) +
+                                  cc->Inputs().HasTag(kNormLandmarkArrayTag);
+  RET_CHECK(num_landmark_inputs > 0)
       << "None of the input streams are provided.";
-  RET_CHECK(!(cc->Inputs().HasTag(kLandmarksTag) &&
-              cc->Inputs().HasTag(kNormLandmarksTag)))
+  RET_CHECK(num_landmark_inputs == 1)
       << "Can only one type of landmark can be taken. Either absolute or "
          "normalized landmarks.";
 
@@ -149,6 +166,9 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
   if (cc->Inputs().HasTag(kNormLandmarksTag)) {
     cc->Inputs().Tag(kNormLandmarksTag).Set<std::vector<NormalizedLandmark>>();
   }
+  if (cc->Inputs().HasTag(kNormLandmarkArrayTag)) {
+    cc->Inputs().Tag(kNormLandmarkArrayTag).Set<LandmarkArray>();
+  }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
   return ::mediapipe::OkStatus();
 }
@@ -163,7 +183,10 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
 
 ::mediapipe::Status LandmarksToRenderDataCalculator::Process(
     CalculatorContext* cc) {
-  auto render_data = absl::make_unique<RenderData>();
+  // The render data and its annotations are allocated on one arena, owned by
+  // the output packet.
+  auto arena = std::make_shared<proto_ns::Arena>();
+  auto* render_data = proto_ns::Arena::CreateMessage<RenderData>(arena.get());
   bool visualize_depth = options_.visualize_landmark_depth();
   float z_min = 0.f;
   float z_max = 0.f;
@@ -179,8 +202,7 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
     // Only change rendering if there are actually z values other than 0.
     visualize_depth &= ((z_max - z_min) > 1e-3);
     for (const auto& landmark : landmarks) {
-      auto* landmark_data_render =
-          AddPointRenderData(options_, render_data.get());
+      auto* landmark_data_render = AddPointRenderData(options_, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max,
                                landmark_data_render);
@@ -192,9 +214,9 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
     }
     if (visualize_depth) {
       AddConnectionsWithDepth(landmarks, /*normalized=*/false, z_min, z_max,
-                              render_data.get());
+                              render_data);
     } else {
-      AddConnections(landmarks, /*normalized=*/false, render_data.get());
+      AddConnections(landmarks, /*normalized=*/false, render_data);
     }
   }
 
@@ -210,8 +232,7 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
     // Only change rendering if there are actually z values other than 0.
     visualize_depth &= ((z_max - z_min) > 1e-3);
     for (const auto& landmark : landmarks) {
-      auto* landmark_data_render =
-          AddPointRenderData(options_, render_data.get());
+      auto* landmark_data_render = AddPointRenderData(options_, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max,
                                landmark_data_render);
@@ -223,21 +244,51 @@ REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
     }
     if (visualize_depth) {
       AddConnectionsWithDepth(landmarks, /*normalized=*/true, z_min, z_max,
-                              render_data.get());
+                              render_data);
     } else {
-      AddConnections(landmarks, /*normalized=*/true, render_data.get());
+      AddConnections(landmarks, /*normalized=*/true, render_data);
+    }
+  }
+
+  if (cc->Inputs().HasTag(kNormLandmarkArrayTag)) {
+    const auto& landmarks =
+        cc->Inputs().Tag(kNormLandmarkArrayTag).Get<LandmarkArray>();
+    RET_CHECK_EQ(options_.landmark_connections_size() % 2, 0)
+        << "Number of entries in landmark connections must be a multiple of 2";
+    if (visualize_depth) {
+      GetMinMaxZ(landmarks, &z_min, &z_max);
+    }
+    // Only change rendering if there are actually z values other than 0.
+    visualize_depth &= ((z_max - z_min) > 1e-3);
+    for (int i = 0; i < landmarks.size(); ++i) {
+      auto* landmark_data_render = AddPointRenderData(options_, render_data);
+      if (visualize_depth) {
+        SetColorSizeValueFromZ(landmarks.z()[i], z_min, z_max,
+                               landmark_data_render);
+      }
+      auto* landmark_data = landmark_data_render->mutable_point();
+      landmark_data->set_normalized(true);
+      landmark_data->set_x(landmarks.x()[i]);
+      landmark_data->set_y(landmarks.y()[i]);
+    }
+    if (visualize_depth) {
+      AddConnectionsWithDepth(landmarks, /*normalized=*/true, z_min, z_max,
+                              render_data);
+    } else {
+      AddConnections(landmarks, /*normalized=*/true, render_data);
     }
   }
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(AdoptOnArena(render_data, std::move(arena))
+                     .At(cc->InputTimestamp()));
   return ::mediapipe::OkStatus();
 }
 
-template <class LandmarkType>
+template <class LandmarkListType>
 void LandmarksToRenderDataCalculator::AddConnectionsWithDepth(
-    const std::vector<LandmarkType>& landmarks, bool normalized, float min_z,
+    const LandmarkListType& landmarks, bool normalized, float min_z,
     float max_z, RenderData* render_data) {
   for (int i = 0; i < options_.landmark_connections_size(); i += 2) {
     const auto& ld0 = landmarks[options_.landmark_connections(i)];
@@ -272,9 +323,9 @@ void LandmarksToRenderDataCalculator::AddConnectionToRenderData(
   connection_annotation->set_thickness(options.thickness());
 }
 
-template <class LandmarkType>
+template <class LandmarkListType>
 void LandmarksToRenderDataCalculator::AddConnections(
-    const std::vector<LandmarkType>& landmarks, bool normalized,
+    const LandmarkListType& landmarks, bool normalized,
     RenderData* render_data) {
   for (int i = 0; i < options_.landmark_connections_size(); i += 2) {
     const auto& ld0 = landmarks[options_.landmark_connections(i)];
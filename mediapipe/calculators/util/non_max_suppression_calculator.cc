@@ -21,6 +21,7 @@
 #include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/logging.h"
@@ -35,6 +36,7 @@ typedef std::vector<std::pair<int, float>> IndexedScores;
 namespace {
 
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
 
 bool SortBySecond(const std::pair<int, float>& indexed_score_0,
                   const std::pair<int, float>& indexed_score_1) {
@@ -119,6 +121,49 @@ float OverlapSimilarity(
   return OverlapSimilarity(overlap_type, rect1, rect2);
 }
 
+// Computes an overlap similarity between the relative boxes of the detections
+// at "index1" and "index2" in "detections", as the above overlap similarity
+// between two rectangles.
+float OverlapSimilarity(
+    const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
+    const DetectionBatch& detections, int index1, int index2) {
+  const float xmin1 = detections.xmin()[index1];
+  const float ymin1 = detections.ymin()[index1];
+  const float width1 = detections.width()[index1];
+  const float height1 = detections.height()[index1];
+  const float xmin2 = detections.xmin()[index2];
+  const float ymin2 = detections.ymin()[index2];
+  const float width2 = detections.width()[index2];
+  const float height2 = detections.height()[index2];
+  const float xmax1 = xmin1 + width1;
+  const float ymax1 = ymin1 + height1;
+  const float xmax2 = xmin2 + width2;
+  const float ymax2 = ymin2 + height2;
+  if (width1 < 0.0f || height1 < 0.0f || width2 < 0.0f || height2 < 0.0f ||
+      xmax2 < xmin1 || xmax1 < xmin2 || ymax2 < ymin1 || ymax1 < ymin2) {
+    return 0.0f;
+  }
+  const float intersection_area =
+      (std::min(xmax1, xmax2) - std::max(xmin1, xmin2)) *
+      (std::min(ymax1, ymax2) - std::max(ymin1, ymin2));
+  float normalization = 0.0f;
+  switch (overlap_type) {
+    case NonMaxSuppressionCalculatorOptions::JACCARD:
+      normalization = (std::max(xmax1, xmax2) - std::min(xmin1, xmin2)) *
+                      (std::max(ymax1, ymax2) - std::min(ymin1, ymin2));
+      break;
+    case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+      normalization = width2 * height2;
+      break;
+    case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
+      normalization = width1 * height1 + width2 * height2 - intersection_area;
+      break;
+    default:
+      LOG(FATAL) << "Unrecognized overlap type: " << overlap_type;
+  }
+  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
+}
+
 }  // namespace
 
 // A calculator performing non-maximum suppression on a set of detections.
@@ -133,6 +178,11 @@ float OverlapSimilarity(
 // Outputs: a single stream of type std::vector<Detection> containing a subset
 //   of the input detections after non-maximum suppression.
 //
+// Alternatively, a single DETECTION_BATCH input stream of type DetectionBatch
+// can be specified instead of the above input streams, in which case the
+// result is output as a DetectionBatch on the DETECTION_BATCH output stream.
+// The boxes of a DetectionBatch are relative, so IMAGE is not needed.
+//
 // Example config:
 // node {
 //   calculator: "NonMaxSuppressionCalculator"
@@ -159,6 +209,11 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     if (cc->Inputs().HasTag(kImageTag)) {
       cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
     }
+    if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+      cc->Inputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+      cc->Outputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+      return ::mediapipe::OkStatus();
+    }
     for (int k = 0; k < options.num_detection_streams(); ++k) {
       cc->Inputs().Index(k).Set<Detections>();
     }
@@ -180,6 +235,9 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
   ::mediapipe::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+      return ProcessBatch(cc);
+    }
     // Add all input detections to the same vector.
     Detections input_detections;
     for (int i = 0; i < options_.num_detection_streams(); ++i) {
@@ -209,7 +267,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     pruned_detections.reserve(input_detections.size());
     for (auto& detection : input_detections) {
       if (RetainMaxScoringLabelOnly(&detection)) {
-        pruned_detections.push_back(detection);
+        pruned_detections.push_back(std::move(detection));
       }
     }
 
@@ -238,7 +296,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
       WeightedNonMaxSuppression(indexed_scores, pruned_detections,
                                 max_num_detections, cc, retained_detections);
     } else {
-      NonMaxSuppression(indexed_scores, pruned_detections, max_num_detections,
+      NonMaxSuppression(indexed_scores, &pruned_detections, max_num_detections,
                         cc, retained_detections);
     }
 
@@ -248,14 +306,153 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
  private:
+  ::mediapipe::Status ProcessBatch(CalculatorContext* cc) {
+    if (cc->Inputs().Tag(kDetectionBatchTag).IsEmpty()) {
+      return ::mediapipe::OkStatus();
+    }
+    const auto& detections =
+        cc->Inputs().Tag(kDetectionBatchTag).Get<DetectionBatch>();
+    if (detections.empty() && !options_.return_empty_detections()) {
+      return ::mediapipe::OkStatus();
+    }
+
+    // Each detection in a batch has a single score, so no label pruning is
+    // needed before sorting the detections by score.
+    IndexedScores indexed_scores(detections.size());
+    for (int index = 0; index < detections.size(); ++index) {
+      indexed_scores[index] = std::make_pair(index, detections.score()[index]);
+    }
+    std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+
+    const int max_num_detections =
+        (options_.max_num_detections() > -1)
+            ? options_.max_num_detections()
+            : static_cast<int>(indexed_scores.size());
+    auto* retained_detections = new DetectionBatch(detections.num_keypoints());
+    retained_detections->Reserve(
+        std::min<int>(max_num_detections, detections.size()));
+    if (options_.algorithm() == NonMaxSuppressionCalculatorOptions::WEIGHTED) {
+      WeightedNonMaxSuppression(indexed_scores, detections,
+                                retained_detections);
+    } else {
+      NonMaxSuppression(indexed_scores, detections, max_num_detections,
+                        retained_detections);
+    }
+
+    cc->Outputs()
+        .Tag(kDetectionBatchTag)
+        .Add(retained_detections, cc->InputTimestamp());
+    return ::mediapipe::OkStatus();
+  }
+
+  void NonMaxSuppression(const IndexedScores& indexed_scores,
+                         const DetectionBatch& detections,
+                         int max_num_detections,
+                         DetectionBatch* output_detections) {
+    std::vector<int> retained_indices;
+    retained_indices.reserve(max_num_detections);
+    // We traverse the detections by decreasing score.
+    for (const auto& indexed_score : indexed_scores) {
+      const int index = indexed_score.first;
+      if (options_.min_score_threshold() > 0 &&
+          detections.score()[index] < options_.min_score_threshold()) {
+        break;
+      }
+      bool suppressed = false;
+      for (const int retained_index : retained_indices) {
+        if (OverlapSimilarity(options_.overlap_type(), detections,
+                              retained_index, index) >
+            options_.min_suppression_threshold()) {
+          suppressed = true;
+          break;
+        }
+      }
+      if (!suppressed) {
+        output_detections->AddFrom(detections, index);
+        retained_indices.push_back(index);
+      }
+      if (output_detections->size() >= max_num_detections) {
+        break;
+      }
+    }
+  }
+
+  void WeightedNonMaxSuppression(const IndexedScores& indexed_scores,
+                                 const DetectionBatch& detections,
+                                 DetectionBatch* output_detections) {
+    IndexedScores remained_indexed_scores(indexed_scores);
+    IndexedScores remained;
+    IndexedScores candidates;
+    const int num_keypoints = detections.num_keypoints();
+    std::vector<float> keypoints(num_keypoints * 2);
+    while (!remained_indexed_scores.empty()) {
+      const int index = remained_indexed_scores[0].first;
+      if (options_.min_score_threshold() > 0 &&
+          detections.score()[index] < options_.min_score_threshold()) {
+        break;
+      }
+
+      remained.clear();
+      candidates.clear();
+      // This includes the first box.
+      for (const auto& indexed_score : remained_indexed_scores) {
+        float similarity = OverlapSimilarity(options_.overlap_type(),
+                                             detections, indexed_score.first,
+                                             index);
+        if (similarity > options_.min_suppression_threshold()) {
+          candidates.push_back(indexed_score);
+        } else {
+          remained.push_back(indexed_score);
+        }
+      }
+      const int weighted_index = output_detections->AddFrom(detections, index);
+      if (!candidates.empty()) {
+        std::fill(keypoints.begin(), keypoints.end(), 0.0f);
+        float w_xmin = 0.0f;
+        float w_ymin = 0.0f;
+        float w_xmax = 0.0f;
+        float w_ymax = 0.0f;
+        float total_score = 0.0f;
+        for (const auto& candidate : candidates) {
+          const int i = candidate.first;
+          const float score = candidate.second;
+          total_score += score;
+          w_xmin += detections.xmin()[i] * score;
+          w_ymin += detections.ymin()[i] * score;
+          w_xmax += (detections.xmin()[i] + detections.width()[i]) * score;
+          w_ymax += (detections.ymin()[i] + detections.height()[i]) * score;
+          const float* candidate_keypoints = detections.keypoints(i);
+          for (int k = 0; k < num_keypoints * 2; ++k) {
+            keypoints[k] += candidate_keypoints[k] * score;
+          }
+        }
+        const float xmin = w_xmin / total_score;
+        const float ymin = w_ymin / total_score;
+        output_detections->mutable_xmin()[weighted_index] = xmin;
+        output_detections->mutable_ymin()[weighted_index] = ymin;
+        output_detections->mutable_width()[weighted_index] =
+            (w_xmax / total_score) - xmin;
+        output_detections->mutable_height()[weighted_index] =
+            (w_ymax / total_score) - ymin;
+        float* weighted_keypoints =
+            output_detections->mutable_keypoints(weighted_index);
+        for (int k = 0; k < num_keypoints * 2; ++k) {
+          weighted_keypoints[k] = keypoints[k] / total_score;
+        }
+      }
+      remained_indexed_scores = std::move(remained);
+    }
+  }
+
+  // Moves the retained detections out of "detections".
   void NonMaxSuppression(const IndexedScores& indexed_scores,
-                         const Detections& detections, int max_num_detections,
+                         Detections* detections, int max_num_detections,
                          CalculatorContext* cc, Detections* output_detections) {
     std::vector<Location> retained_locations;
     retained_locations.reserve(max_num_detections);
     // We traverse the detections by decreasing score.
     for (const auto& indexed_score : indexed_scores) {
-      const auto& detection = detections[indexed_score.first];
+      auto& detection = (*detections)[indexed_score.first];
       if (options_.min_score_threshold() > 0 &&
           detection.score(0) < options_.min_score_threshold()) {
         break;
@@ -282,7 +479,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
         }
       }
       if (!suppressed) {
-        output_detections->push_back(detection);
+        output_detections->push_back(std::move(detection));
         retained_locations.push_back(location);
       }
       if (output_detections->size() >= max_num_detections) {
@@ -366,7 +563,7 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
         }
       }
       remained_indexed_scores = std::move(remained);
-      output_detections->push_back(weighted_detection);
+      output_detections->push_back(std::move(weighted_detection));
     }
   }
 
@@ -0,0 +1,45 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs the benchmarks linked into the binary.  Results are reported as JSON
+// on stdout unless --benchmark_format is given, so that they can be recorded
+// per revision and compared with benchmark's tools/compare.py.  For example:
+//   bazel run -c opt //mediapipe/framework/benchmarks:packet_benchmark \
+//       > packet_benchmark.json
+
+#include <cstring>
+#include <vector>
+
+#include "mediapipe/framework/port/benchmark.h"
+
+int main(int argc, char** argv) {
+  static char kJsonFormat[] = "--benchmark_format=json";
+  std::vector<char*> args(argv, argv + argc);
+  bool has_format = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--benchmark_format", 18) == 0) {
+      has_format = true;
+    }
+  }
+  if (!has_format) {
+    args.insert(args.begin() + 1, kJsonFormat);
+  }
+  int args_count = args.size();
+  benchmark::Initialize(&args_count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
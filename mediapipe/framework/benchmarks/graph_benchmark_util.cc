@@ -0,0 +1,59 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/benchmarks/graph_benchmark_util.h"
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace benchmarks {
+
+void RunGraphBenchmark(const CalculatorGraphConfig& config, int num_packets,
+                       benchmark::State* state) {
+  CalculatorGraph graph;
+  MEDIAPIPE_CHECK_OK(graph.Initialize(config));
+  for (auto _ : *state) {
+    MEDIAPIPE_CHECK_OK(graph.StartRun({}));
+    for (int i = 0; i < num_packets; ++i) {
+      for (const std::string& stream : config.input_stream()) {
+        MEDIAPIPE_CHECK_OK(graph.AddPacketToInputStream(
+            stream, MakePacket<int>(i).At(Timestamp(i))));
+      }
+    }
+    MEDIAPIPE_CHECK_OK(graph.CloseAllInputStreams());
+    MEDIAPIPE_CHECK_OK(graph.WaitUntilDone());
+  }
+  state->SetItemsProcessed(state->iterations() * num_packets);
+}
+
+CalculatorGraphConfig::Node PassThroughNode(
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs) {
+  CalculatorGraphConfig::Node node;
+  node.set_calculator("PassThroughCalculator");
+  for (const std::string& input : inputs) {
+    node.add_input_stream(input);
+  }
+  for (const std::string& output : outputs) {
+    node.add_output_stream(output);
+  }
+  return node;
+}
+
+}  // namespace benchmarks
+}  // namespace mediapipe
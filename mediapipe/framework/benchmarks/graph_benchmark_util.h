@@ -0,0 +1,42 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_BENCHMARKS_GRAPH_BENCHMARK_UTIL_H_
+#define MEDIAPIPE_FRAMEWORK_BENCHMARKS_GRAPH_BENCHMARK_UTIL_H_
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace benchmarks {
+
+// Runs "config" once per benchmark iteration.  Each run sends num_packets
+// int packets, at consecutive timestamps, into every graph input stream,
+// then closes the input streams and waits for the graph to finish.
+// Reports the number of packets sent per input stream as items processed.
+void RunGraphBenchmark(const CalculatorGraphConfig& config, int num_packets,
+                       benchmark::State* state);
+
+// Returns a PassThroughCalculator node that forwards "inputs" to "outputs".
+CalculatorGraphConfig::Node PassThroughNode(
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs);
+
+}  // namespace benchmarks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_BENCHMARKS_GRAPH_BENCHMARK_UTIL_H_
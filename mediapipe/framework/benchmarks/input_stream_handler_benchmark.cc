@@ -0,0 +1,88 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the overhead of each input stream handler on a node with
+// several synchronized inputs.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/benchmarks/graph_benchmark_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+constexpr int kNumPackets = 100;
+
+// Runs a single node with state.range(0) input streams, all fed at the same
+// timestamps, using the named input stream handler.
+void RunHandlerBenchmark(const std::string& handler, benchmark::State* state) {
+  CalculatorGraphConfig config;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  for (int i = 0; i < state->range(0); ++i) {
+    config.add_input_stream(absl::StrCat("in", i));
+    inputs.push_back(absl::StrCat("in", i));
+    outputs.push_back(absl::StrCat("out", i));
+  }
+  CalculatorGraphConfig::Node* node = config.add_node();
+  *node = PassThroughNode(inputs, outputs);
+  node->mutable_input_stream_handler()->set_input_stream_handler(handler);
+  RunGraphBenchmark(config, kNumPackets, state);
+}
+
+void BM_DefaultInputStreamHandler(benchmark::State& state) {
+  RunHandlerBenchmark("DefaultInputStreamHandler", &state);
+}
+BENCHMARK(BM_DefaultInputStreamHandler)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+void BM_ImmediateInputStreamHandler(benchmark::State& state) {
+  RunHandlerBenchmark("ImmediateInputStreamHandler", &state);
+}
+BENCHMARK(BM_ImmediateInputStreamHandler)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+void BM_SyncSetInputStreamHandler(benchmark::State& state) {
+  RunHandlerBenchmark("SyncSetInputStreamHandler", &state);
+}
+BENCHMARK(BM_SyncSetInputStreamHandler)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+void BM_TimestampAlignInputStreamHandler(benchmark::State& state) {
+  RunHandlerBenchmark("TimestampAlignInputStreamHandler", &state);
+}
+BENCHMARK(BM_TimestampAlignInputStreamHandler)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+void BM_FixedSizeInputStreamHandler(benchmark::State& state) {
+  RunHandlerBenchmark("FixedSizeInputStreamHandler", &state);
+}
+BENCHMARK(BM_FixedSizeInputStreamHandler)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
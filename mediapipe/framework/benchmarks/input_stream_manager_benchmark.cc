@@ -0,0 +1,109 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks adding packets to and popping packets from an
+// InputStreamManager, as done for every packet delivered to a calculator.
+
+#include <list>
+
+#include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+class InputStreamManagerFixture {
+ public:
+  InputStreamManagerFixture() {
+    packet_type_.Set<int>();
+    MEDIAPIPE_CHECK_OK(manager_.Initialize("stream", &packet_type_,
+                                           /*back_edge=*/false));
+  }
+
+  InputStreamManager* manager() { return &manager_; }
+
+ private:
+  PacketType packet_type_;
+  InputStreamManager manager_;
+};
+
+// Adds and then pops one packet per iteration.
+void BM_AddAndPopPacket(benchmark::State& state) {
+  InputStreamManagerFixture fixture;
+  InputStreamManager* manager = fixture.manager();
+  int64 timestamp = 0;
+  bool notify;
+  int num_packets_dropped;
+  bool stream_is_done;
+  for (auto _ : state) {
+    std::list<Packet> packets = {MakePacket<int>(0).At(Timestamp(timestamp))};
+    MEDIAPIPE_CHECK_OK(manager->MovePackets(&packets, &notify));
+    Packet packet = manager->PopPacketAtTimestamp(
+        Timestamp(timestamp), &num_packets_dropped, &stream_is_done);
+    benchmark::DoNotOptimize(packet);
+    ++timestamp;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddAndPopPacket);
+
+// Adds state.range(0) packets at once, then pops them one by one.
+void BM_AddAndPopBatch(benchmark::State& state) {
+  InputStreamManagerFixture fixture;
+  InputStreamManager* manager = fixture.manager();
+  int64 timestamp = 0;
+  bool notify;
+  int num_packets_dropped;
+  bool stream_is_done;
+  for (auto _ : state) {
+    std::list<Packet> packets;
+    for (int i = 0; i < state.range(0); ++i) {
+      packets.push_back(MakePacket<int>(i).At(Timestamp(timestamp + i)));
+    }
+    MEDIAPIPE_CHECK_OK(manager->MovePackets(&packets, &notify));
+    for (int i = 0; i < state.range(0); ++i) {
+      Packet packet = manager->PopPacketAtTimestamp(
+          Timestamp(timestamp), &num_packets_dropped, &stream_is_done);
+      benchmark::DoNotOptimize(packet);
+      ++timestamp;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddAndPopBatch)->Arg(8)->Arg(64);
+
+// Queries the queue state as the scheduler and stream handlers do.
+void BM_MinTimestampOrBound(benchmark::State& state) {
+  InputStreamManagerFixture fixture;
+  InputStreamManager* manager = fixture.manager();
+  bool notify;
+  std::list<Packet> packets = {MakePacket<int>(0).At(Timestamp(0))};
+  MEDIAPIPE_CHECK_OK(manager->MovePackets(&packets, &notify));
+  bool is_empty;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manager->MinTimestampOrBound(&is_empty));
+  }
+}
+BENCHMARK(BM_MinTimestampOrBound);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks Packet creation, copying and access.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+void BM_MakePacketInt(benchmark::State& state) {
+  int i = 0;
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(++i);
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_MakePacketInt);
+
+void BM_MakePacketAtTimestamp(benchmark::State& state) {
+  int64 i = 0;
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(0).At(Timestamp(++i));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_MakePacketAtTimestamp);
+
+// Creates a packet holding a vector of state.range(0) floats.
+void BM_AdoptVector(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet packet = Adopt(new std::vector<float>(state.range(0)));
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(float));
+}
+BENCHMARK(BM_AdoptVector)->Arg(16)->Arg(1024)->Arg(65536);
+
+void BM_PacketCopy(benchmark::State& state) {
+  Packet packet = MakePacket<std::string>("payload");
+  for (auto _ : state) {
+    Packet copy = packet;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_PacketCopy);
+
+void BM_PacketMove(benchmark::State& state) {
+  Packet packet = MakePacket<std::string>("payload");
+  for (auto _ : state) {
+    Packet moved = std::move(packet);
+    packet = std::move(moved);
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_PacketMove);
+
+void BM_PacketGet(benchmark::State& state) {
+  Packet packet = MakePacket<int>(1);
+  int sum = 0;
+  for (auto _ : state) {
+    sum += packet.Get<int>();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_PacketGet);
+
+void BM_PacketValidateAsType(benchmark::State& state) {
+  Packet packet = MakePacket<int>(1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(packet.ValidateAsType<int>());
+  }
+}
+BENCHMARK(BM_PacketValidateAsType);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
@@ -0,0 +1,95 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the scheduler on basic graph topologies.  Every node is a
+// PassThroughCalculator, so the results measure framework overhead per
+// packet, including scheduling, input stream handling and output propagation.
+// Since the graph runs on executor threads, wall time is reported.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/benchmarks/graph_benchmark_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/benchmark.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+constexpr int kNumPackets = 100;
+
+// A chain of state.range(0) nodes: in -> n0 -> n1 -> ... -> out.
+void BM_LinearGraph(benchmark::State& state) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("s0");
+  for (int i = 0; i < state.range(0); ++i) {
+    *config.add_node() =
+        PassThroughNode({absl::StrCat("s", i)}, {absl::StrCat("s", i + 1)});
+  }
+  RunGraphBenchmark(config, kNumPackets, &state);
+}
+BENCHMARK(BM_LinearGraph)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+// One input stream consumed by state.range(0) parallel nodes.
+void BM_FanOutGraph(benchmark::State& state) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("in");
+  for (int i = 0; i < state.range(0); ++i) {
+    *config.add_node() = PassThroughNode({"in"}, {absl::StrCat("out", i)});
+  }
+  RunGraphBenchmark(config, kNumPackets, &state);
+}
+BENCHMARK(BM_FanOutGraph)->Arg(2)->Arg(8)->Arg(32)->UseRealTime();
+
+// state.range(0) input streams, each passed through one node, all joined
+// by a single node.
+void BM_FanInGraph(benchmark::State& state) {
+  CalculatorGraphConfig config;
+  std::vector<std::string> joined_inputs;
+  std::vector<std::string> joined_outputs;
+  for (int i = 0; i < state.range(0); ++i) {
+    config.add_input_stream(absl::StrCat("in", i));
+    *config.add_node() =
+        PassThroughNode({absl::StrCat("in", i)}, {absl::StrCat("mid", i)});
+    joined_inputs.push_back(absl::StrCat("mid", i));
+    joined_outputs.push_back(absl::StrCat("out", i));
+  }
+  *config.add_node() = PassThroughNode(joined_inputs, joined_outputs);
+  RunGraphBenchmark(config, kNumPackets, &state);
+}
+BENCHMARK(BM_FanInGraph)->Arg(2)->Arg(8)->Arg(32)->UseRealTime();
+
+// state.range(0) stacked diamonds: each splits a stream into two branches
+// and joins them again.
+void BM_DiamondGraph(benchmark::State& state) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("s0");
+  for (int i = 0; i < state.range(0); ++i) {
+    std::string in = absl::StrCat("s", i);
+    std::string left = absl::StrCat("left", i);
+    std::string right = absl::StrCat("right", i);
+    *config.add_node() = PassThroughNode({in}, {left});
+    *config.add_node() = PassThroughNode({in}, {right});
+    *config.add_node() = PassThroughNode(
+        {left, right}, {absl::StrCat("s", i + 1), absl::StrCat("unused", i)});
+  }
+  RunGraphBenchmark(config, kNumPackets, &state);
+}
+BENCHMARK(BM_DiamondGraph)->Arg(1)->Arg(4)->UseRealTime();
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
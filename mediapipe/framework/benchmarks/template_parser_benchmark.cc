@@ -0,0 +1,187 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks parsing the shipped graph configs in mediapipe/graphs, and
+// expanding graph templates.
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/advanced_proto_inc.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/calculator_graph_template.pb.h"
+#include "mediapipe/framework/tool/template_expander.h"
+#include "mediapipe/framework/tool/template_parser.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+// The directory of the shipped graphs, relative to the runfiles directory.
+constexpr char kGraphsDirectory[] = "mediapipe/graphs";
+
+// Ignores parse errors.
+class SilentErrorCollector : public proto_ns::io::ErrorCollector {
+ public:
+  void AddError(int line, int column, const std::string& message) override {}
+};
+
+// Returns true if the text parses as a CalculatorGraphConfig.  The configs
+// of graphs whose calculator options are not linked into the benchmark
+// do not parse.
+bool IsParseable(const std::string& text) {
+  SilentErrorCollector error_collector;
+  proto_ns::TextFormat::Parser parser;
+  parser.RecordErrorsTo(&error_collector);
+  CalculatorGraphConfig config;
+  return parser.ParseFromString(text, &config);
+}
+
+// Returns the contents of the shipped graph configs which parse.
+const std::vector<std::string>& GraphConfigTexts() {
+  static auto texts = [] {
+    auto result = new std::vector<std::string>();
+    std::vector<std::string> paths;
+    MEDIAPIPE_CHECK_OK(
+        file::MatchInTopSubdirectories(kGraphsDirectory, ".pbtxt", &paths));
+    for (const std::string& path : paths) {
+      std::string text;
+      MEDIAPIPE_CHECK_OK(file::GetContents(path, &text));
+      if (IsParseable(text)) {
+        result->push_back(text);
+      } else {
+        LOG(INFO) << "Skipping graph config: " << path;
+      }
+    }
+    return result;
+  }();
+  return *texts;
+}
+
+// Returns the total size of the shipped graph configs.
+int64 GraphConfigBytes() {
+  int64 result = 0;
+  for (const std::string& text : GraphConfigTexts()) {
+    result += text.size();
+  }
+  return result;
+}
+
+// Returns a template which repeats a node for each element of "nodes".
+CalculatorGraphTemplate NodeLoopTemplate() {
+  CalculatorGraphTemplate result;
+  tool::TemplateParser::Parser parser;
+  CHECK(parser.ParseFromString(R"(
+    input_stream: "in"
+    %for (i : nodes)%
+    node {
+      name: %concat("node_", i)%
+      calculator: "PassThroughCalculator"
+      input_stream: "in"
+      output_stream: %concat("out_", i)%
+    }
+    %end%
+  )",
+                               &result));
+  return result;
+}
+
+// Returns the template arguments for NodeLoopTemplate.
+TemplateDict NodeLoopArguments(int num_nodes) {
+  TemplateDict result;
+  TemplateDict::Parameter* arg = result.add_arg();
+  arg->set_key("nodes");
+  for (int i = 0; i < num_nodes; ++i) {
+    arg->mutable_value()->add_element()->set_num(i);
+  }
+  return result;
+}
+
+// Parses each shipped graph config with the protobuf text parser.
+void BM_ParseTextProto(benchmark::State& state) {
+  const std::vector<std::string>& texts = GraphConfigTexts();
+  if (texts.empty()) {
+    state.SkipWithError("No graph configs found.");
+    return;
+  }
+  for (auto _ : state) {
+    for (const std::string& text : texts) {
+      CalculatorGraphConfig config;
+      CHECK(proto_ns::TextFormat::ParseFromString(text, &config));
+      benchmark::DoNotOptimize(config);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * GraphConfigBytes());
+  state.counters["graphs"] = texts.size();
+}
+BENCHMARK(BM_ParseTextProto);
+
+// Parses each shipped graph config with the template parser.
+void BM_ParseTemplate(benchmark::State& state) {
+  const std::vector<std::string>& texts = GraphConfigTexts();
+  if (texts.empty()) {
+    state.SkipWithError("No graph configs found.");
+    return;
+  }
+  tool::TemplateParser::Parser parser;
+  for (auto _ : state) {
+    for (const std::string& text : texts) {
+      CalculatorGraphTemplate templ;
+      CHECK(parser.ParseFromString(text, &templ));
+      benchmark::DoNotOptimize(templ);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * GraphConfigBytes());
+  state.counters["graphs"] = texts.size();
+}
+BENCHMARK(BM_ParseTemplate);
+
+// Expands a template with a "for" rule over state.range(0) nodes.
+void BM_ExpandTemplate(benchmark::State& state) {
+  CalculatorGraphTemplate templ = NodeLoopTemplate();
+  TemplateDict arguments = NodeLoopArguments(state.range(0));
+  for (auto _ : state) {
+    tool::TemplateExpander expander;
+    CalculatorGraphConfig config;
+    MEDIAPIPE_CHECK_OK(expander.ExpandTemplates(arguments, templ, &config));
+    benchmark::DoNotOptimize(config);
+  }
+}
+BENCHMARK(BM_ExpandTemplate)->Arg(1)->Arg(16)->Arg(64);
+
+// Expands a template subgraph, as a graph does for each instance of it.
+// Repeated expansions are served by the template expansion cache.
+void BM_TemplateSubgraphGetConfig(benchmark::State& state) {
+  CalculatorGraphTemplate templ = NodeLoopTemplate();
+  Subgraph::SubgraphOptions options;
+  *options.MutableExtension(TemplateSubgraphOptions::ext)->mutable_dict() =
+      NodeLoopArguments(state.range(0));
+  for (auto _ : state) {
+    TemplateSubgraph subgraph(templ);
+    auto config = subgraph.GetConfig(options);
+    MEDIAPIPE_CHECK_OK(config.status());
+    benchmark::DoNotOptimize(config);
+  }
+}
+BENCHMARK(BM_TemplateSubgraphGetConfig)->Arg(1)->Arg(16)->Arg(64);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
@@ -0,0 +1,54 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks task latency and throughput of ThreadPoolExecutor.
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+
+namespace mediapipe {
+namespace benchmarks {
+namespace {
+
+// Measures the round trip of scheduling one task and waiting for it.
+void BM_TaskLatency(benchmark::State& state) {
+  ThreadPoolExecutor executor(state.range(0));
+  for (auto _ : state) {
+    absl::Notification done;
+    executor.Schedule([&done] { done.Notify(); });
+    done.WaitForNotification();
+  }
+}
+BENCHMARK(BM_TaskLatency)->Arg(1)->Arg(4)->UseRealTime();
+
+// Measures scheduling 1000 small tasks and waiting for all of them.
+void BM_TaskThroughput(benchmark::State& state) {
+  constexpr int kNumTasks = 1000;
+  ThreadPoolExecutor executor(state.range(0));
+  for (auto _ : state) {
+    absl::BlockingCounter counter(kNumTasks);
+    for (int i = 0; i < kNumTasks; ++i) {
+      executor.Schedule([&counter] { counter.DecrementCount(); });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTasks);
+}
+BENCHMARK(BM_TaskThroughput)->Arg(1)->Arg(4)->Arg(8)->UseRealTime();
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace mediapipe
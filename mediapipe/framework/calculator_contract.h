@@ -29,6 +29,7 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/any_proto.h"
 #include "mediapipe/framework/status_handler.pb.h"
+#include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/options_util.h"
 
 namespace mediapipe {
@@ -45,6 +46,13 @@ namespace mediapipe {
 //      ->set_fixed_min_size(2);
 //  cc->SetInputStreamHandlerOptions(options);
 //
+// A calculator whose output timestamps are a fixed offset from its input
+// timestamps can declare the offset, so that the framework advances the
+// timestamp bounds of its output streams after each Process() call, and even
+// while the calculator is not invoked, without any empty packets and without
+// calling CalculatorContext::SetOffset() in Open():
+//  cc->SetTimestampOffset(TimestampDiff(0));
+//
 class CalculatorContract {
  public:
   ::mediapipe::Status Initialize(const CalculatorGraphConfig::Node& node);
@@ -104,6 +112,22 @@ class CalculatorContract {
     return input_stream_handler_options_;
   }
 
+  // Declares that every output packet has a timestamp of at least the input
+  // timestamp plus "offset", for all output streams.  The framework sets the
+  // offset of the output streams when the graph run is prepared, so the
+  // calculator needs no Open() for it.  Calculator::Open() may still change
+  // the offset with CalculatorContext::SetOffset().
+  void SetTimestampOffset(TimestampDiff offset) {
+    timestamp_offset_enabled_ = true;
+    timestamp_offset_ = offset;
+  }
+
+  // Returns true if SetTimestampOffset() was called.
+  bool TimestampOffsetEnabled() const { return timestamp_offset_enabled_; }
+
+  // Returns the offset set by SetTimestampOffset().
+  TimestampDiff TimestampOffset() const { return timestamp_offset_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -146,6 +170,8 @@ class CalculatorContract {
   std::string input_stream_handler_;
   MediaPipeOptions input_stream_handler_options_;
   std::string node_name_;
+  bool timestamp_offset_enabled_ = false;
+  TimestampDiff timestamp_offset_;
   std::map<std::string, GraphServiceRequest> service_requests_;
 };
 
@@ -168,6 +168,8 @@ CalculatorGraph::~CalculatorGraph() {}
     const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
     MP_RETURN_IF_ERROR(input_stream_managers_[index].Initialize(
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
+    input_stream_managers_[index].SetDropPolicy(edge_info.max_queued_packets,
+                                                edge_info.max_packet_age_usec);
   }
 
   // Create and initialize the output streams.
@@ -257,6 +259,16 @@ CalculatorGraph::~CalculatorGraph() {}
 
 ::mediapipe::Status CalculatorGraph::InitializeProfiler() {
   profiler_->Initialize(*validated_graph_);
+  profiler_->SetGraphStatsCallback(
+      [this](GraphProfile* profile) { GetStreamQueueProfiles(profile); });
+  const ProfilerConfig& profiler_config =
+      validated_graph_->Config().profiler_config();
+  if (!profiler_config.live_profile_path().empty()) {
+    live_profile_exporter_ = absl::make_unique<LiveProfileExporter>(
+        profiler_config, [this](GraphSnapshot* snapshot) {
+          return GetGraphSnapshot(snapshot);
+        });
+  }
   return ::mediapipe::OkStatus();
 }
 
@@ -384,6 +396,14 @@ CalculatorGraph::~CalculatorGraph() {}
   return Initialize(std::move(validated_graph), side_packets);
 }
 
+::mediapipe::Status CalculatorGraph::Initialize(
+    const GraphBundle& bundle,
+    const std::map<std::string, Packet>& side_packets) {
+  auto validated_graph = absl::make_unique<ValidatedGraphConfig>();
+  MP_RETURN_IF_ERROR(validated_graph->Initialize(bundle));
+  return Initialize(std::move(validated_graph), side_packets);
+}
+
 ::mediapipe::Status CalculatorGraph::Initialize(
     const std::vector<CalculatorGraphConfig>& input_configs,
     const std::vector<CalculatorGraphTemplate>& input_templates,
@@ -489,7 +509,14 @@ CalculatorGraph::AddOutputStreamPoller(const std::string& stream_name) {
   RET_CHECK(initialized_).SetNoLogging()
       << "CalculatorGraph is not initialized.";
   MP_RETURN_IF_ERROR(PrepareForRun(extra_side_packets, stream_headers));
+  if (input_recorder_) {
+    MP_RETURN_IF_ERROR(
+        input_recorder_->Start(extra_side_packets, stream_headers));
+  }
   MP_RETURN_IF_ERROR(profiler_->Start(executors_[""].get()));
+  if (live_profile_exporter_) {
+    MP_RETURN_IF_ERROR(live_profile_exporter_->Start());
+  }
   scheduler_.Start();
   return ::mediapipe::OkStatus();
 }
@@ -653,6 +680,36 @@ CalculatorGraph::PrepareGpu(const std::map<std::string, Packet>& side_packets) {
     full_input_streams_.clear();
     full_input_streams_.resize(validated_graph_->CalculatorInfos().size() +
                                graph_input_streams_.size());
+    throttle_stats_.clear();
+    throttle_stats_.resize(full_input_streams_.size());
+    max_buffered_bytes_ = validated_graph_->Config().max_buffered_bytes();
+    buffered_bytes_ = 0;
+    buffered_bytes_exceeded_ = false;
+  }
+
+  // Source nodes and graph input streams are throttled together when the
+  // input streams buffer too many bytes.
+  source_node_ids_.clear();
+  for (int node_id = 0; node_id < validated_graph_->CalculatorInfos().size();
+       ++node_id) {
+    if (validated_graph_->CalculatorInfos()[node_id]
+            .InputStreamTypes()
+            .NumEntries() == 0) {
+      source_node_ids_.push_back(node_id);
+    }
+  }
+  for (const auto& item : graph_input_stream_node_ids_) {
+    source_node_ids_.push_back(item.second);
+  }
+  InputStreamManager::QueueBytesCallback queue_bytes_callback;
+  if (validated_graph_->Config().max_buffered_bytes() > 0) {
+    queue_bytes_callback =
+        std::bind(&CalculatorGraph::UpdateBufferedBytes, this,
+                  std::placeholders::_1, std::placeholders::_2);
+  }
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    input_stream_managers_[index].SetQueueBytesCallback(queue_bytes_callback);
   }
 
   for (auto& item : graph_input_streams_) {
@@ -835,6 +892,10 @@ template <typename T>
     }
   }
 
+  if (input_recorder_) {
+    MP_RETURN_IF_ERROR(input_recorder_->RecordPacket(stream_name, packet));
+  }
+
   // Adding profiling info for a new packet entering the graph.
   const std::string* stream_id = &(*stream)->GetManager()->Name();
   profiler_->LogEvent(TraceEvent(TraceEvent::PROCESS)
@@ -891,6 +952,9 @@ bool CalculatorGraph::HasInputStream(const std::string& stream_name) {
   if ((*stream)->IsClosed()) {
     return ::mediapipe::OkStatus();
   }
+  if (input_recorder_) {
+    MP_RETURN_IF_ERROR(input_recorder_->RecordClose(stream_name));
+  }
 
   (*stream)->Close();
 
@@ -902,14 +966,18 @@ bool CalculatorGraph::HasInputStream(const std::string& stream_name) {
 }
 
 ::mediapipe::Status CalculatorGraph::CloseAllInputStreams() {
+  ::mediapipe::Status status;
   for (auto& item : graph_input_streams_) {
+    if (input_recorder_ && !item.second->IsClosed()) {
+      status.Update(input_recorder_->RecordClose(item.first));
+    }
     item.second->Close();
   }
 
   num_closed_graph_input_streams_ = graph_input_streams_.size();
   scheduler_.ClosedAllGraphInputStreams();
 
-  return ::mediapipe::OkStatus();
+  return status;
 }
 
 ::mediapipe::Status CalculatorGraph::CloseAllPacketSources() {
@@ -1043,41 +1111,8 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
         VLOG(2) << "Stream \"" << stream->Name() << "\" is "
                 << (stream_is_full ? "throttling" : "no longer throttling")
                 << " node with node ID " << node_id;
-        ::mediapipe::LogEvent(
-            profiler_.get(),
-            TraceEvent(stream_is_full ? TraceEvent::THROTTLED
-                                      : TraceEvent::UNTHROTTLED)
-                .set_stream_id(&stream->Name()));
-        bool was_throttled = !full_input_streams_[node_id].empty();
-        if (stream_is_full) {
-          DCHECK_EQ(full_input_streams_[node_id].count(stream), 0);
-          full_input_streams_[node_id].insert(stream);
-        } else {
-          DCHECK_EQ(full_input_streams_[node_id].count(stream), 1);
-          full_input_streams_[node_id].erase(stream);
-        }
-
-        bool is_throttled = !full_input_streams_[node_id].empty();
-        bool is_graph_input_stream =
-            node_id >= validated_graph_->CalculatorInfos().size();
-        if (is_graph_input_stream) {
-          // Making these calls while holding full_input_streams_mutex_
-          // ensures they are correctly serialized.
-          // Note: !is_throttled implies was_throttled, but not vice versa.
-          if (!is_throttled) {
-            scheduler_.UnthrottledGraphInputStream();
-          } else if (!was_throttled && is_throttled) {
-            scheduler_.ThrottledGraphInputStream();
-          }
-        } else {
-          if (!is_throttled) {
-            CalculatorNode& node = (*nodes_)[node_id];
-            // Add this node to the scheduler queue if possible.
-            if (node.Active() && !node.Closed()) {
-              nodes_to_schedule.emplace_back(&node);
-            }
-          }
-        }
+        UpdateSourceThrottling(node_id, stream, stream_is_full,
+                               &stream->Name(), &nodes_to_schedule);
       }
     }
     *stream_was_full = stream_is_full;
@@ -1088,9 +1123,90 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
   }
 }
 
+void CalculatorGraph::UpdateBufferedBytes(InputStreamManager* stream,
+                                          int64 delta) {
+  std::vector<CalculatorNode*> nodes_to_schedule;
+  {
+    absl::MutexLock lock(&full_input_streams_mutex_);
+    buffered_bytes_ += delta;
+    UpdateBufferedBytesThrottling(&stream->Name(), &nodes_to_schedule);
+  }
+
+  if (!nodes_to_schedule.empty()) {
+    scheduler_.ScheduleUnthrottledReadyNodes(nodes_to_schedule);
+  }
+}
+
+void CalculatorGraph::UpdateBufferedBytesThrottling(
+    const std::string* stream_id,
+    std::vector<CalculatorNode*>* nodes_to_schedule) {
+  const bool exceeded =
+      max_buffered_bytes_ > 0 && buffered_bytes_ > max_buffered_bytes_;
+  if (exceeded == buffered_bytes_exceeded_) {
+    return;
+  }
+  VLOG(2) << buffered_bytes_ << " buffered bytes are "
+          << (exceeded ? "throttling" : "no longer throttling")
+          << " all sources";
+  buffered_bytes_exceeded_ = exceeded;
+  for (int node_id : source_node_ids_) {
+    UpdateSourceThrottling(node_id, nullptr, exceeded, stream_id,
+                           nodes_to_schedule);
+  }
+}
+
+void CalculatorGraph::UpdateSourceThrottling(
+    int node_id, InputStreamManager* stream, bool stream_is_full,
+    const std::string* stream_id,
+    std::vector<CalculatorNode*>* nodes_to_schedule) {
+  ::mediapipe::LogEvent(profiler_.get(),
+                        TraceEvent(stream_is_full ? TraceEvent::THROTTLED
+                                                  : TraceEvent::UNTHROTTLED)
+                            .set_stream_id(stream_id));
+  bool was_throttled = !full_input_streams_[node_id].empty();
+  if (stream_is_full) {
+    DCHECK_EQ(full_input_streams_[node_id].count(stream), 0);
+    full_input_streams_[node_id].insert(stream);
+  } else {
+    DCHECK_EQ(full_input_streams_[node_id].count(stream), 1);
+    full_input_streams_[node_id].erase(stream);
+  }
+
+  bool is_throttled = !full_input_streams_[node_id].empty();
+  ThrottleStats& throttle_stats = throttle_stats_[node_id];
+  if (!was_throttled && is_throttled) {
+    throttle_stats.throttle_start_time = absl::Now();
+    ++throttle_stats.throttle_count;
+  } else if (was_throttled && !is_throttled) {
+    throttle_stats.throttled_time_usec += absl::ToInt64Microseconds(
+        absl::Now() - throttle_stats.throttle_start_time);
+  }
+  bool is_graph_input_stream =
+      node_id >= validated_graph_->CalculatorInfos().size();
+  if (is_graph_input_stream) {
+    // Making these calls while holding full_input_streams_mutex_
+    // ensures they are correctly serialized.
+    // Note: !is_throttled implies was_throttled, but not vice versa.
+    if (!is_throttled) {
+      scheduler_.UnthrottledGraphInputStream();
+    } else if (!was_throttled && is_throttled) {
+      scheduler_.ThrottledGraphInputStream();
+    }
+  } else {
+    if (!is_throttled) {
+      CalculatorNode& node = (*nodes_)[node_id];
+      // Add this node to the scheduler queue if possible.
+      if (node.Active() && !node.Closed()) {
+        nodes_to_schedule->emplace_back(&node);
+      }
+    }
+  }
+}
+
 bool CalculatorGraph::IsNodeThrottled(int node_id) {
   absl::MutexLock lock(&full_input_streams_mutex_);
-  return max_queue_size_ != -1 && !full_input_streams_[node_id].empty();
+  return (max_queue_size_ != -1 || max_buffered_bytes_ > 0) &&
+         !full_input_streams_[node_id].empty();
 }
 
 bool CalculatorGraph::UnthrottleSources() {
@@ -1101,6 +1217,7 @@ bool CalculatorGraph::UnthrottleSources() {
   // stream during each call to UnthrottleSources will eventually resolve
   // each deadlock.
   std::unordered_set<InputStreamManager*> full_streams;
+  bool buffered_bytes_exceeded;
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
     for (std::unordered_set<InputStreamManager*>& s : full_input_streams_) {
@@ -1108,6 +1225,32 @@ bool CalculatorGraph::UnthrottleSources() {
         full_streams.insert(s.begin(), s.end());
       }
     }
+    // The null stream stands for the limit on the buffered bytes.
+    buffered_bytes_exceeded = full_streams.erase(nullptr) > 0;
+  }
+  if (buffered_bytes_exceeded) {
+    if (Config().report_deadlock()) {
+      RecordError(::mediapipe::UnavailableError(
+          "Detected a deadlock due to input throttling for "
+          "\"max_buffered_bytes\". All calculators are idle while packet "
+          "sources remain active and throttled.  Consider increasing "
+          "\"max_buffered_bytes\"."));
+    } else {
+      std::vector<CalculatorNode*> nodes_to_schedule;
+      {
+        absl::MutexLock lock(&full_input_streams_mutex_);
+        max_buffered_bytes_ = buffered_bytes_;
+        UpdateBufferedBytesThrottling(nullptr, &nodes_to_schedule);
+        LOG_EVERY_N(WARNING, 100)
+            << "Resolved a deadlock by increasing max_buffered_bytes to: "
+            << max_buffered_bytes_
+            << ". Consider increasing max_buffered_bytes for better "
+               "performance.";
+      }
+      if (!nodes_to_schedule.empty()) {
+        scheduler_.ScheduleUnthrottledReadyNodes(nodes_to_schedule);
+      }
+    }
   }
   for (InputStreamManager* stream : full_streams) {
     // The queue size of a graph output stream shouldn't change. Throttling
@@ -1138,7 +1281,7 @@ bool CalculatorGraph::UnthrottleSources() {
         << stream->Name() << " to: " << new_size
         << ". Consider increasing max_queue_size for better performance.";
   }
-  return !full_streams.empty();
+  return buffered_bytes_exceeded || !full_streams.empty();
 }
 
 CalculatorGraph::GraphInputStreamAddMode
@@ -1152,6 +1295,10 @@ void CalculatorGraph::SetGraphInputStreamAddMode(GraphInputStreamAddMode mode) {
   graph_input_stream_add_mode_ = mode;
 }
 
+void CalculatorGraph::EnableInputRecording(const std::string& path) {
+  input_recorder_ = absl::make_unique<tool::GraphRecorder>(path);
+}
+
 void CalculatorGraph::Cancel() {
   // TODO This function should return ::mediapipe::Status.
   scheduler_.Cancel();
@@ -1225,7 +1372,19 @@ bool CalculatorGraph::IsReservedExecutorName(const std::string& name) {
 ::mediapipe::Status CalculatorGraph::FinishRun() {
   // Check for any errors that may have occurred.
   ::mediapipe::Status status = ::mediapipe::OkStatus();
-  MP_RETURN_IF_ERROR(profiler_->Stop());
+  // Stop the exporter before the profiler it samples, and report the first
+  // error from either of them.
+  ::mediapipe::Status stop_status;
+  if (live_profile_exporter_) {
+    stop_status.Update(live_profile_exporter_->Stop());
+  }
+  stop_status.Update(profiler_->Stop());
+  MP_RETURN_IF_ERROR(stop_status);
+  if (input_recorder_) {
+    ::mediapipe::Status recorder_status = input_recorder_->Finish();
+    LOG_IF(ERROR, !recorder_status.ok())
+        << "Failed to write the input recording: " << recorder_status;
+  }
   GetCombinedErrors(&status);
   CleanupAfterRun(&status);
   return status;
@@ -1303,4 +1462,127 @@ bool MetricElementComparator(const std::pair<std::string, int64>& e1,
   return profiler_->GetCalculatorProfiles(profiles);
 }
 
+void CalculatorGraph::GetStreamQueueProfiles(GraphProfile* profile) const {
+  if (!initialized_) {
+    return;
+  }
+  const CalculatorGraphConfig& config = validated_graph_->Config();
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
+    const InputStreamManager& manager = input_stream_managers_[index];
+    InputStreamManager::QueueSizeStats stats = manager.GetQueueSizeStats();
+    StreamQueueProfile* queue_profile = profile->add_stream_queue_profiles();
+    queue_profile->set_name(manager.Name());
+    if (edge_info.parent_node.type == NodeTypeInfo::NodeType::CALCULATOR) {
+      queue_profile->set_node_name(
+          CanonicalNodeName(config, edge_info.parent_node.index));
+    }
+    for (int64 count : stats.queue_size_histogram) {
+      queue_profile->add_queue_size_histogram(count);
+    }
+    queue_profile->set_max_queue_size_reached(stats.max_queue_size_reached);
+    queue_profile->set_max_queue_size(manager.MaxQueueSize());
+    queue_profile->set_max_queue_bytes_reached(stats.max_queue_bytes_reached);
+    queue_profile->set_num_packets_dropped(stats.num_packets_dropped);
+  }
+
+  absl::Time now = absl::Now();
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  std::vector<std::string> source_names(throttle_stats_.size());
+  for (const auto& item : graph_input_stream_node_ids_) {
+    if (item.second < source_names.size()) {
+      source_names[item.second] = item.first;
+    }
+  }
+  for (int node_id = 0; node_id < throttle_stats_.size(); ++node_id) {
+    const ThrottleStats& stats = throttle_stats_[node_id];
+    if (stats.throttle_count == 0) {
+      continue;
+    }
+    ThrottleProfile* throttle_profile = profile->add_throttle_profiles();
+    throttle_profile->set_name(
+        node_id < validated_graph_->CalculatorInfos().size()
+            ? CanonicalNodeName(config, node_id)
+            : source_names[node_id]);
+    int64 throttled_time_usec = stats.throttled_time_usec;
+    if (!full_input_streams_[node_id].empty()) {
+      throttled_time_usec +=
+          absl::ToInt64Microseconds(now - stats.throttle_start_time);
+    }
+    throttle_profile->set_throttled_time_usec(throttled_time_usec);
+    throttle_profile->set_throttle_count(stats.throttle_count);
+  }
+}
+
+::mediapipe::Status CalculatorGraph::GetGraphSnapshot(
+    GraphSnapshot* snapshot) const {
+  RET_CHECK(initialized_) << "CalculatorGraph is not initialized.";
+  const CalculatorGraphConfig& config = validated_graph_->Config();
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(profiler_->GetCalculatorProfiles(&profiles));
+  std::map<std::string, int64> busy_time_by_node;
+  for (CalculatorProfile& profile : profiles) {
+    busy_time_by_node[profile.name()] = profile.open_runtime() +
+                                        profile.process_runtime().total() +
+                                        profile.close_runtime();
+    *snapshot->add_calculator_profiles() = std::move(profile);
+  }
+
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
+    const InputStreamManager& manager = input_stream_managers_[index];
+    StreamQueueState* queue = snapshot->add_stream_queues();
+    queue->set_name(manager.Name());
+    if (edge_info.parent_node.type == NodeTypeInfo::NodeType::CALCULATOR) {
+      queue->set_node_name(
+          CanonicalNodeName(config, edge_info.parent_node.index));
+    }
+    queue->set_queue_size(manager.QueueSize());
+    queue->set_max_queue_size(manager.MaxQueueSize());
+    queue->set_full(manager.IsFull());
+    queue->set_queue_bytes(manager.QueueBytes());
+  }
+
+  {
+    absl::MutexLock lock(&full_input_streams_mutex_);
+    snapshot->set_buffered_bytes(buffered_bytes_);
+    snapshot->set_max_buffered_bytes(max_buffered_bytes_);
+    int num_calculators = validated_graph_->CalculatorInfos().size();
+    for (int node_id = 0; node_id < num_calculators; ++node_id) {
+      if (node_id < full_input_streams_.size() &&
+          !full_input_streams_[node_id].empty()) {
+        snapshot->add_throttled_nodes(CanonicalNodeName(config, node_id));
+      }
+    }
+    for (const auto& item : graph_input_stream_node_ids_) {
+      if (item.second < full_input_streams_.size() &&
+          !full_input_streams_[item.second].empty()) {
+        snapshot->add_throttled_nodes(item.first);
+      }
+    }
+  }
+
+  std::map<std::string, ExecutorUtilization*> executors;
+  for (const auto& item : executors_) {
+    ExecutorUtilization* executor = snapshot->add_executors();
+    executor->set_name(item.first);
+    auto* thread_pool = dynamic_cast<ThreadPoolExecutor*>(item.second.get());
+    if (thread_pool) {
+      executor->set_num_threads(thread_pool->num_threads());
+    }
+    executors[item.first] = executor;
+  }
+  for (int node_id = 0; node_id < nodes_->size(); ++node_id) {
+    auto executor = executors.find((*nodes_)[node_id].Executor());
+    if (executor != executors.end()) {
+      executor->second->set_busy_time_usec(
+          executor->second->busy_time_usec() +
+          busy_time_by_node[CanonicalNodeName(config, node_id)]);
+    }
+  }
+  return ::mediapipe::OkStatus();
+}
+
 }  // namespace mediapipe
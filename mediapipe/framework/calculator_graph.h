@@ -31,11 +31,13 @@
 #include "absl/base/macros.h"
 #include "absl/container/fixed_array.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/graph_bundle.pb.h"
 #include "mediapipe/framework/graph_output_stream.h"
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
@@ -50,8 +52,10 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/live_profile_exporter.h"
 #include "mediapipe/framework/scheduler.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/tool/graph_recorder.h"
 
 #ifndef MEDIAPIPE_DISABLE_GPU
 namespace mediapipe {
@@ -130,6 +134,13 @@ class CalculatorGraph {
   // Convenience version which does not take side packets.
   ::mediapipe::Status Initialize(const CalculatorGraphConfig& config);
 
+  // Initializes the graph from a GraphBundle made by CreateGraphBundle.
+  // This skips the subgraph expansion and topological sorting already done
+  // when the bundle was created, which shortens startup for large graphs.
+  ::mediapipe::Status Initialize(
+      const GraphBundle& bundle,
+      const std::map<std::string, Packet>& side_packets = {});
+
   // Initializes the CalculatorGraph from the specified graph and subgraph
   // configs.  Template graph and subgraph configs can be specified through
   // |input_templates|.  Every subgraph must have its graph type specified in
@@ -289,6 +300,17 @@ class CalculatorGraph {
   ::mediapipe::Status GetCalculatorProfiles(
       std::vector<CalculatorProfile>*) const;
 
+  // Fills in the current queue depth of each calculator input stream, the
+  // currently throttled nodes, and the calculator profiles and executor busy
+  // times accumulated so far.  May be called at any time after the graph has
+  // been initialized.  See also ProfilerConfig.live_profile_path.
+  ::mediapipe::Status GetGraphSnapshot(GraphSnapshot* snapshot) const;
+
+  // Adds the input queue size statistics and the time each source spent
+  // throttled during the current run to "profile".  These statistics are
+  // also included in each GraphProfile written by the profiler.
+  void GetStreamQueueProfiles(GraphProfile* profile) const;
+
   // Set the type of counter used in this graph.
   void SetCounterFactory(CounterFactory* factory) {
     counter_factory_.reset(factory);
@@ -309,6 +331,13 @@ class CalculatorGraph {
   // Set the mode for adding packets to an input stream.
   void SetGraphInputStreamAddMode(GraphInputStreamAddMode mode);
 
+  // Records the input side packets, stream headers and graph input packets
+  // of each subsequent run, together with their arrival times, to the file
+  // at "path".  The recording can be replayed with tool::ReplayGraph().
+  // Must be called before StartRun().  Adding a packet whose type has no
+  // registered serialize function fails while recording is enabled.
+  void EnableInputRecording(const std::string& path);
+
   // Aborts the scheduler if the graph is not terminated; no-op otherwise.
   void Cancel();
 
@@ -527,6 +556,30 @@ class CalculatorGraph {
   // status before taking any action.
   void UpdateThrottledNodes(InputStreamManager* stream, bool* stream_was_full);
 
+  // Adds the number of bytes "delta" to the bytes buffered in the input
+  // streams of the graph, and throttles or unthrottles all sources when the
+  // total crosses max_buffered_bytes_.  This method is invoked from an input
+  // stream whenever the bytes in its queue change.
+  void UpdateBufferedBytes(InputStreamManager* stream, int64 delta);
+
+  // Throttles or unthrottles all sources if buffered_bytes_ has crossed
+  // max_buffered_bytes_.  "stream_id" names the stream that caused the
+  // change, for tracing.
+  void UpdateBufferedBytesThrottling(
+      const std::string* stream_id,
+      std::vector<CalculatorNode*>* nodes_to_schedule)
+      EXCLUSIVE_LOCKS_REQUIRED(full_input_streams_mutex_);
+
+  // Adds "stream" to or removes it from the full input streams of the
+  // source node or graph input stream "node_id", and throttles or
+  // unthrottles the source accordingly.  Unthrottled source nodes are added
+  // to "nodes_to_schedule".  A null "stream" stands for the limit on the
+  // buffered bytes.
+  void UpdateSourceThrottling(int node_id, InputStreamManager* stream,
+                              bool stream_is_full, const std::string* stream_id,
+                              std::vector<CalculatorNode*>* nodes_to_schedule)
+      EXCLUSIVE_LOCKS_REQUIRED(full_input_streams_mutex_);
+
   Packet GetServicePacket(const GraphServiceBase& service);
 #ifndef MEDIAPIPE_DISABLE_GPU
   // Owns the legacy GpuSharedData if we need to create one for backwards
@@ -582,6 +635,37 @@ class CalculatorGraph {
   std::vector<std::unordered_set<InputStreamManager*>> full_input_streams_
       GUARDED_BY(full_input_streams_mutex_);
 
+  // Backpressure statistics for a source node or graph input stream.
+  struct ThrottleStats {
+    // The time at which the source last became throttled.
+    absl::Time throttle_start_time;
+    // The total time spent throttled, excluding the current throttling.
+    int64 throttled_time_usec = 0;
+    // The number of times the source became throttled.
+    int64 throttle_count = 0;
+  };
+
+  // The backpressure statistics for the current run, indexed like
+  // full_input_streams_.
+  std::vector<ThrottleStats> throttle_stats_
+      GUARDED_BY(full_input_streams_mutex_);
+
+  // The maximum number of bytes buffered in the input streams, or 0 if the
+  // buffered bytes are not limited.  The limit may be raised during a run to
+  // resolve a deadlock.  See CalculatorGraphConfig.max_buffered_bytes.
+  int64 max_buffered_bytes_ GUARDED_BY(full_input_streams_mutex_) = 0;
+
+  // The number of bytes buffered in the input streams.
+  int64 buffered_bytes_ GUARDED_BY(full_input_streams_mutex_) = 0;
+
+  // True if buffered_bytes_ exceeds max_buffered_bytes_, in which case a
+  // null stream is in the full_input_streams_ of every source.
+  bool buffered_bytes_exceeded_ GUARDED_BY(full_input_streams_mutex_) = false;
+
+  // The source nodes and graph input streams, which are throttled when
+  // buffered_bytes_ exceeds max_buffered_bytes_.
+  std::vector<int> source_node_ids_;
+
   // Maps stream names to graph input stream objects.
   std::unordered_map<std::string, std::unique_ptr<GraphInputStream>>
       graph_input_streams_;
@@ -640,6 +724,14 @@ class CalculatorGraph {
   std::shared_ptr<ProfilingContext> profiler_;
 
   internal::Scheduler scheduler_;
+
+  // Publishes live GraphSnapshots when ProfilerConfig.live_profile_path is
+  // set.  It is declared last so that it stops before the graph state it
+  // reports is destroyed.
+  std::unique_ptr<LiveProfileExporter> live_profile_exporter_;
+
+  // Records the graph inputs when EnableInputRecording() has been called.
+  std::unique_ptr<tool::GraphRecorder> input_recorder_;
 };
 
 }  // namespace mediapipe
@@ -101,5 +101,118 @@ TEST(CalculatorGraphBounds, ImmediateHandlerBounds) {
   EXPECT_EQ(output_packets.size(), 4);
 }
 
+// Passes through the packets with even timestamps.  It declares its
+// timestamp offset in its contract rather than emitting empty packets, so
+// the framework advances the output bound after every invocation.
+class EvenTimestampsCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(TimestampDiff(0));
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) final {
+    if (cc->InputTimestamp().Value() % 2 == 0) {
+      cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    }
+    return ::mediapipe::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(EvenTimestampsCalculator);
+
+// Shows that a timestamp offset declared in the contract propagates bounds
+// on a sparse stream to a node with the default input stream handler.
+TEST(CalculatorGraphBounds, ContractOffsetBounds) {
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: 'input'
+        node {
+          calculator: 'EvenTimestampsCalculator'
+          input_stream: 'input'
+          output_stream: 'sparse'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'sparse'
+          input_stream: 'input'
+          output_stream: 'sparse_output'
+          output_stream: 'output'
+        }
+      )");
+  CalculatorGraph graph;
+  std::vector<Packet> output_packets;
+  std::vector<Packet> sparse_output_packets;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("output", [&](const Packet& p) {
+    output_packets.push_back(p);
+    return ::mediapipe::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.ObserveOutputStream("sparse_output", [&](const Packet& p) {
+    sparse_output_packets.push_back(p);
+    return ::mediapipe::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 5; ++i) {
+    Packet p = MakePacket<int>(i).At(Timestamp(i));
+    MP_ASSERT_OK(graph.AddPacketToInputStream("input", p));
+  }
+
+  // All packets arrive at the output before the input stream is closed only
+  // if the bounds of the sparse stream are propagated.
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_EQ(output_packets.size(), 5);
+  EXPECT_EQ(sparse_output_packets.size(), 3);
+
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(output_packets.size(), 5);
+}
+
+// Checks in Open() that the offset declared in its contract is already set
+// on its output streams.
+class ContractOffsetInOpenCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(TimestampDiff(2));
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Open(CalculatorContext* cc) final {
+    RET_CHECK(cc->Outputs().Index(0).OffsetEnabled());
+    RET_CHECK_EQ(cc->Outputs().Index(0).Offset(), TimestampDiff(2));
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) final {
+    return ::mediapipe::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(ContractOffsetInOpenCalculator);
+
+// Shows that the offset declared in the contract is set on the output streams
+// when the run starts, before Calculator::Open().
+TEST(CalculatorGraphBounds, ContractOffsetSetBeforeOpen) {
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: 'input'
+        node {
+          calculator: 'ContractOffsetInOpenCalculator'
+          input_stream: 'input'
+          output_stream: 'output'
+        }
+      )");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(0).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace
 }  // namespace mediapipe
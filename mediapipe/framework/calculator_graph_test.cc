@@ -40,6 +40,7 @@
 #include "mediapipe/framework/lifetime_tracker.h"
 #include "mediapipe/framework/mediapipe_options.pb.h"
 #include "mediapipe/framework/output_stream_poller.h"
+#include "mediapipe/framework/packet_byte_size.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -51,6 +52,7 @@
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/framework/status_handler.h"
+#include "mediapipe/framework/stream_handler/default_input_stream_handler.h"
 #include "mediapipe/framework/subgraph.h"
 #include "mediapipe/framework/thread_pool_executor.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
@@ -3933,6 +3935,271 @@ TEST(CalculatorGraph, SetInputStreamMaxQueueSizeWorksSlowCalculator) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+TEST(CalculatorGraph, GetStreamQueueProfilesReportsThrottling) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+        input_stream: 'in'
+        max_queue_size: 1
+      )");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+  }));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  calc_entered_process.Acquire(1);
+  // The calculator is stuck in Process, so the next packet fills the queue
+  // and throttles the graph input stream.
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(1))));
+
+  GraphProfile profile;
+  graph.GetStreamQueueProfiles(&profile);
+  ASSERT_EQ(1, profile.stream_queue_profiles_size());
+  const StreamQueueProfile& queue_profile = profile.stream_queue_profiles(0);
+  EXPECT_EQ("in", queue_profile.name());
+  EXPECT_EQ("SemaphoreCalculator", queue_profile.node_name());
+  EXPECT_EQ(1, queue_profile.max_queue_size());
+  EXPECT_EQ(1, queue_profile.max_queue_size_reached());
+  ASSERT_EQ(1, profile.throttle_profiles_size());
+  EXPECT_EQ("in", profile.throttle_profiles(0).name());
+  // The first packet may also have filled the queue briefly.
+  EXPECT_GE(profile.throttle_profiles(0).throttle_count(), 1);
+  int64 throttle_count = profile.throttle_profiles(0).throttle_count();
+
+  calc_can_exit_process.Release(2);
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  profile.Clear();
+  graph.GetStreamQueueProfiles(&profile);
+  int64 num_packets = 0;
+  for (int64 count : profile.stream_queue_profiles(0).queue_size_histogram()) {
+    num_packets += count;
+  }
+  EXPECT_EQ(2, num_packets);
+  ASSERT_EQ(1, profile.throttle_profiles_size());
+  EXPECT_EQ(throttle_count, profile.throttle_profiles(0).throttle_count());
+  EXPECT_GE(profile.throttle_profiles(0).throttled_time_usec(), 0);
+}
+
+// Verify that an input stream with the KEEP_LATEST drop policy drops the
+// packets queued behind a busy calculator instead of throttling the graph
+// input stream.
+TEST(CalculatorGraph, DropPolicyKeepsLatestPacket) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+          input_stream_info: { tag_index: ':0' drop_policy: KEEP_LATEST }
+        }
+        input_stream: 'in'
+        max_queue_size: 1
+      )");
+  std::vector<Packet> out_packets;
+  tool::AddVectorSink("out", &config, &out_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+  }));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  calc_entered_process.Acquire(1);
+  // The calculator is stuck in Process, but the graph input stream is never
+  // throttled.
+  for (int i = 1; i <= 4; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  calc_can_exit_process.Release(2);
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(2, out_packets.size());
+  EXPECT_EQ(0, out_packets[0].Get<int>());
+  EXPECT_EQ(4, out_packets[1].Get<int>());
+
+  GraphProfile profile;
+  graph.GetStreamQueueProfiles(&profile);
+  ASSERT_EQ(2, profile.stream_queue_profiles_size());
+  const StreamQueueProfile& queue_profile = profile.stream_queue_profiles(0);
+  EXPECT_EQ("in", queue_profile.name());
+  EXPECT_EQ(-1, queue_profile.max_queue_size());
+  EXPECT_EQ(3, queue_profile.num_packets_dropped());
+}
+
+// A DefaultInputStreamHandler that pauses after it finds the node ready, so
+// that other threads add packets before it fills the input set.
+class SlowDefaultInputStreamHandler : public DefaultInputStreamHandler {
+ public:
+  SlowDefaultInputStreamHandler(std::shared_ptr<tool::TagMap> tag_map,
+                                CalculatorContextManager* cc_manager,
+                                const MediaPipeOptions& options,
+                                bool calculator_run_in_parallel)
+      : DefaultInputStreamHandler(std::move(tag_map), cc_manager, options,
+                                  calculator_run_in_parallel) {}
+
+ protected:
+  NodeReadiness GetNodeReadiness(Timestamp* min_stream_timestamp) override {
+    NodeReadiness readiness =
+        DefaultInputStreamHandler::GetNodeReadiness(min_stream_timestamp);
+    if (readiness == NodeReadiness::kReadyForProcess) {
+      absl::SleepFor(absl::Microseconds(100));
+    }
+    return readiness;
+  }
+};
+REGISTER_INPUT_STREAM_HANDLER(SlowDefaultInputStreamHandler);
+
+// Verify that packets dropped while the calculator runs never leave it with an
+// empty input.  The graph input stream is fed from this thread while the
+// input stream handler selects packets for Process() on the executor threads,
+// so that dropping packets races with selecting them.
+TEST(CalculatorGraph, DropPolicyNeverDropsSelectedPacket) {
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        node {
+          calculator: 'SquareIntCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_stream_handler {
+            input_stream_handler: 'SlowDefaultInputStreamHandler'
+          }
+          input_stream_info: { tag_index: ':0' drop_policy: KEEP_LATEST }
+        }
+        input_stream: 'in'
+        num_threads: 4
+      )");
+  std::vector<Packet> out_packets;
+  tool::AddVectorSink("out", &config, &out_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  constexpr int kNumPackets = 1000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // SquareIntCalculator fails on an empty input, so every invocation
+  // received its packet.
+  ASSERT_FALSE(out_packets.empty());
+  for (const Packet& packet : out_packets) {
+    const int64 value = packet.Timestamp().Value();
+    EXPECT_EQ(value * value, packet.Get<int>());
+  }
+  EXPECT_EQ(kNumPackets - 1, out_packets.back().Timestamp().Value());
+}
+
+// A payload whose byte size is the size of its data, so that the test can
+// control the bytes buffered in each input stream.  A test-local type is used
+// because size functions are registered process-wide.
+struct SizedPayload {
+  std::string data;
+};
+REGISTER_PACKET_BYTE_SIZE(SizedPayload,
+                          [](const SizedPayload& payload) -> int64 {
+                            return payload.data.size();
+                          });
+
+TEST(CalculatorGraph, MaxBufferedBytesThrottlesGraphInputStreams) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+        input_stream: 'in'
+        max_buffered_bytes: 250
+      )");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+  }));
+  const SizedPayload payload{std::string(100, 'x')};
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "in", MakePacket<SizedPayload>(payload).At(Timestamp(0))));
+  calc_entered_process.Acquire(1);
+  // The calculator is stuck in Process, so the payloads accumulate in the
+  // queue until they exceed max_buffered_bytes.
+  for (int i = 1; i <= 3; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<SizedPayload>(payload).At(Timestamp(i))));
+  }
+  EXPECT_EQ(::mediapipe::StatusCode::kUnavailable,
+            graph
+                .AddPacketToInputStream(
+                    "in", MakePacket<SizedPayload>(payload).At(Timestamp(4)))
+                .code());
+
+  GraphSnapshot snapshot;
+  MP_ASSERT_OK(graph.GetGraphSnapshot(&snapshot));
+  EXPECT_EQ(300, snapshot.buffered_bytes());
+  EXPECT_EQ(250, snapshot.max_buffered_bytes());
+  ASSERT_EQ(1, snapshot.stream_queues_size());
+  EXPECT_EQ(300, snapshot.stream_queues(0).queue_bytes());
+  ASSERT_EQ(1, snapshot.throttled_nodes_size());
+  EXPECT_EQ("in", snapshot.throttled_nodes(0));
+
+  // Processing the queued payloads unthrottles the graph input stream.
+  calc_can_exit_process.Release(5);
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  snapshot.Clear();
+  MP_ASSERT_OK(graph.GetGraphSnapshot(&snapshot));
+  EXPECT_EQ(0, snapshot.buffered_bytes());
+  EXPECT_EQ(0, snapshot.throttled_nodes_size());
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "in", MakePacket<SizedPayload>(payload).At(Timestamp(4))));
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  GraphProfile profile;
+  graph.GetStreamQueueProfiles(&profile);
+  ASSERT_EQ(1, profile.stream_queue_profiles_size());
+  EXPECT_EQ(300, profile.stream_queue_profiles(0).max_queue_bytes_reached());
+}
+
 // Verify the scheduler unthrottles the graph input stream to avoid a deadlock,
 // and won't enter a busy loop.
 TEST(CalculatorGraph, AddPacketNoBusyLoop) {
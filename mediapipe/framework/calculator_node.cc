@@ -335,6 +335,11 @@ void CalculatorNode::SetMaxInputStreamQueueSize(int max_queue_size) {
       [this]() { CalculatorNode::CheckIfBecameReady(); },
       std::move(schedule_callback), error_callback);
   output_stream_handler_->PrepareForRun(error_callback);
+  const CalculatorContract& contract =
+      validated_graph_->CalculatorInfos()[node_id_].Contract();
+  if (contract.TimestampOffsetEnabled()) {
+    output_stream_handler_->SetOffset(contract.TimestampOffset());
+  }
 
   const PacketTypeSet* input_side_packet_types =
       &validated_graph_->CalculatorInfos()[node_id_].InputSidePacketTypes();
@@ -347,8 +352,6 @@ void CalculatorNode::SetMaxInputStreamQueueSize(int max_queue_size) {
   calculator_state_->SetOutputSidePackets(output_side_packets_.get());
   calculator_state_->SetCounterFactory(counter_factory);
 
-  const auto& contract =
-      validated_graph_->CalculatorInfos()[node_id_].Contract();
   for (const auto& svc_req : contract.ServiceRequests()) {
     const auto& req = svc_req.second;
     std::string key{req.Service().key};
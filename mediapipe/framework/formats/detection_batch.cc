@@ -0,0 +1,167 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/detection_batch.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Checks that "detection" holds only the fields stored by DetectionBatch.
+::mediapipe::Status CheckRepresentable(const Detection& detection,
+                                       int num_keypoints) {
+  RET_CHECK_EQ(detection.score_size(), 1)
+      << "A batched detection has exactly one score.";
+  RET_CHECK_LE(detection.label_id_size(), 1)
+      << "A batched detection has at most one label id.";
+  RET_CHECK(detection.label_id_size() == 0 || detection.label_id(0) >= 0)
+      << "Label ids of batched detections must be non-negative.";
+  RET_CHECK(detection.label_size() == 0 && detection.display_name_size() == 0 &&
+            !detection.has_feature_tag() && !detection.has_track_id() &&
+            !detection.has_detection_id() &&
+            detection.associated_detections_size() == 0 &&
+            !detection.has_timestamp_usec())
+      << "Batched detections only hold a box, a score, a label id and "
+         "keypoints.";
+  const LocationData& location_data = detection.location_data();
+  RET_CHECK_EQ(location_data.format(), LocationData::RELATIVE_BOUNDING_BOX)
+      << "Batched detections must have relative bounding boxes.";
+  RET_CHECK(!location_data.has_bounding_box() && !location_data.has_mask());
+  RET_CHECK_EQ(location_data.relative_keypoints_size(), num_keypoints)
+      << "Batched detections must have the same number of keypoints.";
+  for (const auto& keypoint : location_data.relative_keypoints()) {
+    RET_CHECK(!keypoint.has_keypoint_label() && !keypoint.has_score())
+        << "Batched keypoints only hold x and y.";
+  }
+  return ::mediapipe::OkStatus();
+}
+
+}  // namespace
+
+constexpr int DetectionBatch::kNoLabelId;
+
+DetectionBatch::DetectionBatch(int num_keypoints)
+    : num_keypoints_(num_keypoints) {
+  CHECK_GE(num_keypoints, 0);
+}
+
+void DetectionBatch::Reserve(int capacity) {
+  xmin_.reserve(capacity);
+  ymin_.reserve(capacity);
+  width_.reserve(capacity);
+  height_.reserve(capacity);
+  score_.reserve(capacity);
+  label_id_.reserve(capacity);
+  keypoints_.reserve(capacity * 2 * num_keypoints_);
+}
+
+void DetectionBatch::Clear() {
+  xmin_.clear();
+  ymin_.clear();
+  width_.clear();
+  height_.clear();
+  score_.clear();
+  label_id_.clear();
+  keypoints_.clear();
+}
+
+int DetectionBatch::Add(float xmin, float ymin, float width, float height,
+                        float score, int label_id) {
+  xmin_.push_back(xmin);
+  ymin_.push_back(ymin);
+  width_.push_back(width);
+  height_.push_back(height);
+  score_.push_back(score);
+  label_id_.push_back(label_id);
+  keypoints_.resize(keypoints_.size() + 2 * num_keypoints_);
+  return size() - 1;
+}
+
+int DetectionBatch::AddFrom(const DetectionBatch& other, int index) {
+  CHECK_EQ(num_keypoints_, other.num_keypoints_);
+  const int new_index =
+      Add(other.xmin_[index], other.ymin_[index], other.width_[index],
+          other.height_[index], other.score_[index], other.label_id_[index]);
+  std::copy_n(other.keypoints(index), 2 * num_keypoints_,
+              mutable_keypoints(new_index));
+  return new_index;
+}
+
+::mediapipe::StatusOr<DetectionBatch> DetectionBatch::FromDetections(
+    const std::vector<Detection>& detections) {
+  DetectionBatch result(
+      detections.empty()
+          ? 0
+          : detections[0].location_data().relative_keypoints_size());
+  result.Reserve(detections.size());
+  for (const Detection& detection : detections) {
+    MP_RETURN_IF_ERROR(result.Append(detection));
+  }
+  return std::move(result);
+}
+
+::mediapipe::Status DetectionBatch::Append(const Detection& detection) {
+  MP_RETURN_IF_ERROR(CheckRepresentable(detection, num_keypoints_));
+  const auto& box = detection.location_data().relative_bounding_box();
+  const int index =
+      Add(box.xmin(), box.ymin(), box.width(), box.height(),
+          detection.score(0),
+          detection.label_id_size() > 0 ? detection.label_id(0) : kNoLabelId);
+  float* keypoints = mutable_keypoints(index);
+  for (const auto& keypoint : detection.location_data().relative_keypoints()) {
+    *keypoints++ = keypoint.x();
+    *keypoints++ = keypoint.y();
+  }
+  return ::mediapipe::OkStatus();
+}
+
+Detection DetectionBatch::GetDetection(int index) const {
+  Detection detection;
+  detection.add_score(score_[index]);
+  if (label_id_[index] != kNoLabelId) {
+    detection.add_label_id(label_id_[index]);
+  }
+  LocationData* location_data = detection.mutable_location_data();
+  location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+  auto* box = location_data->mutable_relative_bounding_box();
+  box->set_xmin(xmin_[index]);
+  box->set_ymin(ymin_[index]);
+  box->set_width(width_[index]);
+  box->set_height(height_[index]);
+  const float* keypoints = this->keypoints(index);
+  location_data->mutable_relative_keypoints()->Reserve(num_keypoints_);
+  for (int k = 0; k < num_keypoints_; ++k) {
+    auto* keypoint = location_data->add_relative_keypoints();
+    keypoint->set_x(keypoints[2 * k]);
+    keypoint->set_y(keypoints[2 * k + 1]);
+  }
+  return detection;
+}
+
+std::vector<Detection> DetectionBatch::ToDetections() const {
+  std::vector<Detection> result;
+  result.reserve(size());
+  for (int i = 0; i < size(); ++i) {
+    result.push_back(GetDetection(i));
+  }
+  return result;
+}
+
+}  // namespace mediapipe
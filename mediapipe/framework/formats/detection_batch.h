@@ -0,0 +1,127 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A compact, struct-of-arrays representation of the detections produced by
+// a detection model, as an alternative to std::vector<Detection>.  Each
+// field of the detections is stored in its own contiguous array, so that
+// post-processing calculators can loop over the boxes, scores and keypoints
+// of all detections without going through protobuf accessors.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// A batch of detections, each with a relative bounding box, a single score,
+// an optional label id, and a fixed number of relative keypoints.  This is
+// the information output by TfLiteTensorsToDetectionsCalculator.
+//
+// Example:
+//   DetectionBatch batch(/*num_keypoints=*/6);
+//   int index = batch.Add(xmin, ymin, width, height, score, label_id);
+//   float* keypoints = batch.mutable_keypoints(index);
+//   ...
+//   for (int i = 0; i < batch.size(); ++i) {
+//     area[i] = batch.width()[i] * batch.height()[i];
+//   }
+class DetectionBatch {
+ public:
+  // The label id of detections without a label id.
+  static constexpr int kNoLabelId = -1;
+
+  DetectionBatch() : DetectionBatch(0) {}
+  explicit DetectionBatch(int num_keypoints);
+
+  // Returns the number of detections.
+  int size() const { return score_.size(); }
+  bool empty() const { return score_.empty(); }
+
+  // Returns the number of keypoints of each detection.
+  int num_keypoints() const { return num_keypoints_; }
+
+  // Reserves space for "capacity" detections.
+  void Reserve(int capacity);
+
+  // Removes all detections.
+  void Clear();
+
+  // Appends a detection and returns its index.  Its keypoints are zero.
+  int Add(float xmin, float ymin, float width, float height, float score,
+          int label_id);
+
+  // Appends a copy of the detection at "index" in "other", which must have
+  // the same number of keypoints, and returns its index.
+  int AddFrom(const DetectionBatch& other, int index);
+
+  // The fields of all detections, indexed by detection.  The relative
+  // bounding box of detection i is (xmin()[i], ymin()[i], width()[i],
+  // height()[i]).  The pointers are invalidated by Add() and Clear().
+  const float* xmin() const { return xmin_.data(); }
+  const float* ymin() const { return ymin_.data(); }
+  const float* width() const { return width_.data(); }
+  const float* height() const { return height_.data(); }
+  const float* score() const { return score_.data(); }
+  const int* label_id() const { return label_id_.data(); }
+  float* mutable_xmin() { return xmin_.data(); }
+  float* mutable_ymin() { return ymin_.data(); }
+  float* mutable_width() { return width_.data(); }
+  float* mutable_height() { return height_.data(); }
+  float* mutable_score() { return score_.data(); }
+  int* mutable_label_id() { return label_id_.data(); }
+
+  // The relative keypoints of the detection at "index", as num_keypoints()
+  // interleaved (x, y) pairs.
+  const float* keypoints(int index) const {
+    return keypoints_.data() + index * 2 * num_keypoints_;
+  }
+  float* mutable_keypoints(int index) {
+    return keypoints_.data() + index * 2 * num_keypoints_;
+  }
+
+  // Converts detections to a DetectionBatch.  Fails unless every detection
+  // has a RELATIVE_BOUNDING_BOX location, exactly one score, at most one
+  // non-negative label id, the same number of keypoints, and no other
+  // fields, so that the conversion is lossless.
+  static ::mediapipe::StatusOr<DetectionBatch> FromDetections(
+      const std::vector<Detection>& detections);
+
+  // Appends a detection, failing as FromDetections() does.
+  ::mediapipe::Status Append(const Detection& detection);
+
+  // Returns the detection at "index" as a Detection proto.
+  Detection GetDetection(int index) const;
+
+  // Returns all detections as Detection protos.
+  std::vector<Detection> ToDetections() const;
+
+ private:
+  int num_keypoints_;
+  std::vector<float> xmin_;
+  std::vector<float> ymin_;
+  std::vector<float> width_;
+  std::vector<float> height_;
+  std::vector<float> score_;
+  std::vector<int> label_id_;
+  std::vector<float> keypoints_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
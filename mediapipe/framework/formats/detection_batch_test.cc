@@ -0,0 +1,109 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/detection_batch.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+Detection CreateDetection(float xmin, float ymin, float score, int label_id,
+                          int num_keypoints) {
+  Detection detection;
+  detection.add_score(score);
+  detection.add_label_id(label_id);
+  LocationData* location_data = detection.mutable_location_data();
+  location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+  auto* box = location_data->mutable_relative_bounding_box();
+  box->set_xmin(xmin);
+  box->set_ymin(ymin);
+  box->set_width(0.25f);
+  box->set_height(0.5f);
+  for (int k = 0; k < num_keypoints; ++k) {
+    auto* keypoint = location_data->add_relative_keypoints();
+    keypoint->set_x(xmin + 0.01f * k);
+    keypoint->set_y(ymin + 0.02f * k);
+  }
+  return detection;
+}
+
+TEST(DetectionBatchTest, ConvertsDetectionsLosslessly) {
+  std::vector<Detection> detections = {CreateDetection(0.1f, 0.2f, 0.9f, 3, 2),
+                                       CreateDetection(0.4f, 0.3f, 0.5f, 0, 2)};
+  auto batch = DetectionBatch::FromDetections(detections);
+  MP_ASSERT_OK(batch);
+  ASSERT_EQ(2, batch.ValueOrDie().size());
+  EXPECT_EQ(2, batch.ValueOrDie().num_keypoints());
+  EXPECT_FLOAT_EQ(0.4f, batch.ValueOrDie().xmin()[1]);
+  EXPECT_FLOAT_EQ(0.9f, batch.ValueOrDie().score()[0]);
+  EXPECT_EQ(3, batch.ValueOrDie().label_id()[0]);
+  EXPECT_FLOAT_EQ(0.32f, batch.ValueOrDie().keypoints(1)[3]);
+
+  std::vector<Detection> round_trip = batch.ValueOrDie().ToDetections();
+  ASSERT_EQ(detections.size(), round_trip.size());
+  for (int i = 0; i < detections.size(); ++i) {
+    EXPECT_EQ(detections[i].SerializeAsString(),
+              round_trip[i].SerializeAsString());
+  }
+}
+
+TEST(DetectionBatchTest, OmitsMissingLabelId) {
+  Detection detection = CreateDetection(0.1f, 0.2f, 0.9f, 3, 0);
+  detection.clear_label_id();
+  DetectionBatch batch;
+  MP_ASSERT_OK(batch.Append(detection));
+  EXPECT_EQ(DetectionBatch::kNoLabelId, batch.label_id()[0]);
+  EXPECT_EQ(0, batch.GetDetection(0).label_id_size());
+}
+
+TEST(DetectionBatchTest, AddsFromOtherBatch) {
+  DetectionBatch batch(1);
+  int index = batch.Add(0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 6);
+  batch.mutable_keypoints(index)[0] = 0.7f;
+  batch.mutable_keypoints(index)[1] = 0.8f;
+  DetectionBatch other(1);
+  other.Add(0.f, 0.f, 1.f, 1.f, 1.f, 0);
+  EXPECT_EQ(1, other.AddFrom(batch, index));
+  EXPECT_FLOAT_EQ(0.4f, other.height()[1]);
+  EXPECT_EQ(6, other.label_id()[1]);
+  EXPECT_FLOAT_EQ(0.8f, other.keypoints(1)[1]);
+}
+
+TEST(DetectionBatchTest, RejectsUnrepresentableDetections) {
+  Detection with_label = CreateDetection(0.1f, 0.2f, 0.9f, 3, 0);
+  with_label.add_label("face");
+  EXPECT_FALSE(DetectionBatch::FromDetections({with_label}).ok());
+
+  Detection with_two_scores = CreateDetection(0.1f, 0.2f, 0.9f, 3, 0);
+  with_two_scores.add_score(0.1f);
+  with_two_scores.add_label_id(4);
+  EXPECT_FALSE(DetectionBatch::FromDetections({with_two_scores}).ok());
+
+  Detection absolute = CreateDetection(0.1f, 0.2f, 0.9f, 3, 0);
+  absolute.mutable_location_data()->set_format(LocationData::BOUNDING_BOX);
+  EXPECT_FALSE(DetectionBatch::FromDetections({absolute}).ok());
+
+  EXPECT_FALSE(DetectionBatch::FromDetections(
+                   {CreateDetection(0.1f, 0.2f, 0.9f, 3, 2),
+                    CreateDetection(0.1f, 0.2f, 0.9f, 3, 1)})
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -25,6 +25,7 @@
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/packet_byte_size.h"
 #include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/proto_ns.h"
@@ -405,4 +406,9 @@ void ImageFrame::CopyToBuffer(float* buffer, int buffer_size) const {
                          reinterpret_cast<char*>(buffer));
   }
 }
+
+REGISTER_PACKET_BYTE_SIZE(ImageFrame, [](const ImageFrame& frame) {
+  return static_cast<int64>(frame.WidthStep()) * frame.Height();
+});
+
 }  // namespace mediapipe
@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_pool.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns the row size of the frames allocated by ImageFrame with the default
+// alignment boundary.
+int AlignedWidthStep(int width, ImageFormat::Format format) {
+  const int row_size = width * ImageFrame::NumberOfChannelsForFormat(format) *
+                       ImageFrame::ByteDepthForFormat(format);
+  const int alignment = ImageFrame::kDefaultAlignmentBoundary;
+  return (row_size + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+ImageFramePool::ImageFramePool(int width, int height,
+                               ImageFormat::Format format, int keep_count)
+    : width_(width),
+      height_(height),
+      format_(format),
+      keep_count_(keep_count),
+      width_step_(AlignedWidthStep(width, format)) {}
+
+std::unique_ptr<ImageFrame> ImageFramePool::GetBuffer() {
+  PixelData pixels;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!available_.empty()) {
+      pixels = std::move(available_.back());
+      available_.pop_back();
+    }
+    ++in_use_count_;
+  }
+  if (!pixels) {
+    // ImageFrame allocates the pixels, which are then managed by the pool.
+    ImageFrame frame(format_, width_, height_);
+    DCHECK_EQ(width_step_, frame.WidthStep());
+    pixels = frame.Release();
+  }
+
+  // Return a frame with a custom deleter that adds the pixels back to our
+  // available list.
+  std::weak_ptr<ImageFramePool> weak_pool(shared_from_this());
+  return absl::make_unique<ImageFrame>(
+      format_, width_, height_, width_step_, pixels.release(),
+      [weak_pool](uint8* data) {
+        auto pool = weak_pool.lock();
+        if (pool) {
+          pool->Return(data);
+        } else {
+          ImageFrame::PixelDataDeleter::kAlignedFree(data);
+        }
+      });
+}
+
+std::pair<int, int> ImageFramePool::GetInUseAndAvailableCounts() {
+  absl::MutexLock lock(&mutex_);
+  return {in_use_count_, available_.size()};
+}
+
+void ImageFramePool::Return(uint8* pixels) {
+  absl::MutexLock lock(&mutex_);
+  --in_use_count_;
+  available_.emplace_back(pixels, ImageFrame::PixelDataDeleter::kAlignedFree);
+  TrimAvailable();
+}
+
+void ImageFramePool::TrimAvailable() {
+  int keep = std::max(keep_count_ - in_use_count_, 0);
+  if (available_.size() > keep) {
+    available_.resize(keep);
+  }
+}
+
+}  // namespace mediapipe
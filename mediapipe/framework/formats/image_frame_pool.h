@@ -0,0 +1,91 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A pool of the pixel buffers of ImageFrames of one size and format, the CPU
+// counterpart of GlTextureBufferPool.  The frames returned by GetBuffer()
+// give their pixels back to the pool when they are destroyed, so that a
+// calculator which outputs a frame per packet does not allocate and free the
+// pixels of each frame.  The pool is thread-safe.
+//
+// Example usage:
+//   if (!pool_ || pool_->width() != width || pool_->height() != height) {
+//     pool_ = ImageFramePool::Create(width, height, ImageFormat::SRGB, 4);
+//   }
+//   std::unique_ptr<ImageFrame> frame = pool_->GetBuffer();
+class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
+ public:
+  // Creates a pool. This pool will manage buffers of the specified dimensions,
+  // and will keep keep_count buffers around for reuse.
+  // We enforce creation as a shared_ptr so that we can use a weak reference in
+  // the frames' deleters.
+  static std::shared_ptr<ImageFramePool> Create(int width, int height,
+                                                ImageFormat::Format format,
+                                                int keep_count) {
+    return std::shared_ptr<ImageFramePool>(
+        new ImageFramePool(width, height, format, keep_count));
+  }
+
+  // Obtains a frame, whose pixels may either be reused or allocated anew.
+  // The pixels are not initialized.  Rows are aligned to
+  // ImageFrame::kDefaultAlignmentBoundary.
+  std::unique_ptr<ImageFrame> GetBuffer();
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  ImageFormat::Format format() const { return format_; }
+
+  // This method is meant for testing.
+  std::pair<int, int> GetInUseAndAvailableCounts();
+
+ private:
+  using PixelData = std::unique_ptr<uint8[], ImageFrame::Deleter>;
+
+  ImageFramePool(int width, int height, ImageFormat::Format format,
+                 int keep_count);
+
+  // Return the pixels of a frame to the pool.
+  void Return(uint8* pixels);
+
+  // If the total number of buffers is greater than keep_count, destroys any
+  // surplus buffers that are no longer in use.
+  void TrimAvailable() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int width_;
+  const int height_;
+  const ImageFormat::Format format_;
+  const int keep_count_;
+  const int width_step_;
+
+  absl::Mutex mutex_;
+  int in_use_count_ GUARDED_BY(mutex_) = 0;
+  std::vector<PixelData> available_ GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_H_
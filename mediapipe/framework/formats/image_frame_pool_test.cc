@@ -0,0 +1,63 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_pool.h"
+
+#include <memory>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ImageFramePoolTest, ReusesReturnedPixels) {
+  auto pool = ImageFramePool::Create(15, 7, ImageFormat::SRGB, 2);
+  std::unique_ptr<ImageFrame> frame = pool->GetBuffer();
+  EXPECT_EQ(ImageFormat::SRGB, frame->Format());
+  EXPECT_EQ(15, frame->Width());
+  EXPECT_EQ(7, frame->Height());
+  EXPECT_TRUE(frame->IsAligned(ImageFrame::kDefaultAlignmentBoundary));
+  EXPECT_EQ(std::make_pair(1, 0), pool->GetInUseAndAvailableCounts());
+
+  const uint8* pixels = frame->PixelData();
+  frame.reset();
+  EXPECT_EQ(std::make_pair(0, 1), pool->GetInUseAndAvailableCounts());
+  frame = pool->GetBuffer();
+  EXPECT_EQ(pixels, frame->PixelData());
+}
+
+TEST(ImageFramePoolTest, KeepsAtMostKeepCountBuffers) {
+  auto pool = ImageFramePool::Create(4, 4, ImageFormat::GRAY8, 2);
+  std::unique_ptr<ImageFrame> frames[3];
+  for (auto& frame : frames) {
+    frame = pool->GetBuffer();
+  }
+  EXPECT_EQ(std::make_pair(3, 0), pool->GetInUseAndAvailableCounts());
+  for (auto& frame : frames) {
+    frame.reset();
+  }
+  EXPECT_EQ(std::make_pair(0, 2), pool->GetInUseAndAvailableCounts());
+}
+
+TEST(ImageFramePoolTest, FramesOutliveThePool) {
+  auto pool = ImageFramePool::Create(8, 2, ImageFormat::SRGBA, 1);
+  std::unique_ptr<ImageFrame> frame = pool->GetBuffer();
+  pool.reset();
+  frame->SetToZero();
+  frame.reset();
+}
+
+}  // namespace
+}  // namespace mediapipe
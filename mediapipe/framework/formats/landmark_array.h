@@ -0,0 +1,121 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A compact, struct-of-arrays representation of a list of landmarks, as an
+// alternative to std::vector<Landmark> and std::vector<NormalizedLandmark>.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe {
+
+// A list of landmarks, with the x, y and z coordinates of all landmarks each
+// stored in a contiguous array.  Whether the coordinates are normalized is
+// determined by the stream carrying the array, as for the landmark protos.
+class LandmarkArray {
+ public:
+  // A view of one landmark with the accessors of the landmark protos, so that
+  // code templated on the landmark list type also accepts a LandmarkArray.
+  class LandmarkView {
+   public:
+    LandmarkView(const LandmarkArray* array, int index)
+        : array_(array), index_(index) {}
+    float x() const { return array_->x_[index_]; }
+    float y() const { return array_->y_[index_]; }
+    float z() const { return array_->z_[index_]; }
+
+   private:
+    const LandmarkArray* array_;
+    int index_;
+  };
+
+  LandmarkArray() = default;
+  // Creates "size" landmarks at the origin.
+  explicit LandmarkArray(int size) : x_(size), y_(size), z_(size) {}
+
+  // Returns the number of landmarks.
+  int size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+
+  // Reserves space for "capacity" landmarks.
+  void Reserve(int capacity) {
+    x_.reserve(capacity);
+    y_.reserve(capacity);
+    z_.reserve(capacity);
+  }
+
+  // Removes all landmarks.
+  void Clear() {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+  }
+
+  // Appends a landmark and returns its index.
+  int Add(float x, float y, float z) {
+    x_.push_back(x);
+    y_.push_back(y);
+    z_.push_back(z);
+    return size() - 1;
+  }
+
+  // The coordinates of all landmarks, indexed by landmark.  The pointers are
+  // invalidated by Add() and Clear().
+  const float* x() const { return x_.data(); }
+  const float* y() const { return y_.data(); }
+  const float* z() const { return z_.data(); }
+  float* mutable_x() { return x_.data(); }
+  float* mutable_y() { return y_.data(); }
+  float* mutable_z() { return z_.data(); }
+
+  // Returns a view of the landmark at "index".
+  LandmarkView operator[](int index) const { return LandmarkView(this, index); }
+
+  // Converts a list of Landmark or NormalizedLandmark protos.
+  template <typename LandmarkType>
+  static LandmarkArray FromLandmarks(
+      const std::vector<LandmarkType>& landmarks) {
+    LandmarkArray result;
+    result.Reserve(landmarks.size());
+    for (const auto& landmark : landmarks) {
+      result.Add(landmark.x(), landmark.y(), landmark.z());
+    }
+    return result;
+  }
+
+  // Converts to a list of Landmark or NormalizedLandmark protos.
+  template <typename LandmarkType>
+  std::vector<LandmarkType> ToLandmarks() const {
+    std::vector<LandmarkType> result(size());
+    for (int i = 0; i < size(); ++i) {
+      result[i].set_x(x_[i]);
+      result[i].set_y(y_[i]);
+      result[i].set_z(z_[i]);
+    }
+    return result;
+  }
+
+ private:
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> z_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
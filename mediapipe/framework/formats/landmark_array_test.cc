@@ -0,0 +1,79 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/landmark_array.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+NormalizedLandmark CreateLandmark(float x, float y, float z) {
+  NormalizedLandmark landmark;
+  landmark.set_x(x);
+  landmark.set_y(y);
+  landmark.set_z(z);
+  return landmark;
+}
+
+TEST(LandmarkArrayTest, ConvertsLandmarksLosslessly) {
+  std::vector<NormalizedLandmark> landmarks = {
+      CreateLandmark(0.1f, 0.2f, 0.3f), CreateLandmark(0.4f, 0.5f, -0.6f)};
+  LandmarkArray array = LandmarkArray::FromLandmarks(landmarks);
+  ASSERT_EQ(2, array.size());
+  EXPECT_FLOAT_EQ(0.4f, array.x()[1]);
+  EXPECT_FLOAT_EQ(0.2f, array.y()[0]);
+  EXPECT_FLOAT_EQ(-0.6f, array.z()[1]);
+
+  std::vector<NormalizedLandmark> round_trip =
+      array.ToLandmarks<NormalizedLandmark>();
+  ASSERT_EQ(landmarks.size(), round_trip.size());
+  for (int i = 0; i < landmarks.size(); ++i) {
+    EXPECT_EQ(landmarks[i].x(), round_trip[i].x());
+    EXPECT_EQ(landmarks[i].y(), round_trip[i].y());
+    EXPECT_EQ(landmarks[i].z(), round_trip[i].z());
+  }
+}
+
+TEST(LandmarkArrayTest, ViewsMatchCoordinates) {
+  LandmarkArray array;
+  array.Reserve(2);
+  EXPECT_TRUE(array.empty());
+  EXPECT_EQ(0, array.Add(1.0f, 2.0f, 3.0f));
+  EXPECT_EQ(1, array.Add(4.0f, 5.0f, 6.0f));
+  array.mutable_y()[1] = 7.0f;
+  EXPECT_EQ(4.0f, array[1].x());
+  EXPECT_EQ(7.0f, array[1].y());
+  EXPECT_EQ(6.0f, array[1].z());
+  EXPECT_EQ(3.0f, array[0].z());
+
+  array.Clear();
+  EXPECT_TRUE(array.empty());
+}
+
+TEST(LandmarkArrayTest, CreatesLandmarksAtOrigin) {
+  LandmarkArray array(3);
+  ASSERT_EQ(3, array.size());
+  for (int i = 0; i < array.size(); ++i) {
+    EXPECT_EQ(0.0f, array[i].x());
+    EXPECT_EQ(0.0f, array[i].y());
+    EXPECT_EQ(0.0f, array[i].z());
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
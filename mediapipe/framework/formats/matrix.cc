@@ -15,6 +15,7 @@
 
 #include <algorithm>
 
+#include "mediapipe/framework/packet_byte_size.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/proto_ns.h"
@@ -62,4 +63,9 @@ void MatrixFromTextProto(const std::string& text_proto, Matrix* matrix) {
   MatrixFromMatrixDataProto(matrix_data, matrix);
 }
 #endif  // !defined(MEDIAPIPE_MOBILE) && !defined(MEDIAPIPE_LITE)
+
+REGISTER_PACKET_BYTE_SIZE(Matrix, [](const Matrix& matrix) {
+  return static_cast<int64>(matrix.size()) * sizeof(float);
+});
+
 }  // namespace mediapipe
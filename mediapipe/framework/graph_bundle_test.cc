@@ -0,0 +1,173 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/graph_bundle.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+namespace {
+
+// Passes "INPUT" through two PassThroughCalculators to "OUTPUT".
+class TwoPassThroughSubgraph : public Subgraph {
+ public:
+  ::mediapipe::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& /*options*/) override {
+    return ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+      input_stream: "INPUT:input"
+      output_stream: "OUTPUT:output"
+      node {
+        calculator: "PassThroughCalculator"
+        input_stream: "middle"
+        output_stream: "output"
+      }
+      node {
+        calculator: "PassThroughCalculator"
+        input_stream: "input"
+        output_stream: "middle"
+      }
+    )");
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(TwoPassThroughSubgraph);
+
+// Outputs an int packet.
+class IntSourceCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Index(0).Set<int>();
+    return ::mediapipe::OkStatus();
+  }
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    return tool::StatusStop();
+  }
+};
+REGISTER_CALCULATOR(IntSourceCalculator);
+
+// Consumes std::string packets.
+class StringSinkCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<std::string>();
+    return ::mediapipe::OkStatus();
+  }
+  ::mediapipe::Status Process(CalculatorContext* cc) override {
+    return ::mediapipe::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(StringSinkCalculator);
+
+CalculatorGraphConfig SubgraphConfig() {
+  return ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+    input_stream: "in"
+    num_threads: 2
+    node {
+      calculator: "TwoPassThroughSubgraph"
+      input_stream: "INPUT:in"
+      output_stream: "OUTPUT:out"
+    }
+  )");
+}
+
+TEST(GraphBundleTest, BundleIsExpandedAndSorted) {
+  GraphBundle bundle;
+  MP_ASSERT_OK(CreateGraphBundle(SubgraphConfig(), &bundle));
+  EXPECT_EQ(ValidatedGraphConfig::kGraphBundleVersion, bundle.version());
+  const CalculatorGraphConfig& config = bundle.config();
+  ASSERT_EQ(2, config.node_size());
+  // The subgraph's nodes are listed in topological order.
+  EXPECT_EQ("PassThroughCalculator", config.node(0).calculator());
+  EXPECT_EQ("in", config.node(0).input_stream(0));
+  EXPECT_EQ("PassThroughCalculator", config.node(1).calculator());
+  EXPECT_EQ("out", config.node(1).output_stream(0));
+  // num_threads is converted into the default executor's config.
+  EXPECT_EQ(0, config.num_threads());
+  ASSERT_EQ(1, config.executor_size());
+  EXPECT_EQ("", config.executor(0).name());
+}
+
+TEST(GraphBundleTest, RunsGraphFromBundle) {
+  CalculatorGraphConfig config = SubgraphConfig();
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("out", &config, &output_packets);
+  GraphBundle bundle;
+  MP_ASSERT_OK(CreateGraphBundle(config, &bundle));
+  // Round trip the bundle, as it would be loaded from a file.
+  std::string serialized;
+  ASSERT_TRUE(bundle.SerializeToString(&serialized));
+  GraphBundle loaded_bundle;
+  ASSERT_TRUE(loaded_bundle.ParseFromString(serialized));
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(loaded_bundle));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(3, output_packets.size());
+  EXPECT_EQ(2, output_packets[2].Get<int>());
+  EXPECT_EQ(bundle.config().node_size(), graph.Config().node_size());
+}
+
+TEST(GraphBundleTest, RejectsUnsupportedVersion) {
+  GraphBundle bundle;
+  MP_ASSERT_OK(CreateGraphBundle(SubgraphConfig(), &bundle));
+  bundle.set_version(ValidatedGraphConfig::kGraphBundleVersion + 1);
+  CalculatorGraph graph;
+  ::mediapipe::Status status = graph.Initialize(bundle);
+  EXPECT_EQ(::mediapipe::StatusCode::kInvalidArgument, status.code());
+}
+
+TEST(GraphBundleTest, RejectsUnsortedBundle) {
+  GraphBundle bundle;
+  MP_ASSERT_OK(CreateGraphBundle(SubgraphConfig(), &bundle));
+  bundle.mutable_config()->mutable_node()->SwapElements(0, 1);
+  CalculatorGraph graph;
+  EXPECT_FALSE(graph.Initialize(bundle).ok());
+}
+
+TEST(GraphBundleTest, RejectsMismatchedStreamTypes) {
+  // A bundle whose calculators no longer agree on the packet types, e.g.
+  // because a calculator changed after the bundle was created.
+  GraphBundle bundle;
+  MP_ASSERT_OK(CreateGraphBundle(SubgraphConfig(), &bundle));
+  *bundle.mutable_config() =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        node { calculator: "IntSourceCalculator" output_stream: "value" }
+        node { calculator: "StringSinkCalculator" input_stream: "value" }
+      )");
+  CalculatorGraph graph;
+  EXPECT_FALSE(graph.Initialize(bundle).ok());
+}
+
+TEST(GraphBundleTest, ReportsInvalidConfig) {
+  CalculatorGraphConfig config = SubgraphConfig();
+  config.mutable_node(0)->set_calculator("NotRegisteredCalculator");
+  GraphBundle bundle;
+  EXPECT_FALSE(CreateGraphBundle(config, &bundle).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
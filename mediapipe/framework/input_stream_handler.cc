@@ -237,6 +237,7 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    StreamUpdated(id);
     notification_();
   }
 }
@@ -250,6 +251,7 @@ void InputStreamHandler::MovePackets(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    StreamUpdated(id);
     notification_();
   }
 }
@@ -263,6 +265,7 @@ void InputStreamHandler::SetNextTimestampBound(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    StreamUpdated(id);
     notification_();
   }
 }
@@ -215,6 +215,14 @@ class InputStreamHandler {
   virtual void FillInputSet(Timestamp input_timestamp,
                             InputStreamShardSet* input_set) = 0;
 
+  // Called when the input stream "id" becomes non-empty or its timestamp
+  // bound advances while it is empty, i.e. when its MinTimestampOrBound()
+  // may have changed.  Subclasses which keep track of the state of their
+  // input streams can override this to avoid examining every stream in
+  // GetNodeReadiness().  It is called before notification_, without holding
+  // the lock of the InputStreamManager.
+  virtual void StreamUpdated(CollectionItemId id) {}
+
   // Collection of InputStreamManager objects.
   InputStreamManagerSet input_stream_managers_;
   // A pointer to the calculator context manager of the calculator node.
@@ -14,12 +14,15 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
+#include <iterator>
 #include <type_traits>
 #include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_byte_size.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status_builder.h"
@@ -27,6 +30,23 @@
 
 namespace mediapipe {
 
+namespace {
+
+// Returns the QueueSizeStats histogram bucket for a queue size.
+int QueueSizeBucket(int queue_size) {
+  int bucket = 0;
+  while (queue_size > 0 &&
+         bucket < InputStreamManager::kNumQueueSizeBuckets - 1) {
+    queue_size >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+constexpr int InputStreamManager::kNumQueueSizeBuckets;
+
 ::mediapipe::Status InputStreamManager::Initialize(
     const std::string& name, const PacketType* packet_type, bool back_edge) {
   name_ = name;
@@ -45,6 +65,57 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
+void InputStreamManager::SetQueueBytesCallback(
+    QueueBytesCallback queue_bytes_callback) {
+  queue_bytes_callback_ = std::move(queue_bytes_callback);
+}
+
+void InputStreamManager::SetDropPolicy(int max_queued_packets,
+                                       int64 max_packet_age_usec) {
+  max_queued_packets_ = max_queued_packets;
+  max_packet_age_usec_ = max_packet_age_usec;
+}
+
+int InputStreamManager::DropPackets(int64* dropped_bytes) {
+  // The input stream handler may already have selected the packets up to
+  // observed_timestamp_, and pops them later when it fills the input set, so
+  // only the packets after them can be dropped.  The latest packet is kept.
+  auto first = queue_.begin();
+  while (first != queue_.end() && first->Timestamp() <= observed_timestamp_) {
+    ++first;
+  }
+  int num_dropped = 0;
+  while (first != queue_.end() && std::next(first) != queue_.end()) {
+    const Timestamp oldest = first->Timestamp();
+    const Timestamp latest = queue_.back().Timestamp();
+    const bool too_many =
+        max_queued_packets_ > 0 && queue_.size() > max_queued_packets_;
+    const bool too_old = max_packet_age_usec_ > 0 && oldest.IsRangeValue() &&
+                         latest.IsRangeValue() &&
+                         latest.Value() - oldest.Value() > max_packet_age_usec_;
+    if (!too_many && !too_old) {
+      break;
+    }
+    const int64 packet_bytes = TrackedByteSize(*first);
+    *dropped_bytes += packet_bytes;
+    queue_bytes_ -= packet_bytes;
+    first = queue_.erase(first);
+    ++num_dropped;
+  }
+  num_packets_dropped_ += num_dropped;
+  return num_dropped;
+}
+
+int64 InputStreamManager::TrackedByteSize(const Packet& packet) const {
+  return queue_bytes_callback_ ? PacketByteSize(packet) : 0;
+}
+
+void InputStreamManager::ReportQueueBytes(int64 delta) {
+  if (delta != 0) {
+    queue_bytes_callback_(this, delta);
+  }
+}
+
 void InputStreamManager::PrepareForRun() {
   absl::MutexLock stream_lock(&stream_mutex_);
   queue_.clear();
@@ -52,8 +123,15 @@ void InputStreamManager::PrepareForRun() {
   num_packets_added_ = 0;
   next_timestamp_bound_ = Timestamp::PreStream();
   last_select_timestamp_ = Timestamp::Unstarted();
+  observed_timestamp_ = Timestamp::Unset();
   closed_ = false;
   header_ = Packet();
+  std::fill(std::begin(queue_size_histogram_), std::end(queue_size_histogram_),
+            0);
+  max_queue_size_reached_ = 0;
+  queue_bytes_ = 0;
+  max_queue_bytes_reached_ = 0;
+  num_packets_dropped_ = 0;
 }
 
 bool InputStreamManager::IsEmpty() const {
@@ -66,6 +144,8 @@ Packet InputStreamManager::QueueHead() const {
   if (queue_.empty()) {
     return Packet();
   }
+  observed_timestamp_ =
+      std::max(observed_timestamp_, queue_.front().Timestamp());
   return queue_.front();
 }
 
@@ -95,6 +175,9 @@ template <typename Container>
   *notify = false;
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
+  int num_dropped = 0;
+  int64 added_bytes = 0;
+  int64 dropped_bytes = 0;
   {
     // Scope to prevent locking the stream when notification is called.
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -152,6 +235,10 @@ template <typename Container>
       // If the caller is MovePackets(), packet's underlying holder should be
       // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
       ++num_packets_added_;
+      ++queue_size_histogram_[QueueSizeBucket(queue_.size())];
+      const int64 packet_bytes = TrackedByteSize(packet);
+      added_bytes += packet_bytes;
+      queue_bytes_ += packet_bytes;
       VLOG(2) << "Input stream:" << name_
               << " has added packet at time: " << packet.Timestamp();
       if (std::is_const<
@@ -161,6 +248,14 @@ template <typename Container>
         queue_.emplace_back(std::move(packet));
       }
     }
+    if (HasDropPolicy()) {
+      num_dropped = DropPackets(&dropped_bytes);
+      VLOG_IF(2, num_dropped > 0) << "Input stream:" << name_ << " dropped "
+                                  << num_dropped << " packets";
+    }
+    max_queue_size_reached_ =
+        std::max(max_queue_size_reached_, static_cast<int>(queue_.size()));
+    max_queue_bytes_reached_ = std::max(max_queue_bytes_reached_, queue_bytes_);
     queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
                          queue_.size() >= max_queue_size_);
     VLOG_IF(2, queue_.size() > 1)
@@ -170,11 +265,14 @@ template <typename Container>
             << " becomes non-empty status:" << queue_became_non_empty
             << " Size: " << queue_.size();
   }
+  ReportQueueBytes(added_bytes - dropped_bytes);
   if (queue_became_full) {
     VLOG(2) << "Queue became full: " << Name();
     becomes_full_callback_(this, &last_reported_stream_full_);
   }
-  *notify = queue_became_non_empty;
+  // Dropping packets changes the head of the queue, which the input stream
+  // handler needs to see even if the queue was already non-empty.
+  *notify = queue_became_non_empty || num_dropped > 0;
   return ::mediapipe::OkStatus();
 }
 
@@ -229,7 +327,12 @@ Timestamp InputStreamManager::MinTimestampOrBound(bool* is_empty) const {
   if (is_empty) {
     *is_empty = queue_.empty();
   }
-  return queue_.empty() ? next_timestamp_bound_ : queue_.front().Timestamp();
+  if (queue_.empty()) {
+    return next_timestamp_bound_;
+  }
+  observed_timestamp_ =
+      std::max(observed_timestamp_, queue_.front().Timestamp());
+  return queue_.front().Timestamp();
 }
 
 Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
@@ -239,6 +342,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
   *num_packets_dropped = -1;
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -266,6 +370,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      removed_bytes += TrackedByteSize(packet);
       current_timestamp = packet.Timestamp();
       ++(*num_packets_dropped);
     }
@@ -278,8 +383,10 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     VLOG(2) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_bytes_ -= removed_bytes;
     *stream_is_done = IsDone();
   }
+  ReportQueueBytes(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(2) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -291,6 +398,7 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   CHECK(!enable_timestamps_);
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -304,6 +412,7 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     if (!queue_.empty()) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      removed_bytes = TrackedByteSize(packet);
     } else {
       packet = Packet();
     }
@@ -311,8 +420,10 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     VLOG(2) << "Input stream removed a packet:" << name_
             << " Size:" << queue_.size();
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_bytes_ -= removed_bytes;
     *stream_is_done = IsDone();
   }
+  ReportQueueBytes(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(2) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -336,7 +447,7 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   {
     absl::MutexLock lock(&stream_mutex_);
     was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
-    max_queue_size_ = max_queue_size;
+    max_queue_size_ = HasDropPolicy() ? -1 : max_queue_size;
     is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
   }
 
@@ -355,6 +466,23 @@ bool InputStreamManager::IsFull() const {
   return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
 }
 
+int64 InputStreamManager::QueueBytes() const {
+  absl::MutexLock lock(&stream_mutex_);
+  return queue_bytes_;
+}
+
+InputStreamManager::QueueSizeStats InputStreamManager::GetQueueSizeStats()
+    const {
+  QueueSizeStats stats;
+  absl::MutexLock lock(&stream_mutex_);
+  stats.queue_size_histogram.assign(std::begin(queue_size_histogram_),
+                                    std::end(queue_size_histogram_));
+  stats.max_queue_size_reached = max_queue_size_reached_;
+  stats.max_queue_bytes_reached = max_queue_bytes_reached_;
+  stats.num_packets_dropped = num_packets_dropped_;
+  return stats;
+}
+
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
   absl::MutexLock lock(&stream_mutex_);
   if (queue_.empty()) {
@@ -365,6 +493,7 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   {
     absl::MutexLock lock(&stream_mutex_);
     // Checks if queue is full.
@@ -372,13 +501,16 @@ void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
         (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
 
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
+      removed_bytes += TrackedByteSize(queue_.front());
       queue_.pop_front();
     }
 
     VLOG(2) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_bytes_ -= removed_bytes;
   }
+  ReportQueueBytes(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(2) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -19,6 +19,7 @@
 #include <functional>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
@@ -45,12 +46,36 @@ namespace mediapipe {
 // callback in the scheduler.
 class InputStreamManager {
  public:
+  // The number of buckets in the queue size histogram.
+  static constexpr int kNumQueueSizeBuckets = 16;
+
+  // Queue size statistics recorded since the last PrepareForRun().
+  struct QueueSizeStats {
+    // Bucket 0 counts the packets that arrived at an empty queue.  Bucket i
+    // counts the packets that arrived when the queue held at least 2^(i-1)
+    // and fewer than 2^i packets.  The last bucket also counts all larger
+    // queue sizes.
+    std::vector<int64> queue_size_histogram;
+    // The largest number of packets held in the queue.
+    int max_queue_size_reached = 0;
+    // The largest number of bytes held in the queue, if tracked.  See
+    // SetQueueBytesCallback().
+    int64 max_queue_bytes_reached = 0;
+    // The number of packets dropped by the drop policy.  See
+    // SetDropPolicy().
+    int64 num_packets_dropped = 0;
+  };
+
   // Function type for becomes_full_callback and becomes_not_full_callback.
   // The arguments are the input stream manager and its
   // last_reported_stream_full_.  The value of last_reported_stream_full_ is
   // maintained by the callback.
   typedef std::function<void(InputStreamManager*, bool*)> QueueSizeCallback;
 
+  // Function type for queue_bytes_callback.  The arguments are the input
+  // stream manager and the change in the number of bytes held in its queue.
+  typedef std::function<void(InputStreamManager*, int64)> QueueBytesCallback;
+
   InputStreamManager(const InputStreamManager&) = delete;
   InputStreamManager& operator=(const InputStreamManager&) = delete;
 
@@ -76,7 +101,8 @@ class InputStreamManager {
   void PrepareForRun() LOCKS_EXCLUDED(stream_mutex_);
 
   // Adds a list of timestamped packets. Sets "notify" to true if the queue
-  // becomes non-empty. Does nothing if the input stream is closed.
+  // becomes non-empty, or if the drop policy drops packets from the head of
+  // the queue. Does nothing if the input stream is closed.
   //
   // The timestamp of each packet must satisfy Timestamp::IsAllowedInStream().
   // Unless DisableTimestamps() is called, packet timestamps must meet
@@ -147,12 +173,22 @@ class InputStreamManager {
   // Returns true iff the queue is full.
   bool IsFull() const LOCKS_EXCLUDED(stream_mutex_);
 
+  // Returns the approximate number of bytes held in the queue, or 0 if no
+  // queue_bytes_callback is set.
+  int64 QueueBytes() const LOCKS_EXCLUDED(stream_mutex_);
+
+  // Returns the queue size statistics recorded since the last
+  // PrepareForRun().
+  QueueSizeStats GetQueueSizeStats() const LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns the max queue size. -1 indicates that there is no maximum.
   int MaxQueueSize() const LOCKS_EXCLUDED(stream_mutex_);
 
   // Sets the maximum queue size for the stream. Used to determine when the
   // callbacks for becomes_full and becomes_not_full should be invoked. A value
-  // of -1 means that there is no maximum queue size.
+  // of -1 means that there is no maximum queue size.  A stream with a drop
+  // policy has no maximum queue size, since it drops packets instead of
+  // throttling its sources.
   void SetMaxQueueSize(int max_queue_size) LOCKS_EXCLUDED(stream_mutex_);
 
   // If there are equal to or more than n packets in the queue, this function
@@ -174,6 +210,27 @@ class InputStreamManager {
   void SetQueueSizeCallbacks(QueueSizeCallback becomes_full_callback,
                              QueueSizeCallback becomes_not_full_callback);
 
+  // If set, the approximate number of bytes held in the queue is tracked
+  // with PacketByteSize(), and the callback is invoked with every change.
+  // Byte tracking costs a type lookup per packet, so it is only enabled
+  // when a graph limits the number of buffered bytes.
+  void SetQueueBytesCallback(QueueBytesCallback queue_bytes_callback);
+
+  // Sets the policy for dropping queued packets as new packets are added.
+  // If "max_queued_packets" is positive, the oldest packets are dropped to
+  // keep at most that many packets.  If "max_packet_age_usec" is positive,
+  // the packets whose timestamps are more than that many microseconds
+  // earlier than the latest packet are dropped.  A packet that has been at
+  // the head of the queue in MinTimestampOrBound() or QueueHead() is never
+  // dropped, since the input stream handler may already have selected it.
+  // Must be called before SetMaxQueueSize().
+  void SetDropPolicy(int max_queued_packets, int64 max_packet_age_usec);
+
+  // Returns true if a drop policy is set.
+  bool HasDropPolicy() const {
+    return max_queued_packets_ > 0 || max_packet_age_usec_ > 0;
+  }
+
  private:
   // Adds or moves a list of timestamped packets. Sets "notify" to true if the
   // queue becomes non-empty. Returns an error if the packets have errors. Does
@@ -189,6 +246,17 @@ class InputStreamManager {
   // Returns true if the next timestamp bound reaches Timestamp::Done().
   bool IsDone() const EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
 
+  // Returns the number of bytes counted for "packet" in queue_bytes_.
+  int64 TrackedByteSize(const Packet& packet) const;
+
+  // Drops the oldest packets after observed_timestamp_ according to the drop
+  // policy.  Returns the number of dropped packets, and adds their tracked
+  // bytes to "dropped_bytes".
+  int DropPackets(int64* dropped_bytes) EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Reports a change of queue_bytes_ to queue_bytes_callback_.
+  void ReportQueueBytes(int64 delta) LOCKS_EXCLUDED(stream_mutex_);
+
   mutable absl::Mutex stream_mutex_;
   std::deque<Packet> queue_ GUARDED_BY(stream_mutex_);
   // The number of packets added to queue_.  Used to verify a packet at
@@ -210,6 +278,26 @@ class InputStreamManager {
   // The maximum queue size for this stream if set.
   int max_queue_size_ GUARDED_BY(stream_mutex_) = -1;
 
+  // The drop policy, see SetDropPolicy().
+  int max_queued_packets_ = -1;
+  int64 max_packet_age_usec_ = 0;
+  int64 num_packets_dropped_ GUARDED_BY(stream_mutex_) = 0;
+  // The latest timestamp of a packet reported at the head of the queue to the
+  // input stream handler.  Packets up to this timestamp are not dropped.
+  mutable Timestamp observed_timestamp_ GUARDED_BY(stream_mutex_);
+
+  // The queue size statistics, see QueueSizeStats.
+  int64 queue_size_histogram_[kNumQueueSizeBuckets]
+      GUARDED_BY(stream_mutex_) = {};
+  int max_queue_size_reached_ GUARDED_BY(stream_mutex_) = 0;
+
+  // The approximate number of bytes held in queue_, if tracked.
+  int64 queue_bytes_ GUARDED_BY(stream_mutex_) = 0;
+  int64 max_queue_bytes_reached_ GUARDED_BY(stream_mutex_) = 0;
+
+  // Callback to notify the framework of changes to queue_bytes_.
+  QueueBytesCallback queue_bytes_callback_;
+
   // Callback to notify the framework that we have hit the maximum queue size.
   QueueSizeCallback becomes_full_callback_;
 
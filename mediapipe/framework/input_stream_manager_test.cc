@@ -781,6 +781,122 @@ TEST_F(InputStreamManagerTest, QueueSizeTest) {
   expected_queue_becomes_not_full_count_ = 1;
 }
 
+TEST_F(InputStreamManagerTest, QueueSizeStats) {
+  std::list<Packet> packets;
+  for (int i = 1; i <= 5; ++i) {
+    packets.push_back(MakePacket<std::string>("packet").At(Timestamp(i * 10)));
+  }
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+
+  // The packets arrived at queue sizes 0, 1, 2, 3, and 4, which fall into
+  // the buckets [0, 1), [1, 2), [2, 4), [2, 4), and [4, 8).
+  InputStreamManager::QueueSizeStats stats =
+      input_stream_manager_->GetQueueSizeStats();
+  ASSERT_EQ(InputStreamManager::kNumQueueSizeBuckets,
+            stats.queue_size_histogram.size());
+  EXPECT_EQ(1, stats.queue_size_histogram[0]);
+  EXPECT_EQ(1, stats.queue_size_histogram[1]);
+  EXPECT_EQ(2, stats.queue_size_histogram[2]);
+  EXPECT_EQ(1, stats.queue_size_histogram[3]);
+  EXPECT_EQ(0, stats.queue_size_histogram[4]);
+  EXPECT_EQ(5, stats.max_queue_size_reached);
+
+  // Popping packets does not lower the high-water mark.
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(50), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ(5, input_stream_manager_->GetQueueSizeStats()
+                   .max_queue_size_reached);
+
+  // The stats are reset for the next run.
+  input_stream_manager_->PrepareForRun();
+  stats = input_stream_manager_->GetQueueSizeStats();
+  EXPECT_EQ(0, stats.max_queue_size_reached);
+  for (int64 count : stats.queue_size_histogram) {
+    EXPECT_EQ(0, count);
+  }
+}
+
+TEST_F(InputStreamManagerTest, DropPolicyKeepsLatestPackets) {
+  input_stream_manager_->SetDropPolicy(/*max_queued_packets=*/2,
+                                       /*max_packet_age_usec=*/0);
+  // A stream with a drop policy never becomes full.
+  input_stream_manager_->SetMaxQueueSize(1);
+  EXPECT_EQ(-1, input_stream_manager_->MaxQueueSize());
+
+  std::list<Packet> packets;
+  for (int i = 1; i <= 3; ++i) {
+    packets.push_back(MakePacket<std::string>("packet").At(Timestamp(i * 10)));
+  }
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+  EXPECT_EQ(Timestamp(20), input_stream_manager_->QueueHead().Timestamp());
+
+  // Packet 20 has been seen at the head of the queue, so the input stream
+  // handler may have selected it.  Packet 30 is dropped instead.
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(40)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+  EXPECT_EQ(Timestamp(20), input_stream_manager_->QueueHead().Timestamp());
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+  EXPECT_EQ(2, input_stream_manager_->GetQueueSizeStats().num_packets_dropped);
+
+  // Once packet 20 is popped, packet 40 is at the head and unseen, so it can
+  // be dropped.
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(20), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ(Timestamp(20), popped_packet_.Timestamp());
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(50)));
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(60)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+  EXPECT_EQ(Timestamp(50), input_stream_manager_->QueueHead().Timestamp());
+  EXPECT_EQ(3, input_stream_manager_->GetQueueSizeStats().num_packets_dropped);
+
+  // The drop count is reset for the next run.
+  input_stream_manager_->PrepareForRun();
+  EXPECT_EQ(0, input_stream_manager_->GetQueueSizeStats().num_packets_dropped);
+}
+
+TEST_F(InputStreamManagerTest, DropPolicyDropsOldPackets) {
+  input_stream_manager_->SetDropPolicy(/*max_queued_packets=*/-1,
+                                       /*max_packet_age_usec=*/15);
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(20)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+
+  // Packet 10 is now 20 microseconds older than the latest packet.
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(30)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(2, input_stream_manager_->QueueSize());
+  EXPECT_EQ(Timestamp(20), input_stream_manager_->QueueHead().Timestamp());
+
+  // Packet 20 is exactly 15 microseconds older than the latest packet.
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet").At(Timestamp(35)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // No notification
+  EXPECT_FALSE(notify_);
+  EXPECT_EQ(3, input_stream_manager_->QueueSize());
+  EXPECT_EQ(1, input_stream_manager_->GetQueueSizeStats().num_packets_dropped);
+}
+
 TEST_F(InputStreamManagerTest, InputReleaseTest) {
   packet_type_.Set<LifetimeTracker::Object>();
   input_stream_manager_ = absl::make_unique<InputStreamManager>();
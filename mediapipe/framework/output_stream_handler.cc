@@ -51,6 +51,13 @@ void OutputStreamHandler::PrepareForRun(
   propagation_state_ = kIdle;
 }
 
+void OutputStreamHandler::SetOffset(TimestampDiff offset) {
+  for (auto& manager : output_stream_managers_) {
+    manager->Spec()->offset_enabled = true;
+    manager->Spec()->offset = offset;
+  }
+}
+
 void OutputStreamHandler::Open(OutputStreamShardSet* output_shards) {
   CHECK(output_shards);
   PropagateOutputPackets(Timestamp::Unstarted(), output_shards);
@@ -126,12 +133,9 @@ void OutputStreamHandler::TryPropagateTimestampBound(Timestamp input_bound) {
   if (!input_bound.IsRangeValue()) {
     return;
   }
-  OutputStreamShard empty_output;
   for (OutputStreamManager* manager : output_stream_managers_) {
-    if (manager->OffsetEnabled() && !manager->IsClosed() &&
-        input_bound + manager->Offset() > manager->NextTimestampBound()) {
-      manager->PropagateUpdatesToMirrors(input_bound + manager->Offset(),
-                                         &empty_output);
+    if (manager->OffsetEnabled()) {
+      manager->PropagateTimestampBound(input_bound + manager->Offset());
     }
   }
 }
@@ -94,6 +94,11 @@ class OutputStreamHandler {
       const std::function<void(::mediapipe::Status)>& error_callback)
       LOCKS_EXCLUDED(timestamp_mutex_);
 
+  // Sets the timestamp offset of all output streams, as declared in the
+  // CalculatorContract.  Called after PrepareForRun(), so that the offset
+  // applies from the start of the run, before Calculator::Open().
+  void SetOffset(TimestampDiff offset);
+
   // Marks the output streams as started and propagates any changes made in
   // Calculator::Open().
   void Open(OutputStreamShardSet* output_shards);
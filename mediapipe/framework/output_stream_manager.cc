@@ -159,16 +159,21 @@ Timestamp OutputStreamManager::ComputeOutputTimestampBound(
 void OutputStreamManager::PropagateUpdatesToMirrors(
     Timestamp next_timestamp_bound, OutputStreamShard* output_stream_shard) {
   CHECK(output_stream_shard);
+  std::list<Packet>* packets_to_propagate = output_stream_shard->OutputQueue();
+  bool add_packets = !packets_to_propagate->empty();
   {
     absl::MutexLock lock(&stream_mutex_);
+    if (!add_packets && next_timestamp_bound == next_timestamp_bound_) {
+      // The mirrors already have this bound, which is the common case for
+      // sparse streams after an invocation that produced no output.
+      return;
+    }
     next_timestamp_bound_ = next_timestamp_bound;
   }
-  std::list<Packet>* packets_to_propagate = output_stream_shard->OutputQueue();
   VLOG(2) << "Output stream: " << Name()
           << " queue size: " << packets_to_propagate->size();
   VLOG(2) << "Output stream: " << Name()
           << " next timestamp: " << next_timestamp_bound;
-  bool add_packets = !packets_to_propagate->empty();
   bool set_bound =
       !add_packets ||
       packets_to_propagate->back().Timestamp().NextAllowedInStream() !=
@@ -196,6 +201,23 @@ void OutputStreamManager::PropagateUpdatesToMirrors(
   packets_to_propagate->clear();
 }
 
+void OutputStreamManager::PropagateTimestampBound(
+    Timestamp next_timestamp_bound) {
+  {
+    absl::MutexLock lock(&stream_mutex_);
+    if (closed_ || next_timestamp_bound <= next_timestamp_bound_) {
+      return;
+    }
+    next_timestamp_bound_ = next_timestamp_bound;
+  }
+  VLOG(2) << "Output stream: " << Name()
+          << " next timestamp: " << next_timestamp_bound;
+  for (const Mirror& mirror : mirrors_) {
+    mirror.input_stream_handler->SetNextTimestampBound(mirror.id,
+                                                       next_timestamp_bound);
+  }
+}
+
 void OutputStreamManager::ResetShard(OutputStreamShard* output_stream_shard) {
   Timestamp next_timestamp_bound;
   bool closed = false;
@@ -94,10 +94,16 @@ class OutputStreamManager {
       Timestamp input_timestamp) const;
 
   // Propagates the updates to the mirrors and clears the packet queue in
-  // the OutputStreamShard afterwards.
+  // the OutputStreamShard afterwards.  The mirrors are not touched if there
+  // are no packets and the bound has not changed.
   void PropagateUpdatesToMirrors(Timestamp next_timestamp_bound,
                                  OutputStreamShard* output_stream_shard);
 
+  // Raises the next timestamp bound of the stream and its mirrors to
+  // "next_timestamp_bound", if the stream is open and its bound is lower.
+  // This is a bound-only update which needs no OutputStreamShard.
+  void PropagateTimestampBound(Timestamp next_timestamp_bound);
+
   void ResetShard(OutputStreamShard* output_stream_shard);
 
   OutputStreamSpec* Spec() { return &output_stream_spec_; }
@@ -18,10 +18,12 @@
 #define MEDIAPIPE_FRAMEWORK_PACKET_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
 #include <typeinfo>
+#include <utility>
 
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
@@ -219,6 +221,32 @@ Packet Adopt(const T* ptr);
 template <typename T>
 Packet PointToForeign(const T* ptr);
 
+// Like PointToForeign(ptr), but calls "release" once the returned Packet and
+// all of its copies are destroyed, so that the caller can free the data or
+// return the memory holding it to its owner.  The data cannot be released by
+// Packet::Consume().
+template <typename T>
+Packet PointToForeign(const T* ptr, std::function<void()> release);
+
+// Returns a Packet holding a protobuf message allocated on an arena.  The
+// Packet and all of its copies share ownership of the arena, which is
+// destroyed along with the last Packet referencing it.  This allows a
+// calculator to allocate all of the messages it outputs for a timestamp,
+// and all of their sub-messages, on one arena:
+//
+//   auto arena = std::make_shared<proto_ns::Arena>();
+//   auto* render_data =
+//       proto_ns::Arena::CreateMessage<RenderData>(arena.get());
+//   ...
+//   cc->Outputs().Tag("RENDER_DATA").AddPacket(
+//       AdoptOnArena(render_data, arena).At(cc->InputTimestamp()));
+//
+// The arena-allocated message cannot be released by Packet::Consume(),
+// and is copied by Packet::ConsumeOrCopy().  The timestamp of the returned
+// Packet is Timestamp::Unset().
+template <typename T>
+Packet AdoptOnArena(const T* ptr, std::shared_ptr<proto_ns::Arena> arena);
+
 // Adopts the data but places it in a std::unique_ptr inside the
 // resulting Packet, leaving the timestamp unset. This allows the
 // adopted data to be mutated, with the mutable data accessible as
@@ -458,6 +486,39 @@ class ForeignHolder : public Holder<T> {
   }
 };
 
+// Like ForeignHolder, but calls a function when it is destroyed.  It is
+// identified as a ForeignHolder, so that Consume() does not release the data.
+template <typename T>
+class ReleasingHolder : public ForeignHolder<T> {
+ public:
+  ReleasingHolder(const T* ptr, std::function<void()> release)
+      : ForeignHolder<T>(ptr), release_(std::move(release)) {}
+  ~ReleasingHolder() override {
+    if (release_) {
+      release_();
+    }
+  }
+
+ private:
+  std::function<void()> release_;
+};
+
+// Like ForeignHolder, but shares ownership of the arena holding its data.
+// It is identified as a ForeignHolder, so that Consume() does not release
+// the data.
+template <typename T>
+class ArenaHolder : public ForeignHolder<T> {
+ public:
+  ArenaHolder(const T* ptr, std::shared_ptr<proto_ns::Arena> arena)
+      : ForeignHolder<T>(ptr), arena_(std::move(arena)) {
+    static_assert(std::is_base_of<proto_ns::MessageLite, T>::value,
+                  "Only protobuf messages can be allocated on an arena.");
+  }
+
+ private:
+  std::shared_ptr<proto_ns::Arena> arena_;
+};
+
 template <typename T>
 Holder<T>* HolderBase::As() {
   if (HolderIsOfType<Holder<T>>() || HolderIsOfType<ForeignHolder<T>>()) {
@@ -653,6 +714,21 @@ Packet PointToForeign(const T* ptr) {
   return packet_internal::Create(new packet_internal::ForeignHolder<T>(ptr));
 }
 
+template <typename T>
+Packet PointToForeign(const T* ptr, std::function<void()> release) {
+  CHECK(ptr != nullptr);
+  return packet_internal::Create(
+      new packet_internal::ReleasingHolder<T>(ptr, std::move(release)));
+}
+
+template <typename T>
+Packet AdoptOnArena(const T* ptr, std::shared_ptr<proto_ns::Arena> arena) {
+  CHECK(ptr != nullptr);
+  CHECK(arena != nullptr);
+  return packet_internal::Create(
+      new packet_internal::ArenaHolder<T>(ptr, std::move(arena)));
+}
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_PACKET_H_
@@ -0,0 +1,71 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_byte_size.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace packet_internal {
+
+namespace {
+
+struct Registry {
+  absl::Mutex mutex;
+  std::unordered_map<size_t, PacketByteSizeRegistry::SizeFunction> functions
+      GUARDED_BY(mutex);
+};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry();
+  return registry;
+}
+
+}  // namespace
+
+bool PacketByteSizeRegistry::Register(size_t type_id, SizeFunction function) {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  CHECK(registry->functions.emplace(type_id, std::move(function)).second)
+      << "A packet byte size function is already registered for type id "
+      << type_id;
+  return true;
+}
+
+const PacketByteSizeRegistry::SizeFunction* PacketByteSizeRegistry::Get(
+    size_t type_id) {
+  Registry* registry = GetRegistry();
+  absl::ReaderMutexLock lock(&registry->mutex);
+  auto it = registry->functions.find(type_id);
+  // Functions are never removed, so the pointer stays valid.
+  return it == registry->functions.end() ? nullptr : &it->second;
+}
+
+}  // namespace packet_internal
+
+int64 PacketByteSize(const Packet& packet) {
+  if (packet.IsEmpty()) {
+    return 0;
+  }
+  const packet_internal::PacketByteSizeRegistry::SizeFunction* function =
+      packet_internal::PacketByteSizeRegistry::Get(packet.GetTypeId());
+  return function ? (*function)(packet) : 0;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,70 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Approximate memory sizes of packet payloads, used to limit the number of
+// bytes buffered in the input streams of a graph.  See
+// CalculatorGraphConfig.max_buffered_bytes.
+//
+// The size function of a payload type is registered with:
+//
+//   REGISTER_PACKET_BYTE_SIZE(ImageFrame, [](const ImageFrame& frame) {
+//     return static_cast<int64>(frame.WidthStep()) * frame.Height();
+//   });
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_BYTE_SIZE_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_BYTE_SIZE_H_
+
+#include <functional>
+
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+
+// Returns the approximate number of bytes held by the payload of "packet",
+// as computed by the function registered for its type.  Returns 0 for an
+// empty packet and for types without a registered function, whose payloads
+// are assumed to be small.
+int64 PacketByteSize(const Packet& packet);
+
+namespace packet_internal {
+
+class PacketByteSizeRegistry {
+ public:
+  using SizeFunction = std::function<int64(const Packet&)>;
+
+  // Registers the size function for the packet type with type id
+  // "type_id".  Returns true so that it can initialize a static variable.
+  static bool Register(size_t type_id, SizeFunction function);
+
+  // Returns the size function for the type with id "type_id", or nullptr if
+  // none is registered.
+  static const SizeFunction* Get(size_t type_id);
+};
+
+}  // namespace packet_internal
+
+}  // namespace mediapipe
+
+#define REGISTER_PACKET_BYTE_SIZE(type, ...)                             \
+  static bool REGISTRY_STATIC_VAR(packet_byte_size, __LINE__) =          \
+      ::mediapipe::packet_internal::PacketByteSizeRegistry::Register(    \
+          ::mediapipe::tool::GetTypeHash<type>(),                        \
+          [](const ::mediapipe::Packet& packet) -> ::int64 {             \
+            return (__VA_ARGS__)(packet.Get<type>());                    \
+          })
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_BYTE_SIZE_H_
@@ -383,6 +383,55 @@ TEST(PacketTest, TestForeignHolderConsumeOrCopy) {
   EXPECT_EQ(33, *result2.ValueOrDie());
 }
 
+TEST(PacketTest, PointToForeignCallsReleaseWithLastCopy) {
+  int value = 7;
+  int num_releases = 0;
+  Packet packet = PointToForeign(&value, [&num_releases]() { ++num_releases; });
+  Packet packet_copy = packet.At(Timestamp(1));
+  packet = Packet();
+  EXPECT_EQ(0, num_releases);
+  EXPECT_EQ(7, packet_copy.Get<int>());
+  EXPECT_FALSE(packet_copy.Consume<int>().ok());
+  packet_copy = Packet();
+  EXPECT_EQ(1, num_releases);
+}
+
+TEST(PacketTest, AdoptOnArenaSharesArenaOwnership) {
+  auto arena = std::make_shared<proto_ns::Arena>();
+  std::weak_ptr<proto_ns::Arena> weak_arena = arena;
+  auto* proto =
+      proto_ns::Arena::CreateMessage<::mediapipe::PacketTestProto>(
+          arena.get());
+  proto->add_x(123);
+  Packet packet = AdoptOnArena(proto, std::move(arena));
+  Packet packet_copy = packet.At(Timestamp(1));
+  packet = Packet();
+  EXPECT_FALSE(weak_arena.expired());
+  EXPECT_EQ(123, packet_copy.Get<::mediapipe::PacketTestProto>().x(0));
+  MP_EXPECT_OK(packet_copy.ValidateAsProtoMessageLite());
+  packet_copy = Packet();
+  EXPECT_TRUE(weak_arena.expired());
+}
+
+TEST(PacketTest, TestArenaHolderConsumeOrCopy) {
+  auto arena = std::make_shared<proto_ns::Arena>();
+  auto* proto =
+      proto_ns::Arena::CreateMessage<::mediapipe::PacketTestProto>(
+          arena.get());
+  proto->add_x(33);
+  Packet packet = AdoptOnArena(proto, std::move(arena));
+  // The message is owned by the arena, so it can't be released.
+  EXPECT_FALSE(packet.Consume<::mediapipe::PacketTestProto>().ok());
+  bool was_copied = false;
+  auto result =
+      packet.ConsumeOrCopy<::mediapipe::PacketTestProto>(&was_copied);
+  MP_ASSERT_OK(result);
+  EXPECT_TRUE(was_copied);
+  EXPECT_TRUE(packet.IsEmpty());
+  EXPECT_EQ(nullptr, result.ValueOrDie()->GetArena());
+  EXPECT_EQ(33, result.ValueOrDie()->x(0));
+}
+
 TEST(PacketTest, TestConsumeBoundedArray) {
   Packet packet1 = MakePacket<int[3]>(10, 20, 30);
   Packet packet_copy = packet1;
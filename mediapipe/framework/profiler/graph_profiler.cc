@@ -16,6 +16,7 @@
 
 #include <fstream>
 #include <list>
+#include <utility>
 
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
@@ -130,6 +131,7 @@ void GraphProfiler::Initialize(
   if (IsTracerEnabled(profiler_config_)) {
     packet_tracer_ = absl::make_unique<GraphTracer>(profiler_config_);
   }
+  use_hardware_counters_ = profiler_config_.enable_hardware_counters();
   for (int node_id = 0;
        node_id < validated_graph_config.CalculatorInfos().size(); ++node_id) {
     std::string node_name =
@@ -194,6 +196,9 @@ void GraphProfiler::Reset() {
          *(calculator_profile->mutable_input_stream_profiles())) {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
     }
+    if (calculator_profile->has_process_counters()) {
+      calculator_profile->mutable_process_counters()->Clear();
+    }
   }
 }
 
@@ -276,6 +281,12 @@ void GraphProfiler::AddPacketInfo(const TraceEvent& packet_info) {
                         production_time_usec, production_time_usec);
 }
 
+void GraphProfiler::SetGraphStatsCallback(
+    std::function<void(GraphProfile*)> callback) {
+  absl::WriterMutexLock lock(&profiler_mutex_);
+  graph_stats_callback_ = std::move(callback);
+}
+
 ::mediapipe::Status GraphProfiler::GetCalculatorProfiles(
     std::vector<CalculatorProfile>* profiles) const {
   absl::ReaderMutexLock lock(&profiler_mutex_);
@@ -505,6 +516,46 @@ void GraphProfiler::AddProcessSample(
   }
 }
 
+void GraphProfiler::AddHardwareCounterSample(
+    GraphTrace::EventType event_type,
+    const CalculatorContext& calculator_context,
+    const PerfCounterValues& delta) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_) {
+    return;
+  }
+
+  const std::string& node_name = calculator_context.NodeName();
+  auto profile_iter = calculator_profiles_.find(node_name);
+  CHECK(profile_iter != calculator_profiles_.end()) << absl::Substitute(
+      "Calculator \"$0\" has not been added during initialization.",
+      calculator_context.NodeName());
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+
+  // Like open_runtime and close_runtime, the Open() and Close() counters
+  // record the latest invocation, while the Process() counters accumulate.
+  HardwareCounters* counters;
+  switch (event_type) {
+    case GraphTrace::OPEN:
+      counters = calculator_profile->mutable_open_counters();
+      counters->Clear();
+      break;
+    case GraphTrace::PROCESS:
+      counters = calculator_profile->mutable_process_counters();
+      break;
+    case GraphTrace::CLOSE:
+      counters = calculator_profile->mutable_close_counters();
+      counters->Clear();
+      break;
+    default:
+      return;
+  }
+  counters->set_cycles(counters->cycles() + delta.cycles);
+  counters->set_instructions(counters->instructions() + delta.instructions);
+  counters->set_cache_misses(counters->cache_misses() + delta.cache_misses);
+  counters->set_branch_misses(counters->branch_misses() + delta.branch_misses);
+}
+
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
   if (!IsTracerEnabled(profiler_config_)) {
     return nullptr;
@@ -609,6 +660,16 @@ void AssignNodeNames(GraphProfile* profile) {
   }
   this->Reset();
 
+  // Record the queue and throttling statistics kept by the graph.
+  std::function<void(GraphProfile*)> graph_stats_callback;
+  {
+    absl::ReaderMutexLock lock(&profiler_mutex_);
+    graph_stats_callback = graph_stats_callback_;
+  }
+  if (graph_stats_callback) {
+    graph_stats_callback(&profile);
+  }
+
   // Record the CalculatorGraphConfig, once per log file.
   ++previous_log_index_;
   bool is_new_file = (previous_log_index_ % log_interval_count == 0);
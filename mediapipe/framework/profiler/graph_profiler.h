@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
@@ -31,6 +32,7 @@
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
+#include "mediapipe/framework/profiler/perf_counters.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
@@ -80,12 +82,15 @@ class GraphProfilerTestPeer;
 // the graph (source nodes) to reach the Calculator.
 // - Process input latency: Process input latency + process runtime for a
 // packet.
+// - Optionally, hardware performance counters (cycles, instructions, cache
+// misses and branch misses) for Open(), Process(), and Close().
 //
 // The profiler can be configured in the graph definition:
 //   profiler_config {
 //     histogram_interval_size_usec : 2000000
 //     num_histogram_intervals : 5
 //     enable_profiler: true
+//     enable_hardware_counters: true
 //   }
 //
 // Because the graph definition affects the stream profiling and the profiler is
@@ -102,6 +107,7 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
         is_profiling_(false),
         calculator_profiles_(1000),
         packets_info_(1000),
+        use_hardware_counters_(false),
         is_running_(false),
         previous_log_end_time_(absl::InfinitePast()),
         previous_log_index_(-1),
@@ -157,6 +163,12 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // ProfilerConfig.  Includes events since the previous call to WriteProfile.
   ::mediapipe::Status WriteProfile();
 
+  // Sets a function that adds statistics kept by the graph itself, such as
+  // input queue sizes and throttled time, to each GraphProfile written by
+  // WriteProfile().
+  void SetGraphStatsCallback(std::function<void(GraphProfile*)> callback)
+      LOCKS_EXCLUDED(profiler_mutex_);
+
   // Returns the trace event buffer.
   GraphTracer* tracer() { return packet_tracer_.get(); }
 
@@ -177,16 +189,28 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                           GraphProfiler* profiler)
         : calculator_method_(event_type),
           calculator_context_(*calculator_context),
-          profiler_(profiler) {
+          profiler_(profiler),
+          perf_counters_(nullptr) {
       start_time_usec_ = profiler_->TimeNowUsec();
       if (profiler_->is_tracing_) {
         absl::Time time_now = absl::FromUnixMicros(start_time_usec_);
         profiler_->packet_tracer_->LogInputEvents(
             calculator_method_, &calculator_context_, time_now);
       }
+      // The counters are read last, so that profiler overhead is excluded.
+      if (profiler_->is_profiling_ && profiler_->use_hardware_counters_) {
+        perf_counters_ = PerfCounters::ForCurrentThread();
+        if (perf_counters_ && !perf_counters_->Read(&start_counters_)) {
+          perf_counters_ = nullptr;
+        }
+      }
     }
 
     inline ~Scope() {
+      PerfCounterValues end_counters;
+      if (perf_counters_ && !perf_counters_->Read(&end_counters)) {
+        perf_counters_ = nullptr;
+      }
       int64 end_time_usec;
       if (profiler_->is_profiling_ || profiler_->is_tracing_) {
         end_time_usec = profiler_->TimeNowUsec();
@@ -211,6 +235,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
           default:
             break;
         }
+        if (perf_counters_) {
+          profiler_->AddHardwareCounterSample(calculator_method_,
+                                              calculator_context_,
+                                              end_counters - start_counters_);
+        }
       }
       if (profiler_->is_tracing_) {
         absl::Time time_now = absl::FromUnixMicros(end_time_usec);
@@ -224,6 +253,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
     const CalculatorContext& calculator_context_;
     GraphProfiler* profiler_;
     int64 start_time_usec_;
+    // The counters of the calling thread, or nullptr if not recorded.
+    PerfCounters* perf_counters_;
+    PerfCounterValues start_counters_;
   };
 
  private:
@@ -291,6 +323,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                         int64 start_time_usec, int64 end_time_usec)
       LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Adds the hardware counter deltas of one Open(), Process(), or Close()
+  // invocation to the calculator profile.
+  void AddHardwareCounterSample(GraphTrace::EventType event_type,
+                                const CalculatorContext& calculator_context,
+                                const PerfCounterValues& delta)
+      LOCKS_EXCLUDED(profiler_mutex_);
+
   // Helper method to get trace_log_path.  If the trace_log_path is empty and
   // tracing is enabled, this function returns a default platform dependent
   // trace_log_path.
@@ -312,6 +351,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // If true, the tracer records timing events.
   std::atomic_bool is_tracing_;
 
+  // If true, hardware performance counters are recorded while profiling.
+  bool use_hardware_counters_;
+
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
@@ -341,6 +383,10 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
+  // Adds graph-owned statistics to each written GraphProfile.
+  std::function<void(GraphProfile*)> graph_stats_callback_
+      GUARDED_BY(profiler_mutex_);
+
   // For testing.
   friend GraphProfilerTestPeer;
 };
@@ -15,6 +15,8 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 
+#include <functional>
+
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
 
@@ -89,6 +91,8 @@ class GraphProfilerStub {
     return mediapipe::OkStatus();
   }
   inline ::mediapipe::Status Stop() { return mediapipe::OkStatus(); }
+  inline void SetGraphStatsCallback(
+      std::function<void(GraphProfile*)> callback) {}
   inline GraphTracer* tracer() { return nullptr; }
   inline std::unique_ptr<GlProfilingHelper> CreateGlProfilingHelper() {
     return nullptr;
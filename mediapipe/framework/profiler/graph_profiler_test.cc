@@ -941,6 +941,89 @@ TEST_F(GraphProfilerTestPeer, AddProcessSample) {
   ASSERT_EQ(GetPacketsInfoMap()->size(), 0);
 }
 
+// Tests that the profiler scope records hardware counters for Process() only
+// when enable_hardware_counters is set and the platform supports them.
+TEST_F(GraphProfilerTestPeer, AddProcessSampleWithHardwareCounters) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+      enable_hardware_counters: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  context.AddInputs({MakePacket<std::string>("5").At(Timestamp(100))});
+  context.AddOutputs({{MakePacket<std::string>("15").At(Timestamp(100))}});
+
+  volatile int64 sum = 0;
+  for (int i = 0; i < 2; ++i) {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS, context.get(),
+                                        &profiler_);
+    for (int j = 0; j < 10000; ++j) {
+      sum += j;
+    }
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_FALSE(profiles[0].has_open_counters());
+  EXPECT_FALSE(profiles[0].has_close_counters());
+  PerfCounters* counters = PerfCounters::ForCurrentThread();
+  if (counters == nullptr) {
+    // Hardware counters are not available on this machine.
+    EXPECT_FALSE(profiles[0].has_process_counters());
+    return;
+  }
+  ASSERT_TRUE(profiles[0].has_process_counters());
+  // Some hosts only allow a subset of the counters to be opened.
+  if (counters->HasCounter(&PerfCounterValues::instructions)) {
+    EXPECT_GT(profiles[0].process_counters().instructions(), 20000);
+  }
+
+  // Reset() clears the accumulated Process() counters.
+  profiler_.Reset();
+  profiles = Profiles();
+  EXPECT_EQ(profiles[0].process_counters().instructions(), 0);
+}
+
+// Tests that hardware counters are not recorded unless enabled.
+TEST_F(GraphProfilerTestPeer, HardwareCountersDisabledByDefault) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  context.AddInputs({MakePacket<std::string>("5").At(Timestamp(100))});
+  context.AddOutputs({{MakePacket<std::string>("15").At(Timestamp(100))}});
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::OPEN, context.get(),
+                                        &profiler_);
+  }
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS, context.get(),
+                                        &profiler_);
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_FALSE(profiles[0].has_open_counters());
+  EXPECT_FALSE(profiles[0].has_process_counters());
+}
+
 // Tests that AddProcessSample() updates |process_runtime| and also updates the
 // packet info map when stream latency is enabled.
 TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
@@ -0,0 +1,376 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/live_profile_exporter.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/core_proto_inc.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+#if !defined(MEDIAPIPE_PROTO_LITE)
+#include "google/protobuf/util/json_util.h"
+#endif  // !defined(MEDIAPIPE_PROTO_LITE)
+
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+
+namespace mediapipe {
+
+const char LiveProfileExporter::kUnixSocketPrefix[] = "unix:";
+
+namespace {
+
+constexpr int64 kDefaultIntervalUsec = 1000000;
+
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+constexpr int kListenBacklog = 8;
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif  // MSG_NOSIGNAL
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+
+// Returns current - previous, or current if the value was reset in between.
+int64 Delta(int64 current, int64 previous) {
+  return current >= previous ? current - previous : current;
+}
+
+void SubtractHistogram(const TimeHistogram& previous, TimeHistogram* current) {
+  // A smaller total indicates that the histogram was reset in between.
+  if (current->total() < previous.total() ||
+      current->count_size() != previous.count_size()) {
+    return;
+  }
+  current->set_total(current->total() - previous.total());
+  for (int i = 0; i < current->count_size(); ++i) {
+    current->set_count(i, Delta(current->count(i), previous.count(i)));
+  }
+}
+
+void SubtractCounters(const HardwareCounters& previous,
+                      HardwareCounters* current) {
+  current->set_cycles(Delta(current->cycles(), previous.cycles()));
+  current->set_instructions(
+      Delta(current->instructions(), previous.instructions()));
+  current->set_cache_misses(
+      Delta(current->cache_misses(), previous.cache_misses()));
+  current->set_branch_misses(
+      Delta(current->branch_misses(), previous.branch_misses()));
+}
+
+// Replaces the cumulative values in "current" with the values recorded since
+// "previous" was reported.  The open and close runtimes are not cumulative,
+// and are kept as reported.
+void SubtractProfile(const CalculatorProfile& previous,
+                     CalculatorProfile* current) {
+  if (current->has_process_runtime()) {
+    SubtractHistogram(previous.process_runtime(),
+                      current->mutable_process_runtime());
+  }
+  if (current->has_process_input_latency()) {
+    SubtractHistogram(previous.process_input_latency(),
+                      current->mutable_process_input_latency());
+  }
+  if (current->has_process_output_latency()) {
+    SubtractHistogram(previous.process_output_latency(),
+                      current->mutable_process_output_latency());
+  }
+  if (current->input_stream_profiles_size() ==
+      previous.input_stream_profiles_size()) {
+    for (int i = 0; i < current->input_stream_profiles_size(); ++i) {
+      StreamProfile* stream = current->mutable_input_stream_profiles(i);
+      if (stream->has_latency()) {
+        SubtractHistogram(previous.input_stream_profiles(i).latency(),
+                          stream->mutable_latency());
+      }
+    }
+  }
+  if (current->has_open_counters()) {
+    SubtractCounters(previous.open_counters(),
+                     current->mutable_open_counters());
+  }
+  if (current->has_process_counters()) {
+    SubtractCounters(previous.process_counters(),
+                     current->mutable_process_counters());
+  }
+  if (current->has_close_counters()) {
+    SubtractCounters(previous.close_counters(),
+                     current->mutable_close_counters());
+  }
+}
+
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+bool SetNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+void SetNoSigPipe(int fd) {
+#if defined(SO_NOSIGPIPE)
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif  // SO_NOSIGPIPE
+}
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+
+}  // namespace
+
+LiveProfileExporter::LiveProfileExporter(const ProfilerConfig& config,
+                                         SnapshotCallback snapshot_callback)
+    : config_(config),
+      snapshot_callback_(std::move(snapshot_callback)),
+      interval_(absl::Microseconds(config.live_profile_interval_usec() > 0
+                                       ? config.live_profile_interval_usec()
+                                       : kDefaultIntervalUsec)) {
+  const std::string& path = config_.live_profile_path();
+  if (absl::StartsWith(path, kUnixSocketPrefix)) {
+    socket_path_ = path.substr(strlen(kUnixSocketPrefix));
+  } else {
+    file_path_ = path;
+  }
+}
+
+LiveProfileExporter::~LiveProfileExporter() { Stop().IgnoreError(); }
+
+::mediapipe::Status LiveProfileExporter::Start() {
+  RET_CHECK(!thread_) << "LiveProfileExporter is already running.";
+  RET_CHECK(!file_path_.empty() || !socket_path_.empty())
+      << "ProfilerConfig.live_profile_path must not be empty.";
+  {
+    absl::MutexLock lock(&export_mutex_);
+    previous_time_ = absl::Now();
+    previous_profiles_.clear();
+    previous_busy_time_.clear();
+    previous_status_ = ::mediapipe::OkStatus();
+    if (!socket_path_.empty()) {
+      MP_RETURN_IF_ERROR(OpenSocket());
+    }
+  }
+  {
+    absl::MutexLock lock(&stop_mutex_);
+    stopping_ = false;
+  }
+  thread_ = absl::make_unique<ThreadPool>("mediapipe_live_profile", 1);
+  thread_->StartWorkers();
+  thread_->Schedule([this] { RunExportLoop(); });
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status LiveProfileExporter::Stop() {
+  if (!thread_) {
+    return ::mediapipe::OkStatus();
+  }
+  {
+    absl::MutexLock lock(&stop_mutex_);
+    stopping_ = true;
+  }
+  // Waits for the export loop to exit.
+  thread_.reset();
+  ::mediapipe::Status status = ExportSnapshot();
+  absl::MutexLock lock(&export_mutex_);
+  CloseSocket();
+  return status;
+}
+
+void LiveProfileExporter::RunExportLoop() {
+  while (true) {
+    {
+      absl::MutexLock lock(&stop_mutex_);
+      stop_mutex_.AwaitWithTimeout(absl::Condition(&stopping_), interval_);
+      if (stopping_) {
+        return;
+      }
+    }
+    // Failures are logged by ExportSnapshot and retried at the next interval.
+    ExportSnapshot().IgnoreError();
+  }
+}
+
+::mediapipe::Status LiveProfileExporter::ExportSnapshot() {
+  absl::MutexLock lock(&export_mutex_);
+  GraphSnapshot snapshot;
+  ::mediapipe::Status status = snapshot_callback_(&snapshot);
+  if (status.ok()) {
+    ComputeWindow(&snapshot);
+    auto line = FormatSnapshot(snapshot);
+    status = line.status();
+    if (status.ok()) {
+      status = socket_path_.empty() ? WriteFile(line.ValueOrDie())
+                                    : WriteSocket(line.ValueOrDie());
+    }
+  }
+  // Log each distinct failure once, rather than once per interval.
+  if (!status.ok() && status != previous_status_) {
+    LOG(WARNING) << "Unable to publish live profile to \""
+                 << config_.live_profile_path() << "\": " << status;
+  }
+  previous_status_ = status;
+  return status;
+}
+
+void LiveProfileExporter::ComputeWindow(GraphSnapshot* snapshot) {
+  absl::Time now = absl::Now();
+  int64 window_usec = absl::ToInt64Microseconds(now - previous_time_);
+  previous_time_ = now;
+  snapshot->set_time_usec(absl::ToUnixMicros(now));
+  snapshot->set_window_usec(window_usec);
+
+  for (CalculatorProfile& profile : *snapshot->mutable_calculator_profiles()) {
+    CalculatorProfile& previous = previous_profiles_[profile.name()];
+    CalculatorProfile cumulative = profile;
+    SubtractProfile(previous, &profile);
+    previous = std::move(cumulative);
+  }
+
+  for (ExecutorUtilization& executor : *snapshot->mutable_executors()) {
+    int64& previous = previous_busy_time_[executor.name()];
+    int64 cumulative = executor.busy_time_usec();
+    executor.set_busy_time_usec(Delta(cumulative, previous));
+    previous = cumulative;
+    if (window_usec > 0 && executor.num_threads() > 0) {
+      executor.set_utilization(static_cast<double>(executor.busy_time_usec()) /
+                               (window_usec * executor.num_threads()));
+    }
+  }
+}
+
+::mediapipe::StatusOr<std::string> LiveProfileExporter::FormatSnapshot(
+    const GraphSnapshot& snapshot) {
+#if defined(MEDIAPIPE_PROTO_LITE)
+  return ::mediapipe::UnimplementedError(
+      "Live profiles require full protobuf support.");
+#else
+  std::string result;
+  if (config_.live_profile_text_format()) {
+    proto_ns::TextFormat::Printer printer;
+    printer.SetSingleLineMode(true);
+    RET_CHECK(printer.PrintToString(snapshot, &result));
+  } else {
+    auto status = proto_ns::util::MessageToJsonString(snapshot, &result);
+    if (!status.ok()) {
+      return ::mediapipe::InternalError(status.ToString());
+    }
+  }
+  result.push_back('\n');
+  return result;
+#endif  // MEDIAPIPE_PROTO_LITE
+}
+
+::mediapipe::Status LiveProfileExporter::WriteFile(const std::string& line) {
+  // The new snapshot is written completely before it replaces the old one,
+  // so that readers never observe a partial snapshot.
+  std::string temp_path = absl::StrCat(file_path_, ".tmp");
+  {
+    std::ofstream ofs(temp_path, std::ofstream::out | std::ofstream::trunc);
+    ofs << line;
+    ofs.close();
+    RET_CHECK(ofs.good()) << "Could not write live profile to: " << temp_path;
+  }
+  int file_count = config_.live_profile_file_count();
+  for (int i = file_count - 1; i > 0; --i) {
+    std::string from =
+        (i == 1) ? file_path_ : absl::StrCat(file_path_, ".", i - 1);
+    // Missing older snapshots are expected during the first intervals.
+    std::rename(from.c_str(), absl::StrCat(file_path_, ".", i).c_str());
+  }
+  RET_CHECK_EQ(std::rename(temp_path.c_str(), file_path_.c_str()), 0)
+      << "Could not replace live profile: " << file_path_ << ": "
+      << strerror(errno);
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status LiveProfileExporter::OpenSocket() {
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  RET_CHECK_LT(socket_path_.size(), sizeof(address.sun_path))
+      << "Socket path is too long: " << socket_path_;
+  memcpy(address.sun_path, socket_path_.data(), socket_path_.size());
+
+  // Replace any socket left behind by a previous run or process.
+  unlink(socket_path_.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  RET_CHECK_NE(fd, -1) << "Could not create socket: " << strerror(errno);
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(fd, kListenBacklog) != 0 || !SetNonBlocking(fd)) {
+    int error = errno;
+    close(fd);
+    return ::mediapipe::UnavailableError(absl::StrCat(
+        "Could not listen on socket: ", socket_path_, ": ", strerror(error)));
+  }
+  listen_fd_ = fd;
+  return ::mediapipe::OkStatus();
+#else
+  return ::mediapipe::UnimplementedError(
+      "Live profile sockets require a POSIX platform.");
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+}
+
+void LiveProfileExporter::CloseSocket() {
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+  for (int fd : client_fds_) {
+    close(fd);
+  }
+  client_fds_.clear();
+  if (listen_fd_ != -1) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(socket_path_.c_str());
+  }
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+}
+
+::mediapipe::Status LiveProfileExporter::WriteSocket(const std::string& line) {
+  RET_CHECK_NE(listen_fd_, -1);
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+  int client_fd;
+  while ((client_fd = accept(listen_fd_, nullptr, nullptr)) != -1) {
+    SetNonBlocking(client_fd);
+    SetNoSigPipe(client_fd);
+    client_fds_.push_back(client_fd);
+  }
+  std::vector<int> connected_fds;
+  for (int fd : client_fds_) {
+    ssize_t size = send(fd, line.data(), line.size(), kSendFlags);
+    if (size == static_cast<ssize_t>(line.size())) {
+      connected_fds.push_back(fd);
+    } else {
+      // A partial line cannot be completed later, so the client is dropped.
+      close(fd);
+    }
+  }
+  client_fds_ = std::move(connected_fds);
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+  return ::mediapipe::OkStatus();
+}
+
+}  // namespace mediapipe
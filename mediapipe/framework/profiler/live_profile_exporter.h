@@ -0,0 +1,132 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_LIVE_PROFILE_EXPORTER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_LIVE_PROFILE_EXPORTER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MEDIAPIPE_LIVE_PROFILE_SOCKETS 1
+#endif  // __unix__ || __APPLE__
+
+namespace mediapipe {
+
+// LiveProfileExporter periodically publishes a GraphSnapshot of a running
+// graph, so that the graph can be observed from outside the process.
+//
+// Snapshots are written on a dedicated thread, once every
+// ProfilerConfig.live_profile_interval_usec, either to a file or to the
+// clients of a Unix domain socket.  Each snapshot is written as a single
+// line of JSON, or of protobuf text format if live_profile_text_format is
+// set.  For example, a live graph can be watched with:
+//   socat - UNIX-CONNECT:/tmp/graph.sock
+//
+// The snapshot callback reports calculator profiles and executor busy times
+// cumulatively.  The exporter subtracts the values reported for the previous
+// snapshot, so that each published snapshot describes only its own window.
+// The open and close runtimes are measured once per run, and are published
+// as reported.
+//
+// Unix domain sockets are only available on POSIX platforms, where
+// MEDIAPIPE_LIVE_PROFILE_SOCKETS is defined.  Elsewhere only files are
+// supported.
+class LiveProfileExporter {
+ public:
+  // Fills in the current state of the graph.  Called on the exporter thread.
+  using SnapshotCallback = std::function<::mediapipe::Status(GraphSnapshot*)>;
+
+  LiveProfileExporter(const ProfilerConfig& config,
+                      SnapshotCallback snapshot_callback);
+  ~LiveProfileExporter();
+
+  LiveProfileExporter(const LiveProfileExporter&) = delete;
+  LiveProfileExporter& operator=(const LiveProfileExporter&) = delete;
+
+  // Opens the output and starts publishing snapshots.
+  ::mediapipe::Status Start() LOCKS_EXCLUDED(stop_mutex_);
+
+  // Publishes a final snapshot, stops the exporter thread, and closes the
+  // output.  Does nothing if the exporter is not running.
+  ::mediapipe::Status Stop() LOCKS_EXCLUDED(stop_mutex_);
+
+  // Takes a snapshot and publishes it immediately.
+  ::mediapipe::Status ExportSnapshot() LOCKS_EXCLUDED(export_mutex_);
+
+  // The ProfilerConfig.live_profile_path prefix denoting a Unix domain socket.
+  static const char kUnixSocketPrefix[];
+
+ private:
+  // Publishes snapshots until Stop() is called.
+  void RunExportLoop() LOCKS_EXCLUDED(stop_mutex_);
+
+  // Converts the cumulative values in a snapshot into per-window values.
+  void ComputeWindow(GraphSnapshot* snapshot)
+      EXCLUSIVE_LOCKS_REQUIRED(export_mutex_);
+
+  // Serializes a snapshot as one line of JSON or protobuf text.
+  ::mediapipe::StatusOr<std::string> FormatSnapshot(
+      const GraphSnapshot& snapshot);
+
+  // Replaces the snapshot file, rotating older snapshot files.
+  ::mediapipe::Status WriteFile(const std::string& line);
+
+  // Accepts pending socket clients and sends the line to each client.
+  // Clients that have disconnected or cannot keep up are dropped.
+  ::mediapipe::Status WriteSocket(const std::string& line)
+      EXCLUSIVE_LOCKS_REQUIRED(export_mutex_);
+
+  ::mediapipe::Status OpenSocket() EXCLUSIVE_LOCKS_REQUIRED(export_mutex_);
+  void CloseSocket() EXCLUSIVE_LOCKS_REQUIRED(export_mutex_);
+
+  const ProfilerConfig config_;
+  const SnapshotCallback snapshot_callback_;
+  const absl::Duration interval_;
+
+  // Exactly one of file_path_ and socket_path_ is non-empty.
+  std::string file_path_;
+  std::string socket_path_;
+
+  // Serializes snapshots from the exporter thread and from Stop().
+  absl::Mutex export_mutex_;
+  int listen_fd_ GUARDED_BY(export_mutex_) = -1;
+  std::vector<int> client_fds_ GUARDED_BY(export_mutex_);
+  absl::Time previous_time_ GUARDED_BY(export_mutex_);
+  std::map<std::string, CalculatorProfile> previous_profiles_
+      GUARDED_BY(export_mutex_);
+  std::map<std::string, int64> previous_busy_time_ GUARDED_BY(export_mutex_);
+  ::mediapipe::Status previous_status_ GUARDED_BY(export_mutex_);
+
+  absl::Mutex stop_mutex_;
+  bool stopping_ GUARDED_BY(stop_mutex_) = false;
+  std::unique_ptr<ThreadPool> thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_LIVE_PROFILE_EXPORTER_H_
@@ -0,0 +1,204 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/live_profile_exporter.h"
+
+#include <cstring>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/util/json_util.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/core_proto_inc.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+
+namespace mediapipe {
+namespace {
+
+// Parses one JSON snapshot line.
+GraphSnapshot ParseJsonSnapshot(const std::string& json) {
+  GraphSnapshot snapshot;
+  EXPECT_TRUE(proto_ns::util::JsonStringToMessage(json, &snapshot).ok());
+  return snapshot;
+}
+
+// Returns a snapshot callback reporting a growing cumulative process time.
+LiveProfileExporter::SnapshotCallback GrowingProfileCallback(
+    int64* process_time_usec) {
+  return [process_time_usec](GraphSnapshot* snapshot) {
+    CalculatorProfile* profile = snapshot->add_calculator_profiles();
+    profile->set_name("calc");
+    profile->set_open_runtime(30);
+    profile->mutable_process_runtime()->set_total(*process_time_usec);
+    ExecutorUtilization* executor = snapshot->add_executors();
+    executor->set_name("");
+    executor->set_num_threads(2);
+    executor->set_busy_time_usec(*process_time_usec);
+    return ::mediapipe::OkStatus();
+  };
+}
+
+TEST(LiveProfileExporterTest, FileSnapshotsReportWindowDeltas) {
+  std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/live_profile_deltas.json");
+  ProfilerConfig config;
+  config.set_live_profile_path(path);
+  config.set_live_profile_interval_usec(100000000);
+  int64 process_time_usec = 100;
+  LiveProfileExporter exporter(config,
+                               GrowingProfileCallback(&process_time_usec));
+  MP_ASSERT_OK(exporter.Start());
+
+  std::string contents;
+  MP_ASSERT_OK(exporter.ExportSnapshot());
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  GraphSnapshot snapshot = ParseJsonSnapshot(contents);
+  EXPECT_EQ(100, snapshot.calculator_profiles(0).process_runtime().total());
+
+  process_time_usec = 250;
+  MP_ASSERT_OK(exporter.ExportSnapshot());
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  snapshot = ParseJsonSnapshot(contents);
+  EXPECT_EQ("calc", snapshot.calculator_profiles(0).name());
+  EXPECT_EQ(150, snapshot.calculator_profiles(0).process_runtime().total());
+  EXPECT_EQ(30, snapshot.calculator_profiles(0).open_runtime());
+  EXPECT_EQ(150, snapshot.executors(0).busy_time_usec());
+  EXPECT_GT(snapshot.window_usec(), 0);
+  EXPECT_GT(snapshot.executors(0).utilization(), 0);
+  MP_EXPECT_OK(exporter.Stop());
+}
+
+TEST(LiveProfileExporterTest, RotatesSnapshotFiles) {
+  std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/live_profile_rotated.json");
+  ProfilerConfig config;
+  config.set_live_profile_path(path);
+  config.set_live_profile_file_count(3);
+  int64 process_time_usec = 0;
+  LiveProfileExporter exporter(config,
+                               GrowingProfileCallback(&process_time_usec));
+  for (int i = 1; i <= 4; ++i) {
+    process_time_usec = i * i * 1000;
+    MP_ASSERT_OK(exporter.ExportSnapshot());
+  }
+
+  // The latest snapshot is at "path", the oldest kept one at "path.2".
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  EXPECT_EQ(7000, ParseJsonSnapshot(contents)
+                      .calculator_profiles(0)
+                      .process_runtime()
+                      .total());
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(path, ".2"), &contents));
+  EXPECT_EQ(3000, ParseJsonSnapshot(contents)
+                      .calculator_profiles(0)
+                      .process_runtime()
+                      .total());
+  EXPECT_FALSE(file::Exists(absl::StrCat(path, ".3")).ok());
+}
+
+#if defined(MEDIAPIPE_LIVE_PROFILE_SOCKETS)
+TEST(LiveProfileExporterTest, ServesTextSnapshotsOnUnixSocket) {
+  std::string socket_path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/live_profile.sock");
+  ProfilerConfig config;
+  config.set_live_profile_path(
+      absl::StrCat(LiveProfileExporter::kUnixSocketPrefix, socket_path));
+  config.set_live_profile_interval_usec(100000000);
+  config.set_live_profile_text_format(true);
+  int64 process_time_usec = 500;
+  LiveProfileExporter exporter(config,
+                               GrowingProfileCallback(&process_time_usec));
+  MP_ASSERT_OK(exporter.Start());
+
+  int client_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_NE(-1, client_fd);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(0, connect(client_fd, reinterpret_cast<struct sockaddr*>(&address),
+                       sizeof(address)));
+  MP_ASSERT_OK(exporter.ExportSnapshot());
+
+  std::string line;
+  char c;
+  while (read(client_fd, &c, 1) == 1 && c != '\n') {
+    line.push_back(c);
+  }
+  close(client_fd);
+  GraphSnapshot snapshot;
+  ASSERT_TRUE(proto_ns::TextFormat::ParseFromString(line, &snapshot));
+  EXPECT_EQ(500, snapshot.calculator_profiles(0).process_runtime().total());
+
+  MP_EXPECT_OK(exporter.Stop());
+  EXPECT_FALSE(file::Exists(socket_path).ok());
+}
+#endif  // MEDIAPIPE_LIVE_PROFILE_SOCKETS
+
+TEST(LiveProfileExporterTest, CalculatorGraphPublishesSnapshots) {
+  std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/live_profile_graph.json");
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "input"
+        max_queue_size: 4
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "output"
+        }
+        profiler_config {
+          enable_profiler: true
+        }
+      )");
+  config.mutable_profiler_config()->set_live_profile_path(path);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // The final snapshot is published when the run finishes.
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(path, &contents));
+  GraphSnapshot snapshot = ParseJsonSnapshot(contents);
+  ASSERT_EQ(1, snapshot.calculator_profiles_size());
+  EXPECT_EQ("PassThroughCalculator", snapshot.calculator_profiles(0).name());
+  ASSERT_EQ(1, snapshot.stream_queues_size());
+  EXPECT_EQ("input", snapshot.stream_queues(0).name());
+  EXPECT_EQ("PassThroughCalculator", snapshot.stream_queues(0).node_name());
+  EXPECT_EQ(4, snapshot.stream_queues(0).max_queue_size());
+  EXPECT_EQ(0, snapshot.stream_queues(0).queue_size());
+  EXPECT_EQ(0, snapshot.throttled_nodes_size());
+  ASSERT_EQ(1, snapshot.executors_size());
+  EXPECT_EQ("", snapshot.executors(0).name());
+}
+
+}  // namespace
+}  // namespace mediapipe
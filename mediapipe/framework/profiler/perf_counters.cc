@@ -0,0 +1,142 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/perf_counters.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mediapipe/framework/port/logging.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif  // __linux__
+
+namespace mediapipe {
+
+namespace {
+
+#if defined(__linux__)
+struct CounterSpec {
+  uint64 config;
+  int64 PerfCounterValues::*field;
+};
+
+// The counters in the group.  The first counter that opens successfully
+// becomes the group leader.
+const CounterSpec kCounterSpecs[] = {
+    {PERF_COUNT_HW_CPU_CYCLES, &PerfCounterValues::cycles},
+    {PERF_COUNT_HW_INSTRUCTIONS, &PerfCounterValues::instructions},
+    {PERF_COUNT_HW_CACHE_MISSES, &PerfCounterValues::cache_misses},
+    {PERF_COUNT_HW_BRANCH_MISSES, &PerfCounterValues::branch_misses},
+};
+
+// The largest read() result: the number of counters followed by the values.
+constexpr int kMaxReadValues = 1 + sizeof(kCounterSpecs) / sizeof(CounterSpec);
+
+int OpenCounter(uint64 config, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.disabled = (group_fd == -1) ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // pid == 0 and cpu == -1 measure the calling thread on any cpu.
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+#endif  // __linux__
+
+}  // namespace
+
+PerfCounters::PerfCounters() : group_fd_(-1) {}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+  for (int fd : fds_) {
+    close(fd);
+  }
+#endif  // __linux__
+}
+
+PerfCounters* PerfCounters::ForCurrentThread() {
+  // Counters are opened at most once per thread, even if opening fails.
+  static thread_local std::unique_ptr<PerfCounters> counters = [] {
+    std::unique_ptr<PerfCounters> result(new PerfCounters());
+    if (!result->Open()) {
+      result.reset();
+    }
+    return result;
+  }();
+  return counters.get();
+}
+
+bool PerfCounters::Open() {
+#if defined(__linux__)
+  for (const CounterSpec& spec : kCounterSpecs) {
+    int fd = OpenCounter(spec.config, group_fd_);
+    if (fd == -1) {
+      VLOG(1) << "Unable to open hardware counter " << spec.config << ": "
+              << strerror(errno);
+      continue;
+    }
+    if (group_fd_ == -1) {
+      group_fd_ = fd;
+    }
+    fds_.push_back(fd);
+    fields_.push_back(spec.field);
+  }
+  if (group_fd_ == -1) {
+    return false;
+  }
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+#else
+  return false;
+#endif  // __linux__
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) {
+#if defined(__linux__)
+  uint64 buffer[kMaxReadValues];
+  ssize_t size = read(group_fd_, buffer, sizeof(buffer));
+  if (size < static_cast<ssize_t>(sizeof(uint64)) ||
+      buffer[0] != fields_.size()) {
+    return false;
+  }
+  *values = PerfCounterValues();
+  for (int i = 0; i < fields_.size(); ++i) {
+    values->*fields_[i] = static_cast<int64>(buffer[i + 1]);
+  }
+  return true;
+#else
+  return false;
+#endif  // __linux__
+}
+
+bool PerfCounters::HasCounter(int64 PerfCounterValues::*field) const {
+  return std::find(fields_.begin(), fields_.end(), field) != fields_.end();
+}
+
+}  // namespace mediapipe
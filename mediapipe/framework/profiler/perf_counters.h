@@ -0,0 +1,100 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_PERF_COUNTERS_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_PERF_COUNTERS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A snapshot of the hardware performance counters of one thread.
+struct PerfCounterValues {
+  int64 cycles = 0;
+  int64 instructions = 0;
+  int64 cache_misses = 0;
+  int64 branch_misses = 0;
+
+  PerfCounterValues operator-(const PerfCounterValues& other) const {
+    PerfCounterValues result;
+    result.cycles = cycles - other.cycles;
+    result.instructions = instructions - other.instructions;
+    result.cache_misses = cache_misses - other.cache_misses;
+    result.branch_misses = branch_misses - other.branch_misses;
+    return result;
+  }
+};
+
+// PerfCounters reads the cycle, instruction, cache-miss and branch-miss
+// counters of the calling thread.  On Linux the counters are opened with
+// perf_event_open as a single event group, so that all values are read
+// with one system call.  Only user-space events are counted.
+//
+// Counters are opened lazily, once per thread.  On platforms without
+// perf_event_open, or when the kernel refuses to open the counters (for
+// example because of perf_event_paranoid or a virtualized PMU),
+// ForCurrentThread() returns nullptr and callers should skip recording.
+//
+// Example:
+//   PerfCounters* counters = PerfCounters::ForCurrentThread();
+//   PerfCounterValues start;
+//   if (counters && counters->Read(&start)) {
+//     ... do work ...
+//     PerfCounterValues end;
+//     counters->Read(&end);
+//     PerfCounterValues delta = end - start;
+//   }
+class PerfCounters {
+ public:
+  ~PerfCounters();
+
+  // Not copyable or movable.
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // Returns the counters for the calling thread, opening them on first use.
+  // Returns nullptr if hardware counters are unavailable on this thread.
+  // The returned object is owned by the thread and must only be used from it.
+  static PerfCounters* ForCurrentThread();
+
+  // Reads the current counter values.  Counters that could not be opened
+  // read as zero.  Returns false if the counters could not be read.
+  bool Read(PerfCounterValues* values);
+
+  // Returns true if the counter for "field", e.g.
+  // &PerfCounterValues::instructions, could be opened.
+  bool HasCounter(int64 PerfCounterValues::*field) const;
+
+ private:
+  PerfCounters();
+
+  // Opens the counter group.  Returns false if no counter could be opened.
+  bool Open();
+
+  // The file descriptor of the group leader, or -1.
+  int group_fd_;
+
+  // For each counter in the group in read order, the corresponding member
+  // of PerfCounterValues.
+  std::vector<int64 PerfCounterValues::*> fields_;
+
+  // All opened file descriptors, including the group leader.
+  std::vector<int> fds_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_PERF_COUNTERS_H_
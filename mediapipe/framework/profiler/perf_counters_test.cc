@@ -0,0 +1,94 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/perf_counters.h"
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+// Spends some instructions that the compiler cannot optimize away.
+int64 Spin(int iterations) {
+  volatile int64 sum = 0;
+  for (int i = 0; i < iterations; ++i) {
+    sum += i;
+  }
+  return sum;
+}
+
+TEST(PerfCountersTest, CountersIncreaseOnCurrentThread) {
+  PerfCounters* counters = PerfCounters::ForCurrentThread();
+  // Returns the same object on each call from a thread.
+  EXPECT_EQ(counters, PerfCounters::ForCurrentThread());
+  if (counters == nullptr) {
+    // Hardware counters are not available on this machine.
+    return;
+  }
+  PerfCounterValues start;
+  ASSERT_TRUE(counters->Read(&start));
+  Spin(100000);
+  PerfCounterValues end;
+  ASSERT_TRUE(counters->Read(&end));
+  PerfCounterValues delta = end - start;
+  if (counters->HasCounter(&PerfCounterValues::instructions)) {
+    EXPECT_GT(delta.instructions, 100000);
+  }
+  EXPECT_GE(delta.cycles, 0);
+  EXPECT_GE(delta.cache_misses, 0);
+  EXPECT_GE(delta.branch_misses, 0);
+}
+
+TEST(PerfCountersTest, CountersArePerThread) {
+  PerfCounters* counters = PerfCounters::ForCurrentThread();
+  if (counters == nullptr) {
+    return;
+  }
+  // Compares a counter which is open on this thread, and so on the worker.
+  int64 PerfCounterValues::*field =
+      counters->HasCounter(&PerfCounterValues::instructions)
+          ? &PerfCounterValues::instructions
+          : &PerfCounterValues::cycles;
+  if (!counters->HasCounter(field)) {
+    return;
+  }
+  PerfCounterValues main_start;
+  ASSERT_TRUE(counters->Read(&main_start));
+  // The worker spins while this thread waits for it, so only the worker's
+  // own counters see the work.
+  bool worker_read = false;
+  PerfCounterValues worker_delta;
+  {
+    ThreadPool pool(1);
+    pool.StartWorkers();
+    pool.Schedule([&worker_read, &worker_delta] {
+      PerfCounters* worker_counters = PerfCounters::ForCurrentThread();
+      PerfCounterValues start;
+      PerfCounterValues end;
+      worker_read = worker_counters && worker_counters->Read(&start);
+      Spin(10000000);
+      worker_read = worker_read && worker_counters->Read(&end);
+      worker_delta = end - start;
+    });
+  }
+  PerfCounterValues main_end;
+  ASSERT_TRUE(counters->Read(&main_end));
+  PerfCounterValues main_delta = main_end - main_start;
+  ASSERT_TRUE(worker_read);
+  EXPECT_LT(main_delta.*field, worker_delta.*field);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
 
 // TODO: Move protos in another CL after the C++ code migration.
 #include "absl/strings/substitute.h"
@@ -21,6 +24,7 @@
 #include "mediapipe/framework/mediapipe_options.pb.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/stream_handler/sync_set_input_stream_handler.pb.h"
+#include "mediapipe/framework/stream_handler/sync_set_readiness.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/tag_map.h"
 
@@ -59,10 +63,27 @@ class SyncSetInputStreamHandler : public InputStreamHandler {
   void FillInputSet(Timestamp input_timestamp,
                     InputStreamShardSet* input_set) override;
 
+  void StreamUpdated(CollectionItemId id) override;
+
  private:
+  // Marks the stream to be examined by the next GetNodeReadiness().
+  void MarkStreamUpdated(CollectionItemId id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   absl::Mutex mutex_;
   // The ids of each set of inputs.
   std::vector<std::vector<CollectionItemId>> sync_sets_ GUARDED_BY(mutex_);
+  // The readiness of each set of inputs, from the streams examined so far.
+  std::vector<SyncSetReadiness> readiness_ GUARDED_BY(mutex_);
+  // The sync set index and the index within the sync set of each stream.
+  std::vector<std::pair<int, int>> stream_positions_ GUARDED_BY(mutex_);
+  // The streams updated since they were last examined, and whether each
+  // stream is among them.  Only these streams are examined by
+  // GetNodeReadiness(), instead of every stream of every sync set.
+  std::vector<CollectionItemId> updated_streams_ GUARDED_BY(mutex_);
+  std::vector<bool> stream_updated_ GUARDED_BY(mutex_);
+  // The number of sync sets which are done.
+  int num_done_sync_sets_ GUARDED_BY(mutex_) = 0;
+  std::vector<bool> sync_set_done_ GUARDED_BY(mutex_);
   // The index of the ready sync set.  A value of -1 indicates that no
   // sync sets are ready.
   int ready_sync_set_index_ GUARDED_BY(mutex_) = -1;
@@ -77,7 +98,8 @@ SyncSetInputStreamHandler::SyncSetInputStreamHandler(
     std::shared_ptr<tool::TagMap> tag_map, CalculatorContextManager* cc_manager,
     const MediaPipeOptions& extendable_options, bool calculator_run_in_parallel)
     : InputStreamHandler(std::move(tag_map), cc_manager, extendable_options,
-                         calculator_run_in_parallel) {}
+                         calculator_run_in_parallel),
+      stream_updated_(input_stream_managers_.NumEntries(), false) {}
 
 void SyncSetInputStreamHandler::PrepareForRun(
     std::function<void()> headers_ready_callback,
@@ -115,6 +137,25 @@ void SyncSetInputStreamHandler::PrepareForRun(
     if (!remaining_ids.empty()) {
       sync_sets_.push_back(std::move(remaining_ids));
     }
+
+    const int num_streams = input_stream_managers_.NumEntries();
+    readiness_.resize(sync_sets_.size());
+    stream_positions_.resize(num_streams);
+    for (int i = 0; i < sync_sets_.size(); ++i) {
+      readiness_[i].Reset(sync_sets_[i].size());
+      for (int j = 0; j < sync_sets_[i].size(); ++j) {
+        stream_positions_[sync_sets_[i][j].value()] = {i, j};
+      }
+    }
+    updated_streams_.clear();
+    updated_streams_.reserve(num_streams);
+    stream_updated_.assign(num_streams, false);
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id) {
+      MarkStreamUpdated(id);
+    }
+    num_done_sync_sets_ = 0;
+    sync_set_done_.assign(sync_sets_.size(), false);
     ready_sync_set_index_ = -1;
     ready_timestamp_ = Timestamp::Done();
   }
@@ -124,6 +165,18 @@ void SyncSetInputStreamHandler::PrepareForRun(
       std::move(schedule_callback), std::move(error_callback));
 }
 
+void SyncSetInputStreamHandler::StreamUpdated(CollectionItemId id) {
+  absl::MutexLock lock(&mutex_);
+  MarkStreamUpdated(id);
+}
+
+void SyncSetInputStreamHandler::MarkStreamUpdated(CollectionItemId id) {
+  if (!stream_updated_[id.value()]) {
+    stream_updated_[id.value()] = true;
+    updated_streams_.push_back(id);
+  }
+}
+
 NodeReadiness SyncSetInputStreamHandler::GetNodeReadiness(
     Timestamp* min_stream_timestamp) {
   DCHECK(min_stream_timestamp);
@@ -132,48 +185,43 @@ NodeReadiness SyncSetInputStreamHandler::GetNodeReadiness(
     *min_stream_timestamp = ready_timestamp_;
     return NodeReadiness::kReadyForProcess;
   }
+  // A stream may be updated again while it is examined, in which case it is
+  // marked again once mutex_ is released.
+  for (CollectionItemId id : updated_streams_) {
+    stream_updated_[id.value()] = false;
+    bool empty;
+    Timestamp stream_timestamp =
+        input_stream_managers_.Get(id)->MinTimestampOrBound(&empty);
+    const auto& position = stream_positions_[id.value()];
+    readiness_[position.first].Update(position.second, stream_timestamp,
+                                      empty);
+  }
+  updated_streams_.clear();
+
   for (int sync_set_index = 0; sync_set_index < sync_sets_.size();
        ++sync_set_index) {
-    const std::vector<CollectionItemId>& sync_set = sync_sets_[sync_set_index];
-    *min_stream_timestamp = Timestamp::Done();
-    Timestamp min_bound = Timestamp::Done();
-    for (CollectionItemId id : sync_set) {
-      const auto& stream = input_stream_managers_.Get(id);
-      bool empty;
-      Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-      if (empty) {
-        min_bound = std::min(min_bound, stream_timestamp);
-      }
-      *min_stream_timestamp = std::min(*min_stream_timestamp, stream_timestamp);
-    }
-
-    if (*min_stream_timestamp == Timestamp::Done()) {
-      // This sync set is done, remove it.  Note that this invalidates
-      // sync set indexes higher than sync_set_index.  However, we are
-      // guaranteed that we were not ready before entering the outer
-      // loop, so even if we are ready now, ready_sync_set_index_ must
-      // be less than the current value of sync_set_index.
-      sync_sets_.erase(sync_sets_.begin() + sync_set_index);
-      --sync_set_index;
+    if (sync_set_done_[sync_set_index]) {
       continue;
     }
-
-    if (min_bound > *min_stream_timestamp) {
-      if (*min_stream_timestamp < ready_timestamp_) {
-        // Store the timestamp and corresponding sync set index for the
-        // sync set with the earliest arrival timestamp.
-        ready_timestamp_ = *min_stream_timestamp;
-        ready_sync_set_index_ = sync_set_index;
-      }
-    } else {
-      CHECK_EQ(min_bound, *min_stream_timestamp);
+    NodeReadiness readiness =
+        readiness_[sync_set_index].GetReadiness(min_stream_timestamp);
+    if (readiness == NodeReadiness::kReadyForClose) {
+      // This sync set is done, skip it from now on.
+      sync_set_done_[sync_set_index] = true;
+      ++num_done_sync_sets_;
+    } else if (readiness == NodeReadiness::kReadyForProcess &&
+               *min_stream_timestamp < ready_timestamp_) {
+      // Store the timestamp and corresponding sync set index for the
+      // sync set with the earliest arrival timestamp.
+      ready_timestamp_ = *min_stream_timestamp;
+      ready_sync_set_index_ = sync_set_index;
     }
   }
   if (ready_sync_set_index_ >= 0) {
     *min_stream_timestamp = ready_timestamp_;
     return NodeReadiness::kReadyForProcess;
   }
-  if (sync_sets_.empty()) {
+  if (num_done_sync_sets_ == sync_sets_.size()) {
     *min_stream_timestamp = Timestamp::Done();
     return NodeReadiness::kReadyForClose;
   }
@@ -199,6 +247,9 @@ void SyncSetInputStreamHandler::FillInputSet(Timestamp input_timestamp,
     CHECK_EQ(num_packets_dropped, 0)
         << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
                             num_packets_dropped, stream->Name());
+    if (!current_packet.IsEmpty()) {
+      MarkStreamUpdated(id);
+    }
     AddPacketToShard(&input_set->Get(id), std::move(current_packet),
                      stream_is_done);
   }
@@ -0,0 +1,92 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/stream_handler/sync_set_readiness.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+void SyncSetReadiness::Reset(int num_streams) {
+  heap_.resize(num_streams);
+  positions_.resize(num_streams);
+  for (int i = 0; i < num_streams; ++i) {
+    heap_[i] = {Timestamp::Unstarted(), /*empty=*/true, i};
+    positions_[i] = i;
+  }
+}
+
+void SyncSetReadiness::Update(int index, Timestamp timestamp, bool empty) {
+  DCHECK_LE(0, index);
+  DCHECK_LT(index, positions_.size());
+  const int position = positions_[index];
+  Entry& entry = heap_[position];
+  const bool moved_earlier = Precedes({timestamp, empty, index}, entry);
+  entry.timestamp = timestamp;
+  entry.empty = empty;
+  if (moved_earlier) {
+    SiftUp(position);
+  } else {
+    SiftDown(position);
+  }
+}
+
+NodeReadiness SyncSetReadiness::GetReadiness(
+    Timestamp* min_stream_timestamp) const {
+  if (heap_.empty() || heap_[0].timestamp == Timestamp::Done()) {
+    *min_stream_timestamp = Timestamp::Done();
+    return NodeReadiness::kReadyForClose;
+  }
+  *min_stream_timestamp = heap_[0].timestamp;
+  return heap_[0].empty ? NodeReadiness::kNotReady
+                        : NodeReadiness::kReadyForProcess;
+}
+
+void SyncSetReadiness::Swap(int i, int j) {
+  std::swap(heap_[i], heap_[j]);
+  positions_[heap_[i].index] = i;
+  positions_[heap_[j].index] = j;
+}
+
+void SyncSetReadiness::SiftUp(int i) {
+  while (i > 0) {
+    const int parent = (i - 1) / 2;
+    if (!Precedes(heap_[i], heap_[parent])) {
+      break;
+    }
+    Swap(i, parent);
+    i = parent;
+  }
+}
+
+void SyncSetReadiness::SiftDown(int i) {
+  const int size = heap_.size();
+  while (true) {
+    int smallest = i;
+    for (int child = 2 * i + 1; child <= 2 * i + 2 && child < size; ++child) {
+      if (Precedes(heap_[child], heap_[smallest])) {
+        smallest = child;
+      }
+    }
+    if (smallest == i) {
+      break;
+    }
+    Swap(i, smallest);
+    i = smallest;
+  }
+}
+
+}  // namespace mediapipe
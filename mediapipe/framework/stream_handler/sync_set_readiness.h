@@ -0,0 +1,76 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_STREAM_HANDLER_SYNC_SET_READINESS_H_
+#define MEDIAPIPE_FRAMEWORK_STREAM_HANDLER_SYNC_SET_READINESS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/input_stream_handler.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Tracks the readiness of a set of input streams which are synchronized as in
+// the DefaultInputStreamHandler, from the last known minimum timestamp or
+// bound of each stream.  The set is ready for Process() when the earliest
+// packet of any stream is earlier than the timestamp bound of every empty
+// stream.
+//
+// The streams are kept in an indexed min-heap, in which an empty stream is
+// ordered before a non-empty stream with the same timestamp.  The readiness
+// is therefore determined by the top of the heap alone, and updating one
+// stream takes logarithmic time.  No memory is allocated after Reset().
+class SyncSetReadiness {
+ public:
+  // Resets the set to "num_streams" empty streams, whose bounds are
+  // Timestamp::Unstarted().
+  void Reset(int num_streams);
+
+  // Sets the minimum timestamp or bound of the stream at "index", as
+  // returned by InputStreamManager::MinTimestampOrBound().
+  void Update(int index, Timestamp timestamp, bool empty);
+
+  // Returns kReadyForProcess and the input timestamp if the set is ready
+  // for Process(), kReadyForClose and Timestamp::Done() if all streams are
+  // done, and kNotReady and the minimum timestamp bound otherwise.
+  NodeReadiness GetReadiness(Timestamp* min_stream_timestamp) const;
+
+  int NumStreams() const { return positions_.size(); }
+
+ private:
+  struct Entry {
+    Timestamp timestamp;
+    bool empty;
+    int index;
+  };
+
+  static bool Precedes(const Entry& a, const Entry& b) {
+    return a.timestamp < b.timestamp ||
+           (a.timestamp == b.timestamp && a.empty && !b.empty);
+  }
+
+  void Swap(int i, int j);
+  void SiftUp(int i);
+  void SiftDown(int i);
+
+  // The heap of the streams.
+  std::vector<Entry> heap_;
+  // The position of each stream in heap_.
+  std::vector<int> positions_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_STREAM_HANDLER_SYNC_SET_READINESS_H_
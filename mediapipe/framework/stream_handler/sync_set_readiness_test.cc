@@ -0,0 +1,74 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/stream_handler/sync_set_readiness.h"
+
+#include "mediapipe/framework/input_stream_handler.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(SyncSetReadinessTest, NotReadyAfterReset) {
+  SyncSetReadiness readiness;
+  readiness.Reset(3);
+  Timestamp timestamp;
+  EXPECT_EQ(NodeReadiness::kNotReady, readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp::Unstarted(), timestamp);
+}
+
+TEST(SyncSetReadinessTest, ReadyWhenEarliestPacketPrecedesAllBounds) {
+  SyncSetReadiness readiness;
+  readiness.Reset(3);
+  Timestamp timestamp;
+  readiness.Update(0, Timestamp(10), /*empty=*/false);
+  readiness.Update(1, Timestamp(10), /*empty=*/true);
+  readiness.Update(2, Timestamp(20), /*empty=*/false);
+  // Stream 1 may still receive a packet at 10.
+  EXPECT_EQ(NodeReadiness::kNotReady, readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp(10), timestamp);
+
+  readiness.Update(1, Timestamp(11), /*empty=*/true);
+  EXPECT_EQ(NodeReadiness::kReadyForProcess,
+            readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp(10), timestamp);
+
+  // After the packet at 10 is consumed, stream 0 waits for its next packet.
+  readiness.Update(0, Timestamp(11), /*empty=*/true);
+  EXPECT_EQ(NodeReadiness::kNotReady, readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp(11), timestamp);
+
+  readiness.Update(0, Timestamp(30), /*empty=*/true);
+  readiness.Update(1, Timestamp(25), /*empty=*/true);
+  EXPECT_EQ(NodeReadiness::kReadyForProcess,
+            readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp(20), timestamp);
+}
+
+TEST(SyncSetReadinessTest, ReadyForCloseWhenAllStreamsAreDone) {
+  SyncSetReadiness readiness;
+  readiness.Reset(4);
+  Timestamp timestamp;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(NodeReadiness::kReadyForClose,
+              readiness.GetReadiness(&timestamp));
+    readiness.Update(i, Timestamp::Done(), /*empty=*/true);
+  }
+  EXPECT_EQ(NodeReadiness::kReadyForClose, readiness.GetReadiness(&timestamp));
+  EXPECT_EQ(Timestamp::Done(), timestamp);
+}
+
+}  // namespace
+}  // namespace mediapipe
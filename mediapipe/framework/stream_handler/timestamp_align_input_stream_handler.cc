@@ -21,6 +21,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/collection_item_id.h"
 #include "mediapipe/framework/input_stream_handler.h"
+#include "mediapipe/framework/stream_handler/sync_set_readiness.h"
 #include "mediapipe/framework/stream_handler/timestamp_align_input_stream_handler.pb.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/validate_name.h"
@@ -75,12 +76,24 @@ class TimestampAlignInputStreamHandler : public InputStreamHandler {
   void FillInputSet(Timestamp input_timestamp,
                     InputStreamShardSet* input_set) override;
 
+  void StreamUpdated(CollectionItemId id) override;
+
  private:
+  // Marks the stream to be examined by the next GetNodeReadiness().
+  void MarkStreamUpdated(CollectionItemId id) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   CollectionItemId timestamp_base_stream_id_;
 
   absl::Mutex mutex_;
   bool offsets_initialized_ GUARDED_BY(mutex_) = false;
   std::vector<TimestampDiff> timestamp_offsets_;
+  // The readiness of the input streams after the timestamp offsets are
+  // initialized, with the offsets applied.
+  SyncSetReadiness readiness_ GUARDED_BY(mutex_);
+  // The streams updated since they were last examined, and whether each
+  // stream is among them.
+  std::vector<CollectionItemId> updated_streams_ GUARDED_BY(mutex_);
+  std::vector<bool> stream_updated_ GUARDED_BY(mutex_);
 };
 REGISTER_INPUT_STREAM_HANDLER(TimestampAlignInputStreamHandler);
 
@@ -89,7 +102,8 @@ TimestampAlignInputStreamHandler::TimestampAlignInputStreamHandler(
     const MediaPipeOptions& options, bool calculator_run_in_parallel)
     : InputStreamHandler(std::move(tag_map), cc_manager, options,
                          calculator_run_in_parallel),
-      timestamp_offsets_(input_stream_managers_.NumEntries()) {
+      timestamp_offsets_(input_stream_managers_.NumEntries()),
+      stream_updated_(input_stream_managers_.NumEntries(), false) {
   const auto& handler_options =
       options.GetExtension(TimestampAlignInputStreamHandlerOptions::ext);
   std::string tag;
@@ -111,6 +125,14 @@ void TimestampAlignInputStreamHandler::PrepareForRun(
   {
     absl::MutexLock lock(&mutex_);
     offsets_initialized_ = (input_stream_managers_.NumEntries() == 1);
+    readiness_.Reset(input_stream_managers_.NumEntries());
+    updated_streams_.clear();
+    updated_streams_.reserve(input_stream_managers_.NumEntries());
+    stream_updated_.assign(input_stream_managers_.NumEntries(), false);
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id) {
+      MarkStreamUpdated(id);
+    }
   }
 
   InputStreamHandler::PrepareForRun(
@@ -118,96 +140,100 @@ void TimestampAlignInputStreamHandler::PrepareForRun(
       std::move(schedule_callback), std::move(error_callback));
 }
 
+void TimestampAlignInputStreamHandler::StreamUpdated(CollectionItemId id) {
+  absl::MutexLock lock(&mutex_);
+  MarkStreamUpdated(id);
+}
+
+void TimestampAlignInputStreamHandler::MarkStreamUpdated(CollectionItemId id) {
+  if (!stream_updated_[id.value()]) {
+    stream_updated_[id.value()] = true;
+    updated_streams_.push_back(id);
+  }
+}
+
 NodeReadiness TimestampAlignInputStreamHandler::GetNodeReadiness(
     Timestamp* min_stream_timestamp) {
   DCHECK(min_stream_timestamp);
   *min_stream_timestamp = Timestamp::Done();
-  Timestamp min_bound = Timestamp::Done();
 
-  {
-    absl::MutexLock lock(&mutex_);
-    if (!offsets_initialized_) {
-      bool timestamp_base_empty;
-      *min_stream_timestamp =
-          input_stream_managers_.Get(timestamp_base_stream_id_)
-              ->MinTimestampOrBound(&timestamp_base_empty);
-      if (timestamp_base_empty) {
-        return NodeReadiness::kNotReady;
+  absl::MutexLock lock(&mutex_);
+  if (!offsets_initialized_) {
+    bool timestamp_base_empty;
+    *min_stream_timestamp =
+        input_stream_managers_.Get(timestamp_base_stream_id_)
+            ->MinTimestampOrBound(&timestamp_base_empty);
+    if (timestamp_base_empty) {
+      return NodeReadiness::kNotReady;
+    }
+    int unknown_non_base_stream_count = 0;
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id) {
+      if (id == timestamp_base_stream_id_) {
+        continue;
+      }
+      const auto& stream = input_stream_managers_.Get(id);
+      bool empty;
+      Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
+      if (empty) {
+        ++unknown_non_base_stream_count;
+      } else {
+        timestamp_offsets_[id.value()] =
+            *min_stream_timestamp - stream_timestamp;
       }
-      int unknown_non_base_stream_count = 0;
+    }
+    if (unknown_non_base_stream_count == 0) {
+      offsets_initialized_ = true;
+      // The timestamps examined so far were not aligned.
       for (CollectionItemId id = input_stream_managers_.BeginId();
            id < input_stream_managers_.EndId(); ++id) {
-        if (id == timestamp_base_stream_id_) {
-          continue;
-        }
-        const auto& stream = input_stream_managers_.Get(id);
-        bool empty;
-        Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-        if (empty) {
-          ++unknown_non_base_stream_count;
-        } else {
-          timestamp_offsets_[id.value()] =
-              *min_stream_timestamp - stream_timestamp;
-        }
-      }
-      if (unknown_non_base_stream_count == 0) {
-        offsets_initialized_ = true;
+        MarkStreamUpdated(id);
       }
-      return NodeReadiness::kReadyForProcess;
     }
+    return NodeReadiness::kReadyForProcess;
   }
 
-  for (CollectionItemId id = input_stream_managers_.BeginId();
-       id < input_stream_managers_.EndId(); ++id) {
-    const auto& stream = input_stream_managers_.Get(id);
+  // Only the streams updated since the last call are examined.  A stream may
+  // be updated again while it is examined, in which case it is marked again
+  // once mutex_ is released.
+  for (CollectionItemId id : updated_streams_) {
+    stream_updated_[id.value()] = false;
     bool empty;
-    Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
+    Timestamp stream_timestamp =
+        input_stream_managers_.Get(id)->MinTimestampOrBound(&empty);
     if (stream_timestamp.IsRangeValue()) {
       stream_timestamp += timestamp_offsets_[id.value()];
     }
-    if (empty) {
-      min_bound = std::min(min_bound, stream_timestamp);
-    }
-    *min_stream_timestamp = std::min(*min_stream_timestamp, stream_timestamp);
-  }
-
-  if (*min_stream_timestamp == Timestamp::Done()) {
-    return NodeReadiness::kReadyForClose;
-  }
-
-  if (min_bound > *min_stream_timestamp) {
-    return NodeReadiness::kReadyForProcess;
+    readiness_.Update(id.value(), stream_timestamp, empty);
   }
-
-  CHECK_EQ(min_bound, *min_stream_timestamp);
-  return NodeReadiness::kNotReady;
+  updated_streams_.clear();
+  return readiness_.GetReadiness(min_stream_timestamp);
 }
 
 void TimestampAlignInputStreamHandler::FillInputSet(
     Timestamp input_timestamp, InputStreamShardSet* input_set) {
   CHECK(input_timestamp.IsAllowedInStream());
   CHECK(input_set);
-  {
-    absl::MutexLock lock(&mutex_);
-    if (!offsets_initialized_) {
-      for (CollectionItemId id = input_stream_managers_.BeginId();
-           id < input_stream_managers_.EndId(); ++id) {
-        const auto& stream = input_stream_managers_.Get(id);
-        int num_packets_dropped = 0;
-        bool stream_is_done = false;
-        Packet current_packet;
-        if (id == timestamp_base_stream_id_) {
-          current_packet = stream->PopPacketAtTimestamp(
-              input_timestamp, &num_packets_dropped, &stream_is_done);
-          CHECK_EQ(num_packets_dropped, 0) << absl::Substitute(
-              "Dropped $0 packet(s) on input stream \"$1\".",
-              num_packets_dropped, stream->Name());
-        }
-        AddPacketToShard(&input_set->Get(id), std::move(current_packet),
-                         stream_is_done);
+  absl::MutexLock lock(&mutex_);
+  if (!offsets_initialized_) {
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id) {
+      const auto& stream = input_stream_managers_.Get(id);
+      int num_packets_dropped = 0;
+      bool stream_is_done = false;
+      Packet current_packet;
+      if (id == timestamp_base_stream_id_) {
+        current_packet = stream->PopPacketAtTimestamp(
+            input_timestamp, &num_packets_dropped, &stream_is_done);
+        CHECK_EQ(num_packets_dropped, 0) << absl::Substitute(
+            "Dropped $0 packet(s) on input stream \"$1\".",
+            num_packets_dropped, stream->Name());
+        MarkStreamUpdated(id);
       }
-      return;
+      AddPacketToShard(&input_set->Get(id), std::move(current_packet),
+                       stream_is_done);
     }
+    return;
   }
   for (CollectionItemId id = input_stream_managers_.BeginId();
        id < input_stream_managers_.EndId(); ++id) {
@@ -221,6 +247,7 @@ void TimestampAlignInputStreamHandler::FillInputSet(
     if (!current_packet.IsEmpty()) {
       CHECK_EQ(current_packet.Timestamp(), stream_timestamp);
       current_packet = current_packet.At(input_timestamp);
+      MarkStreamUpdated(id);
     }
     CHECK_EQ(num_packets_dropped, 0)
         << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
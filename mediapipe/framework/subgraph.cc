@@ -17,12 +17,62 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/tool/template_expander.h"
 
 namespace mediapipe {
 
+namespace {
+
+// Expanded template configs, keyed by the content of the template and its
+// arguments.  A process that initializes many graphs from the same templates
+// expands each template instance only once.
+class TemplateExpansionCache {
+ public:
+  static TemplateExpansionCache* Get() {
+    static TemplateExpansionCache* cache = new TemplateExpansionCache();
+    return cache;
+  }
+
+  // Returns true and sets config if the key has been expanded before.
+  bool Lookup(const std::string& key, CalculatorGraphConfig* config)
+      LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    auto it = configs_.find(key);
+    if (it == configs_.end()) {
+      return false;
+    }
+    *config = it->second;
+    return true;
+  }
+
+  void Insert(const std::string& key, const CalculatorGraphConfig& config)
+      LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    // Bounds the cache size for processes which expand many distinct
+    // templates.
+    if (configs_.size() >= kMaxEntries) {
+      configs_.clear();
+    }
+    configs_[key] = config;
+  }
+
+ private:
+  static constexpr int kMaxEntries = 256;
+
+  absl::Mutex mutex_;
+  std::unordered_map<std::string, CalculatorGraphConfig> configs_
+      GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
 Subgraph::Subgraph() {}
 
 Subgraph::~Subgraph() {}
@@ -46,9 +96,19 @@ TemplateSubgraph::~TemplateSubgraph() {}
     const Subgraph::SubgraphOptions& options) {
   const TemplateDict& arguments =
       options.GetExtension(TemplateSubgraphOptions::ext).dict();
-  tool::TemplateExpander expander;
+  std::string templ_bytes;
+  std::string arguments_bytes;
+  RET_CHECK(templ_.SerializePartialToString(&templ_bytes));
+  RET_CHECK(arguments.SerializePartialToString(&arguments_bytes));
+  std::string key =
+      absl::StrCat(templ_bytes.size(), ":", templ_bytes, arguments_bytes);
   CalculatorGraphConfig config;
+  if (TemplateExpansionCache::Get()->Lookup(key, &config)) {
+    return config;
+  }
+  tool::TemplateExpander expander;
   MP_RETURN_IF_ERROR(expander.ExpandTemplates(arguments, templ_, &config));
+  TemplateExpansionCache::Get()->Insert(key, config);
   return config;
 }
 
@@ -14,9 +14,13 @@
 
 #include "mediapipe/framework/subgraph.h"
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/tool/calculator_graph_template.pb.h"
+#include "mediapipe/framework/tool/template_parser.h"
 
 // Because of portability issues, we include this directly.
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT(build/deprecated)
@@ -75,5 +79,82 @@ TEST_F(SubgraphTest, LinkedSubgraph) {
   TestGraphEnclosing("DubQuadTestSubgraph");
 }
 
+// Returns a template subgraph with a single node named by "in_name".
+CalculatorGraphTemplate PassThroughTemplate() {
+  tool::TemplateParser::Parser parser;
+  CalculatorGraphTemplate templ;
+  CHECK(parser.ParseFromString(R"(
+    type: "PassThroughGraph"
+    input_stream: % "INPUT:" + in_name %
+    output_stream: "OUTPUT:out"
+    node {
+      name: %in_name%
+      calculator: "PassThroughCalculator"
+      input_stream: %in_name%
+      output_stream: "out"
+    }
+  )",
+                               &templ));
+  return templ;
+}
+
+// Returns subgraph options which set the template argument "in_name".
+Subgraph::SubgraphOptions InNameOptions(const std::string& in_name) {
+  Subgraph::SubgraphOptions options;
+  TemplateDict::Parameter* arg =
+      options.MutableExtension(TemplateSubgraphOptions::ext)
+          ->mutable_dict()
+          ->add_arg();
+  arg->set_key("in_name");
+  arg->mutable_value()->set_str(in_name);
+  return options;
+}
+
+// Checks that the expansion of PassThroughTemplate names the node "in_name".
+void ExpectExpandedName(
+    const ::mediapipe::StatusOr<CalculatorGraphConfig>& config,
+    const std::string& in_name) {
+  MP_ASSERT_OK(config);
+  const CalculatorGraphConfig& expanded = config.ValueOrDie();
+  ASSERT_EQ(expanded.input_stream_size(), 1);
+  EXPECT_EQ(expanded.input_stream(0), absl::StrCat("INPUT:", in_name));
+  ASSERT_EQ(expanded.node_size(), 1);
+  EXPECT_EQ(expanded.node(0).name(), in_name);
+  EXPECT_EQ(expanded.node(0).input_stream(0), in_name);
+}
+
+// Shows that expanding a template again returns the same config for the same
+// arguments, and a distinct config for different arguments.
+TEST_F(SubgraphTest, TemplateExpandedRepeatedly) {
+  TemplateSubgraph subgraph_1(PassThroughTemplate());
+  TemplateSubgraph subgraph_2(PassThroughTemplate());
+  auto config_1 = subgraph_1.GetConfig(InNameOptions("stream_1"));
+  ExpectExpandedName(config_1, "stream_1");
+  auto config_2 = subgraph_2.GetConfig(InNameOptions("stream_1"));
+  ExpectExpandedName(config_2, "stream_1");
+  EXPECT_EQ(config_1.ValueOrDie().SerializeAsString(),
+            config_2.ValueOrDie().SerializeAsString());
+
+  ExpectExpandedName(subgraph_1.GetConfig(InNameOptions("stream_2")),
+                     "stream_2");
+  ExpectExpandedName(subgraph_2.GetConfig(InNameOptions("stream_1")),
+                     "stream_1");
+}
+
+// Shows that expansions remain correct after more distinct template instances
+// are expanded than the process keeps.
+TEST_F(SubgraphTest, TemplateExpandedManyTimes) {
+  TemplateSubgraph subgraph(PassThroughTemplate());
+  constexpr int kCount = 600;
+  for (int i = 0; i < kCount; ++i) {
+    std::string in_name = absl::StrCat("stream_", i);
+    ExpectExpandedName(subgraph.GetConfig(InNameOptions(in_name)), in_name);
+  }
+  for (int i = 0; i < kCount; i += 100) {
+    std::string in_name = absl::StrCat("stream_", i);
+    ExpectExpandedName(subgraph.GetConfig(InNameOptions(in_name)), in_name);
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -0,0 +1,93 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A command line utility to expand and validate a text CalculatorGraphConfig
+// and output a binary GraphBundle.  The calculators, packet generators and
+// subgraphs used by the graph must be linked into the utility, see the
+// mediapipe_graph_bundle rule.
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <string>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/graph_bundle.pb.h"
+#include "mediapipe/framework/port/advanced_proto_inc.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/commandlineflags.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+DEFINE_string(proto_source, "",
+              "The source file containing CalculatorGraphConfig protobuf "
+              "text.");
+DEFINE_string(proto_output, "",
+              "An output file in binary GraphBundle form.");
+
+#define EXIT_IF_ERROR(status) \
+  if (!status.ok()) {         \
+    LOG(ERROR) << status;     \
+    return EXIT_FAILURE;      \
+  }
+
+namespace mediapipe {
+
+// Reads a CalculatorGraphConfig from a text file.
+mediapipe::Status ReadGraphConfig(const std::string& proto_source,
+                                  CalculatorGraphConfig* config) {
+  std::ifstream ifs(proto_source);
+  proto_ns::io::IstreamInputStream in(&ifs);
+  RET_CHECK(proto_ns::TextFormat::Parse(&in, config))
+      << "could not parse text proto: " << proto_source;
+  return mediapipe::OkStatus();
+}
+
+// Writes a GraphBundle to a binary file.
+mediapipe::Status WriteGraphBundle(const std::string& proto_output,
+                                   const GraphBundle& bundle) {
+  std::ofstream ofs(proto_output, std::ofstream::out | std::ofstream::trunc);
+  proto_ns::io::OstreamOutputStream out(&ofs);
+  RET_CHECK(bundle.SerializeToZeroCopyStream(&out))
+      << "could not write binary proto to: " << proto_output;
+  return mediapipe::OkStatus();
+}
+
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  // Validate command line options.
+  mediapipe::Status status;
+  if (FLAGS_proto_source.empty()) {
+    status.Update(
+        ::mediapipe::InvalidArgumentError("--proto_source must be specified"));
+  }
+  if (FLAGS_proto_output.empty()) {
+    status.Update(
+        ::mediapipe::InvalidArgumentError("--proto_output must be specified"));
+  }
+  if (!status.ok()) {
+    return EXIT_FAILURE;
+  }
+  mediapipe::CalculatorGraphConfig config;
+  EXIT_IF_ERROR(mediapipe::ReadGraphConfig(FLAGS_proto_source, &config));
+  mediapipe::GraphBundle bundle;
+  EXIT_IF_ERROR(mediapipe::CreateGraphBundle(config, &bundle));
+  EXIT_IF_ERROR(mediapipe::WriteGraphBundle(FLAGS_proto_output, bundle));
+  return EXIT_SUCCESS;
+}
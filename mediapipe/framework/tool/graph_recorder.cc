@@ -0,0 +1,213 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_recorder.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/core_proto_inc.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+namespace tool {
+
+::mediapipe::Status SerializePacket(const Packet& packet,
+                                    std::string* type_name,
+                                    std::string* value) {
+  RET_CHECK(!packet.IsEmpty()) << "Cannot serialize an empty packet.";
+  const MediaPipeTypeData* type_data =
+      PacketTypeIdToMediaPipeTypeData::GetValue(packet.GetTypeId());
+  if (!type_data || !type_data->serialize_fn) {
+    return ::mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+           << "No serialize function is registered for packet type "
+           << packet.DebugTypeName() << ".";
+  }
+  *type_name = type_data->type_string;
+  return type_data->serialize_fn(*packet_internal::GetHolder(packet), value);
+}
+
+::mediapipe::Status DeserializePacket(const std::string& type_name,
+                                      const std::string& value,
+                                      Packet* packet) {
+  const MediaPipeTypeData* type_data =
+      PacketTypeStringToMediaPipeTypeData::GetValue(type_name);
+  if (!type_data || !type_data->deserialize_fn) {
+    return ::mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+           << "No deserialize function is registered for packet type "
+           << type_name << ".";
+  }
+  std::unique_ptr<packet_internal::HolderBase> holder;
+  MP_RETURN_IF_ERROR(type_data->deserialize_fn(value, &holder));
+  RET_CHECK(holder);
+  *packet = packet_internal::Create(holder.release());
+  return ::mediapipe::OkStatus();
+}
+
+GraphRecorder::GraphRecorder(const std::string& path) : path_(path) {}
+
+GraphRecorder::~GraphRecorder() { Finish().IgnoreError(); }
+
+::mediapipe::Status GraphRecorder::Start(
+    const std::map<std::string, Packet>& side_packets,
+    const std::map<std::string, Packet>& stream_headers) {
+  absl::MutexLock lock(&mutex_);
+  if (file_) {
+    fclose(file_);
+  }
+  file_ = fopen(path_.c_str(), "wb");
+  if (!file_) {
+    return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Unable to open recording file " << path_ << ".";
+  }
+  start_time_ = absl::Now();
+
+  GraphRecordingEvent event;
+  for (const auto& item : side_packets) {
+    if (item.second.IsEmpty()) {
+      continue;
+    }
+    event.Clear();
+    event.set_type(GraphRecordingEvent::SIDE_PACKET);
+    event.set_name(item.first);
+    ::mediapipe::Status status = SerializePacket(
+        item.second, event.mutable_type_name(), event.mutable_value());
+    if (!status.ok()) {
+      LOG(WARNING) << "Not recording input side packet \"" << item.first
+                   << "\": " << status.message();
+      continue;
+    }
+    MP_RETURN_IF_ERROR(WriteEvent(&event));
+  }
+  for (const auto& item : stream_headers) {
+    event.Clear();
+    event.set_type(GraphRecordingEvent::STREAM_HEADER);
+    event.set_name(item.first);
+    MP_RETURN_IF_ERROR(SerializePacket(item.second, event.mutable_type_name(),
+                                       event.mutable_value()))
+        << "Unable to record the header of stream \"" << item.first << "\".";
+    MP_RETURN_IF_ERROR(WriteEvent(&event));
+  }
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status GraphRecorder::RecordPacket(const std::string& stream_name,
+                                                const Packet& packet) {
+  GraphRecordingEvent event;
+  event.set_type(GraphRecordingEvent::PACKET);
+  event.set_name(stream_name);
+  event.set_timestamp(packet.Timestamp().Value());
+  MP_RETURN_IF_ERROR(SerializePacket(packet, event.mutable_type_name(),
+                                     event.mutable_value()))
+      << "Unable to record a packet on stream \"" << stream_name << "\".";
+  absl::MutexLock lock(&mutex_);
+  return WriteEvent(&event);
+}
+
+::mediapipe::Status GraphRecorder::RecordClose(
+    const std::string& stream_name) {
+  GraphRecordingEvent event;
+  event.set_type(GraphRecordingEvent::CLOSE_STREAM);
+  event.set_name(stream_name);
+  absl::MutexLock lock(&mutex_);
+  return WriteEvent(&event);
+}
+
+::mediapipe::Status GraphRecorder::Finish() {
+  absl::MutexLock lock(&mutex_);
+  if (!file_) {
+    return ::mediapipe::OkStatus();
+  }
+  int result = fclose(file_);
+  file_ = nullptr;
+  RET_CHECK_EQ(0, result) << "Unable to write recording file " << path_;
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status GraphRecorder::WriteEvent(GraphRecordingEvent* event) {
+  RET_CHECK(file_) << "GraphRecorder::Start() has not been called.";
+  // The arrival time is taken under the lock, so that events are written in
+  // order of arrival time.
+  event->set_arrival_time_usec(
+      absl::ToInt64Microseconds(absl::Now() - start_time_));
+  uint32 size = event->ByteSizeLong();
+  buffer_.resize(proto_ns::io::CodedOutputStream::VarintSize32(size) + size);
+  uint8* data = reinterpret_cast<uint8*>(&buffer_[0]);
+  data = proto_ns::io::CodedOutputStream::WriteVarint32ToArray(size, data);
+  event->SerializeWithCachedSizesToArray(data);
+  RET_CHECK_EQ(buffer_.size(), fwrite(buffer_.data(), 1, buffer_.size(), file_))
+      << "Unable to write recording file " << path_;
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status ReadGraphRecording(const std::string& path,
+                                       GraphRecording* recording) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  const uint8* data = reinterpret_cast<const uint8*>(contents.data());
+  size_t offset = 0;
+  GraphRecordingEvent event;
+  while (offset < contents.size()) {
+    int remaining = static_cast<int>(std::min<size_t>(
+        contents.size() - offset, std::numeric_limits<int>::max()));
+    proto_ns::io::CodedInputStream input(data + offset, remaining);
+    uint32 size;
+    RET_CHECK(input.ReadVarint32(&size))
+        << "Corrupt recording file " << path << " at offset " << offset;
+    offset += input.CurrentPosition();
+    RET_CHECK_LE(size, contents.size() - offset)
+        << "Truncated recording file " << path;
+    RET_CHECK(event.ParseFromArray(data + offset, size))
+        << "Corrupt recording file " << path << " at offset " << offset;
+    offset += size;
+
+    Packet packet;
+    if (event.type() != GraphRecordingEvent::CLOSE_STREAM) {
+      MP_RETURN_IF_ERROR(
+          DeserializePacket(event.type_name(), event.value(), &packet));
+    }
+    switch (event.type()) {
+      case GraphRecordingEvent::SIDE_PACKET:
+        recording->side_packets[event.name()] = packet;
+        break;
+      case GraphRecordingEvent::STREAM_HEADER:
+        recording->stream_headers[event.name()] = packet;
+        break;
+      case GraphRecordingEvent::PACKET:
+      case GraphRecordingEvent::CLOSE_STREAM:
+        recording->inputs.push_back(
+            {event.type(), event.name(),
+             absl::Microseconds(event.arrival_time_usec()),
+             event.type() == GraphRecordingEvent::PACKET
+                 ? packet.At(Timestamp::CreateNoErrorChecking(
+                       event.timestamp()))
+                 : packet});
+        break;
+      default:
+        return ::mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "Unknown event type " << event.type() << " in recording "
+               << path;
+    }
+  }
+  return ::mediapipe::OkStatus();
+}
+
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,181 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Functions for recording the inputs of a CalculatorGraph run, so that the
+// run can be replayed later by tool/graph_replayer.h.
+//
+// Packets are encoded with the serialize and deserialize functions that are
+// registered for their types with MEDIAPIPE_REGISTER_TYPE.  For example, a
+// protobuf message type can be made recordable with:
+//
+//   MEDIAPIPE_REGISTER_TYPE(
+//       ::mediapipe::Detection, "::mediapipe::Detection",
+//       ::mediapipe::tool::SerializeProtoMessage<::mediapipe::Detection>,
+//       ::mediapipe::tool::DeserializeProtoMessage<::mediapipe::Detection>);
+//
+// Serialize functions for the basic types such as int and std::string are
+// registered by the ":graph_recorder_basic_types" library.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_RECORDER_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_RECORDER_H_
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_recording.pb.h"
+
+namespace mediapipe {
+namespace tool {
+
+// A SerializeFn for protobuf message types.
+template <typename T>
+::mediapipe::Status SerializeProtoMessage(
+    const packet_internal::HolderBase& holder, std::string* output) {
+  const packet_internal::Holder<T>* typed_holder = holder.As<T>();
+  RET_CHECK(typed_holder);
+  RET_CHECK(typed_holder->data().SerializeToString(output));
+  return ::mediapipe::OkStatus();
+}
+
+// A DeserializeFn for protobuf message types.
+template <typename T>
+::mediapipe::Status DeserializeProtoMessage(
+    const std::string& encoding,
+    std::unique_ptr<packet_internal::HolderBase>* holder) {
+  auto message = absl::make_unique<T>();
+  RET_CHECK(message->ParseFromString(encoding));
+  holder->reset(new packet_internal::Holder<T>(message.release()));
+  return ::mediapipe::OkStatus();
+}
+
+// A SerializeFn for trivially copyable types, encoded in host byte order.
+template <typename T>
+::mediapipe::Status SerializeTriviallyCopyable(
+    const packet_internal::HolderBase& holder, std::string* output) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T must be trivially copyable.");
+  const packet_internal::Holder<T>* typed_holder = holder.As<T>();
+  RET_CHECK(typed_holder);
+  output->assign(reinterpret_cast<const char*>(&typed_holder->data()),
+                 sizeof(T));
+  return ::mediapipe::OkStatus();
+}
+
+// A DeserializeFn for trivially copyable types, encoded in host byte order.
+template <typename T>
+::mediapipe::Status DeserializeTriviallyCopyable(
+    const std::string& encoding,
+    std::unique_ptr<packet_internal::HolderBase>* holder) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "T must be trivially copyable.");
+  RET_CHECK_EQ(sizeof(T), encoding.size());
+  auto value = absl::make_unique<T>();
+  std::memcpy(value.get(), encoding.data(), sizeof(T));
+  holder->reset(new packet_internal::Holder<T>(value.release()));
+  return ::mediapipe::OkStatus();
+}
+
+// Encodes the payload of a packet using the serialize function registered
+// for its type.  Fails if the type has no registered serialize function.
+::mediapipe::Status SerializePacket(const Packet& packet,
+                                    std::string* type_name,
+                                    std::string* value);
+
+// Decodes a packet payload using the deserialize function registered for
+// the type named "type_name".  The returned packet has no timestamp.
+::mediapipe::Status DeserializePacket(const std::string& type_name,
+                                      const std::string& value,
+                                      Packet* packet);
+
+// Records the inputs of CalculatorGraph runs to a file.  Each run replaces
+// the previous contents of the file.  The methods are thread-safe.
+//
+// Input side packets whose types have no registered serialize function,
+// such as pointers and callbacks, are skipped with a warning, and must be
+// supplied again when the recording is replayed.  Graph input packets
+// must always be serializable.
+class GraphRecorder {
+ public:
+  explicit GraphRecorder(const std::string& path);
+  ~GraphRecorder();
+
+  GraphRecorder(const GraphRecorder&) = delete;
+  GraphRecorder& operator=(const GraphRecorder&) = delete;
+
+  // Opens the recording file and records the side packets and stream
+  // headers of a new run.
+  ::mediapipe::Status Start(
+      const std::map<std::string, Packet>& side_packets,
+      const std::map<std::string, Packet>& stream_headers)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Records a packet added to a graph input stream.
+  ::mediapipe::Status RecordPacket(const std::string& stream_name,
+                                   const Packet& packet)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Records the closing of a graph input stream.
+  ::mediapipe::Status RecordClose(const std::string& stream_name)
+      LOCKS_EXCLUDED(mutex_);
+
+  // Flushes and closes the recording file.  Does nothing if no run is
+  // being recorded.
+  ::mediapipe::Status Finish() LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // Appends one length-delimited event to the file.
+  ::mediapipe::Status WriteEvent(GraphRecordingEvent* event)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::string path_;
+  absl::Mutex mutex_;
+  FILE* file_ GUARDED_BY(mutex_) = nullptr;
+  absl::Time start_time_ GUARDED_BY(mutex_);
+  std::string buffer_ GUARDED_BY(mutex_);
+};
+
+// The contents of a recording, with all packets decoded.
+struct GraphRecording {
+  std::map<std::string, Packet> side_packets;
+  std::map<std::string, Packet> stream_headers;
+  // The PACKET and CLOSE_STREAM events in order of arrival time.
+  struct Input {
+    GraphRecordingEvent::EventType type;
+    std::string stream_name;
+    absl::Duration arrival_time;
+    Packet packet;
+  };
+  std::vector<Input> inputs;
+};
+
+// Reads and decodes a recording written by GraphRecorder.
+::mediapipe::Status ReadGraphRecording(const std::string& path,
+                                       GraphRecording* recording);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_RECORDER_H_
@@ -0,0 +1,73 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Registers serialize functions for the basic packet types, so that graphs
+// using them can be recorded by GraphRecorder.
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_recorder.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+::mediapipe::Status SerializeString(const packet_internal::HolderBase& holder,
+                                    std::string* output) {
+  const packet_internal::Holder<std::string>* typed_holder =
+      holder.As<std::string>();
+  RET_CHECK(typed_holder);
+  *output = typed_holder->data();
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::Status DeserializeString(
+    const std::string& encoding,
+    std::unique_ptr<packet_internal::HolderBase>* holder) {
+  holder->reset(
+      new packet_internal::Holder<std::string>(new std::string(encoding)));
+  return ::mediapipe::OkStatus();
+}
+
+}  // namespace
+}  // namespace tool
+
+MEDIAPIPE_REGISTER_TYPE(bool, "bool",
+                        ::mediapipe::tool::SerializeTriviallyCopyable<bool>,
+                        ::mediapipe::tool::DeserializeTriviallyCopyable<bool>);
+MEDIAPIPE_REGISTER_TYPE(int, "int",
+                        ::mediapipe::tool::SerializeTriviallyCopyable<int>,
+                        ::mediapipe::tool::DeserializeTriviallyCopyable<int>);
+MEDIAPIPE_REGISTER_TYPE(int64, "int64",
+                        ::mediapipe::tool::SerializeTriviallyCopyable<int64>,
+                        ::mediapipe::tool::DeserializeTriviallyCopyable<int64>);
+MEDIAPIPE_REGISTER_TYPE(
+    uint64, "uint64", ::mediapipe::tool::SerializeTriviallyCopyable<uint64>,
+    ::mediapipe::tool::DeserializeTriviallyCopyable<uint64>);
+MEDIAPIPE_REGISTER_TYPE(float, "float",
+                        ::mediapipe::tool::SerializeTriviallyCopyable<float>,
+                        ::mediapipe::tool::DeserializeTriviallyCopyable<float>);
+MEDIAPIPE_REGISTER_TYPE(
+    double, "double", ::mediapipe::tool::SerializeTriviallyCopyable<double>,
+    ::mediapipe::tool::DeserializeTriviallyCopyable<double>);
+MEDIAPIPE_REGISTER_TYPE(::std::string, "::std::string",
+                        ::mediapipe::tool::SerializeString,
+                        ::mediapipe::tool::DeserializeString);
+
+}  // namespace mediapipe
@@ -0,0 +1,127 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_recorder.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+MEDIAPIPE_REGISTER_TYPE(
+    ::mediapipe::PacketTestProto, "::mediapipe::PacketTestProto",
+    ::mediapipe::tool::SerializeProtoMessage<::mediapipe::PacketTestProto>,
+    ::mediapipe::tool::DeserializeProtoMessage<::mediapipe::PacketTestProto>);
+
+namespace {
+
+struct UnregisteredStruct {
+  int value;
+};
+
+TEST(GraphRecorderTest, SerializesRegisteredTypes) {
+  std::string type_name;
+  std::string value;
+  Packet packet;
+  MP_ASSERT_OK(
+      tool::SerializePacket(MakePacket<int>(42), &type_name, &value));
+  EXPECT_EQ("int", type_name);
+  MP_ASSERT_OK(tool::DeserializePacket(type_name, value, &packet));
+  EXPECT_EQ(42, packet.Get<int>());
+
+  MP_ASSERT_OK(tool::SerializePacket(MakePacket<std::string>("forty-two"),
+                                     &type_name, &value));
+  MP_ASSERT_OK(tool::DeserializePacket(type_name, value, &packet));
+  EXPECT_EQ("forty-two", packet.Get<std::string>());
+
+  PacketTestProto proto;
+  proto.add_x(4);
+  proto.add_x(2);
+  MP_ASSERT_OK(tool::SerializePacket(MakePacket<PacketTestProto>(proto),
+                                     &type_name, &value));
+  EXPECT_EQ("::mediapipe::PacketTestProto", type_name);
+  MP_ASSERT_OK(tool::DeserializePacket(type_name, value, &packet));
+  EXPECT_THAT(packet.Get<PacketTestProto>().x(), testing::ElementsAre(4, 2));
+}
+
+TEST(GraphRecorderTest, RejectsUnregisteredTypes) {
+  std::string type_name;
+  std::string value;
+  ::mediapipe::Status status = tool::SerializePacket(
+      MakePacket<UnregisteredStruct>(UnregisteredStruct{1}), &type_name,
+      &value);
+  EXPECT_EQ(::mediapipe::StatusCode::kFailedPrecondition, status.code());
+}
+
+TEST(GraphRecorderTest, RecordsGraphInputs) {
+  std::string path = absl::StrCat(getenv("TEST_TMPDIR"), "/recording.bin");
+  CalculatorGraphConfig config =
+      ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "input"
+        input_side_packet: "label"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "output"
+        }
+      )");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.EnableInputRecording(path);
+  MP_ASSERT_OK(graph.StartRun(
+      {{"label", MakePacket<std::string>("test")},
+       {"unserializable",
+        MakePacket<UnregisteredStruct>(UnregisteredStruct{1})}}));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i * 10).At(Timestamp(i))));
+  }
+  // Packets of unregistered types cannot be recorded.
+  EXPECT_FALSE(graph
+                   .AddPacketToInputStream(
+                       "input", MakePacket<UnregisteredStruct>(
+                                    UnregisteredStruct{1})
+                                    .At(Timestamp(5)))
+                   .ok());
+  MP_ASSERT_OK(graph.CloseInputStream("input"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  tool::GraphRecording recording;
+  MP_ASSERT_OK(tool::ReadGraphRecording(path, &recording));
+  ASSERT_EQ(1, recording.side_packets.size());
+  EXPECT_EQ("test", recording.side_packets["label"].Get<std::string>());
+  ASSERT_EQ(6, recording.inputs.size());
+  for (int i = 0; i < 5; ++i) {
+    const tool::GraphRecording::Input& input = recording.inputs[i];
+    EXPECT_EQ(GraphRecordingEvent::PACKET, input.type);
+    EXPECT_EQ("input", input.stream_name);
+    EXPECT_EQ(Timestamp(i), input.packet.Timestamp());
+    EXPECT_EQ(i * 10, input.packet.Get<int>());
+    if (i > 0) {
+      EXPECT_GE(input.arrival_time, recording.inputs[i - 1].arrival_time);
+    }
+  }
+  EXPECT_EQ(GraphRecordingEvent::CLOSE_STREAM, recording.inputs[5].type);
+  EXPECT_EQ("input", recording.inputs[5].stream_name);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,237 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_replayer.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/deps/clock.h"
+#include "mediapipe/framework/tool/simulation_clock.h"
+#include "mediapipe/framework/tool/simulation_clock_executor.h"
+#include "mediapipe/framework/tool/validate_name.h"
+
+namespace mediapipe {
+namespace tool {
+
+namespace {
+
+// Returns the latency at the given percentile of sorted latencies.
+absl::Duration Percentile(const std::vector<absl::Duration>& latencies,
+                          int percentile) {
+  if (latencies.empty()) {
+    return absl::ZeroDuration();
+  }
+  int index = (latencies.size() - 1) * percentile / 100;
+  return latencies[index];
+}
+
+// Returns the relative change from "baseline" to "candidate" as a string.
+std::string RelativeChange(double baseline, double candidate) {
+  if (baseline == 0) {
+    return "n/a";
+  }
+  return absl::StrFormat("%+.1f%%", (candidate - baseline) / baseline * 100);
+}
+
+// Returns one line comparing a duration in two replays.
+std::string CompareDuration(const std::string& label, absl::Duration baseline,
+                            absl::Duration candidate) {
+  return absl::StrFormat(
+      "%-16s %12.3f ms %12.3f ms %10s\n", label,
+      absl::ToDoubleMilliseconds(baseline),
+      absl::ToDoubleMilliseconds(candidate),
+      RelativeChange(absl::ToDoubleMicroseconds(baseline),
+                     absl::ToDoubleMicroseconds(candidate)));
+}
+
+}  // namespace
+
+double ReplayStats::InputPacketsPerSecond() const {
+  double seconds = absl::ToDoubleSeconds(run_time);
+  return seconds > 0 ? num_input_packets / seconds : 0;
+}
+
+::mediapipe::Status ReplayGraph(const CalculatorGraphConfig& config,
+                                const GraphRecording& recording,
+                                const ReplayOptions& options,
+                                ReplayStats* stats) {
+  CalculatorGraph graph;
+  Clock* clock = Clock::RealClock();
+  std::shared_ptr<SimulationClock> simulation_clock;
+  if (options.mode == ReplayMode::SIMULATED_TIME) {
+    auto executor = std::make_shared<SimulationClockExecutor>(
+        options.num_simulation_threads);
+    simulation_clock = executor->GetClock();
+    clock = simulation_clock.get();
+    MP_RETURN_IF_ERROR(graph.SetExecutor("", executor));
+    // Blocking in AddPacketToInputStream would stop simulated time, so
+    // throttled inputs are retried after letting the graph run instead.
+    graph.SetGraphInputStreamAddMode(
+        CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  }
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+
+  std::vector<std::string> output_streams = options.output_streams;
+  if (output_streams.empty()) {
+    for (const std::string& output_stream : config.output_stream()) {
+      std::string tag;
+      int index;
+      std::string name;
+      MP_RETURN_IF_ERROR(ParseTagIndexName(output_stream, &tag, &index, &name));
+      output_streams.push_back(name);
+    }
+  }
+
+  absl::Mutex mutex;
+  // The time at which the first input packet with each timestamp was added.
+  std::map<Timestamp, absl::Time> input_times;
+  std::vector<absl::Duration> latencies;
+  int64 num_output_packets = 0;
+  for (const std::string& stream_name : output_streams) {
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        stream_name, [&, clock](const Packet& packet) {
+          absl::Time now = clock->TimeNow();
+          absl::MutexLock lock(&mutex);
+          ++num_output_packets;
+          auto iter = input_times.find(packet.Timestamp());
+          if (iter != input_times.end()) {
+            latencies.push_back(now - iter->second);
+          }
+          return ::mediapipe::OkStatus();
+        }));
+  }
+
+  std::map<std::string, Packet> side_packets = recording.side_packets;
+  for (const auto& item : options.extra_side_packets) {
+    side_packets[item.first] = item.second;
+  }
+  absl::Time start_time = clock->TimeNow();
+  MP_RETURN_IF_ERROR(graph.StartRun(side_packets, recording.stream_headers));
+  if (simulation_clock) {
+    simulation_clock->ThreadStart();
+  }
+
+  int64 num_input_packets = 0;
+  ::mediapipe::Status status;
+  for (const GraphRecording::Input& input : recording.inputs) {
+    absl::Time arrival_time = start_time + input.arrival_time;
+    if (options.mode != ReplayMode::MAX_SPEED &&
+        arrival_time > clock->TimeNow()) {
+      clock->SleepUntil(arrival_time);
+    }
+    if (input.type == GraphRecordingEvent::CLOSE_STREAM) {
+      status = graph.CloseInputStream(input.stream_name);
+    } else {
+      {
+        absl::MutexLock lock(&mutex);
+        input_times.emplace(input.packet.Timestamp(), clock->TimeNow());
+      }
+      status = graph.AddPacketToInputStream(input.stream_name, input.packet);
+      while (simulation_clock &&
+             status.code() == ::mediapipe::StatusCode::kUnavailable) {
+        simulation_clock->Sleep(absl::Microseconds(1));
+        status = graph.AddPacketToInputStream(input.stream_name, input.packet);
+      }
+      ++num_input_packets;
+    }
+    if (!status.ok()) {
+      break;
+    }
+  }
+  if (simulation_clock) {
+    simulation_clock->ThreadFinish();
+  }
+  if (status.ok()) {
+    status = graph.CloseAllInputStreams();
+  }
+  // An error in the graph explains any error in adding packets.
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  MP_RETURN_IF_ERROR(status);
+
+  *stats = ReplayStats();
+  stats->run_time = clock->TimeNow() - start_time;
+  stats->num_input_packets = num_input_packets;
+  absl::MutexLock lock(&mutex);
+  stats->num_output_packets = num_output_packets;
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    absl::Duration total_latency;
+    for (absl::Duration latency : latencies) {
+      total_latency += latency;
+    }
+    stats->mean_latency = total_latency / latencies.size();
+    stats->p50_latency = Percentile(latencies, 50);
+    stats->p90_latency = Percentile(latencies, 90);
+    stats->p99_latency = Percentile(latencies, 99);
+    stats->max_latency = latencies.back();
+  }
+  return ::mediapipe::OkStatus();
+}
+
+std::string FormatReplayStats(const ReplayStats& stats) {
+  return absl::StrFormat(
+      "input packets:   %d\n"
+      "output packets:  %d\n"
+      "run time:        %.3f ms\n"
+      "throughput:      %.1f packets/s\n"
+      "latency mean:    %.3f ms\n"
+      "latency p50:     %.3f ms\n"
+      "latency p90:     %.3f ms\n"
+      "latency p99:     %.3f ms\n"
+      "latency max:     %.3f ms\n",
+      stats.num_input_packets, stats.num_output_packets,
+      absl::ToDoubleMilliseconds(stats.run_time),
+      stats.InputPacketsPerSecond(),
+      absl::ToDoubleMilliseconds(stats.mean_latency),
+      absl::ToDoubleMilliseconds(stats.p50_latency),
+      absl::ToDoubleMilliseconds(stats.p90_latency),
+      absl::ToDoubleMilliseconds(stats.p99_latency),
+      absl::ToDoubleMilliseconds(stats.max_latency));
+}
+
+std::string CompareReplayStats(const ReplayStats& baseline,
+                               const ReplayStats& candidate) {
+  std::string result = absl::StrFormat("%-16s %15s %15s %10s\n", "",
+                                       "baseline", "candidate", "change");
+  absl::StrAppend(
+      &result,
+      absl::StrFormat("%-16s %10.1f p/s %10.1f p/s %10s\n", "throughput",
+                      baseline.InputPacketsPerSecond(),
+                      candidate.InputPacketsPerSecond(),
+                      RelativeChange(baseline.InputPacketsPerSecond(),
+                                     candidate.InputPacketsPerSecond())));
+  absl::StrAppend(&result, CompareDuration("run time", baseline.run_time,
+                                           candidate.run_time));
+  absl::StrAppend(&result,
+                  CompareDuration("latency mean", baseline.mean_latency,
+                                  candidate.mean_latency));
+  absl::StrAppend(&result, CompareDuration("latency p50", baseline.p50_latency,
+                                           candidate.p50_latency));
+  absl::StrAppend(&result, CompareDuration("latency p90", baseline.p90_latency,
+                                           candidate.p90_latency));
+  absl::StrAppend(&result, CompareDuration("latency p99", baseline.p99_latency,
+                                           candidate.p99_latency));
+  absl::StrAppend(&result, CompareDuration("latency max", baseline.max_latency,
+                                           candidate.max_latency));
+  return result;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
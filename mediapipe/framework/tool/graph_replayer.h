@@ -0,0 +1,99 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Replays the inputs recorded by GraphRecorder into a CalculatorGraph and
+// measures its throughput and latency.  Replaying the same recording into
+// two graph configs, for example with different executor settings, gives a
+// repeatable A/B comparison on captured traffic.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_REPLAYER_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_REPLAYER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_recorder.h"
+
+namespace mediapipe {
+namespace tool {
+
+enum class ReplayMode {
+  // Adds each input at its recorded arrival time.
+  REAL_TIME,
+  // Adds the inputs as fast as the graph accepts them.
+  MAX_SPEED,
+  // Adds each input at its recorded arrival time according to a
+  // SimulationClock, which runs the graph on a SimulationClockExecutor.
+  // Time advances only while all graph threads are idle or sleeping on the
+  // clock, which makes the order of events repeatable.
+  SIMULATED_TIME,
+};
+
+struct ReplayOptions {
+  ReplayMode mode = ReplayMode::MAX_SPEED;
+
+  // The output streams observed for latency.  By default, all of the graph
+  // output streams are observed.
+  std::vector<std::string> output_streams;
+
+  // Side packets that are added to, or override, the recorded side packets.
+  std::map<std::string, Packet> extra_side_packets;
+
+  // The number of threads of the SimulationClockExecutor used in
+  // SIMULATED_TIME mode.
+  int num_simulation_threads = 4;
+};
+
+// Throughput and latency measured during a replay.  Latency is the time
+// from adding the first input packet with a given timestamp to observing an
+// output packet with that timestamp.
+struct ReplayStats {
+  int64 num_input_packets = 0;
+  int64 num_output_packets = 0;
+  // The time from starting the run until the graph is done.
+  absl::Duration run_time;
+  absl::Duration mean_latency;
+  absl::Duration p50_latency;
+  absl::Duration p90_latency;
+  absl::Duration p99_latency;
+  absl::Duration max_latency;
+
+  // Returns the input packets replayed per second of run time.
+  double InputPacketsPerSecond() const;
+};
+
+// Runs "config" once with the inputs in "recording".
+::mediapipe::Status ReplayGraph(const CalculatorGraphConfig& config,
+                                const GraphRecording& recording,
+                                const ReplayOptions& options,
+                                ReplayStats* stats);
+
+// Returns a human-readable summary of "stats".
+std::string FormatReplayStats(const ReplayStats& stats);
+
+// Returns a human-readable comparison of two replays, with the relative
+// change of each value from "baseline" to "candidate".
+std::string CompareReplayStats(const ReplayStats& baseline,
+                               const ReplayStats& candidate);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_REPLAYER_H_
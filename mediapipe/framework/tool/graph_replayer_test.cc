@@ -0,0 +1,112 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_replayer.h"
+
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+CalculatorGraphConfig PassThroughConfig() {
+  return ::mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+    input_stream: "input"
+    output_stream: "output"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+    }
+  )");
+}
+
+// Returns a recording of 10 int packets arriving 1 ms apart.
+tool::GraphRecording MakeRecording() {
+  tool::GraphRecording recording;
+  for (int i = 0; i < 10; ++i) {
+    recording.inputs.push_back({GraphRecordingEvent::PACKET, "input",
+                                absl::Milliseconds(i),
+                                MakePacket<int>(i).At(Timestamp(i))});
+  }
+  recording.inputs.push_back({GraphRecordingEvent::CLOSE_STREAM, "input",
+                              absl::Milliseconds(10), Packet()});
+  return recording;
+}
+
+class GraphReplayerTest : public ::testing::TestWithParam<tool::ReplayMode> {
+};
+
+TEST_P(GraphReplayerTest, ReplaysAllInputs) {
+  tool::ReplayOptions options;
+  options.mode = GetParam();
+  tool::ReplayStats stats;
+  MP_ASSERT_OK(
+      tool::ReplayGraph(PassThroughConfig(), MakeRecording(), options, &stats));
+  EXPECT_EQ(10, stats.num_input_packets);
+  EXPECT_EQ(10, stats.num_output_packets);
+  EXPECT_LE(stats.p50_latency, stats.max_latency);
+  if (GetParam() != tool::ReplayMode::MAX_SPEED) {
+    // The last packet arrives 9 ms after the start of the run.
+    EXPECT_GE(stats.run_time, absl::Milliseconds(9));
+  }
+  if (GetParam() == tool::ReplayMode::SIMULATED_TIME) {
+    // Processing takes no simulated time.
+    EXPECT_EQ(absl::ZeroDuration(), stats.max_latency);
+    EXPECT_EQ(absl::Milliseconds(10), stats.run_time);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllModes, GraphReplayerTest,
+                         ::testing::Values(tool::ReplayMode::REAL_TIME,
+                                           tool::ReplayMode::MAX_SPEED,
+                                           tool::ReplayMode::SIMULATED_TIME));
+
+TEST(GraphReplayerTest, ReplaysToObservedStreams) {
+  tool::ReplayOptions options;
+  options.output_streams = {"output"};
+  CalculatorGraphConfig config = PassThroughConfig();
+  config.clear_output_stream();
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output", &config, &output_packets);
+  tool::ReplayStats stats;
+  MP_ASSERT_OK(tool::ReplayGraph(config, MakeRecording(), options, &stats));
+  ASSERT_EQ(10, output_packets.size());
+  EXPECT_EQ(9, output_packets.back().Get<int>());
+  EXPECT_EQ(10, stats.num_output_packets);
+}
+
+TEST(GraphReplayerTest, ComparesStats) {
+  tool::ReplayStats baseline;
+  baseline.num_input_packets = 100;
+  baseline.run_time = absl::Seconds(1);
+  baseline.p50_latency = absl::Milliseconds(10);
+  tool::ReplayStats candidate = baseline;
+  candidate.run_time = absl::Milliseconds(500);
+  candidate.p50_latency = absl::Milliseconds(12);
+  EXPECT_DOUBLE_EQ(100, baseline.InputPacketsPerSecond());
+  std::string comparison = tool::CompareReplayStats(baseline, candidate);
+  EXPECT_NE(std::string::npos, comparison.find("+100.0%"));
+  EXPECT_NE(std::string::npos, comparison.find("-50.0%"));
+  EXPECT_NE(std::string::npos, comparison.find("+20.0%"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -13,6 +13,9 @@ Example:
     ]
   )
 
+mediapipe_graph_bundle() expands and validates a graph from text format into
+a serialized binary GraphBundle, which loads without re-validation.
+
 """
 
 load("//mediapipe/framework:encode_binary_proto.bzl", "encode_binary_proto", "generate_proto_descriptor_set")
@@ -60,6 +63,44 @@ def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], te
         testonly = testonly,
     )
 
+def mediapipe_graph_bundle(name, graph = None, output_name = None, deps = [], testonly = False, **kwargs):
+    """Expands and validates a text format graph into a binary GraphBundle.
+
+    The bundle is loaded with CalculatorGraph::Initialize(const GraphBundle&),
+    which skips subgraph expansion and topological sorting.  The packet types
+    of connected streams and the executors are still checked at load time.
+    The deps must include every calculator and subgraph used by the graph.
+    """
+    if not graph:
+        fail("No input graph file specified.")
+    if not output_name:
+        fail("Must specify the output_name.")
+
+    # Compile a bundle builder binary linking the calculators.
+    native.cc_binary(
+        name = name + "_build_graph_bundle",
+        visibility = ["//visibility:private"],
+        deps = [
+            "//mediapipe/framework/tool:build_graph_bundle",
+        ] + deps,
+        tags = ["manual"],
+        testonly = testonly,
+    )
+
+    # Invoke the bundle builder binary.
+    native.genrule(
+        name = name,
+        srcs = [graph],
+        outs = [output_name],
+        cmd = (
+            "$(location " + name + "_build_graph_bundle" + ") " +
+            ("--proto_source=$(location %s) " % graph) +
+            ("--proto_output=\"$@\" ")
+        ),
+        tools = [name + "_build_graph_bundle"],
+        testonly = testonly,
+    )
+
 def data_as_c_string(
         name,
         srcs,
@@ -15,6 +15,8 @@
 // This template is used by the mediapipe_simple_subgraph macro in
 // //mediapipe/framework/tool/mediapipe_graph.bzl
 
+#include <memory>
+
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/subgraph.h"
 
@@ -28,15 +30,26 @@ class {{SUBGRAPH_CLASS_NAME}} : public Subgraph {
  public:
   ::mediapipe::StatusOr<CalculatorGraphConfig> GetConfig(
       const SubgraphOptions& /*options*/) {
-    CalculatorGraphConfig config;
-    // Note: this is a binary protobuf serialization, and may include NUL
-    // bytes. The trailing NUL added to the std::string literal should be excluded.
-    if (config.ParseFromArray(binary_graph, sizeof(binary_graph) - 1)) {
-      return config;
+    // The graph is parsed once per process, and copied for each use.
+    static const CalculatorGraphConfig* config = ParseConfig();
+    if (config != nullptr) {
+      return *config;
     } else {
       return ::mediapipe::InternalError("Could not parse subgraph.");
     }
   }
+
+ private:
+  static const CalculatorGraphConfig* ParseConfig() {
+    std::unique_ptr<CalculatorGraphConfig> config(new CalculatorGraphConfig());
+    // Note: this is a binary protobuf serialization, and may include NUL
+    // bytes. The trailing NUL added to the std::string literal should be
+    // excluded.
+    if (!config->ParseFromArray(binary_graph, sizeof(binary_graph) - 1)) {
+      return nullptr;
+    }
+    return config.release();
+  }
 };
 REGISTER_MEDIAPIPE_GRAPH({{SUBGRAPH_CLASS_NAME}});
 
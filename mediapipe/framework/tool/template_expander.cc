@@ -161,9 +161,8 @@ class TemplateExpanderImpl {
       return false;
     }
 
-    // Extract the CalculatorGraphTemplate rules.
-    template_rules_ = templ;
-    template_rules_.clear_config();
+    // Reference the CalculatorGraphTemplate rules, without copying them.
+    rules_ = &templ.rule();
 
     // Invoke recursive rule expansion.
     environment_ = args;
@@ -181,7 +180,7 @@ class TemplateExpanderImpl {
   bool ExpandTemplateRule(int base_index, const FieldValue& base_message,
                           std::vector<FieldValue>* result) {
     // Exapand a template rule of a specific type.
-    const TemplateExpression& rule = template_rules_.rule().Get(base_index);
+    const TemplateExpression& rule = rules().Get(base_index);
     if (rule.op() == "for") {
       ExpandIterationRule(base_index, base_message, result);
     } else if (rule.op() == "if") {
@@ -200,10 +199,10 @@ class TemplateExpanderImpl {
   bool ExpandPeerRules(int base_index, const FieldValue& base_message,
                        std::vector<FieldValue>* result) {
     // If the next rule applies to the same message, apply it now.
-    auto& base_rule = template_rules_.rule().Get(base_index);
+    auto& base_rule = rules().Get(base_index);
     int next_index = base_index + 1;
-    if (next_index < template_rules_.rule().size()) {
-      auto& next_rule = template_rules_.rule().Get(next_index);
+    if (next_index < rules().size()) {
+      auto& next_rule = rules().Get(next_index);
       if (next_rule.path() == base_rule.path()) {
         return ExpandTemplateRule(next_index, base_message, result);
       }
@@ -214,11 +213,32 @@ class TemplateExpanderImpl {
                              result);
   }
 
+  // Returns the template rules.
+  const proto_ns::RepeatedPtrField<TemplateExpression>& rules() const {
+    return *rules_;
+  }
+
+  // Returns the field path of a rule relative to a base path.
+  mediapipe::Status GetFieldPath(int rule_index, const std::string& base_path,
+                                 const ProtoPath** result) {
+    auto key = std::make_pair(rule_index, base_path);
+    auto it = field_paths_.find(key);
+    if (it == field_paths_.end()) {
+      ProtoPath field_path;
+      const TemplateExpression& rule = rules().Get(rule_index);
+      MP_RETURN_IF_ERROR(ProtoPathSplit(
+          ProtoPathRelative(rule.path(), base_path), &field_path));
+      it = field_paths_.emplace(key, std::move(field_path)).first;
+    }
+    *result = &it->second;
+    return ::mediapipe::OkStatus();
+  }
+
   // Return the field values addressed by a template rule.
-  mediapipe::Status GetBaseValue(const std::string& base_path,
-                                 const TemplateExpression& rule,
+  mediapipe::Status GetBaseValue(const std::string& base_path, int rule_index,
                                  const FieldValue& output,
                                  std::vector<FieldValue>* base) {
+    const TemplateExpression& rule = rules().Get(rule_index);
     if (!rule.has_path()) {
       base->push_back(output);
       return ::mediapipe::OkStatus();
@@ -228,25 +248,24 @@ class TemplateExpanderImpl {
       base->push_back(rule.field_value());
       return ::mediapipe::OkStatus();
     }
-    ProtoPath field_path;
-    mediapipe::Status status =
-        ProtoPathSplit(ProtoPathRelative(rule.path(), base_path), &field_path);
-    if (!status.ok()) return status;
-    return ProtoUtilLite::GetFieldRange(output, field_path, 1,
+    const ProtoPath* field_path;
+    MP_RETURN_IF_ERROR(GetFieldPath(rule_index, base_path, &field_path));
+    return ProtoUtilLite::GetFieldRange(output, *field_path, 1,
                                         GetFieldType(rule), base);
   }
 
   // Replace the field values addressed by a template rule.
   mediapipe::Status ReplaceBaseValue(
-      const std::string& base_path, const TemplateExpression& rule,
+      const std::string& base_path, int rule_index,
       const std::vector<FieldValue>& field_values, FieldValue* output) {
+    const TemplateExpression& rule = rules().Get(rule_index);
     if (!rule.has_path()) {
       *output = field_values[0];
       return ::mediapipe::OkStatus();
     }
-    ProtoPath field_path;
-    RET_CHECK_OK(
-        ProtoPathSplit(ProtoPathRelative(rule.path(), base_path), &field_path));
+    const ProtoPath* split_path;
+    RET_CHECK_OK(GetFieldPath(rule_index, base_path, &split_path));
+    ProtoPath field_path = *split_path;
     int field_count = 1;
     if (rule.has_field_value()) {
       // For a non-repeated field, only one value can be specified.
@@ -271,19 +290,18 @@ class TemplateExpanderImpl {
     FieldValue output = base_message;
 
     // Evaluate the rules nested below base_path in lexical order.
-    std::vector<int> rules = GetNestedRules(base_index, base_path);
+    const std::vector<int>& rules = GetNestedRules(base_index, base_path);
     std::vector<std::vector<FieldValue>> edits;
     for (int i = 0; i < rules.size(); ++i) {
-      const auto& rule = template_rules_.rule().Get(rules[i]);
       std::vector<FieldValue> base;
-      status = GetBaseValue(base_path, rule, output, &base);
+      status = GetBaseValue(base_path, rules[i], output, &base);
       if (!status.ok()) break;
       std::vector<FieldValue> values;
       if (!ExpandTemplateRule(rules[i], base[0], &values)) {
         status = ::mediapipe::InternalError("ExpandTemplateRule failed");
         break;
       }
-      edits.push_back(values);
+      edits.push_back(std::move(values));
     }
     if (!status.ok()) {
       RecordError(status);
@@ -292,25 +310,29 @@ class TemplateExpanderImpl {
     // Replace base field values with the evaluated results.
     // Edits are applied in reverse order since later indices are invalidated.
     for (int i = edits.size() - 1; i >= 0; --i) {
-      const auto& rule = template_rules_.rule().Get(rules[i]);
-      status = ReplaceBaseValue(base_path, rule, edits[i], &output);
+      status = ReplaceBaseValue(base_path, rules[i], edits[i], &output);
       if (!status.ok()) break;
     }
     if (!status.ok()) {
       RecordError(status);
       return false;
     }
-    result->push_back(output);
+    result->push_back(std::move(output));
     return true;
   }
 
   // Returns indexes of the rules directly nested within a certain rule.
-  std::vector<int> GetNestedRules(int rule_index,
-                                  const std::string& rule_path) {
+  const std::vector<int>& GetNestedRules(int rule_index,
+                                         const std::string& rule_path) {
+    auto key = std::make_pair(rule_index, rule_path);
+    auto it = nested_rules_.find(key);
+    if (it != nested_rules_.end()) {
+      return it->second;
+    }
     std::vector<int> result;
     std::string prev_path = "-1[-1]";
-    for (int i = rule_index; i < template_rules_.rule().size(); ++i) {
-      auto& rule = template_rules_.rule().Get(i);
+    for (int i = rule_index; i < rules().size(); ++i) {
+      auto& rule = rules().Get(i);
       if (!ProtoPathStartsWith(rule.path(), rule_path)) {
         break;
       }
@@ -319,7 +341,7 @@ class TemplateExpanderImpl {
         prev_path = rule.path();
       }
     }
-    return result;
+    return nested_rules_.emplace(key, std::move(result)).first->second;
   }
 
   // Apply a "for" operation to a base message.
@@ -327,7 +349,7 @@ class TemplateExpanderImpl {
   bool ExpandIterationRule(int base_index, const FieldValue& base_message,
                            std::vector<FieldValue>* result) {
     // Retrieve the var param and the range expression.
-    const TemplateExpression& rule = template_rules_.rule().Get(base_index);
+    const TemplateExpression& rule = rules().Get(base_index);
     std::string var_param = rule.arg().Get(0).param();
     const TemplateExpression& range_expr = rule.arg().Get(1);
     TemplateArgument range = EvalExpression(range_expr);
@@ -346,7 +368,7 @@ class TemplateExpanderImpl {
   bool ExpandDeclaration(int base_index, const FieldValue& base_message,
                          std::vector<FieldValue>* result) {
     // Retrieve the var param and the range expression.
-    const TemplateExpression& rule = template_rules_.rule().Get(base_index);
+    const TemplateExpression& rule = rules().Get(base_index);
     if (rule.arg().empty() || rule.arg().size() > 2) {
       RecordError(::mediapipe::InvalidArgumentError(
           "Param declaration must specify a parameter name and "
@@ -372,7 +394,7 @@ class TemplateExpanderImpl {
   bool ExpandConditionalRule(int base_index, const FieldValue& base_message,
                              std::vector<FieldValue>* result) {
     // Retrieve the condition expression.
-    const TemplateExpression& rule = template_rules_.rule().Get(base_index);
+    const TemplateExpression& rule = rules().Get(base_index);
     // Expand this template zero or one times.
     bool condition = AsBool(EvalExpression(rule.arg(0)));
     if (condition) {
@@ -383,7 +405,7 @@ class TemplateExpanderImpl {
 
   // A self-contained expression just defines a single result value.
   bool ExpandExpressionRule(int base_index, std::vector<FieldValue>* result) {
-    const TemplateExpression& rule = template_rules_.rule().Get(base_index);
+    const TemplateExpression& rule = rules().Get(base_index);
     TemplateArgument item = EvalExpression(rule);
     std::vector<FieldValue> values;
     mediapipe::Status status = AsFieldValues(
@@ -620,8 +642,15 @@ class TemplateExpanderImpl {
   }
 
  private:
-  // The list of template rules.
-  mediapipe::CalculatorGraphTemplate template_rules_;
+  // The list of template rules, owned by the CalculatorGraphTemplate.
+  const proto_ns::RepeatedPtrField<TemplateExpression>* rules_ = nullptr;
+
+  // The field path of each rule relative to its base path, split once.
+  // Rules nested in a "for" rule are otherwise split on every iteration.
+  std::map<std::pair<int, std::string>, ProtoPath> field_paths_;
+
+  // The rules directly nested within each rule and base path.
+  std::map<std::pair<int, std::string>, std::vector<int>> nested_rules_;
 
   // The template variable environment.
   TemplateDict environment_;
@@ -98,6 +98,21 @@ bool IsAdjacent(const io::Token& t1, const io::Token& t2) {
   return t1.line == t2.line && t1.end_column == t2.column;
 }
 
+// Returns true if two symbols form one of the two-symbol tokens:
+// ">=", "<=", "==", "!=", "&&" or "||".  This is checked for every pair
+// of adjacent tokens, so it does not allocate.
+bool IsDoubleToken(const io::Token& t1, const io::Token& t2) {
+  if (t1.type != io::Tokenizer::TYPE_SYMBOL ||
+      t2.type != io::Tokenizer::TYPE_SYMBOL || t1.text.size() != 1 ||
+      t2.text.size() != 1) {
+    return false;
+  }
+  char c1 = t1.text[0];
+  char c2 = t2.text[0];
+  return (c2 == '=' && (c1 == '>' || c1 == '<' || c1 == '=' || c1 == '!')) ||
+         (c1 == c2 && (c1 == '&' || c1 == '|'));
+}
+
 // A tokenizer with support for a few two-symbol tokens.
 class Tokenizer {
  public:
@@ -119,18 +134,13 @@ class Tokenizer {
 
   // Reads the next token, joining two symbols if needed.
   bool Next() {
-    static auto kDoubleTokens =
-        new std::set<std::string>{">=", "<=", "==", "!=", "&&", "||"};
     current_ = tokenizer_.current();
     tokenizer_.Next();
-    if (IsAdjacent(current_, tokenizer_.current())) {
-      std::string double_token =
-          absl::StrCat(current_.text, tokenizer_.current().text);
-      if (kDoubleTokens->count(double_token) > 0) {
-        current_.text = double_token;
-        current_.end_column = tokenizer_.current().end_column;
-        tokenizer_.Next();
-      }
+    if (IsAdjacent(current_, tokenizer_.current()) &&
+        IsDoubleToken(current_, tokenizer_.current())) {
+      current_.text.append(tokenizer_.current().text);
+      current_.end_column = tokenizer_.current().end_column;
+      tokenizer_.Next();
     }
     return true;
   }
@@ -1331,13 +1341,15 @@ bool IsFunctionOperator(const std::string& token) {
 // GeneratedMessageFactory ("template_rules_"), and a Message produced
 // by the DynamicMessageFactory ("output").  These two Messages have
 // different Descriptors so Message::MergeFrom cannot be applied directly,
-// but they are expected to be equivalent.
+// but they are expected to be equivalent, so they share a wire format.
 ::mediapipe::Status MergeFields(const Message& source, Message* dest) {
-  std::unique_ptr<Message> temp(dest->New());
+  if (source.GetDescriptor() == dest->GetDescriptor()) {
+    dest->MergeFrom(source);
+    return ::mediapipe::OkStatus();
+  }
   std::string temp_str;
-  RET_CHECK(TextFormat::PrintToString(source, &temp_str));
-  RET_CHECK(TextFormat::ParseFromString(temp_str, temp.get()));
-  dest->MergeFrom(*temp);
+  RET_CHECK(source.SerializeToString(&temp_str));
+  RET_CHECK(dest->MergeFromString(temp_str));
   return ::mediapipe::OkStatus();
 }
 
@@ -1416,13 +1428,17 @@ class TemplateParser::Parser::MediaPipeParserImpl
     bool success = TemplateParser::Parser::ParserImpl::Parse(config);
 
     // Copy the template rules into the output template "rule" field.
-    success &= MergeFields(template_rules_, output).ok();
+    success &= MergeFields(*template_rules_, output).ok();
     return success;
   }
 
  protected:
   void EnterField(const FieldDescriptor* field) override {
-    RecordFieldPath(*field, parse_info_tree_->GetLastPath(field));
+    // Most fields have no template rule, so the field path is built only
+    // when the most recent rule still awaits its field.
+    if (HasPendingRule()) {
+      RecordFieldPath(*field, parse_info_tree_->GetLastPath(field));
+    }
   }
 
   // Parse and record a template definition for the current field path.
@@ -1635,14 +1651,23 @@ class TemplateParser::Parser::MediaPipeParserImpl
 
   // Records a template expression for the current field-path.
   TemplateExpression* RecordTemplateRule() {
-    return template_rules_.mutable_rule()->Add();
+    return template_rules_->mutable_rule()->Add();
+  }
+
+  // Returns true if the most recent template rule has no field path yet.
+  bool HasPendingRule() const {
+    if (template_rules_->rule().empty()) {
+      return false;
+    }
+    const TemplateExpression& rule = *template_rules_->rule().rbegin();
+    return !rule.has_path() && rule.op() != "param";
   }
 
   // Records the field path and field type for the rule or rules targeting
   // a certain field.
   void RecordFieldPath(const FieldDescriptor& field, const std::string& path) {
-    for (int i = template_rules_.rule().size() - 1; i >= 0; --i) {
-      auto rule = template_rules_.mutable_rule()->Mutable(i);
+    for (int i = template_rules_->rule().size() - 1; i >= 0; --i) {
+      auto rule = template_rules_->mutable_rule()->Mutable(i);
       if (rule->has_path() || rule->op() == "param") {
         break;
       }
@@ -1652,7 +1677,13 @@ class TemplateParser::Parser::MediaPipeParserImpl
     }
   }
 
-  mediapipe::CalculatorGraphTemplate template_rules_;
+  // The template rules are allocated on an arena, since a template records
+  // many small TemplateExpressions which are discarded once they are copied
+  // into the output.
+  proto_ns::Arena arena_;
+  mediapipe::CalculatorGraphTemplate* template_rules_ =
+      proto_ns::Arena::CreateMessage<mediapipe::CalculatorGraphTemplate>(
+          &arena_);
 };
 
 #undef DO
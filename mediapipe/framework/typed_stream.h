@@ -0,0 +1,170 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Typed stream handles which resolve a tag to a CollectionItemId once, so
+// that Calculator::Process() does no tag lookups.  A calculator declares
+// each stream as a constexpr StreamTag carrying the packet type:
+//
+//   constexpr StreamTag<ImageFrame> kImageTag("IMAGE");
+//   constexpr StreamTag<std::vector<Detection>> kDetectionsTag("DETECTIONS");
+//
+//   ::mediapipe::Status GetContract(CalculatorContract* cc) {
+//     kImageTag.SetType(&cc->Inputs());
+//     kDetectionsTag.SetType(&cc->Outputs());
+//     return ::mediapipe::OkStatus();
+//   }
+//
+//   ::mediapipe::Status Open(CalculatorContext* cc) {
+//     image_ = TypedInput<ImageFrame>(kImageTag, cc->Inputs());
+//     detections_ = TypedOutput<std::vector<Detection>>(kDetectionsTag,
+//                                                       cc->Outputs());
+//     return ::mediapipe::OkStatus();
+//   }
+//
+//   ::mediapipe::Status Process(CalculatorContext* cc) {
+//     if (image_.IsEmpty(cc)) return ::mediapipe::OkStatus();
+//     const ImageFrame& image = image_.Get(cc);
+//     ...
+//     detections_.Add(cc, std::move(detections), cc->InputTimestamp());
+//   }
+//
+// The ids are valid for every CalculatorContext of the node, since all of
+// them share the node's tool::TagMap.  Reading or writing a packet of the
+// wrong type through a handle is a compile error.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TYPED_STREAM_H_
+#define MEDIAPIPE_FRAMEWORK_TYPED_STREAM_H_
+
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/collection_item_id.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// The tag and index of a calculator stream, together with its packet type.
+template <typename T>
+class StreamTag {
+ public:
+  using PayloadType = T;
+
+  constexpr explicit StreamTag(const char* tag, int index = 0)
+      : tag_(tag), index_(index) {}
+
+  constexpr const char* tag() const { return tag_; }
+  constexpr int index() const { return index_; }
+
+  // Returns true if the node connects this stream.
+  template <typename CollectionT>
+  bool IsPresent(const CollectionT& collection) const {
+    return collection.GetId(tag_, index_).IsValid();
+  }
+
+  // Declares the stream with packet type T in a CalculatorContract.  If the
+  // node does not connect the stream, the contract fails validation.
+  void SetType(PacketTypeSet* types) const {
+    types->Get(tag_, index_).template Set<T>();
+  }
+
+  // Declares the stream with packet type T if the node connects it.
+  void SetTypeIfPresent(PacketTypeSet* types) const {
+    if (IsPresent(*types)) {
+      SetType(types);
+    }
+  }
+
+ private:
+  const char* tag_;
+  int index_;
+};
+
+// A resolved input stream of type T.  A default constructed TypedInput, or
+// one resolved from a stream the node does not connect, is not connected.
+template <typename T>
+class TypedInput {
+ public:
+  TypedInput() = default;
+  TypedInput(const StreamTag<T>& tag, const InputStreamShardSet& inputs)
+      : id_(inputs.GetId(tag.tag(), tag.index())) {}
+
+  bool IsConnected() const { return id_.IsValid(); }
+
+  // Returns the input stream in the given context.  Requires IsConnected().
+  const InputStream& Stream(const CalculatorContext* cc) const {
+    return cc->Inputs().Get(id_);
+  }
+
+  // Returns true if the stream is unconnected or has no packet at the
+  // current input timestamp.
+  bool IsEmpty(const CalculatorContext* cc) const {
+    return !IsConnected() || Stream(cc).IsEmpty();
+  }
+
+  const Packet& Value(const CalculatorContext* cc) const {
+    return Stream(cc).Value();
+  }
+
+  const T& Get(const CalculatorContext* cc) const {
+    return Stream(cc).template Get<T>();
+  }
+
+ private:
+  CollectionItemId id_;
+};
+
+// A resolved output stream of type T.
+template <typename T>
+class TypedOutput {
+ public:
+  TypedOutput() = default;
+  TypedOutput(const StreamTag<T>& tag, const OutputStreamShardSet& outputs)
+      : id_(outputs.GetId(tag.tag(), tag.index())) {}
+
+  bool IsConnected() const { return id_.IsValid(); }
+
+  // Returns the output stream in the given context.  Requires IsConnected().
+  OutputStream& Stream(CalculatorContext* cc) const {
+    return cc->Outputs().Get(id_);
+  }
+
+  void Add(CalculatorContext* cc, std::unique_ptr<T> value,
+           Timestamp timestamp) const {
+    Stream(cc).Add(value.release(), timestamp);
+  }
+
+  void Add(CalculatorContext* cc, T value, Timestamp timestamp) const {
+    Stream(cc).AddPacket(MakePacket<T>(std::move(value)).At(timestamp));
+  }
+
+  // Adds a packet, which must hold a T.  The type is checked when the
+  // packet is added to the stream, not at compile time.
+  void AddPacket(CalculatorContext* cc, Packet packet) const {
+    Stream(cc).AddPacket(std::move(packet));
+  }
+
+  void SetNextTimestampBound(CalculatorContext* cc, Timestamp bound) const {
+    Stream(cc).SetNextTimestampBound(bound);
+  }
+
+ private:
+  CollectionItemId id_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TYPED_STREAM_H_
@@ -0,0 +1,145 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/typed_stream.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr StreamTag<int> kValueTag("VALUE");
+constexpr StreamTag<int> kOffsetTag("OFFSET");
+constexpr StreamTag<std::string> kSumTag("SUM");
+constexpr StreamTag<int> kSumValueTag("SUM_VALUE");
+
+// Outputs VALUE + OFFSET, both as a string on SUM and as an int on
+// SUM_VALUE.  OFFSET and SUM_VALUE are optional.
+class TypedAdderCalculator : public CalculatorBase {
+ public:
+  static ::mediapipe::Status GetContract(CalculatorContract* cc) {
+    kValueTag.SetType(&cc->Inputs());
+    kOffsetTag.SetTypeIfPresent(&cc->Inputs());
+    kSumTag.SetType(&cc->Outputs());
+    kSumValueTag.SetTypeIfPresent(&cc->Outputs());
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Open(CalculatorContext* cc) final {
+    value_ = TypedInput<int>(kValueTag, cc->Inputs());
+    offset_ = TypedInput<int>(kOffsetTag, cc->Inputs());
+    sum_ = TypedOutput<std::string>(kSumTag, cc->Outputs());
+    sum_value_ = TypedOutput<int>(kSumValueTag, cc->Outputs());
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::Status Process(CalculatorContext* cc) final {
+    if (value_.IsEmpty(cc)) {
+      return ::mediapipe::OkStatus();
+    }
+    int sum = value_.Get(cc) + (offset_.IsEmpty(cc) ? 0 : offset_.Get(cc));
+    sum_.Add(cc, absl::make_unique<std::string>(std::to_string(sum)),
+             cc->InputTimestamp());
+    if (sum_value_.IsConnected()) {
+      sum_value_.Add(cc, sum, cc->InputTimestamp());
+    }
+    return ::mediapipe::OkStatus();
+  }
+
+ private:
+  TypedInput<int> value_;
+  TypedInput<int> offset_;
+  TypedOutput<std::string> sum_;
+  TypedOutput<int> sum_value_;
+};
+REGISTER_CALCULATOR(TypedAdderCalculator);
+
+TEST(TypedStreamTest, ResolvesConnectedStreams) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "TypedAdderCalculator"
+    input_stream: "VALUE:value"
+    input_stream: "OFFSET:offset"
+    output_stream: "SUM:sum"
+    output_stream: "SUM_VALUE:sum_value"
+  )"));
+  runner.MutableInputs()->Tag("VALUE").packets.push_back(
+      MakePacket<int>(1).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("OFFSET").packets.push_back(
+      MakePacket<int>(10).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("VALUE").packets.push_back(
+      MakePacket<int>(2).At(Timestamp(1)));
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& sums = runner.Outputs().Tag("SUM").packets;
+  ASSERT_EQ(2, sums.size());
+  EXPECT_EQ("11", sums[0].Get<std::string>());
+  EXPECT_EQ("2", sums[1].Get<std::string>());
+  const std::vector<Packet>& sum_values =
+      runner.Outputs().Tag("SUM_VALUE").packets;
+  ASSERT_EQ(2, sum_values.size());
+  EXPECT_EQ(11, sum_values[0].Get<int>());
+  EXPECT_EQ(Timestamp(1), sum_values[1].Timestamp());
+}
+
+TEST(TypedStreamTest, SkipsUnconnectedStreams) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "TypedAdderCalculator"
+    input_stream: "VALUE:value"
+    output_stream: "SUM:sum"
+  )"));
+  runner.MutableInputs()->Tag("VALUE").packets.push_back(
+      MakePacket<int>(5).At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& sums = runner.Outputs().Tag("SUM").packets;
+  ASSERT_EQ(1, sums.size());
+  EXPECT_EQ("5", sums[0].Get<std::string>());
+}
+
+TEST(TypedStreamTest, RejectsMissingRequiredStream) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"(
+    calculator: "TypedAdderCalculator"
+    input_stream: "OFFSET:offset"
+    output_stream: "SUM:sum"
+  )"));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+TEST(TypedStreamTest, RejectsMismatchedPacketType) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "value"
+        node {
+          calculator: "TypedAdderCalculator"
+          input_stream: "VALUE:value"
+          output_stream: "SUM:sum"
+        }
+        node {
+          calculator: "TypedAdderCalculator"
+          input_stream: "VALUE:sum"
+          output_stream: "SUM:unused"
+        }
+      )");
+  CalculatorGraph graph;
+  EXPECT_FALSE(graph.Initialize(config).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -246,6 +246,19 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
                << "\" has more than one InputStreamInfo.";
       }
       id_used[id.value()] = true;
+      if (input_stream_info.drop_policy() == InputStreamInfo::DROP_OLDEST &&
+          input_stream_info.max_queued_packets() <= 0) {
+        return ::mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "Input stream with tag_index \""
+               << input_stream_info.tag_index()
+               << "\" uses DROP_OLDEST without a positive max_queued_packets.";
+      }
+      if (input_stream_info.max_packet_age_usec() < 0) {
+        return ::mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "Input stream with tag_index \""
+               << input_stream_info.tag_index()
+               << "\" has a negative max_packet_age_usec.";
+      }
     }
   }
 
@@ -383,7 +396,28 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
 
   MP_RETURN_IF_ERROR(
       PerformBasicTransforms(input_config, graph_registry, &config_));
+  return InitializeFromCanonicalConfig(/*from_bundle=*/false);
+}
+
+// static
+constexpr int ValidatedGraphConfig::kGraphBundleVersion;
+
+::mediapipe::Status ValidatedGraphConfig::Initialize(
+    const GraphBundle& bundle) {
+  RET_CHECK(!initialized_)
+      << "ValidatedGraphConfig can be initialized only once.";
+  if (bundle.version() != kGraphBundleVersion) {
+    return ::mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "GraphBundle version " << bundle.version()
+           << " is not supported, expected version " << kGraphBundleVersion
+           << ".  Regenerate the bundle.";
+  }
+  config_ = bundle.config();
+  return InitializeFromCanonicalConfig(/*from_bundle=*/true);
+}
 
+::mediapipe::Status ValidatedGraphConfig::InitializeFromCanonicalConfig(
+    bool from_bundle) {
   // Initialize the basic node information.
   MP_RETURN_IF_ERROR(InitializeGeneratorInfo());
   MP_RETURN_IF_ERROR(InitializeCalculatorInfo());
@@ -406,27 +440,33 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
     sorted_nodes_.push_back(node_type_info);
   }
 
-  // Initialize the side packet information.
-  bool need_sorting = false;
-  MP_RETURN_IF_ERROR(InitializeSidePacketInfo(&need_sorting));
-  // Initialize the stream information.
-  MP_RETURN_IF_ERROR(InitializeStreamInfo(&need_sorting));
-  if (need_sorting) {
-    MP_RETURN_IF_ERROR(TopologicalSortNodes());
-
-    // Clear the information from the unsorted analysis.
-    side_packet_to_producer_.clear();
-    required_side_packets_.clear();
-    input_side_packets_.clear();
-    output_side_packets_.clear();
-    stream_to_producer_.clear();
-    input_streams_.clear();
-    output_streams_.clear();
-    owned_packet_types_.clear();
-
-    // Recompute on sorted graph.
+  if (from_bundle) {
+    // A bundle is sorted when it is created, so a single pass suffices.
     MP_RETURN_IF_ERROR(InitializeSidePacketInfo(nullptr));
     MP_RETURN_IF_ERROR(InitializeStreamInfo(nullptr));
+  } else {
+    // Initialize the side packet information.
+    bool need_sorting = false;
+    MP_RETURN_IF_ERROR(InitializeSidePacketInfo(&need_sorting));
+    // Initialize the stream information.
+    MP_RETURN_IF_ERROR(InitializeStreamInfo(&need_sorting));
+    if (need_sorting) {
+      MP_RETURN_IF_ERROR(TopologicalSortNodes());
+
+      // Clear the information from the unsorted analysis.
+      side_packet_to_producer_.clear();
+      required_side_packets_.clear();
+      input_side_packets_.clear();
+      output_side_packets_.clear();
+      stream_to_producer_.clear();
+      input_streams_.clear();
+      output_streams_.clear();
+      owned_packet_types_.clear();
+
+      // Recompute on sorted graph.
+      MP_RETURN_IF_ERROR(InitializeSidePacketInfo(nullptr));
+      MP_RETURN_IF_ERROR(InitializeStreamInfo(nullptr));
+    }
   }
 
   // Fill in all the upstream fields now that we are assured of having
@@ -439,7 +479,9 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
   MP_RETURN_IF_ERROR(
       ResolveAnyTypes(&input_side_packets_, &output_side_packets_));
 
-  // Validate consistency of side packets and streams.
+  // Validate consistency of side packets and streams.  These checks are
+  // repeated for a bundle, since the registered calculators may have changed
+  // since the bundle was created.
   MP_RETURN_IF_ERROR(ValidateSidePacketTypes());
   MP_RETURN_IF_ERROR(ValidateStreamTypes());
 
@@ -672,20 +714,19 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
   node_type_info->SetInputStreamBaseIndex(input_streams_.size());
   const int node_index = node_type_info->Node().index;
   const PacketTypeSet& input_stream_types = node_type_info->InputStreamTypes();
-  std::vector<bool> is_back_edge;  // Indexed by CollectionItemId.
+  // Indexed by CollectionItemId.
+  std::vector<const InputStreamInfo*> input_stream_infos;
   if (!config_.node(node_index).input_stream_info().empty()) {
-    is_back_edge.resize(input_stream_types.NumEntries(), false);
+    input_stream_infos.resize(input_stream_types.NumEntries(), nullptr);
     for (const auto& input_stream_info :
          config_.node(node_index).input_stream_info()) {
-      if (input_stream_info.back_edge()) {
-        std::string tag;
-        int index;
-        MP_RETURN_IF_ERROR(
-            tool::ParseTagIndex(input_stream_info.tag_index(), &tag, &index));
-        CollectionItemId id = input_stream_types.GetId(tag, index);
-        RET_CHECK(id.IsValid());
-        is_back_edge[id.value()] = true;
-      }
+      std::string tag;
+      int index;
+      MP_RETURN_IF_ERROR(
+          tool::ParseTagIndex(input_stream_info.tag_index(), &tag, &index));
+      CollectionItemId id = input_stream_types.GetId(tag, index);
+      RET_CHECK(id.IsValid());
+      input_stream_infos[id.value()] = &input_stream_info;
     }
   }
 
@@ -694,7 +735,23 @@ std::string NodeTypeInfo::NodeTypeToString(NodeType node_type) {
     const std::string& name = tag_map.Names()[id.value()];
     input_streams_.emplace_back();
     auto& edge_info = input_streams_.back();
-    edge_info.back_edge = !is_back_edge.empty() && is_back_edge[id.value()];
+    const InputStreamInfo* input_stream_info =
+        input_stream_infos.empty() ? nullptr : input_stream_infos[id.value()];
+    if (input_stream_info) {
+      edge_info.back_edge = input_stream_info->back_edge();
+      switch (input_stream_info->drop_policy()) {
+        case InputStreamInfo::KEEP_LATEST:
+          edge_info.max_queued_packets = 1;
+          break;
+        case InputStreamInfo::DROP_OLDEST:
+          edge_info.max_queued_packets =
+              input_stream_info->max_queued_packets();
+          break;
+        default:
+          break;
+      }
+      edge_info.max_packet_age_usec = input_stream_info->max_packet_age_usec();
+    }
 
     auto iter = stream_to_producer_.find(name);
     if (iter != stream_to_producer_.end()) {
@@ -1152,4 +1209,14 @@ ValidatedGraphConfig::RegisteredStreamTypeName(const std::string& name) {
             "determinable, or the type may be defined but not registered.";
 }
 
+::mediapipe::Status CreateGraphBundle(const CalculatorGraphConfig& config,
+                                      GraphBundle* bundle) {
+  ValidatedGraphConfig validated_graph;
+  MP_RETURN_IF_ERROR(validated_graph.Initialize(config));
+  bundle->Clear();
+  bundle->set_version(ValidatedGraphConfig::kGraphBundleVersion);
+  *bundle->mutable_config() = validated_graph.Config();
+  return ::mediapipe::OkStatus();
+}
+
 }  // namespace mediapipe
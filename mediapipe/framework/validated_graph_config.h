@@ -21,8 +21,10 @@
 
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_contract.h"
+#include "mediapipe/framework/graph_bundle.pb.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
@@ -230,6 +232,10 @@ struct EdgeInfo {
   std::string name;
   PacketType* packet_type = nullptr;
   bool back_edge = false;  // Only applicable to input streams.
+  // The drop policy of an input stream, see InputStreamInfo.  -1 and 0 mean
+  // that no packets are dropped.  Only applicable to input streams.
+  int max_queued_packets = -1;
+  int64 max_packet_age_usec = 0;
 };
 
 // This class is used to validate and canonicalize a CalculatorGraphConfig.
@@ -262,6 +268,17 @@ class ValidatedGraphConfig {
       const std::string& graph_type = "",
       const Subgraph::SubgraphOptions* arguments = nullptr);
 
+  // Initializes the ValidatedGraphConfig from a GraphBundle produced by
+  // CreateGraphBundle.  The bundled config is already canonical, so subgraph
+  // expansion and topological sorting are skipped.  The calculator contracts
+  // are still gathered and the stream, side packet and executor checks are
+  // still made, so that a bundle which no longer matches the registered
+  // calculators is rejected here rather than when packets are accessed.
+  ::mediapipe::Status Initialize(const GraphBundle& bundle);
+
+  // The GraphBundle format version written by CreateGraphBundle.
+  static constexpr int kGraphBundleVersion = 1;
+
   // Returns true if the ValidatedGraphConfig has been initialized.
   bool Initialized() const { return initialized_; }
 
@@ -337,6 +354,11 @@ class ValidatedGraphConfig {
   static bool IsReservedExecutorName(const std::string& name);
 
  private:
+  // Analyzes config_, which must already have had the basic transforms
+  // applied.  If |from_bundle| is true, config_ must also be sorted, and
+  // topological sorting is skipped.
+  ::mediapipe::Status InitializeFromCanonicalConfig(bool from_bundle);
+
   // Initialize the PacketGenerator information.
   ::mediapipe::Status InitializeGeneratorInfo();
   // Initialize the Calculator information.
@@ -477,6 +499,13 @@ template <typename T>
   return ::mediapipe::OkStatus();
 }
 
+// Expands and validates |config|, with subgraphs taken from the global graph
+// registry, and stores the canonical result in |bundle|.  The bundle can be
+// loaded with ValidatedGraphConfig::Initialize(const GraphBundle&) by any
+// binary which registers the same calculators.
+::mediapipe::Status CreateGraphBundle(const CalculatorGraphConfig& config,
+                                      GraphBundle* bundle);
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_VALIDATED_GRAPH_CONFIG_H_
@@ -0,0 +1,50 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/util/parallel_rows.h"
+
+#include <algorithm>
+
+#include "absl/synchronization/blocking_counter.h"
+
+namespace mediapipe {
+
+void ParallelForRowBands(int num_rows, int num_bands, ThreadPool* pool,
+                         const std::function<void(int, int)>& fn) {
+  num_bands = std::max(1, std::min(num_bands, num_rows));
+  if (!pool || num_bands == 1) {
+    if (num_rows > 0) {
+      fn(0, num_rows);
+    }
+    return;
+  }
+  // The first num_rows % num_bands bands have one extra row.
+  const int band_rows = num_rows / num_bands;
+  const int extra_rows = num_rows % num_bands;
+  auto band_start = [band_rows, extra_rows](int band) {
+    return band * band_rows + std::min(band, extra_rows);
+  };
+  absl::BlockingCounter counter(num_bands - 1);
+  for (int band = 1; band < num_bands; ++band) {
+    const int first_row = band_start(band);
+    const int end_row = band_start(band + 1);
+    pool->Schedule([&fn, &counter, first_row, end_row]() {
+      fn(first_row, end_row);
+      counter.DecrementCount();
+    });
+  }
+  fn(0, band_start(1));
+  counter.Wait();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,33 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_UTIL_PARALLEL_ROWS_H_
+#define MEDIAPIPE_UTIL_PARALLEL_ROWS_H_
+
+#include <functional>
+
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Splits the rows [0, num_rows) of an image into at most "num_bands" bands
+// of consecutive rows, and calls "fn(first_row, end_row)" once for each band.
+// The bands are run concurrently on "pool", except the first band, which is
+// run on the calling thread.  Returns after all bands have completed.  If
+// "pool" is null, all bands are run on the calling thread.
+void ParallelForRowBands(int num_rows, int num_bands, ThreadPool* pool,
+                         const std::function<void(int, int)>& fn);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_PARALLEL_ROWS_H_
@@ -0,0 +1,69 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/resource_mapping.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/resource_util.h"
+
+namespace mediapipe {
+
+MappedResource::~MappedResource() {
+  if (address_) {
+    munmap(address_, size_);
+  }
+}
+
+::mediapipe::StatusOr<std::shared_ptr<const MappedResource>> MapResource(
+    const std::string& path) {
+  ASSIGN_OR_RETURN(std::string file_path, PathToResourceAsFile(path));
+  const int fd = open(file_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return ::mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't open file: " << file_path << ": " << strerror(errno);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    const int error = errno;
+    close(fd);
+    return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't stat file: " << file_path << ": " << strerror(error);
+  }
+  const size_t size = file_stat.st_size;
+  void* address = nullptr;
+  // An empty mapping is invalid, so an empty file is left unmapped.
+  if (size > 0) {
+    address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  const int error = errno;
+  // The mapping remains valid after the file is closed.
+  close(fd);
+  if (address == MAP_FAILED) {
+    return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Can't map file: " << file_path << ": " << strerror(error);
+  }
+  return std::shared_ptr<const MappedResource>(
+      new MappedResource(address, size));
+}
+
+}  // namespace mediapipe
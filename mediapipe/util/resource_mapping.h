@@ -0,0 +1,61 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_RESOURCE_MAPPING_H_
+#define MEDIAPIPE_UTIL_RESOURCE_MAPPING_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// The read-only contents of a resource, mapped into memory.  The pages are
+// read from the file on first access and shared with every other mapping of
+// the file, instead of being copied to the heap as by GetResourceContents.
+// The contents are unmapped when the MappedResource is destroyed, so users
+// of data() must hold a reference to it.
+class MappedResource {
+ public:
+  ~MappedResource();
+  MappedResource(const MappedResource&) = delete;
+  MappedResource& operator=(const MappedResource&) = delete;
+
+  const char* data() const { return static_cast<const char*>(address_); }
+  size_t size() const { return size_; }
+  absl::string_view contents() const { return {data(), size_}; }
+
+ private:
+  friend ::mediapipe::StatusOr<std::shared_ptr<const MappedResource>>
+  MapResource(const std::string& path);
+
+  MappedResource(void* address, size_t size)
+      : address_(address), size_(size) {}
+
+  // The start of the mapping, or nullptr for an empty resource.
+  void* address_;
+  size_t size_;
+};
+
+// Maps the entire contents of a resource into memory.  The search path is as
+// in PathToResourceAsFile.
+::mediapipe::StatusOr<std::shared_ptr<const MappedResource>> MapResource(
+    const std::string& path);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_RESOURCE_MAPPING_H_
@@ -0,0 +1,62 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/resource_mapping.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ResourceMappingTest, MapsFileContents) {
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/resource_mapping_contents");
+  const std::string contents(10000, 'x');
+  MP_ASSERT_OK(file::SetContents(path, contents));
+
+  auto status_or_resource = MapResource(path);
+  MP_ASSERT_OK(status_or_resource.status());
+  std::shared_ptr<const MappedResource> resource =
+      std::move(status_or_resource).ValueOrDie();
+  EXPECT_EQ(contents.size(), resource->size());
+  EXPECT_EQ(contents, resource->contents());
+}
+
+TEST(ResourceMappingTest, MapsEmptyFile) {
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/resource_mapping_empty");
+  MP_ASSERT_OK(file::SetContents(path, ""));
+
+  auto status_or_resource = MapResource(path);
+  MP_ASSERT_OK(status_or_resource.status());
+  EXPECT_EQ(0, status_or_resource.ValueOrDie()->size());
+  EXPECT_TRUE(status_or_resource.ValueOrDie()->contents().empty());
+}
+
+TEST(ResourceMappingTest, FailsForMissingFile) {
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/resource_mapping_missing");
+  EXPECT_FALSE(MapResource(path).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
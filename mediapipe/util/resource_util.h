@@ -43,7 +43,8 @@ namespace mediapipe {
     const std::string& path);
 
 // Reads the entire contents of a resource. The search path is as in
-// PathToResourceAsFile.
+// PathToResourceAsFile. Large resources, such as models, can instead be
+// mapped into memory with MapResource in resource_mapping.h.
 ::mediapipe::Status GetResourceContents(const std::string& path,
                                         std::string* output);
 
@@ -0,0 +1,410 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/shared_memory_ring.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_builder.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr uint32 kMagic = 0x4d505352;  // "MPSR"
+constexpr uint32 kVersion = 2;
+constexpr int64 kAlignment = 64;
+
+// The states of a slot.
+enum SlotState : uint32 {
+  kSlotFree = 0,
+  kSlotWritten = 1,
+  kSlotReading = 2,
+};
+
+// How long to sleep between polls of the ring.
+constexpr absl::Duration kPollInterval = absl::Microseconds(50);
+
+// How long to wait for another process to initialize the segment.
+constexpr absl::Duration kAttachTimeout = absl::Seconds(10);
+
+// How often a waiting side checks that the other side is still alive.
+constexpr absl::Duration kPeerCheckInterval = absl::Milliseconds(10);
+
+// How often a stale segment is replaced before giving up.
+constexpr int kMaxStaleSegments = 3;
+
+// The process id recorded for a side which has not attached yet, and for a
+// side which has detached.
+constexpr int32 kNotAttached = 0;
+constexpr int32 kDetached = -1;
+
+// Returns true if "pid" is the id of a process which has exited.
+bool ProcessExited(int32 pid) {
+  return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+int64 RoundUp(int64 size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "The ring requires lock-free atomics to work across processes.");
+
+}  // namespace
+
+constexpr int SharedMemoryRing::kMaxTypeNameSize;
+
+struct alignas(kAlignment) SharedMemoryRing::SegmentHeader {
+  // Set last by the process which creates the segment.
+  std::atomic<uint32> magic;
+  uint32 version;
+  int32 num_slots;
+  int64 slot_size;
+  std::atomic<uint32> writer_closed;
+  // The process id of each side, or kNotAttached or kDetached.
+  std::atomic<int32> writer_pid;
+  std::atomic<int32> reader_pid;
+};
+
+struct alignas(kAlignment) SharedMemoryRing::SlotHeader {
+  std::atomic<uint32> state;
+  int32 type_name_size;
+  int64 timestamp;
+  int64 size;
+  char type_name[kMaxTypeNameSize];
+};
+
+SharedMemoryRing::SharedMemoryRing(const std::string& name, Role role,
+                                   int num_slots, int64 slot_size)
+    : name_(name),
+      role_(role),
+      num_slots_(num_slots),
+      slot_size_(RoundUp(slot_size)) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+  if (base_) {
+    SegmentHeader* header = segment_header();
+    int32 peer_pid;
+    if (role_ == kWriter) {
+      // A reader must not wait for a writer which is gone.
+      header->writer_closed.store(1, std::memory_order_release);
+      header->writer_pid.store(kDetached, std::memory_order_release);
+      peer_pid = header->reader_pid.load(std::memory_order_acquire);
+    } else {
+      header->reader_pid.store(kDetached, std::memory_order_release);
+      peer_pid = header->writer_pid.load(std::memory_order_acquire);
+    }
+    // The reader removes the segment once it is done with it.  The writer
+    // only removes it if the reader exited without doing so.
+    if (role_ == kReader || ProcessExited(peer_pid)) {
+      shm_unlink(name_.c_str());
+    }
+  }
+  Unmap();
+}
+
+::mediapipe::StatusOr<std::shared_ptr<SharedMemoryRing>> SharedMemoryRing::Open(
+    const std::string& name, Role role, int num_slots, int64 slot_size) {
+  RET_CHECK(!name.empty() && name[0] == '/')
+      << "Shared memory segment names must start with '/': " << name;
+  RET_CHECK_GT(num_slots, 0);
+  RET_CHECK_GT(slot_size, 0);
+  std::shared_ptr<SharedMemoryRing> ring(
+      new SharedMemoryRing(name, role, num_slots, slot_size));
+  MP_RETURN_IF_ERROR(ring->Map());
+  return ring;
+}
+
+::mediapipe::Status SharedMemoryRing::Map() {
+  for (int i = 0; i < kMaxStaleSegments; ++i) {
+    bool stale = false;
+    MP_RETURN_IF_ERROR(MapSegment(&stale));
+    if (!stale) {
+      return ::mediapipe::OkStatus();
+    }
+    LOG(WARNING) << "Replacing stale shared memory segment " << name_;
+    Unmap();
+    shm_unlink(name_.c_str());
+  }
+  return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+         << "Shared memory segment " << name_
+         << " was replaced repeatedly while attaching to it.";
+}
+
+void SharedMemoryRing::Unmap() {
+  if (base_) {
+    munmap(base_, mapped_size_);
+    base_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+::mediapipe::Status SharedMemoryRing::MapSegment(bool* stale) {
+  const int64 slot_headers_offset = RoundUp(sizeof(SegmentHeader));
+  const int64 data_offset =
+      slot_headers_offset + RoundUp(num_slots_ * sizeof(SlotHeader));
+  mapped_size_ = data_offset + num_slots_ * slot_size_;
+
+  bool created = false;
+  const absl::Time deadline = absl::Now() + kAttachTimeout;
+  while (fd_ < 0) {
+    fd_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ >= 0) {
+      created = true;
+    } else if (errno == EEXIST) {
+      // Another process created the segment.  It may be removed again
+      // before it is opened here, in which case creation is retried.
+      fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+      RET_CHECK(fd_ >= 0 || errno == ENOENT)
+          << "Cannot open shared memory segment " << name_ << ": "
+          << strerror(errno);
+    } else {
+      return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Cannot create shared memory segment " << name_ << ": "
+             << strerror(errno);
+    }
+  }
+
+  if (created) {
+    if (ftruncate(fd_, mapped_size_) != 0) {
+      const int error = errno;
+      shm_unlink(name_.c_str());
+      return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+             << "Cannot resize shared memory segment " << name_ << ": "
+             << strerror(error);
+    }
+  } else {
+    // Waits for the creator to resize the segment.
+    struct stat status;
+    do {
+      RET_CHECK_EQ(0, fstat(fd_, &status));
+      if (status.st_size != 0) break;
+      RET_CHECK(absl::Now() < deadline)
+          << "Timed out waiting for shared memory segment " << name_;
+      absl::SleepFor(kPollInterval);
+    } while (true);
+    RET_CHECK_EQ(status.st_size, mapped_size_)
+        << "Shared memory segment " << name_
+        << " was created with a different number of slots or slot size.";
+  }
+
+  void* base = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd_, 0);
+  if (base == MAP_FAILED) {
+    const int error = errno;
+    if (created) {
+      shm_unlink(name_.c_str());
+    }
+    return ::mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Cannot map shared memory segment " << name_ << ": "
+           << strerror(error);
+  }
+  base_ = static_cast<uint8*>(base);
+
+  SegmentHeader* header = segment_header();
+  if (created) {
+    new (header) SegmentHeader();
+    header->version = kVersion;
+    header->num_slots = num_slots_;
+    header->slot_size = slot_size_;
+    header->writer_closed.store(0, std::memory_order_relaxed);
+    header->writer_pid.store(kNotAttached, std::memory_order_relaxed);
+    header->reader_pid.store(kNotAttached, std::memory_order_relaxed);
+    for (int i = 0; i < num_slots_; ++i) {
+      new (slot_header(i)) SlotHeader();
+      slot_header(i)->state.store(kSlotFree, std::memory_order_relaxed);
+    }
+    header->magic.store(kMagic, std::memory_order_release);
+  } else {
+    while (header->magic.load(std::memory_order_acquire) != kMagic) {
+      RET_CHECK(absl::Now() < deadline)
+          << "Timed out waiting for shared memory segment " << name_;
+      absl::SleepFor(kPollInterval);
+    }
+    if (header->version != kVersion) {
+      // Left over by a process using another version of the ring.
+      *stale = true;
+      return ::mediapipe::OkStatus();
+    }
+    RET_CHECK(header->num_slots == num_slots_ &&
+              header->slot_size == slot_size_)
+        << "Shared memory segment " << name_
+        << " was created with a different number of slots or slot size.";
+  }
+
+  // Registers this side.  A side which was used before belongs to a
+  // previous run, whose data must not be read or overwritten.
+  std::atomic<int32>& own_pid =
+      role_ == kWriter ? header->writer_pid : header->reader_pid;
+  const std::atomic<int32>& peer_pid =
+      role_ == kWriter ? header->reader_pid : header->writer_pid;
+  int32 previous_pid = kNotAttached;
+  if (!own_pid.compare_exchange_strong(previous_pid, getpid(),
+                                       std::memory_order_acq_rel)) {
+    if (previous_pid > 0 && !ProcessExited(previous_pid)) {
+      Unmap();
+      return ::mediapipe::AlreadyExistsErrorBuilder(MEDIAPIPE_LOC)
+             << "Shared memory segment " << name_ << " already has a "
+             << (role_ == kWriter ? "writer" : "reader") << ", process "
+             << previous_pid;
+    }
+    *stale = true;
+  } else if (ProcessExited(peer_pid.load(std::memory_order_acquire))) {
+    *stale = true;
+  }
+  return ::mediapipe::OkStatus();
+}
+
+SharedMemoryRing::SegmentHeader* SharedMemoryRing::segment_header() const {
+  return reinterpret_cast<SegmentHeader*>(base_);
+}
+
+SharedMemoryRing::SlotHeader* SharedMemoryRing::slot_header(int slot) const {
+  return reinterpret_cast<SlotHeader*>(base_ +
+                                       RoundUp(sizeof(SegmentHeader))) +
+         slot;
+}
+
+uint8* SharedMemoryRing::slot_data(int slot) const {
+  return base_ + RoundUp(sizeof(SegmentHeader)) +
+         RoundUp(num_slots_ * sizeof(SlotHeader)) + slot * slot_size_;
+}
+
+::mediapipe::Status SharedMemoryRing::CheckPeer() const {
+  const SegmentHeader* header = segment_header();
+  const std::atomic<int32>& peer =
+      role_ == kWriter ? header->reader_pid : header->writer_pid;
+  const int32 peer_pid = peer.load(std::memory_order_acquire);
+  if (peer_pid == kDetached && role_ == kWriter) {
+    return ::mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
+           << "The reader of shared memory segment " << name_
+           << " has detached.";
+  }
+  if (ProcessExited(peer_pid)) {
+    return ::mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
+           << "The " << (role_ == kWriter ? "reader" : "writer")
+           << " of shared memory segment " << name_ << ", process "
+           << peer_pid << ", has exited.";
+  }
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::StatusOr<int> SharedMemoryRing::AcquireWriteSlot(
+    absl::Duration timeout) {
+  RET_CHECK_EQ(role_, kWriter) << "The ring is used for reading.";
+  const int slot = write_count_ % num_slots_;
+  const absl::Time start = absl::Now();
+  absl::Time next_peer_check = start;
+  while (slot_header(slot)->state.load(std::memory_order_acquire) !=
+         kSlotFree) {
+    const absl::Time now = absl::Now();
+    if (now >= next_peer_check) {
+      MP_RETURN_IF_ERROR(CheckPeer());
+      next_peer_check = now + kPeerCheckInterval;
+    }
+    if (now - start >= timeout) {
+      return ::mediapipe::StatusBuilder(
+                 ::mediapipe::StatusCode::kDeadlineExceeded, MEDIAPIPE_LOC)
+             << "Timed out waiting for the reader of shared memory segment "
+             << name_ << " to release a slot.";
+    }
+    absl::SleepFor(kPollInterval);
+  }
+  return slot;
+}
+
+::mediapipe::Status SharedMemoryRing::CommitWriteSlot(
+    int slot, const std::string& type_name, int64 timestamp, int64 size) {
+  RET_CHECK_EQ(slot, write_count_ % num_slots_);
+  RET_CHECK_LE(size, slot_size_);
+  RET_CHECK_LE(type_name.size(), kMaxTypeNameSize)
+      << "Type name too long: " << type_name;
+  SlotHeader* header = slot_header(slot);
+  header->type_name_size = type_name.size();
+  memcpy(header->type_name, type_name.data(), type_name.size());
+  header->timestamp = timestamp;
+  header->size = size;
+  header->state.store(kSlotWritten, std::memory_order_release);
+  ++write_count_;
+  return ::mediapipe::OkStatus();
+}
+
+void SharedMemoryRing::CloseWriting() {
+  segment_header()->writer_closed.store(1, std::memory_order_release);
+}
+
+::mediapipe::Status SharedMemoryRing::AcquireReadSlot(absl::Duration timeout,
+                                                     SlotInfo* info) {
+  RET_CHECK_EQ(role_, kReader) << "The ring is used for writing.";
+  const int slot = read_count_ % num_slots_;
+  SlotHeader* header = slot_header(slot);
+  const SegmentHeader* ring_header = segment_header();
+  const absl::Time start = absl::Now();
+  absl::Time next_peer_check = start;
+  while (header->state.load(std::memory_order_acquire) != kSlotWritten) {
+    // The writer closes the ring after committing its last slot, so the slot
+    // is checked again once the ring is seen closed.
+    if (ring_header->writer_closed.load(std::memory_order_acquire) &&
+        header->state.load(std::memory_order_acquire) != kSlotWritten) {
+      return ::mediapipe::StatusBuilder(
+                 ::mediapipe::StatusCode::kOutOfRange, MEDIAPIPE_LOC)
+             << "The writer of shared memory segment " << name_
+             << " has closed it.";
+    }
+    const absl::Time now = absl::Now();
+    if (now >= next_peer_check) {
+      MP_RETURN_IF_ERROR(CheckPeer());
+      next_peer_check = now + kPeerCheckInterval;
+    }
+    if (now - start >= timeout) {
+      return ::mediapipe::StatusBuilder(
+                 ::mediapipe::StatusCode::kDeadlineExceeded, MEDIAPIPE_LOC)
+             << "Timed out waiting for the writer of shared memory segment "
+             << name_ << " to write a slot.";
+    }
+    absl::SleepFor(kPollInterval);
+  }
+  header->state.store(kSlotReading, std::memory_order_relaxed);
+  info->slot = slot;
+  info->type_name.assign(header->type_name, header->type_name_size);
+  info->timestamp = header->timestamp;
+  info->size = header->size;
+  ++read_count_;
+  return ::mediapipe::OkStatus();
+}
+
+void SharedMemoryRing::ReleaseReadSlot(int slot) {
+  CHECK_GE(slot, 0);
+  CHECK_LT(slot, num_slots_);
+  slot_header(slot)->state.store(kSlotFree, std::memory_order_release);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,159 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A ring of fixed size slots in POSIX shared memory, which passes packet
+// payloads from one writer process to one reader process.
+
+#ifndef MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
+#define MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// A single-producer, single-consumer ring of slots in a named shared memory
+// segment.  The writer fills the slots in order and the reader reads them in
+// order, but the reader may release the slots it has read in any order, so
+// that the packets it creates can point into the slots for as long as they
+// are alive.  The writer waits for a slot to be released before reusing it.
+//
+// Either side may be opened first: the first one creates and initializes the
+// segment, and the other one attaches to it.  Both sides must agree on the
+// number of slots and the slot size.  The reader removes the segment name when
+// it is destroyed, so a name can be reused by the next pair of processes.  The
+// writer leaves the segment to a reader which has not attached yet.
+//
+// The segment records the process id of each side.  A segment left behind by
+// a side which exited without detaching, or whose side has already been used
+// by a previous run, is stale: it is removed and created anew when a side is
+// opened.  A side waiting for its peer fails once the peer process exits.
+//
+// Example:
+//   // Writer process.
+//   ASSIGN_OR_RETURN(auto ring, SharedMemoryRing::Open(
+//       "/frames", SharedMemoryRing::kWriter, 4, 1 << 22));
+//   ASSIGN_OR_RETURN(int slot, ring->AcquireWriteSlot(absl::Seconds(1)));
+//   memcpy(ring->slot_data(slot), payload, payload_size);
+//   ring->CommitWriteSlot(slot, type_name, timestamp, payload_size);
+//   ...
+//   ring->CloseWriting();
+//
+//   // Reader process.
+//   ASSIGN_OR_RETURN(auto ring, SharedMemoryRing::Open(
+//       "/frames", SharedMemoryRing::kReader, 4, 1 << 22));
+//   SharedMemoryRing::SlotInfo info;
+//   ::mediapipe::Status status;
+//   while ((status = ring->AcquireReadSlot(absl::Seconds(1), &info)).ok()) {
+//     Use(ring->slot_data(info.slot), info.size);
+//     ring->ReleaseReadSlot(info.slot);
+//   }
+//
+// Waiting is done by polling, so the ring suits streams of large payloads
+// such as video frames rather than streams of many small packets.
+class SharedMemoryRing {
+ public:
+  // The maximum length of the type name stored with each slot.
+  static constexpr int kMaxTypeNameSize = 128;
+
+  // The side of the ring used by a SharedMemoryRing object.
+  enum Role { kWriter, kReader };
+
+  // Describes a slot written by the writer.
+  struct SlotInfo {
+    int slot = -1;
+    std::string type_name;
+    int64 timestamp = 0;
+    int64 size = 0;
+  };
+
+  // Creates or attaches to the shared memory segment "name", which must
+  // start with a '/' as required by shm_open, as its "role" side.
+  // "slot_size" is rounded up to a multiple of 64 bytes.  Fails with
+  // AlreadyExists if a live process already uses that side of the segment.
+  static ::mediapipe::StatusOr<std::shared_ptr<SharedMemoryRing>> Open(
+      const std::string& name, Role role, int num_slots, int64 slot_size);
+
+  ~SharedMemoryRing();
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  int num_slots() const { return num_slots_; }
+  int64 slot_size() const { return slot_size_; }
+
+  // Returns the payload memory of "slot", which is aligned to 64 bytes.
+  uint8* slot_data(int slot) const;
+
+  // Writer side.  Waits until the next slot is released by the reader, and
+  // returns it.  Fails with DeadlineExceeded if no slot is released within
+  // "timeout", and with Unavailable if the reader has exited or detached.
+  ::mediapipe::StatusOr<int> AcquireWriteSlot(
+      absl::Duration timeout = absl::InfiniteDuration());
+  // Publishes the first "size" bytes of "slot" to the reader.
+  ::mediapipe::Status CommitWriteSlot(int slot, const std::string& type_name,
+                                      int64 timestamp, int64 size);
+  // Tells the reader that no more slots will be written.
+  void CloseWriting();
+
+  // Reader side.  Waits until the next slot is written, and describes it in
+  // "info".  Fails with OutOfRange once the writer has closed the ring and
+  // all written slots have been acquired, with DeadlineExceeded if no slot is
+  // written within "timeout", and with Unavailable if the writer has exited
+  // without closing the ring.
+  ::mediapipe::Status AcquireReadSlot(absl::Duration timeout, SlotInfo* info);
+  // Returns "slot" to the writer.  This may be called from any thread.
+  void ReleaseReadSlot(int slot);
+
+ private:
+  struct SegmentHeader;
+  struct SlotHeader;
+
+  SharedMemoryRing(const std::string& name, Role role, int num_slots,
+                   int64 slot_size);
+
+  // Creates or attaches to the segment, replacing it if it is stale.
+  ::mediapipe::Status Map();
+  // Creates or attaches to the segment, and registers this side in it.  Sets
+  // "stale" instead if the segment is left over from a previous run.
+  ::mediapipe::Status MapSegment(bool* stale);
+  // Unmaps the segment and closes its file descriptor.
+  void Unmap();
+
+  SegmentHeader* segment_header() const;
+  SlotHeader* slot_header(int slot) const;
+
+  // Returns an error if the process of the other side has exited, or has
+  // detached from the segment.
+  ::mediapipe::Status CheckPeer() const;
+
+  const std::string name_;
+  const Role role_;
+  const int num_slots_;
+  const int64 slot_size_;
+  int fd_ = -1;
+  uint8* base_ = nullptr;
+  int64 mapped_size_ = 0;
+  // The next slot to write, or to read.
+  int64 write_count_ = 0;
+  int64 read_count_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
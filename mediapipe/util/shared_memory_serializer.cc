@@ -0,0 +1,207 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/shared_memory_serializer.h"
+
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/cleanup.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/tool/graph_recorder.h"
+
+namespace mediapipe {
+
+namespace {
+
+struct Registry {
+  absl::Mutex mutex;
+  std::map<size_t, std::pair<std::string, const SharedMemorySerializer*>>
+      by_type_id GUARDED_BY(mutex);
+  std::map<std::string, const SharedMemorySerializer*> by_type_name
+      GUARDED_BY(mutex);
+};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry();
+  return registry;
+}
+
+// The offset of the pixels of an ImageFrame from its header, which keeps the
+// pixels aligned as the ImageFrame allocator does.
+constexpr int64 kImageFramePixelOffset = 64;
+
+struct ImageFrameHeader {
+  int32 format;
+  int32 width;
+  int32 height;
+  int32 width_step;
+};
+
+// Copies the pixels into the buffer.  Packets read from the buffer refer to
+// the pixels in place.
+class ImageFrameSerializer : public SharedMemorySerializer {
+ public:
+  ::mediapipe::Status Write(const Packet& packet, uint8* buffer,
+                            int64 capacity, int64* size) const override {
+    const ImageFrame& frame = packet.Get<ImageFrame>();
+    const int64 pixel_bytes =
+        static_cast<int64>(frame.WidthStep()) * frame.Height();
+    *size = kImageFramePixelOffset + pixel_bytes;
+    RET_CHECK_LE(*size, capacity)
+        << "A " << frame.Width() << "x" << frame.Height()
+        << " image does not fit into a shared memory slot.";
+    ImageFrameHeader header = {frame.Format(), frame.Width(), frame.Height(),
+                               frame.WidthStep()};
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + kImageFramePixelOffset, frame.PixelData(), pixel_bytes);
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::StatusOr<Packet> Read(
+      const uint8* buffer, int64 size,
+      std::function<void()> release) const override {
+    // The slot is released if the payload is rejected.
+    auto release_on_error = MakeCleanup(release);
+    RET_CHECK_GE(size, kImageFramePixelOffset);
+    ImageFrameHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    RET_CHECK_EQ(size, kImageFramePixelOffset +
+                           static_cast<int64>(header.width_step) *
+                               header.height);
+    // The ImageFrame is not modified by downstream calculators, which only
+    // get const access to packet contents.
+    uint8* pixels = const_cast<uint8*>(buffer + kImageFramePixelOffset);
+    release_on_error.release();
+    return Adopt(new ImageFrame(
+        static_cast<ImageFormat::Format>(header.format), header.width,
+        header.height, header.width_step, pixels,
+        [release](uint8*) { release(); }));
+  }
+};
+REGISTER_SHARED_MEMORY_SERIALIZER(ImageFrame, ImageFrameSerializer);
+
+// Copies the matrix into the buffer.  Packets read from the buffer hold a
+// copy of the matrix, since an Eigen matrix cannot adopt external memory.
+class MatrixSerializer : public SharedMemorySerializer {
+ public:
+  ::mediapipe::Status Write(const Packet& packet, uint8* buffer,
+                            int64 capacity, int64* size) const override {
+    const Matrix& matrix = packet.Get<Matrix>();
+    const int64 dims[2] = {matrix.rows(), matrix.cols()};
+    const int64 data_bytes = matrix.size() * sizeof(float);
+    *size = sizeof(dims) + data_bytes;
+    RET_CHECK_LE(*size, capacity)
+        << "A " << matrix.rows() << "x" << matrix.cols()
+        << " matrix does not fit into a shared memory slot.";
+    memcpy(buffer, dims, sizeof(dims));
+    memcpy(buffer + sizeof(dims), matrix.data(), data_bytes);
+    return ::mediapipe::OkStatus();
+  }
+
+  ::mediapipe::StatusOr<Packet> Read(
+      const uint8* buffer, int64 size,
+      std::function<void()> release) const override {
+    // The matrix is copied, so the slot is released on every return.
+    auto release_slot = MakeCleanup(std::move(release));
+    int64 dims[2];
+    RET_CHECK_GE(size, sizeof(dims));
+    memcpy(dims, buffer, sizeof(dims));
+    RET_CHECK_EQ(size, sizeof(dims) + dims[0] * dims[1] * sizeof(float));
+    auto matrix = absl::make_unique<Matrix>(dims[0], dims[1]);
+    memcpy(matrix->data(), buffer + sizeof(dims),
+           matrix->size() * sizeof(float));
+    return Adopt(matrix.release());
+  }
+};
+REGISTER_SHARED_MEMORY_SERIALIZER(Matrix, MatrixSerializer);
+
+}  // namespace
+
+bool SharedMemorySerializerRegistry::Register(
+    size_t type_id, const std::string& type_name,
+    std::unique_ptr<SharedMemorySerializer> serializer) {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  const SharedMemorySerializer* raw_serializer = serializer.release();
+  CHECK(registry->by_type_id
+            .emplace(type_id, std::make_pair(type_name, raw_serializer))
+            .second)
+      << "A shared memory serializer is already registered for " << type_name;
+  registry->by_type_name.emplace(type_name, raw_serializer);
+  return true;
+}
+
+const SharedMemorySerializer* SharedMemorySerializerRegistry::GetByTypeId(
+    size_t type_id, std::string* type_name) {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  auto it = registry->by_type_id.find(type_id);
+  if (it == registry->by_type_id.end()) {
+    return nullptr;
+  }
+  *type_name = it->second.first;
+  return it->second.second;
+}
+
+const SharedMemorySerializer* SharedMemorySerializerRegistry::GetByTypeName(
+    const std::string& type_name) {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  auto it = registry->by_type_name.find(type_name);
+  return it == registry->by_type_name.end() ? nullptr : it->second;
+}
+
+::mediapipe::Status WriteSharedMemoryPacket(const Packet& packet,
+                                            uint8* buffer, int64 capacity,
+                                            std::string* type_name,
+                                            int64* size) {
+  const SharedMemorySerializer* serializer =
+      SharedMemorySerializerRegistry::GetByTypeId(packet.GetTypeId(),
+                                                  type_name);
+  if (serializer) {
+    return serializer->Write(packet, buffer, capacity, size);
+  }
+  std::string value;
+  MP_RETURN_IF_ERROR(tool::SerializePacket(packet, type_name, &value));
+  RET_CHECK_LE(value.size(), capacity)
+      << "A serialized " << *type_name
+      << " packet does not fit into a shared memory slot.";
+  memcpy(buffer, value.data(), value.size());
+  *size = value.size();
+  return ::mediapipe::OkStatus();
+}
+
+::mediapipe::StatusOr<Packet> ReadSharedMemoryPacket(
+    const std::string& type_name, const uint8* buffer, int64 size,
+    std::function<void()> release) {
+  const SharedMemorySerializer* serializer =
+      SharedMemorySerializerRegistry::GetByTypeName(type_name);
+  if (serializer) {
+    return serializer->Read(buffer, size, std::move(release));
+  }
+  Packet packet;
+  const std::string value(reinterpret_cast<const char*>(buffer), size);
+  release();
+  MP_RETURN_IF_ERROR(tool::DeserializePacket(type_name, value, &packet));
+  return packet;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,105 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Serializers which write packet payloads directly into a block of shared
+// memory, and create packets which refer to the payloads in place.
+
+#ifndef MEDIAPIPE_UTIL_SHARED_MEMORY_SERIALIZER_H_
+#define MEDIAPIPE_UTIL_SHARED_MEMORY_SERIALIZER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+
+#include "mediapipe/framework/demangle.h"
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+
+// Writes the payload of packets of one type into a buffer, and creates
+// packets of that type from the buffer.
+class SharedMemorySerializer {
+ public:
+  virtual ~SharedMemorySerializer() = default;
+
+  // Writes the payload of "packet" into the "capacity" bytes at "buffer",
+  // which is aligned to 64 bytes, and sets "size" to the number of bytes
+  // written.
+  virtual ::mediapipe::Status Write(const Packet& packet, uint8* buffer,
+                                    int64 capacity, int64* size) const = 0;
+
+  // Returns a packet holding the payload of "size" bytes at "buffer".  The
+  // packet may refer to the buffer instead of copying it, in which case it
+  // calls "release" once the packet and all of its copies are destroyed.
+  // Otherwise "release" is called before Read returns.
+  virtual ::mediapipe::StatusOr<Packet> Read(
+      const uint8* buffer, int64 size,
+      std::function<void()> release) const = 0;
+};
+
+// Maps packet types to their serializers.  Types are identified across
+// processes by their demangled C++ names.
+class SharedMemorySerializerRegistry {
+ public:
+  // Registers "serializer" for the packet type with type id "type_id" and
+  // name "type_name".  Returns true so that it can initialize a static
+  // variable.
+  static bool Register(size_t type_id, const std::string& type_name,
+                       std::unique_ptr<SharedMemorySerializer> serializer);
+
+  // Returns the serializer for the type with id "type_id" and sets
+  // "type_name" to its name, or returns nullptr if none is registered.
+  static const SharedMemorySerializer* GetByTypeId(size_t type_id,
+                                                   std::string* type_name);
+
+  // Returns the serializer for the type named "type_name", or nullptr if
+  // none is registered.
+  static const SharedMemorySerializer* GetByTypeName(
+      const std::string& type_name);
+};
+
+// Writes "packet" into "buffer" with the serializer registered for its
+// type, or else with the serialize function registered for its type with
+// MEDIAPIPE_REGISTER_TYPE.  Sets "type_name" to the name to pass to
+// ReadSharedMemoryPacket.
+::mediapipe::Status WriteSharedMemoryPacket(const Packet& packet,
+                                            uint8* buffer, int64 capacity,
+                                            std::string* type_name,
+                                            int64* size);
+
+// Reads a packet written by WriteSharedMemoryPacket.  See
+// SharedMemorySerializer::Read for the meaning of "release".
+::mediapipe::StatusOr<Packet> ReadSharedMemoryPacket(
+    const std::string& type_name, const uint8* buffer, int64 size,
+    std::function<void()> release);
+
+}  // namespace mediapipe
+
+// Registers SerializerClass, a default-constructible subclass of
+// SharedMemorySerializer, for packets holding "type".
+#define REGISTER_SHARED_MEMORY_SERIALIZER(type, SerializerClass)             \
+  static bool REGISTRY_STATIC_VAR(shared_memory_serializer, __LINE__) =      \
+      ::mediapipe::SharedMemorySerializerRegistry::Register(                 \
+          ::mediapipe::tool::GetTypeHash<type>(),                            \
+          ::mediapipe::Demangle(typeid(type).name()),                        \
+          std::unique_ptr<::mediapipe::SharedMemorySerializer>(              \
+              new SerializerClass()))
+
+#endif  // MEDIAPIPE_UTIL_SHARED_MEMORY_SERIALIZER_H_
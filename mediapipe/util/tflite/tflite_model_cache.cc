@@ -0,0 +1,102 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_cache.h"
+
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "tensorflow/lite/kernels/register.h"
+
+namespace mediapipe {
+
+const GraphService<TfLiteModelCache> kTfLiteModelCacheService(
+    "kTfLiteModelCacheService");
+
+::mediapipe::StatusOr<std::shared_ptr<tflite::FlatBufferModel>>
+TfLiteModelCache::GetModel(const std::string& path) {
+  absl::MutexLock lock(&mutex_);
+  return GetModelLocked(path);
+}
+
+::mediapipe::StatusOr<std::shared_ptr<tflite::FlatBufferModel>>
+TfLiteModelCache::GetModelLocked(const std::string& path) {
+  std::weak_ptr<tflite::FlatBufferModel>& cached = models_[path];
+  std::shared_ptr<tflite::FlatBufferModel> model = cached.lock();
+  if (!model) {
+    model = tflite::FlatBufferModel::BuildFromFile(path.c_str());
+    RET_CHECK(model) << "Failed to load the TF Lite model " << path;
+    cached = model;
+  }
+  return model;
+}
+
+::mediapipe::StatusOr<TfLiteModelCache::InterpreterPtr>
+TfLiteModelCache::GetInterpreter(const std::string& path, int num_threads) {
+  const InterpreterKey key(path, num_threads > 0 ? num_threads : -1);
+  std::shared_ptr<tflite::FlatBufferModel> model;
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = idle_interpreters_.find(key);
+    if (it != idle_interpreters_.end() && !it->second.empty()) {
+      model = std::move(it->second.back().model);
+      interpreter = std::move(it->second.back().interpreter);
+      it->second.pop_back();
+    } else {
+      ASSIGN_OR_RETURN(model, GetModelLocked(path));
+    }
+  }
+  if (!interpreter) {
+    const tflite::ops::builtin::BuiltinOpResolver op_resolver;
+    tflite::InterpreterBuilder(*model, op_resolver)(&interpreter);
+    RET_CHECK(interpreter);
+    if (num_threads > 0) {
+      interpreter->SetNumThreads(num_threads);
+    }
+    RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  }
+  return InterpreterPtr(interpreter.release(),
+                        [this, key, model](tflite::Interpreter* interpreter) {
+                          Release(key, model, interpreter);
+                        });
+}
+
+void TfLiteModelCache::Release(const InterpreterKey& key,
+                               std::shared_ptr<tflite::FlatBufferModel> model,
+                               tflite::Interpreter* interpreter) {
+  absl::MutexLock lock(&mutex_);
+  IdleInterpreter idle;
+  idle.model = std::move(model);
+  idle.interpreter.reset(interpreter);
+  idle_interpreters_[key].push_back(std::move(idle));
+}
+
+void TfLiteModelCache::ReleaseIdleInterpreters() {
+  std::map<InterpreterKey, std::vector<IdleInterpreter>> idle_interpreters;
+  {
+    absl::MutexLock lock(&mutex_);
+    idle_interpreters.swap(idle_interpreters_);
+  }
+}
+
+int TfLiteModelCache::NumIdleInterpreters() {
+  absl::MutexLock lock(&mutex_);
+  int count = 0;
+  for (const auto& entry : idle_interpreters_) {
+    count += entry.second.size();
+  }
+  return count;
+}
+
+}  // namespace mediapipe
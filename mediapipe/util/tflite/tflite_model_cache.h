@@ -0,0 +1,105 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_
+#define MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model.h"
+
+namespace mediapipe {
+
+// Shares TF Lite models and interpreters between the graphs of a process.
+//
+// A model is loaded with tflite::FlatBufferModel::BuildFromFile, which maps
+// the model file into memory, once for all of its users, and is unloaded when
+// the last of them releases it.  Interpreters of a model return to the cache
+// when they are released, and are handed out again to the next user of the
+// model asking for the same number of threads, instead of being built and
+// allocated anew.
+//
+// The cache is thread-safe, and must outlive the interpreters it hands out.
+// It is available to TfLiteInferenceCalculator as a graph service, e.g.:
+//   auto cache = std::make_shared<TfLiteModelCache>();
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(kTfLiteModelCacheService,
+//                                             cache));
+class TfLiteModelCache {
+ public:
+  // An interpreter, which returns to the cache when destroyed.
+  using InterpreterPtr =
+      std::unique_ptr<tflite::Interpreter,
+                      std::function<void(tflite::Interpreter*)>>;
+
+  // Returns the model at "path", loading it if it is not in use.
+  ::mediapipe::StatusOr<std::shared_ptr<tflite::FlatBufferModel>> GetModel(
+      const std::string& path);
+
+  // Returns an interpreter of the model at "path" with the builtin ops and
+  // "num_threads" threads, or the TF Lite default if not positive.  Its
+  // tensors are allocated, and the interpreter keeps the model loaded.
+  // The inputs of an interpreter which was used before may refer to buffers
+  // of its previous user, and must be set before invoking it.
+  //
+  // An interpreter is recycled as soon as its InterpreterPtr is destroyed,
+  // and keeps its tensor buffers.  Any data of its previous user pointing
+  // into those buffers, such as the output tensors TfLiteInferenceCalculator
+  // emits without copying, is overwritten by the next user, and must not be
+  // used once the InterpreterPtr is released.
+  ::mediapipe::StatusOr<InterpreterPtr> GetInterpreter(const std::string& path,
+                                                       int num_threads);
+
+  // Destroys the idle interpreters, unloading the models which are no
+  // longer used.
+  void ReleaseIdleInterpreters();
+
+  int NumIdleInterpreters();
+
+ private:
+  struct IdleInterpreter {
+    // Declared first, so that the interpreter is destroyed before it.
+    std::shared_ptr<tflite::FlatBufferModel> model;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+  using InterpreterKey = std::pair<std::string, int>;
+
+  ::mediapipe::StatusOr<std::shared_ptr<tflite::FlatBufferModel>>
+  GetModelLocked(const std::string& path) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns "interpreter" to the idle interpreters of "key".
+  void Release(const InterpreterKey& key,
+               std::shared_ptr<tflite::FlatBufferModel> model,
+               tflite::Interpreter* interpreter);
+
+  absl::Mutex mutex_;
+  std::map<std::string, std::weak_ptr<tflite::FlatBufferModel>> models_
+      GUARDED_BY(mutex_);
+  std::map<InterpreterKey, std::vector<IdleInterpreter>> idle_interpreters_
+      GUARDED_BY(mutex_);
+};
+
+extern const GraphService<TfLiteModelCache> kTfLiteModelCacheService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TFLITE_TFLITE_MODEL_CACHE_H_